@@ -0,0 +1,178 @@
+// Allocation hot paths: untracked malloc vs tracked new/delete (every tracking mode and
+// backend), aligned allocation and ISentry-routed allocation, across sizes and threads.
+//
+// Every single-threaded run also reports `overhead_B`: the bytes each block costs beyond
+// the requested size (header, end marker, padding, allocator rounding).
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <new>
+
+#include "mem_sentry/heap.h"
+#include "mem_sentry/mem_sentry.h"
+#include "mem_sentry/sentry.h"
+
+#include "bench_common.h"
+
+using MEM_SENTRY::heap::Heap;
+using MEM_SENTRY::heap::TrackingMode;
+
+namespace {
+    constexpr size_t ALIGNMENT = 64;
+
+    /** @brief The heap configurations under test, built once. */
+    struct Heaps {
+        Heap m_Shared{"BenchShared"};
+        Heap m_ThreadLocal{"BenchThreadLocal", TrackingMode::ThreadLocal};
+        Heap m_Slab{"BenchSlab", TrackingMode::ThreadLocal};
+        Heap m_Sampled{"BenchSampled", TrackingMode::ThreadLocal};
+
+        Heaps() {
+            m_Slab.SetSlabBackend(true);
+            m_Sampled.SetSlabBackend(true);
+            m_Sampled.SetSamplingInterval(512 * 1024);
+        }
+    };
+
+    Heaps& heaps() {
+        static Heaps s_Heaps;
+        return s_Heaps;
+    }
+
+    Heap* sharedHeap() { return &heaps().m_Shared; }
+    Heap* threadLocalHeap() { return &heaps().m_ThreadLocal; }
+    Heap* slabHeap() { return &heaps().m_Slab; }
+    Heap* sampledHeap() { return &heaps().m_Sampled; }
+
+    size_t alignedSize(size_t size) {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    /** @brief Sizes x thread counts every allocation benchmark runs with. */
+    void allocArgs(benchmark::internal::Benchmark* b) {
+        b->RangeMultiplier(8)->Range(16, 64 << 10)->ThreadRange(1, 8)->UseRealTime();
+    }
+
+    template<typename Alloc, typename Release>
+    void reportOverhead(benchmark::State& state, size_t size, Alloc alloc, Release release) {
+        // the counter would be summed over threads, and the measurement needs a quiet process.
+        if (state.threads() == 1) {
+            state.counters["overhead_B"] = bench::OverheadPerAllocation(size, alloc, release);
+        }
+    }
+
+    /**
+     * @brief Overhead of tracked blocks, measured on a fresh heap configured like `like`
+     * so slab pages kept by earlier runs don't hide the cost of new ones.
+     */
+    void reportHeapOverhead(benchmark::State& state, size_t size, Heap* like, size_t alignment = 0) {
+        if (state.threads() != 1)
+            return;
+
+        Heap fresh("BenchOverhead", like->GetTrackingMode());
+        fresh.SetSlabBackend(like->UsesSlabBackend());
+        fresh.SetSamplingInterval(like->GetSamplingInterval());
+
+        if (alignment) {
+            reportOverhead(state, size,
+                [&fresh, alignment](size_t n) { return ::operator new(n, std::align_val_t{alignment}, &fresh); },
+                [alignment](void* p) { ::operator delete(p, std::align_val_t{alignment}); });
+        } else {
+            reportOverhead(state, size,
+                [&fresh](size_t n) { return ::operator new(n, &fresh); },
+                [](void* p) { ::operator delete(p); });
+        }
+    }
+
+    /** @brief A payload of `N` bytes routed to its own heap through ISentry. */
+    template<size_t N>
+    struct SentryObject : MEM_SENTRY::sentry::ISentry<SentryObject<N>> {
+        char m_Data[N];
+    };
+}
+
+static void BM_UntrackedMallocFree(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+
+    for (auto _ : state) {
+        void* p = std::malloc(size);
+        benchmark::DoNotOptimize(p);
+        std::free(p);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    reportOverhead(state, size, [](size_t n) { return std::malloc(n); }, [](void* p) { std::free(p); });
+}
+BENCHMARK(BM_UntrackedMallocFree)->Apply(allocArgs);
+
+static void BM_TrackedNewDelete(benchmark::State& state, Heap* (*heap)()) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    Heap* target = heap();
+
+    for (auto _ : state) {
+        void* p = ::operator new(size, target);
+        benchmark::DoNotOptimize(p);
+        ::operator delete(p);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    reportHeapOverhead(state, size, target);
+}
+BENCHMARK_CAPTURE(BM_TrackedNewDelete, shared, sharedHeap)->Apply(allocArgs);
+BENCHMARK_CAPTURE(BM_TrackedNewDelete, thread_local, threadLocalHeap)->Apply(allocArgs);
+BENCHMARK_CAPTURE(BM_TrackedNewDelete, slab, slabHeap)->Apply(allocArgs);
+BENCHMARK_CAPTURE(BM_TrackedNewDelete, sampled, sampledHeap)->Apply(allocArgs);
+
+static void BM_UntrackedAlignedAlloc(benchmark::State& state) {
+    const size_t size = alignedSize(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        void* p = std::aligned_alloc(ALIGNMENT, size);
+        benchmark::DoNotOptimize(p);
+        std::free(p);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    reportOverhead(state, size,
+        [](size_t n) { return std::aligned_alloc(ALIGNMENT, n); },
+        [](void* p) { std::free(p); });
+}
+BENCHMARK(BM_UntrackedAlignedAlloc)->Apply(allocArgs);
+
+static void BM_TrackedAlignedNew(benchmark::State& state, Heap* (*heap)()) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    Heap* target = heap();
+
+    for (auto _ : state) {
+        void* p = ::operator new(size, std::align_val_t{ALIGNMENT}, target);
+        benchmark::DoNotOptimize(p);
+        ::operator delete(p, std::align_val_t{ALIGNMENT});
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    reportHeapOverhead(state, size, target, ALIGNMENT);
+}
+BENCHMARK_CAPTURE(BM_TrackedAlignedNew, shared, sharedHeap)->Apply(allocArgs);
+BENCHMARK_CAPTURE(BM_TrackedAlignedNew, thread_local, threadLocalHeap)->Apply(allocArgs);
+
+template<size_t N>
+static void BM_ISentryNew(benchmark::State& state) {
+    SentryObject<N>::setHeap(threadLocalHeap());
+
+    for (auto _ : state) {
+        auto* object = new SentryObject<N>();
+        benchmark::DoNotOptimize(object);
+        delete object;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    reportOverhead(state, sizeof(SentryObject<N>),
+        [](size_t) -> void* { return new SentryObject<N>(); },
+        [](void* p) { delete static_cast<SentryObject<N>*>(p); });
+}
+BENCHMARK_TEMPLATE(BM_ISentryNew, 16)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ISentryNew, 256)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ISentryNew, 4096)->ThreadRange(1, 8)->UseRealTime();
+
+BENCHMARK_MAIN();
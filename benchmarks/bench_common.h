@@ -0,0 +1,118 @@
+#pragma once
+// Helpers shared by the MemSentry microbenchmarks.
+
+#include <cstddef>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#include <vector>
+
+namespace bench {
+    /**
+     * @brief Bytes glibc currently hands out (arena chunks + mmapped chunks).
+     * @note Process-wide: only meaningful while a single thread allocates.
+     */
+    inline size_t MallocInUse() noexcept {
+        struct mallinfo2 info = ::mallinfo2();
+        return info.uordblks + info.hblkhd;
+    }
+
+    /**
+     * @brief Average bytes each block really costs beyond the `size` bytes asked for.
+     *
+     * Allocates `count` blocks of `size` bytes through `alloc`, reads how much malloc's
+     * in-use bytes grew and frees them through `release`. Includes headers, end markers,
+     * alignment padding, size-class rounding and malloc's own chunk overhead.
+     *
+     * @note Slab pages come from malloc too, but a slab heap keeps its pages after the
+     * blocks are freed: measure slab configurations on a fresh heap.
+     */
+    template<typename Alloc, typename Release>
+    double OverheadPerAllocation(size_t size, Alloc alloc, Release release, size_t count = 4096) {
+        // the vector itself must not show up in the measurement.
+        std::vector<void*> blocks;
+        blocks.reserve(count);
+
+        size_t before = MallocInUse();
+
+        for (size_t i = 0; i < count; ++i) {
+            blocks.push_back(alloc(size));
+        }
+
+        size_t after = MallocInUse();
+
+        for (void* block : blocks) {
+            release(block);
+        }
+
+        return (double)(after - before) / (double)count - (double)size;
+    }
+
+    /**
+     * @brief Pins the calling thread to `cpu` and remembers its previous affinity.
+     *
+     * Benchmarks run on the same threads one after another, so every pin is undone
+     * by the destructor. CPUs the machine doesn't have are ignored.
+     */
+    class ScopedPin {
+    private:
+        cpu_set_t m_Previous;
+        bool m_Pinned{false};
+
+    public:
+        explicit ScopedPin(int cpu) {
+            if (cpu < 0 || cpu >= (int)std::thread::hardware_concurrency())
+                return;
+
+            if (::pthread_getaffinity_np(::pthread_self(), sizeof(m_Previous), &m_Previous) != 0)
+                return;
+
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            m_Pinned = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+        }
+
+        ~ScopedPin() {
+            if (m_Pinned) {
+                ::pthread_setaffinity_np(::pthread_self(), sizeof(m_Previous), &m_Previous);
+            }
+        }
+
+        ScopedPin(const ScopedPin&) = delete;
+        ScopedPin& operator=(const ScopedPin&) = delete;
+    };
+
+    /**
+     * @brief Busy-wait step: a pause hint, and a yield every so often so two
+     * spinning threads sharing one core still make progress.
+     */
+    inline void SpinWait(unsigned& spins) noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+        if ((++spins & 1023) == 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief CPU pairs (producer, consumer) worth comparing on this machine:
+     * same core, neighbour core, middle (often the other socket or SMT sibling), last.
+     */
+    inline std::vector<std::pair<int, int>> CorePairs() {
+        int cpus = (int)std::thread::hardware_concurrency();
+        std::vector<std::pair<int, int>> pairs{{0, 0}};
+
+        for (int other : {1, cpus / 2, cpus - 1}) {
+            if (other > 0 && other < cpus && pairs.back().second != other) {
+                pairs.push_back({0, other});
+            }
+        }
+
+        return pairs;
+    }
+}
@@ -0,0 +1,227 @@
+// Pool hot paths: RingPool pop/push on one thread, SPSC throughput and one-way latency
+// percentiles between pinned cores, and PoolChain pops while the chain grows.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mem_pools/chain.h"
+#include "mem_pools/pool.h"
+
+#include "bench_common.h"
+
+using MEM_SENTRY::mem_pool::Buffer;
+using MEM_SENTRY::mem_pool::GrowthPolicy;
+using MEM_SENTRY::mem_pool::PoolChain;
+using MEM_SENTRY::mem_pool::RingPool;
+
+namespace {
+    constexpr size_t RING_SIZE = 1024;
+    constexpr size_t BULK = 32;
+
+    /** @brief Inline buffer holding a steady_clock timestamp (ns). */
+    using StampPool = RingPool<uint64_t, 64, false>;
+    using StampBuffer = Buffer<uint64_t, 64, false>;
+
+    uint64_t nowNs() noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    StampBuffer* popWait(StampPool& pool, const std::atomic<bool>* stop = nullptr) {
+        unsigned spins = 0;
+
+        while (true) {
+            if (StampBuffer* buffer = pool.pop())
+                return buffer;
+
+            if (stop && stop->load(std::memory_order_relaxed))
+                return nullptr;
+
+            bench::SpinWait(spins);
+        }
+    }
+}
+
+static void BM_RingPoolPopPush(benchmark::State& state) {
+    RingPool<uint64_t, 64, true> pool(false, RING_SIZE, uint64_t{0});
+
+    for (auto _ : state) {
+        auto* buffer = pool.pop();
+        benchmark::DoNotOptimize(buffer);
+        pool.push(buffer);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RingPoolPopPush);
+
+static void BM_RingPoolBulk(benchmark::State& state) {
+    RingPool<uint64_t, 64, true> pool(false, RING_SIZE, uint64_t{0});
+    Buffer<uint64_t, 64, true>* buffers[BULK];
+
+    for (auto _ : state) {
+        size_t popped = pool.pop_bulk(buffers, BULK);
+        benchmark::DoNotOptimize(buffers);
+        pool.push_bulk(buffers, popped);
+    }
+
+    state.SetItemsProcessed(state.iterations() * BULK);
+}
+BENCHMARK(BM_RingPoolBulk);
+
+/**
+ * SPSC throughput: buffers circulate producer -> consumer through one ring and come back
+ * through another, so each ring has exactly one producer and one consumer.
+ * Args: producer CPU, consumer CPU.
+ */
+static void BM_RingPoolSPSC(benchmark::State& state) {
+    StampPool forward(true, RING_SIZE);
+    StampPool back(false, RING_SIZE, uint64_t{0});
+    std::atomic<bool> stop{false};
+
+    std::thread producer([&]() {
+        bench::ScopedPin pin(static_cast<int>(state.range(0)));
+
+        while (StampBuffer* buffer = popWait(back, &stop)) {
+            unsigned spins = 0;
+            while (!forward.push(buffer)) bench::SpinWait(spins);
+        }
+    });
+
+    bench::ScopedPin pin(static_cast<int>(state.range(1)));
+
+    for (auto _ : state) {
+        StampBuffer* buffer = popWait(forward);
+        benchmark::DoNotOptimize(buffer);
+        back.push(buffer);
+    }
+
+    stop.store(true, std::memory_order_relaxed);
+    producer.join();
+
+    // hand the buffers still in flight back to their owner.
+    while (StampBuffer* buffer = forward.pop()) back.push(buffer);
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * SPSC one-way latency: a single stamped buffer ping-pongs between the two threads, the
+ * consumer records `now - stamp` for every hop. Reports p50 / p99 / p99.9 in ns.
+ * Args: producer CPU, consumer CPU.
+ */
+static void BM_RingPoolLatency(benchmark::State& state) {
+    StampPool forward(true, RING_SIZE);
+    StampPool back(false, 2, uint64_t{0});
+    std::atomic<bool> stop{false};
+
+    std::vector<uint64_t> samples;
+    samples.reserve(static_cast<size_t>(state.max_iterations));
+
+    std::thread producer([&]() {
+        bench::ScopedPin pin(static_cast<int>(state.range(0)));
+
+        while (StampBuffer* buffer = popWait(back, &stop)) {
+            buffer->m_Buffer = nowNs();
+            forward.push(buffer);
+        }
+    });
+
+    bench::ScopedPin pin(static_cast<int>(state.range(1)));
+
+    for (auto _ : state) {
+        StampBuffer* buffer = popWait(forward);
+        samples.push_back(nowNs() - buffer->m_Buffer);
+        back.push(buffer);
+    }
+
+    stop.store(true, std::memory_order_relaxed);
+    producer.join();
+
+    while (StampBuffer* buffer = forward.pop()) back.push(buffer);
+
+    if (!samples.empty()) {
+        std::sort(samples.begin(), samples.end());
+
+        const auto percentile = [&](double p) {
+            return static_cast<double>(samples[static_cast<size_t>(p * (samples.size() - 1))]);
+        };
+
+        state.counters["p50_ns"] = percentile(0.50);
+        state.counters["p99_ns"] = percentile(0.99);
+        state.counters["p999_ns"] = percentile(0.999);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/**
+ * PoolChain growth: every iteration builds a fresh chain of small pools and pops
+ * `range(0)` buffers, forcing it to grow, with inline growth (threshold 0) or with
+ * the next pool pre-built by the helper thread (threshold `range(1)`).
+ * Building and tearing down the chain is not timed.
+ */
+static void BM_PoolChainGrowth(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    const size_t threshold = static_cast<size_t>(state.range(1));
+
+    std::vector<Buffer<uint64_t, 64, false>*> popped(count);
+    size_t pools = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto* chain = new PoolChain<uint64_t, 64, false>(64, uint64_t{0});
+        if (threshold) {
+            chain->setGrowthPolicy(GrowthPolicy{threshold, {}});
+        }
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < count; ++i) {
+            popped[i] = chain->pop();
+        }
+
+        benchmark::DoNotOptimize(popped.data());
+
+        state.PauseTiming();
+        for (auto* buffer : popped) {
+            chain->push(buffer);
+        }
+        pools = chain->poolCount();
+        delete chain;
+        state.ResumeTiming();
+    }
+
+    state.counters["pools"] = static_cast<double>(pools);
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_PoolChainGrowth)
+    ->ArgsProduct({{1 << 10, 1 << 14}, {0, 32}})
+    ->ArgNames({"buffers", "threshold"})
+    ->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv) {
+    // the interesting core pairs depend on the machine, so these are registered at run time.
+    for (auto [producerCpu, consumerCpu] : bench::CorePairs()) {
+        benchmark::RegisterBenchmark("BM_RingPoolSPSC", BM_RingPoolSPSC)
+            ->Args({producerCpu, consumerCpu})->ArgNames({"producer", "consumer"})->UseRealTime();
+        benchmark::RegisterBenchmark("BM_RingPoolLatency", BM_RingPoolLatency)
+            ->Args({producerCpu, consumerCpu})->ArgNames({"producer", "consumer"})->UseRealTime();
+    }
+
+    benchmark::Initialize(&argc, argv);
+
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
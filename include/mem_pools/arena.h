@@ -0,0 +1,214 @@
+#pragma once
+#include "mem_pools/buffer.h"
+#include "mem_sentry/constants.h"
+#include "mem_sentry/numa.h"
+
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+
+namespace MEM_SENTRY::mem_pool {
+
+/**
+ * @brief Tag selecting contiguous arena storage for a pool that owns its buffers.
+ *
+ * `RingPool<T, alignment, isDynamic> pool(ArenaStorage{}, size, args...)` builds a
+ * full pool whose buffers all live in one BufferArena instead of separate
+ * allocations.
+ */
+struct ArenaStorage {
+    /**
+     * @brief Back the arena with transparent huge pages (2 MiB aligned + MADV_HUGEPAGE).
+     * @note Huge-page arenas come from std::aligned_alloc and are not tracked by MemSentry.
+     */
+    bool m_HugePages{false};
+
+    /**
+     * @brief NUMA node the arena is placed on, numa::NO_NODE (default) for first-touch.
+     *
+     * The block is page aligned and bound to the node (numa::BindMemory()) before any
+     * buffer is constructed, so every buffer and payload is node-local whichever
+     * thread builds the pool.
+     * @note Node-bound arenas come from std::aligned_alloc and are not tracked by MemSentry.
+     */
+    int m_Node{MEM_SENTRY::numa::NO_NODE};
+};
+
+/**
+ * @brief One aligned block holding `count` constructed `Buffer<T, alignment, isDynamic>`
+ * objects and, for dynamic buffers, their payloads.
+ *
+ * Layout: [Buffer 0 .. Buffer N-1] [T 0 .. T N-1]
+ * - Buffers are packed with stride `sizeof(Buffer)` (already a multiple of its alignment).
+ * - Payloads start on an `alignment` boundary and are packed with stride
+ *   `sizeof(T)` rounded up to `alignment`, so iterating them is a linear walk.
+ * - Inline buffers (`isDynamic == false`) already hold their `T`; there is no payload area.
+ *
+ * Everything is constructed in place (dynamic buffers through InPlaceStorage) and the
+ * destructor runs every destructor and releases the block with a single free, instead of
+ * 2 x N scattered allocations that each carry an AllocHeader.
+ *
+ * @note Not thread-safe; pools create and destroy it from their constructor/destructor.
+ */
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment = 0, bool isDynamic = true>
+class BufferArena {
+private:
+    using BufferType = Buffer<T, alignment, isDynamic>;
+
+    /** @brief Boundary the payload area and every payload start on. */
+    static constexpr size_t PAYLOAD_ALIGN = alignment > alignof(T) ? alignment : alignof(T);
+
+    /** @brief Distance between two payloads. */
+    static constexpr size_t PAYLOAD_STRIDE = (sizeof(T) + PAYLOAD_ALIGN - 1) & ~(PAYLOAD_ALIGN - 1);
+
+    /** @brief Alignment of the whole block. */
+    static constexpr size_t BLOCK_ALIGN = PAYLOAD_ALIGN > MEM_SENTRY::constants::CACHE_LINE_SIZE
+        ? PAYLOAD_ALIGN : MEM_SENTRY::constants::CACHE_LINE_SIZE;
+
+    /** @brief transparent huge page size on x86-64 and aarch64 (4K base pages). */
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /** @brief Start of the block, nullptr if the allocation failed. */
+    char* p_Memory{nullptr};
+
+    /** @brief Size of the block in bytes. */
+    size_t m_Bytes{0};
+
+    /** @brief Offset of the first payload from p_Memory. */
+    size_t m_PayloadOffset{0};
+
+    /** @brief Number of constructed buffers. */
+    size_t m_Count{0};
+
+    /** @brief Base page size, the alignment of node-bound arenas. */
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    /** @brief Whether the block came from std::aligned_alloc (huge-page or node-bound path). */
+    bool m_PageAligned{false};
+
+    void release() {
+        for (size_t i = 0; i < m_Count; ++i) {
+            at(i)->~BufferType();
+        }
+
+        if (p_Memory) {
+            if (m_PageAligned) {
+                std::free(p_Memory);
+            } else {
+                ::operator delete(p_Memory, std::align_val_t{BLOCK_ALIGN});
+            }
+        }
+
+        p_Memory = nullptr;
+        m_Count = 0;
+    }
+
+public:
+    /**
+     * @brief Allocate the block and construct `count` buffers from `args`.
+     *
+     * @param count Number of buffers.
+     * @param storage Huge pages and NUMA placement of the block (see ArenaStorage).
+     * @param args Forwarded (as lvalues) to every `T` constructor.
+     *
+     * @note Check isValid() afterwards.
+     */
+    template<typename... Args>
+    BufferArena(size_t count, ArenaStorage storage, Args&&... args)
+        : m_PageAligned(storage.m_HugePages || storage.m_Node != MEM_SENTRY::numa::NO_NODE) {
+        m_PayloadOffset = isDynamic
+            ? (count * sizeof(BufferType) + PAYLOAD_ALIGN - 1) & ~(PAYLOAD_ALIGN - 1)
+            : count * sizeof(BufferType);
+        m_Bytes = m_PayloadOffset + (isDynamic ? count * PAYLOAD_STRIDE : 0);
+
+        if (m_Bytes == 0) {
+            return;
+        }
+
+        if (m_PageAligned) {
+            size_t page = storage.m_HugePages ? HUGE_PAGE_SIZE : PAGE_SIZE;
+
+            // aligned_alloc needs a multiple of the alignment.
+            m_Bytes = (m_Bytes + page - 1) & ~(page - 1);
+            p_Memory = static_cast<char*>(std::aligned_alloc(page, m_Bytes));
+
+            // both are only hints: without THP or NUMA support the arena still works
+            // with normal, first-touch pages.
+            if (p_Memory && storage.m_HugePages) {
+                ::madvise(p_Memory, m_Bytes, MADV_HUGEPAGE);
+            }
+
+            if (p_Memory && storage.m_Node != MEM_SENTRY::numa::NO_NODE) {
+                MEM_SENTRY::numa::BindMemory(p_Memory, m_Bytes, storage.m_Node);
+            }
+        } else {
+            p_Memory = static_cast<char*>(::operator new(m_Bytes, std::align_val_t{BLOCK_ALIGN}, std::nothrow));
+        }
+
+        if (!p_Memory) {
+            return;
+        }
+
+        for (; m_Count < count; ++m_Count) {
+            void* slot = p_Memory + m_Count * sizeof(BufferType);
+
+            /*
+                NOTE: we didn't use std::forward because we need to keep the args lvalue..
+                every buffer is built from the same arguments.
+            */
+            if constexpr (isDynamic) {
+                new (slot) BufferType(InPlaceStorage{p_Memory + m_PayloadOffset + m_Count * PAYLOAD_STRIDE}, args...);
+            } else {
+                new (slot) BufferType(args...);
+            }
+        }
+    }
+
+    /**
+     * @brief Destroy every buffer and free the block at once.
+     */
+    ~BufferArena() {
+        release();
+    }
+
+    BufferArena(const BufferArena&) = delete;
+    BufferArena& operator=(const BufferArena&) = delete;
+
+    /**
+     * @brief true if the block was allocated and every buffer constructed.
+     */
+    bool isValid() const noexcept {
+        return p_Memory != nullptr;
+    }
+
+    /**
+     * @brief The i-th buffer.
+     */
+    BufferType* at(size_t i) noexcept {
+        return reinterpret_cast<BufferType*>(p_Memory + i * sizeof(BufferType));
+    }
+
+    /**
+     * @brief Number of buffers in the arena.
+     */
+    size_t count() const noexcept {
+        return m_Count;
+    }
+
+    /**
+     * @brief Size of the block in bytes (rounded up to the (huge) page size for
+     * huge-page and node-bound arenas).
+     */
+    size_t bytes() const noexcept {
+        return m_Bytes;
+    }
+
+    /**
+     * @brief true if `buffer` is one of this arena's buffers.
+     */
+    bool owns(const BufferType* buffer) const noexcept {
+        const char* p = reinterpret_cast<const char*>(buffer);
+        return p_Memory && p >= p_Memory && p < p_Memory + m_Count * sizeof(BufferType);
+    }
+};
+}
@@ -3,6 +3,19 @@
 #include "mem_pools/concepts.h"
 
 namespace MEM_SENTRY::mem_pool {
+    /**
+     * @brief Tag to construct a dynamic Buffer's `T` in caller-provided storage.
+     *
+     * `Buffer<T, alignment, true> b(InPlaceStorage{ptr}, args...)` placement-news
+     * `T` at `ptr` instead of allocating it; the destructor then only runs `~T()`
+     * and leaves the memory to its owner (see BufferArena).
+     *
+     * @note `p_Storage` must hold `sizeof(T)` bytes aligned to `alignment`.
+     */
+    struct InPlaceStorage {
+        void* p_Storage;
+    };
+
     /**
      * @brief Buffer storage wrapper (dynamic or inline)
      *
@@ -45,21 +58,35 @@ namespace MEM_SENTRY::mem_pool {
      * 
      * - Inline:  `Buffer<MyType, 64, false> b(arg1);` — constructs `MyType`
      *   inline inside the `Buffer` object.
+     * 
+     * - In place: `Buffer<MyType, 32, true> b(InPlaceStorage{mem}, arg1);` —
+     *   constructs `MyType` at `mem`, which the caller owns and frees.
      */
     template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic = true>
     struct Buffer {
         T* p_Buffer;
 
+        /** @brief true when `p_Buffer` lives in caller-provided storage. */
+        bool m_InPlace{false};
+
         template<typename... Args>
         Buffer(Args&&... args) {
             void* ptr = ::operator new(sizeof(T), std::align_val_t{alignment});
             p_Buffer = new (ptr) T(std::forward<Args>(args)...);
         }
 
+        template<typename... Args>
+        Buffer(InPlaceStorage storage, Args&&... args) : m_InPlace(true) {
+            p_Buffer = new (storage.p_Storage) T(std::forward<Args>(args)...);
+        }
+
         ~Buffer() {
             if (p_Buffer) {
                 p_Buffer->~T();
-                ::operator delete(p_Buffer, std::align_val_t{alignment});
+
+                if (!m_InPlace) {
+                    ::operator delete(p_Buffer, std::align_val_t{alignment});
+                }
             }
         }
 
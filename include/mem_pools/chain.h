@@ -2,8 +2,12 @@
 #include "mem_pools/concepts.h"
 #include "mem_pools/pool.h"
 #include "mem_pools/buffer.h"
+#include "mem_sentry/stats.h"
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <thread>
 
 namespace MEM_SENTRY::mem_pool {
 
@@ -28,6 +32,11 @@ struct ChainNode {
      */
     CacheAlignedAtomic<ChainNode*> m_Next;
 
+    /**
+     * @brief Retire epoch of the node once `PoolChain::trim()` unlinked it, 0 while live.
+     */
+    uint64_t m_RetireEpoch{0};
+
     /**
      * @brief Construct a ChainNode wrapping the given pool.
      *
@@ -42,6 +51,79 @@ struct ChainNode {
     }
 };
 
+/**
+ * @brief Index of up to 64 consecutive nodes of a `PoolChain`.
+ *
+ * Bit `i` of `m_NonEmpty` / `m_NonFull` hints that pool `p_Nodes[i]` has a
+ * buffer to pop / room for a push. The hints are set after a successful
+ * push / pop (or when the pool is created) and cleared when an operation on
+ * the pool fails; a stale bit only costs one failed try, and a missed bit is
+ * recovered by the full traversal that runs before the chain grows.
+ */
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment = 0, bool isDynamic = true>
+struct alignas(MEM_SENTRY::constants::CACHE_LINE_SIZE) PoolGroup {
+    /** @brief Pools per group, one bit each. */
+    static constexpr size_t GROUP_SIZE = 64;
+
+    /** @brief Pools that probably have a buffer to pop. */
+    std::atomic<uint64_t> m_NonEmpty{0};
+
+    /** @brief Pools that probably have room for a push. */
+    std::atomic<uint64_t> m_NonFull{0};
+
+    /** @brief Nodes registered in this group, published after `p_Nodes[i]` is written. */
+    std::atomic<size_t> m_Count{0};
+
+    /** @brief Next group, set once this one is full. */
+    std::atomic<PoolGroup*> p_Next{nullptr};
+
+    /**
+     * @brief The nodes, in chain order.
+     * @note Atomic because a trimmed slot may be reused while a stale hint still points at it.
+     */
+    std::atomic<ChainNode<T, alignment, isDynamic>*> p_Nodes[GROUP_SIZE]{};
+};
+
+/**
+ * @brief When `PoolChain` gives memory back after a spike.
+ *
+ * A pool can only be retired when it is the tail of the chain and fully
+ * refilled (every buffer it holds is back). `trim()` retires such pools
+ * down to `m_LowWatermark`; with a non-zero `m_HighWatermark`, `pop()` also
+ * trims on its own once the chain exceeds it and hasn't grown for `m_IdleTime`.
+ */
+struct TrimPolicy {
+    /** @brief Pools trimming never goes below (at least 1). */
+    size_t m_LowWatermark{1};
+
+    /** @brief Pool count above which pop() trims automatically, 0 to only trim explicitly. */
+    size_t m_HighWatermark{0};
+
+    /** @brief Time the chain must go without growing before pop() trims. */
+    std::chrono::milliseconds m_IdleTime{0};
+};
+
+/**
+ * @brief How `PoolChain` grows.
+ *
+ * By default `pop()` builds a new pool inline when every pool is empty. With a
+ * non-zero `m_Threshold` the next pool is built ahead of time, off the consumer
+ * thread, as soon as fewer than `m_Threshold` buffers are left in the chain;
+ * `pop()` then only links the pre-built node (and still builds inline if the
+ * spare isn't ready yet).
+ */
+struct GrowthPolicy {
+    /** @brief Free buffers below which the next pool is pre-built, 0 to always grow inline. */
+    size_t m_Threshold{0};
+
+    /**
+     * @brief Runs a build task somewhere else (thread pool, job system...).
+     * Left empty, the chain starts its own helper thread.
+     * @note The task must eventually run: the chain's destructor waits for it.
+     */
+    std::function<void(std::function<void()>)> m_Executor{};
+};
+
 /**
  * @brief Lock-free chain of ring pools (growable pool-of-pools).
  *
@@ -56,6 +138,12 @@ struct ChainNode {
  * - Each `RingPool` is a single-producer / single-consumer SPSC queue of
  *   `Buffer<T>` pointers. `PoolChain` iterates pools to `push()` or `pop()`.
  * 
+ * - `push()` and `pop()` don't walk the list: pools are indexed by
+ *   `PoolGroup` bitmaps of non-empty / non-full pools, so they go straight
+ *   to the first pool (in chain order) that can serve them. The list is
+ *   only traversed when the bitmaps have nothing to offer, before the chain
+ *   grows (`pop()`) or reports that every pool is full (`push()`).
+ * 
  * - `PoolChain` performs lock-free traversal using atomics. It is intended
  *   for the single-writer/single-reader producer-consumer patterns that the
  *   underlying `RingPool` expects: typically one thread calls `pop()` to
@@ -73,6 +161,15 @@ struct ChainNode {
  * 
  * - The implementation assumes a single writer for `addPool()`/tail updates.
  * 
+ * - With a `GrowthPolicy` threshold, new pools are pre-built on a helper
+ *   thread (or a user executor) and handed over through a single spare
+ *   slot, so `pop()` doesn't allocate on the consumer's real-time thread.
+ * 
+ * - `trim()` (and the automatic trim in `pop()`, see `TrimPolicy`) runs on
+ *   the consumer thread. A retired pool is unlinked at once but freed only
+ *   after the producer's next `push()`, which acknowledges the retire epoch
+ *   it loaded on entry, so the producer never touches a freed pool.
+ * 
  * @note the cleanup is not thread safe and it's called in the destructor of the `PoolChain`.
  */
 template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment = 0, bool isDynamic = true>
@@ -100,6 +197,82 @@ private:
      * constructor arguments and returns an allocated `RingPool*`.
      */
     std::function<RingPool<T, alignment, isDynamic>*()> m_PoolFactory;   
+
+    /**
+     * @brief First group of the pool index, set in the constructor.
+     */
+    PoolGroup<T, alignment, isDynamic>* p_FirstGroup{nullptr};
+
+    /**
+     * @brief Group new nodes are registered in (only touched by the growing thread).
+     */
+    PoolGroup<T, alignment, isDynamic>* p_LastGroup{nullptr};
+
+    /**
+     * @brief Epoch of the last retirement, bumped by the consumer; the producer loads it on every push.
+     */
+    CacheAlignedAtomic<uint64_t> m_RetireEpoch;
+
+    /**
+     * @brief Last retire epoch the producer saw at the start of a push (producer-written).
+     */
+    CacheAlignedAtomic<uint64_t> m_SeenEpoch;
+
+    /**
+     * @brief Unlinked nodes waiting for the producer to acknowledge their epoch (consumer-owned).
+     */
+    alignas(MEM_SENTRY::constants::CACHE_LINE_SIZE) ChainNode<T, alignment, isDynamic>* p_Retired{nullptr};
+
+    /** @brief Pools linked into the chain (consumer-written, readable from any thread). */
+    std::atomic<size_t> m_PoolCount{0};
+
+    /** @brief pop() calls since the last automatic trim check (consumer-owned). */
+    size_t m_PopsSinceCheck{0};
+
+    /** @brief When the chain last grew (consumer-owned). */
+    std::chrono::steady_clock::time_point m_LastGrowth{};
+
+    /** @brief Current trim policy (consumer-owned). */
+    TrimPolicy m_TrimPolicy{};
+
+    /** @brief pop() calls between two automatic trim checks. */
+    static constexpr size_t TRIM_CHECK_INTERVAL = 256;
+
+    /** @brief Buffers each pool is built with (queue size - 1). */
+    size_t m_PoolCapacity{0};
+
+    /** @brief Successful pop() calls (consumer-written, readable from any thread). */
+    std::atomic<uint64_t> m_Pops{0};
+
+    /** @brief pop() calls left before the free buffers can reach the growth threshold (consumer-owned). */
+    int64_t m_PopsUntilCheck{0};
+
+    /** @brief Successful push() calls (producer-written, read by the consumer on growth checks). */
+    CacheAlignedAtomic<uint64_t> m_Pushes;
+
+    /** @brief Current growth policy (consumer-owned). */
+    GrowthPolicy m_GrowthPolicy{};
+
+    /** @brief A node + full pool built ahead of time, taken by addPool(). */
+    CacheAlignedAtomic<ChainNode<T, alignment, isDynamic>*> m_Spare;
+
+    /** @brief Set while a build task is requested or running. */
+    CacheAlignedAtomic<bool> m_Building;
+
+    /** @brief Bumped to wake the helper thread (build request or stop). */
+    CacheAlignedAtomic<uint32_t> m_HelperSignal;
+
+    /** @brief Tells the helper thread to exit. */
+    std::atomic<bool> m_HelperStop{false};
+
+    /** @brief Helper thread building spares when the policy has no executor. */
+    std::thread m_Helper;
+
+    /** @brief Where the consumer parks in `pop_wait()`; notified by every push. */
+    ParkingSpot m_ConsumerSpot;
+
+    /** @brief Where the producer parks in `push_wait()`; notified by every pop. */
+    ParkingSpot m_ProducerSpot;
 private:
 
     /**
@@ -127,6 +300,87 @@ private:
      */
     void addPool();
 
+    /**
+     * @brief Register `node` in the pool index as a full, non-empty pool.
+     */
+    void indexNode(ChainNode<T, alignment, isDynamic>* node);
+
+    /**
+     * @brief Set `bit` in `word` unless it is already set (skips the RMW in steady state).
+     */
+    static void setHint(std::atomic<uint64_t>& word, uint64_t bit) noexcept {
+        if(!(word.load(std::memory_order_relaxed) & bit)){
+            word.fetch_or(bit, std::memory_order_release);
+        }
+    }
+
+    /**
+     * @brief Try every pool in chain order, repairing the hints on the way.
+     * @return A buffer, or nullptr if every pool is empty.
+     */
+    Buffer<T, alignment, isDynamic>* popSlow();
+
+    /**
+     * @brief Try every pool in chain order, repairing the hints on the way.
+     * @return true if some pool accepted the buffer.
+     */
+    bool pushSlow(Buffer<T, alignment, isDynamic>* buffer);
+
+    /**
+     * @brief push() without the retire-epoch handshake.
+     */
+    bool pushRouted(Buffer<T, alignment, isDynamic>* buffer);
+
+    /**
+     * @brief Free the retired nodes whose epoch the producer acknowledged.
+     */
+    void reclaim();
+
+    /**
+     * @brief Automatic trim of pop(), every TRIM_CHECK_INTERVAL calls.
+     */
+    void maybeTrim();
+
+    /**
+     * @brief pop() without the growth bookkeeping.
+     */
+    Buffer<T, alignment, isDynamic>* popRouted();
+
+    /**
+     * @brief popRouted() without the trim check and without growing: nullptr if every pool is empty.
+     */
+    Buffer<T, alignment, isDynamic>* popLinked();
+
+    /**
+     * @brief pop_wait() body, waiting until `deadline`.
+     */
+    Buffer<T, alignment, isDynamic>* popWaitUntil(std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief push_wait() body, waiting until `deadline`.
+     */
+    bool pushWaitUntil(Buffer<T, alignment, isDynamic>* buffer, std::chrono::steady_clock::time_point deadline);
+
+    /**
+     * @brief Request a spare pool if the free buffers dropped below the threshold.
+     */
+    void maybePrebuild();
+
+    /**
+     * @brief Build the spare node (runs on the helper thread or the executor).
+     */
+    void buildSpare();
+
+    /**
+     * @brief Body of the helper thread.
+     */
+    void helperLoop();
+
+    /**
+     * @brief Stop the helper thread and wait for any build in flight.
+     */
+    void stopGrowth();
+
     /**
      * @brief Destroy all pools and chain nodes owned by this `PoolChain`.
      *
@@ -160,12 +414,28 @@ public:
             return new RingPool<T, alignment, isDynamic>(false, queue_size, args...);
         };
 
+        m_PoolCapacity = queue_size - 1;
+
+        m_Pushes.m_Value.store(0, std::memory_order_relaxed);
+        m_Spare.m_Value.store(nullptr, std::memory_order_relaxed);
+        m_Building.m_Value.store(false, std::memory_order_relaxed);
+        m_HelperSignal.m_Value.store(0, std::memory_order_relaxed);
+
         RingPool<T, alignment, isDynamic>* pool = m_PoolFactory();
         
         ChainNode<T, alignment, isDynamic>* node = new ChainNode(pool);
 
         m_Head.m_Value.store(node, std::memory_order_relaxed);
         m_Tail.m_Value.store(node, std::memory_order_relaxed);
+
+        p_FirstGroup = new PoolGroup<T, alignment, isDynamic>();
+        p_LastGroup = p_FirstGroup;
+        indexNode(node);
+
+        m_RetireEpoch.m_Value.store(0, std::memory_order_relaxed);
+        m_SeenEpoch.m_Value.store(0, std::memory_order_relaxed);
+        m_PoolCount.store(1, std::memory_order_relaxed);
+        m_LastGrowth = std::chrono::steady_clock::now();
     }
 
     /**
@@ -175,14 +445,15 @@ public:
      * destructor assumes exclusive access to the chain.
      */
     ~PoolChain(){
+        stopGrowth();
         cleanup();
     }
 
     /**
      * @brief Attempt to push a buffer into the first pool with free space.
      *
-     * Iterates the chain from head to tail and calls `push()` on each
-     * `RingPool` until one accepts the buffer.
+     * Picks the first pool the non-full bitmap points at; only when every
+     * hinted pool is full does it iterate the chain from head to tail.
      *
      * @param buffer Pointer to the buffer to return to the chain.
      * 
@@ -193,7 +464,8 @@ public:
     /**
      * @brief Pop a buffer from the first pool that has available data.
      *
-     * Iterates pools from head to tail calling `pop()` on each. If no
+     * Picks the first pool the non-empty bitmap points at; only when every
+     * hinted pool is empty does it iterate pools from head to tail. If no
      * buffers are available in any existing pool, this function calls
      * `addPool()` to append a new pool and then pops from it.
      *
@@ -201,13 +473,134 @@ public:
      * last created pool failed to provide one.
      */
     Buffer<T, alignment, isDynamic>* pop();
+
+    /**
+     * @brief Pop a buffer, waiting for the producer instead of growing the chain.
+     *
+     * Takes the first buffer of the pools already linked; when every pool is
+     * empty it spins, yields, then parks on a futex (see `ParkingSpot`) until
+     * the next `push()` / `push_wait()` returns a buffer. The chain never grows
+     * here, so consumers using it keep the memory bounded to the current pools.
+     *
+     * @return Pointer to a `Buffer` (never `nullptr`: it waits as long as it takes).
+     */
+    Buffer<T, alignment, isDynamic>* pop_wait();
+
+    /**
+     * @brief Like `pop_wait()`, but gives up after `timeout`.
+     * @return Pointer to a `Buffer`, or `nullptr` if every pool stayed empty for the whole timeout.
+     */
+    Buffer<T, alignment, isDynamic>* pop_wait(std::chrono::nanoseconds timeout);
+
+    /**
+     * @brief Push a buffer, waiting for the consumer while every pool is full.
+     *
+     * Parks like `pop_wait()` and is woken by the next `pop()` / `pop_wait()`.
+     *
+     * @return `true` once pushed.
+     */
+    bool push_wait(Buffer<T, alignment, isDynamic>* buffer);
+
+    /**
+     * @brief Like `push_wait()`, but gives up after `timeout`.
+     * @return `false` if every pool stayed full for the whole timeout.
+     */
+    bool push_wait(Buffer<T, alignment, isDynamic>* buffer, std::chrono::nanoseconds timeout);
+
+    /**
+     * @brief Retire fully refilled tail pools, down to the policy's low watermark.
+     *
+     * Call it from the consumer thread (the one calling `pop()`), e.g. during
+     * quiet periods. Retired pools are unlinked at once; their memory (the
+     * `RingPool` and the buffers it holds) goes back to the allocator once
+     * the producer has entered `push()` again, at the latest in the destructor.
+     *
+     * @return Number of pools retired by this call.
+     */
+    size_t trim();
+
+    /**
+     * @brief Replace the trim policy (consumer thread).
+     */
+    void setTrimPolicy(const TrimPolicy& policy) noexcept {
+        m_TrimPolicy = policy;
+    }
+
+    /**
+     * @brief Replace the growth policy (consumer thread).
+     *
+     * Waits for a build in flight and stops the helper thread of the previous
+     * policy; a spare already built is kept.
+     */
+    void setGrowthPolicy(const GrowthPolicy& policy);
+
+    /**
+     * @brief true if a pre-built pool is waiting to be linked.
+     */
+    bool hasSpare() const noexcept {
+        return m_Spare.m_Value.load(std::memory_order_acquire) != nullptr;
+    }
+
+    /**
+     * @brief Estimated buffers left in the chain.
+     * @note Counts buffers the producer has pushed but not yet published as popped;
+     * exact on the consumer thread, approximate on any other (e.g. a telemetry sampler).
+     */
+    size_t freeBuffers() const noexcept {
+        int64_t outstanding = (int64_t)(m_Pops.load(std::memory_order_relaxed) - m_Pushes.m_Value.load(std::memory_order_relaxed));
+        int64_t capacity = (int64_t)this->capacity();
+
+        // more pushes than pops: buffers from outside were added.
+        if(outstanding <= 0){
+            return capacity;
+        }
+
+        return outstanding >= capacity ? 0 : (size_t)(capacity - outstanding);
+    }
+
+    /**
+     * @brief Pools currently linked into the chain.
+     */
+    size_t poolCount() const noexcept {
+        return m_PoolCount.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Buffers the pools currently linked can hold.
+     */
+    size_t capacity() const noexcept {
+        return poolCount() * m_PoolCapacity;
+    }
+
+    /**
+     * @brief Retired pools still waiting to be freed (consumer thread).
+     */
+    size_t retiredCount() const noexcept {
+        size_t count = 0;
+
+        for(ChainNode<T, alignment, isDynamic>* node = p_Retired; node; node = node->m_Next.m_Value.load(std::memory_order_relaxed)){
+            ++count;
+        }
+
+        return count;
+    }
 };
 }
 
 template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
 void MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::addPool(){
-    RingPool<T, alignment, isDynamic> *pool = m_PoolFactory();
-    ChainNode<T, alignment, isDynamic>* node = new ChainNode<T, alignment, isDynamic>(pool);
+    stats::ScopedCycles<stats::Histogram::ChainGrowth> timer;
+    stats::Count(stats::Counter::ChainGrowths);
+
+    // publish a pre-built node if there is one, build inline otherwise.
+    ChainNode<T, alignment, isDynamic>* node = m_Spare.m_Value.exchange(nullptr, std::memory_order_acquire);
+
+    if(node){
+        stats::Count(stats::Counter::ChainSpareUsed);
+    } else {
+        RingPool<T, alignment, isDynamic> *pool = m_PoolFactory();
+        node = new ChainNode<T, alignment, isDynamic>(pool);
+    }
     
     ChainNode<T, alignment, isDynamic>* current_tail = m_Tail.m_Value.load(std::memory_order_acquire);
 
@@ -215,6 +608,46 @@ void MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::addPool(){
 
     // Single Writer so relaxed here is safe.
     m_Tail.m_Value.store(node, std::memory_order_relaxed);
+
+    indexNode(node);
+
+    m_PoolCount.store(m_PoolCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_LastGrowth = std::chrono::steady_clock::now();
+
+    // a burst that needed this pool will likely need the next one too.
+    if(m_GrowthPolicy.m_Threshold){
+        maybePrebuild();
+    }
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+void MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::indexNode(ChainNode<T, alignment, isDynamic>* node){
+    constexpr size_t GROUP_SIZE = PoolGroup<T, alignment, isDynamic>::GROUP_SIZE;
+
+    PoolGroup<T, alignment, isDynamic>* group = p_LastGroup;
+    size_t count = group->m_Count.load(std::memory_order_relaxed);
+
+    if(count == GROUP_SIZE){
+        // a group emptied by trim() stays linked and is reused.
+        PoolGroup<T, alignment, isDynamic>* next = group->p_Next.load(std::memory_order_relaxed);
+
+        if(!next){
+            next = new PoolGroup<T, alignment, isDynamic>();
+            group->p_Next.store(next, std::memory_order_release);
+        }
+
+        p_LastGroup = next;
+
+        group = next;
+        count = 0;
+    }
+
+    group->p_Nodes[count].store(node, std::memory_order_release);
+
+    // a new pool starts full (the factory builds full-mode pools).
+    uint64_t bit = uint64_t{1} << count;
+    group->m_NonEmpty.fetch_or(bit, std::memory_order_release);
+    group->m_Count.store(count + 1, std::memory_order_release);
 }
 
 template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
@@ -237,49 +670,462 @@ void MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::cleanup(){
 
     m_Head.m_Value.store(nullptr, std::memory_order_relaxed);
     m_Tail.m_Value.store(nullptr, std::memory_order_relaxed);
+
+    PoolGroup<T, alignment, isDynamic>* group = p_FirstGroup;
+
+    while(group){
+        PoolGroup<T, alignment, isDynamic>* next = group->p_Next.load(std::memory_order_relaxed);
+        delete group;
+        group = next;
+    }
+
+    p_FirstGroup = nullptr;
+    p_LastGroup = nullptr;
+
+    if(ChainNode<T, alignment, isDynamic>* spare = m_Spare.m_Value.exchange(nullptr, std::memory_order_acquire)){
+        delete spare->m_Pool.m_Value.load(std::memory_order_relaxed);
+        delete spare;
+    }
+
+    // the chain is going away, nobody can still be using the retired pools.
+    while(p_Retired){
+        ChainNode<T, alignment, isDynamic>* next = p_Retired->m_Next.m_Value.load(std::memory_order_relaxed);
+
+        delete p_Retired->m_Pool.m_Value.load(std::memory_order_relaxed);
+        delete p_Retired;
+
+        p_Retired = next;
+    }
 }
 
 template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
-bool MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::push(Buffer<T, alignment, isDynamic>* buffer){
-    ChainNode<T, alignment, isDynamic>* current = m_Head.m_Value.load(std::memory_order_acquire);
+void MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::reclaim(){
+    uint64_t seen = m_SeenEpoch.m_Value.load(std::memory_order_acquire);
 
-    while(current){
-        ChainNode<T, alignment, isDynamic>* next = current->m_Next.m_Value.load(std::memory_order_acquire);
-        
-        RingPool<T, alignment, isDynamic>* pool = current->m_Pool.m_Value.load(std::memory_order_acquire);
+    ChainNode<T, alignment, isDynamic>* prev = nullptr;
+    ChainNode<T, alignment, isDynamic>* node = p_Retired;
+
+    while(node){
+        ChainNode<T, alignment, isDynamic>* next = node->m_Next.m_Value.load(std::memory_order_relaxed);
+
+        if(node->m_RetireEpoch <= seen){
+            if(prev){
+                prev->m_Next.m_Value.store(next, std::memory_order_relaxed);
+            } else {
+                p_Retired = next;
+            }
 
-        if(pool->push(buffer)){
-            return true;
+            // the pool is full, deleting it frees the buffers it holds.
+            delete node->m_Pool.m_Value.load(std::memory_order_relaxed);
+            delete node;
+        } else {
+            prev = node;
         }
 
-        current = next;
+        node = next;
+    }
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+bool MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::pushSlow(Buffer<T, alignment, isDynamic>* buffer){
+    PoolGroup<T, alignment, isDynamic>* group = p_FirstGroup;
+
+    while(group){
+        size_t count = group->m_Count.load(std::memory_order_acquire);
+
+        for(size_t i = 0; i < count; ++i){
+            RingPool<T, alignment, isDynamic>* pool = group->p_Nodes[i].load(std::memory_order_acquire)->m_Pool.m_Value.load(std::memory_order_acquire);
+
+            if(pool->push(buffer)){
+                uint64_t bit = uint64_t{1} << i;
+
+                setHint(group->m_NonFull, bit);
+                setHint(group->m_NonEmpty, bit);
+
+                return true;
+            }
+        }
+
+        group = group->p_Next.load(std::memory_order_acquire);
     }
 
     return false;
 }
 
 template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
-MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::pop(){
-    ChainNode<T, alignment, isDynamic>* current = m_Head.m_Value.load(std::memory_order_acquire);
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::popSlow(){
+    PoolGroup<T, alignment, isDynamic>* group = p_FirstGroup;
 
-    while(current){
-        ChainNode<T, alignment, isDynamic>* next = current->m_Next.m_Value.load(std::memory_order_acquire);
-        
-        RingPool<T, alignment, isDynamic>* pool = current->m_Pool.m_Value.load(std::memory_order_acquire);
+    while(group){
+        size_t count = group->m_Count.load(std::memory_order_acquire);
 
-        Buffer<T, alignment, isDynamic>* buffer = pool->pop();
+        for(size_t i = 0; i < count; ++i){
+            RingPool<T, alignment, isDynamic>* pool = group->p_Nodes[i].load(std::memory_order_acquire)->m_Pool.m_Value.load(std::memory_order_acquire);
 
-        if(buffer){
-            return buffer;
+            Buffer<T, alignment, isDynamic>* buffer = pool->pop();
+
+            if(buffer){
+                uint64_t bit = uint64_t{1} << i;
+
+                setHint(group->m_NonEmpty, bit);
+                setHint(group->m_NonFull, bit);
+
+                return buffer;
+            }
         }
 
-        current = next;
+        group = group->p_Next.load(std::memory_order_acquire);
+    }
+
+    return nullptr;
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+bool MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::push(Buffer<T, alignment, isDynamic>* buffer){
+    // everything this push reads happens after the load: pools retired up to
+    // `epoch` are already unlinked from what it can see.
+    uint64_t epoch = m_RetireEpoch.m_Value.load(std::memory_order_acquire);
+
+    bool pushed = pushRouted(buffer);
+
+    // single writer: a plain store on the producer's own line.
+    if(pushed){
+        m_Pushes.m_Value.store(m_Pushes.m_Value.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // acknowledge once done with the chain; a plain store in steady state.
+    if(m_SeenEpoch.m_Value.load(std::memory_order_relaxed) != epoch){
+        m_SeenEpoch.m_Value.store(epoch, std::memory_order_release);
+    }
+
+    if(pushed){
+        m_ConsumerSpot.notify();
+    }
+
+    return pushed;
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+bool MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::push_wait(Buffer<T, alignment, isDynamic>* buffer){
+    return pushWaitUntil(buffer, std::chrono::steady_clock::time_point::max());
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+bool MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::push_wait(Buffer<T, alignment, isDynamic>* buffer, std::chrono::nanoseconds timeout){
+    return pushWaitUntil(buffer, std::chrono::steady_clock::now() + timeout);
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+bool MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::pushWaitUntil(Buffer<T, alignment, isDynamic>* buffer,
+    std::chrono::steady_clock::time_point deadline){
+    if(!buffer){
+        return false;
+    }
+
+    // every retry is a full push(), so each one acknowledges the retire epoch.
+    if(push(buffer)){
+        return true;
+    }
+
+    return m_ProducerSpot.wait([this, buffer]() { return push(buffer); }, deadline);
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+bool MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::pushRouted(Buffer<T, alignment, isDynamic>* buffer){
+    PoolGroup<T, alignment, isDynamic>* group = p_FirstGroup;
+
+    while(group){
+        uint64_t bits = group->m_NonFull.load(std::memory_order_acquire);
+
+        while(bits){
+            uint64_t bit = bits & (~bits + 1);
+            size_t i = __builtin_ctzll(bits);
+
+            RingPool<T, alignment, isDynamic>* pool = group->p_Nodes[i].load(std::memory_order_acquire)->m_Pool.m_Value.load(std::memory_order_acquire);
+
+            if(pool->push(buffer)){
+                setHint(group->m_NonEmpty, bit);
+                return true;
+            }
+
+            // full: drop the hint until the consumer pops from it again.
+            group->m_NonFull.fetch_and(~bit, std::memory_order_relaxed);
+            bits &= ~bit;
+        }
+
+        group = group->p_Next.load(std::memory_order_acquire);
+    }
+
+    return pushSlow(buffer);
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::pop(){
+    Buffer<T, alignment, isDynamic>* buffer = popRouted();
+
+    if(buffer){
+        // single writer: a plain store, no read-modify-write.
+        m_Pops.store(m_Pops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_ProducerSpot.notify();
+
+        if(m_GrowthPolicy.m_Threshold && --m_PopsUntilCheck <= 0){
+            maybePrebuild();
+        }
+    }
+
+    return buffer;
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::pop_wait(){
+    return popWaitUntil(std::chrono::steady_clock::time_point::max());
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::pop_wait(std::chrono::nanoseconds timeout){
+    return popWaitUntil(std::chrono::steady_clock::now() + timeout);
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::popWaitUntil(
+    std::chrono::steady_clock::time_point deadline){
+    Buffer<T, alignment, isDynamic>* buffer = popLinked();
+
+    if(!buffer){
+        buffer = m_ConsumerSpot.wait([this]() { return popLinked(); }, deadline);
+    }
+
+    if(buffer){
+        m_Pops.store(m_Pops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_ProducerSpot.notify();
+    }
+
+    return buffer;
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::popRouted(){
+    if(m_TrimPolicy.m_HighWatermark && ++m_PopsSinceCheck >= TRIM_CHECK_INTERVAL){
+        m_PopsSinceCheck = 0;
+        maybeTrim();
+    }
+
+    Buffer<T, alignment, isDynamic>* buffer = popLinked();
+
+    if(buffer){
+        return buffer;
     }
 
     addPool();
 
-    current = m_Tail.m_Value.load(std::memory_order_acquire);
+    ChainNode<T, alignment, isDynamic>* current = m_Tail.m_Value.load(std::memory_order_acquire);
     RingPool<T, alignment, isDynamic>* last_pool = current->m_Pool.m_Value.load(std::memory_order_acquire);
 
-    return last_pool->pop(); 
-}
\ No newline at end of file
+    buffer = last_pool->pop();
+
+    if(buffer){
+        setHint(p_LastGroup->m_NonFull, uint64_t{1} << (p_LastGroup->m_Count.load(std::memory_order_relaxed) - 1));
+    }
+
+    return buffer; 
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::popLinked(){
+    PoolGroup<T, alignment, isDynamic>* group = p_FirstGroup;
+
+    while(group){
+        uint64_t bits = group->m_NonEmpty.load(std::memory_order_acquire);
+
+        while(bits){
+            uint64_t bit = bits & (~bits + 1);
+            size_t i = __builtin_ctzll(bits);
+
+            RingPool<T, alignment, isDynamic>* pool = group->p_Nodes[i].load(std::memory_order_acquire)->m_Pool.m_Value.load(std::memory_order_acquire);
+
+            Buffer<T, alignment, isDynamic>* buffer = pool->pop();
+
+            if(buffer){
+                setHint(group->m_NonFull, bit);
+                return buffer;
+            }
+
+            // empty: drop the hint until the producer pushes into it again.
+            group->m_NonEmpty.fetch_and(~bit, std::memory_order_relaxed);
+            bits &= ~bit;
+        }
+
+        group = group->p_Next.load(std::memory_order_acquire);
+    }
+
+    // a hint may have been lost to a concurrent push, check every pool before growing.
+    return popSlow();
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+size_t MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::trim(){
+    constexpr size_t GROUP_SIZE = PoolGroup<T, alignment, isDynamic>::GROUP_SIZE;
+
+    size_t floor = m_TrimPolicy.m_LowWatermark ? m_TrimPolicy.m_LowWatermark : 1;
+    size_t retired = 0;
+
+    while(m_PoolCount.load(std::memory_order_relaxed) > floor){
+        PoolGroup<T, alignment, isDynamic>* group = p_LastGroup;
+        size_t count = group->m_Count.load(std::memory_order_relaxed);
+
+        ChainNode<T, alignment, isDynamic>* node = group->p_Nodes[count - 1].load(std::memory_order_relaxed);
+        RingPool<T, alignment, isDynamic>* pool = node->m_Pool.m_Value.load(std::memory_order_relaxed);
+
+        // only this thread pops, so a full pool stays full: no push can land in it anymore.
+        if(pool->currentSize() != pool->queueSize() - 1){
+            break;
+        }
+
+        uint64_t bit = uint64_t{1} << (count - 1);
+        group->m_NonEmpty.fetch_and(~bit, std::memory_order_relaxed);
+        group->m_NonFull.fetch_and(~bit, std::memory_order_relaxed);
+        group->m_Count.store(count - 1, std::memory_order_release);
+
+        // find the new tail; an emptied group stays linked for reuse.
+        ChainNode<T, alignment, isDynamic>* prev;
+
+        if(count > 1){
+            prev = group->p_Nodes[count - 2].load(std::memory_order_relaxed);
+        } else {
+            PoolGroup<T, alignment, isDynamic>* before = p_FirstGroup;
+
+            while(before->p_Next.load(std::memory_order_relaxed) != group){
+                before = before->p_Next.load(std::memory_order_relaxed);
+            }
+
+            p_LastGroup = before;
+            prev = before->p_Nodes[GROUP_SIZE - 1].load(std::memory_order_relaxed);
+        }
+
+        prev->m_Next.m_Value.store(nullptr, std::memory_order_release);
+        m_Tail.m_Value.store(prev, std::memory_order_relaxed);
+        m_PoolCount.store(m_PoolCount.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+
+        // publish the unlink; the producer acknowledges it on its next push.
+        uint64_t epoch = m_RetireEpoch.m_Value.load(std::memory_order_relaxed) + 1;
+        m_RetireEpoch.m_Value.store(epoch, std::memory_order_release);
+
+        node->m_RetireEpoch = epoch;
+        node->m_Next.m_Value.store(p_Retired, std::memory_order_relaxed);
+        p_Retired = node;
+
+        ++retired;
+    }
+
+    reclaim();
+
+    stats::Count(stats::Counter::ChainTrims, retired);
+
+    return retired;
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+void MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::maybeTrim(){
+    if(p_Retired){
+        reclaim();
+    }
+
+    if(m_PoolCount.load(std::memory_order_relaxed) <= m_TrimPolicy.m_HighWatermark){
+        return;
+    }
+
+    if(m_TrimPolicy.m_IdleTime.count() && std::chrono::steady_clock::now() - m_LastGrowth < m_TrimPolicy.m_IdleTime){
+        return;
+    }
+
+    trim();
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+void MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::maybePrebuild(){
+    size_t free = freeBuffers();
+
+    // pushes only add free buffers, so nothing can change before that many pops.
+    if(free >= m_GrowthPolicy.m_Threshold){
+        m_PopsUntilCheck = (int64_t)(free - m_GrowthPolicy.m_Threshold) + 1;
+        return;
+    }
+
+    // below the threshold: addPool() checks again once this spare is used.
+    m_PopsUntilCheck = (int64_t)free + 1;
+
+    if(m_Spare.m_Value.load(std::memory_order_relaxed)){
+        return;
+    }
+
+    // one build at a time, the spare slot holds a single node.
+    if(m_Building.m_Value.exchange(true, std::memory_order_acq_rel)){
+        return;
+    }
+
+    if(m_GrowthPolicy.m_Executor){
+        m_GrowthPolicy.m_Executor([this](){ buildSpare(); });
+    } else {
+        m_HelperSignal.m_Value.fetch_add(1, std::memory_order_release);
+        m_HelperSignal.m_Value.notify_one();
+    }
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+void MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::buildSpare(){
+    ChainNode<T, alignment, isDynamic>* node = new ChainNode<T, alignment, isDynamic>(m_PoolFactory());
+
+    m_Spare.m_Value.store(node, std::memory_order_release);
+    m_Building.m_Value.store(false, std::memory_order_release);
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+void MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::helperLoop(){
+    uint32_t seen = m_HelperSignal.m_Value.load(std::memory_order_acquire);
+
+    while(!m_HelperStop.load(std::memory_order_acquire)){
+        if(m_Building.m_Value.load(std::memory_order_acquire) && !m_Spare.m_Value.load(std::memory_order_acquire)){
+            buildSpare();
+        }
+
+        m_HelperSignal.m_Value.wait(seen, std::memory_order_acquire);
+        seen = m_HelperSignal.m_Value.load(std::memory_order_acquire);
+    }
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+void MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::stopGrowth(){
+    if(m_Helper.joinable()){
+        m_HelperStop.store(true, std::memory_order_release);
+        m_HelperSignal.m_Value.fetch_add(1, std::memory_order_release);
+        m_HelperSignal.m_Value.notify_one();
+
+        m_Helper.join();
+        m_HelperStop.store(false, std::memory_order_relaxed);
+    }
+
+    // a requested build that the helper never picked up won't run anymore.
+    if(!m_GrowthPolicy.m_Executor){
+        m_Building.m_Value.store(false, std::memory_order_release);
+    }
+
+    // an executor task may still be running and touches the chain.
+    while(m_Building.m_Value.load(std::memory_order_acquire)){
+        std::this_thread::yield();
+    }
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+void MEM_SENTRY::mem_pool::PoolChain<T, alignment, isDynamic>::setGrowthPolicy(const GrowthPolicy& policy){
+    stopGrowth();
+
+    m_GrowthPolicy = policy;
+
+    if(m_GrowthPolicy.m_Threshold && !m_GrowthPolicy.m_Executor){
+        m_Helper = std::thread(&PoolChain::helperLoop, this);
+    }
+
+    if(m_GrowthPolicy.m_Threshold){
+        maybePrebuild();
+    }
+}
@@ -0,0 +1,433 @@
+#pragma once
+#include "mem_pools/buffer.h"
+#include "mem_pools/chain.h"
+#include "mem_sentry/constants.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include <sys/uio.h>
+
+namespace MEM_SENTRY::mem_pool {
+
+/**
+ * @brief A byte stream stored in pooled `std::array<char, N>` buffers, exposed as `iovec` spans.
+ *
+ * `IoChain` pops blocks from a `PoolChain` as bytes are appended and pushes
+ * each block back as soon as its bytes are consumed, so network and file
+ * I/O work on pooled memory as it is:
+ *
+ * ```cpp
+ * PoolChain<std::array<char, 4096>, 64, false> pool(64);
+ * IoChain<4096, 64, false> out(pool);
+ *
+ * out.append(header, headerLen);            // copies across block boundaries
+ * iovec iov[16];
+ * ssize_t sent = ::writev(fd, iov, out.readSpans(iov, 16));
+ * if(sent > 0) out.consume(sent);           // drained blocks go back to the pool
+ *
+ * IoChain<4096, 64, false> in(pool);
+ * ssize_t got = ::readv(fd, iov, in.writeSpans(iov, 16, 16 * 4096));
+ * if(got > 0) in.commit(got);               // received straight into pooled blocks
+ * ```
+ *
+ * The bytes run from the read offset of the first block to the write offset
+ * of the write block; blocks after the write block are reserved by
+ * `writeSpans()` and still empty.
+ *
+ * @tparam N Bytes per block.
+ * @tparam alignment Alignment of the blocks, as for `Buffer`.
+ * @tparam isDynamic Storage mode of the blocks, as for `Buffer`.
+ * @tparam MaxSegments Blocks the chain can hold at once (a power of two).
+ *
+ * @note Not thread-safe: the owning thread is both the consumer (pop) and the
+ * producer (push) of `pool` for the blocks it holds. The destructor returns
+ * every block.
+ */
+template<size_t N, size_t alignment, bool isDynamic = false,
+    size_t MaxSegments = MEM_SENTRY::constants::IO_CHAIN_MAX_SEGMENTS>
+class IoChain {
+    static_assert(N > 0, "a block must hold at least one byte");
+    static_assert((MaxSegments & (MaxSegments - 1)) == 0, "MaxSegments must be a power of 2");
+
+public:
+    using Block = std::array<char, N>;
+    using BlockBuffer = Buffer<Block, alignment, isDynamic>;
+    using Pool = PoolChain<Block, alignment, isDynamic>;
+
+private:
+    /** @brief Where blocks come from and go back to. */
+    Pool& m_Pool;
+
+    /** @brief Ring of the blocks held, oldest first from `m_Head`. */
+    std::array<BlockBuffer*, MaxSegments> p_Segments{};
+
+    /** @brief Ring index of the first block. */
+    size_t m_Head{0};
+
+    /** @brief Blocks held, reserved ones included. */
+    size_t m_Count{0};
+
+    /** @brief First unread byte of the first block. */
+    size_t m_ReadOffset{0};
+
+    /** @brief Block the next byte is written to, counted from the first one. */
+    size_t m_WriteSegment{0};
+
+    /** @brief First free byte of the write block. */
+    size_t m_WriteOffset{0};
+
+    /** @brief Bytes between the read and the write position. */
+    size_t m_Size{0};
+
+    /** @brief Bytes of a block. */
+    static char* bytesOf(BlockBuffer* buffer) noexcept {
+        if constexpr (isDynamic) {
+            return buffer->p_Buffer->data();
+        } else {
+            return buffer->m_Buffer.data();
+        }
+    }
+
+    /** @brief The i-th block held, counted from the first one. */
+    BlockBuffer* segment(size_t i) const noexcept {
+        return p_Segments[(m_Head + i) & (MaxSegments - 1)];
+    }
+
+    /**
+     * @brief Pops one more block from the pool, at the back.
+     * @return false if the ring is full or the pool gave none.
+     */
+    bool reserve();
+
+    /**
+     * @brief Moves the write position to a free byte, reserving a block when every held one is full.
+     * @return false if no byte can be written.
+     */
+    bool nextWritable();
+
+    /**
+     * @brief Pushes the first block back to the pool.
+     */
+    void releaseFront();
+
+public:
+    /**
+     * @brief An empty chain drawing its blocks from `pool`.
+     */
+    explicit IoChain(Pool& pool) noexcept : m_Pool(pool) {}
+
+    /**
+     * @brief Returns every block held to the pool.
+     */
+    ~IoChain(){
+        clear();
+    }
+
+    IoChain(const IoChain&) = delete;
+    IoChain& operator=(const IoChain&) = delete;
+    IoChain(IoChain&&) = delete;
+    IoChain& operator=(IoChain&&) = delete;
+
+    /**
+     * @brief Copies `bytes` at the end of the stream, filling the last block before taking a new one.
+     * @return Bytes appended; fewer than `bytes` once `MaxSegments` blocks are held or the pool is out.
+     */
+    size_t append(const void* data, size_t bytes);
+
+    /**
+     * @brief Fills `iov` with the readable bytes, for `writev()` / `sendmsg()`.
+     * @return Spans written, at most `max`; call `consume()` with the bytes actually sent.
+     */
+    size_t readSpans(iovec* iov, size_t max) const noexcept;
+
+    /**
+     * @brief Drops the first `bytes` of the stream, returning drained blocks to the pool.
+     * @return Bytes consumed, at most `size()`.
+     */
+    size_t consume(size_t bytes);
+
+    /**
+     * @brief Copies up to `bytes` from the front of the stream to `out`, then consumes them.
+     * @return Bytes read.
+     */
+    size_t read(void* out, size_t bytes);
+
+    /**
+     * @brief Reserves room for `bytes` and fills `iov` with it, for `readv()` / `recvmsg()`.
+     *
+     * The spans start at the write position; the first may be the tail of
+     * a partly filled block. Call `commit()` with the bytes actually received.
+     *
+     * @return Spans written, at most `max`; they may hold fewer than `bytes`
+     * once `MaxSegments` blocks are held or the pool is out.
+     */
+    size_t writeSpans(iovec* iov, size_t max, size_t bytes);
+
+    /**
+     * @brief Appends `bytes` written into the spans of the last `writeSpans()`.
+     * @return Bytes committed, at most the room reserved.
+     */
+    size_t commit(size_t bytes) noexcept;
+
+    /**
+     * @brief Returns every block to the pool and empties the stream.
+     */
+    void clear();
+
+    /** @brief Readable bytes. */
+    size_t size() const noexcept { return m_Size; }
+
+    /** @brief true if there is nothing to read. */
+    bool empty() const noexcept { return m_Size == 0; }
+
+    /** @brief Blocks held, reserved ones included. */
+    size_t segments() const noexcept { return m_Count; }
+
+    /** @brief Bytes that can be written without taking another block. */
+    size_t room() const noexcept {
+        return m_Count ? (N - m_WriteOffset) + N * (m_Count - 1 - m_WriteSegment) : 0;
+    }
+};
+}
+
+template<size_t N, size_t alignment, bool isDynamic, size_t MaxSegments>
+bool MEM_SENTRY::mem_pool::IoChain<N, alignment, isDynamic, MaxSegments>::reserve(){
+    if(m_Count == MaxSegments){
+        return false;
+    }
+
+    BlockBuffer* buffer = m_Pool.pop();
+
+    if(!buffer){
+        return false;
+    }
+
+    p_Segments[(m_Head + m_Count) & (MaxSegments - 1)] = buffer;
+    ++m_Count;
+
+    return true;
+}
+
+template<size_t N, size_t alignment, bool isDynamic, size_t MaxSegments>
+bool MEM_SENTRY::mem_pool::IoChain<N, alignment, isDynamic, MaxSegments>::nextWritable(){
+    if(m_Count && m_WriteOffset < N){
+        return true;
+    }
+
+    if(m_Count == 0 || m_WriteSegment + 1 == m_Count){
+        if(!reserve()){
+            return false;
+        }
+
+        // the first block is the write block already.
+        if(m_Count == 1){
+            return true;
+        }
+    }
+
+    ++m_WriteSegment;
+    m_WriteOffset = 0;
+
+    return true;
+}
+
+template<size_t N, size_t alignment, bool isDynamic, size_t MaxSegments>
+void MEM_SENTRY::mem_pool::IoChain<N, alignment, isDynamic, MaxSegments>::releaseFront(){
+    // a block popped from the pool always has a slot to go back to.
+    m_Pool.push(p_Segments[m_Head]);
+
+    m_Head = (m_Head + 1) & (MaxSegments - 1);
+    --m_Count;
+    m_ReadOffset = 0;
+
+    if(m_WriteSegment){
+        --m_WriteSegment;
+    } else {
+        // the write block itself was drained: writing goes on at the next one.
+        m_WriteOffset = 0;
+    }
+}
+
+template<size_t N, size_t alignment, bool isDynamic, size_t MaxSegments>
+size_t MEM_SENTRY::mem_pool::IoChain<N, alignment, isDynamic, MaxSegments>::append(const void* data, size_t bytes){
+    const char* src = static_cast<const char*>(data);
+    size_t done = 0;
+
+    while(done < bytes && nextWritable()){
+        size_t n = N - m_WriteOffset;
+
+        if(n > bytes - done){
+            n = bytes - done;
+        }
+
+        std::memcpy(bytesOf(segment(m_WriteSegment)) + m_WriteOffset, src + done, n);
+
+        m_WriteOffset += n;
+        done += n;
+    }
+
+    m_Size += done;
+    return done;
+}
+
+template<size_t N, size_t alignment, bool isDynamic, size_t MaxSegments>
+size_t MEM_SENTRY::mem_pool::IoChain<N, alignment, isDynamic, MaxSegments>::readSpans(iovec* iov, size_t max) const noexcept {
+    size_t spans = 0;
+
+    if(m_Size == 0){
+        return 0;
+    }
+
+    for(size_t i = 0; i <= m_WriteSegment && spans < max; ++i){
+        size_t begin = i == 0 ? m_ReadOffset : 0;
+        size_t end = i == m_WriteSegment ? m_WriteOffset : N;
+
+        if(end > begin){
+            iov[spans].iov_base = bytesOf(segment(i)) + begin;
+            iov[spans].iov_len = end - begin;
+            ++spans;
+        }
+    }
+
+    return spans;
+}
+
+template<size_t N, size_t alignment, bool isDynamic, size_t MaxSegments>
+size_t MEM_SENTRY::mem_pool::IoChain<N, alignment, isDynamic, MaxSegments>::consume(size_t bytes){
+    if(bytes > m_Size){
+        bytes = m_Size;
+    }
+
+    size_t left = bytes;
+
+    while(left){
+        size_t end = m_WriteSegment == 0 ? m_WriteOffset : N;
+        size_t n = end - m_ReadOffset;
+
+        if(n > left){
+            n = left;
+        }
+
+        m_ReadOffset += n;
+        left -= n;
+
+        if(m_ReadOffset == N){
+            releaseFront();
+        }
+    }
+
+    m_Size -= bytes;
+
+    // drained but still holding the write block: rewind it instead of trading it for another.
+    if(m_Size == 0 && m_Count && m_WriteSegment == 0){
+        m_ReadOffset = 0;
+        m_WriteOffset = 0;
+    }
+
+    return bytes;
+}
+
+template<size_t N, size_t alignment, bool isDynamic, size_t MaxSegments>
+size_t MEM_SENTRY::mem_pool::IoChain<N, alignment, isDynamic, MaxSegments>::read(void* out, size_t bytes){
+    char* dst = static_cast<char*>(out);
+
+    if(bytes > m_Size){
+        bytes = m_Size;
+    }
+
+    size_t copied = 0;
+
+    for(size_t i = 0; i <= m_WriteSegment && copied < bytes; ++i){
+        size_t begin = i == 0 ? m_ReadOffset : 0;
+        size_t end = i == m_WriteSegment ? m_WriteOffset : N;
+        size_t n = end - begin;
+
+        if(n > bytes - copied){
+            n = bytes - copied;
+        }
+
+        std::memcpy(dst + copied, bytesOf(segment(i)) + begin, n);
+        copied += n;
+    }
+
+    return consume(copied);
+}
+
+template<size_t N, size_t alignment, bool isDynamic, size_t MaxSegments>
+size_t MEM_SENTRY::mem_pool::IoChain<N, alignment, isDynamic, MaxSegments>::writeSpans(iovec* iov, size_t max, size_t bytes){
+    if(max == 0 || bytes == 0){
+        return 0;
+    }
+
+    // a full write block would start the spans with an empty one.
+    if(!nextWritable()){
+        return 0;
+    }
+
+    while(room() < bytes && reserve()){}
+
+    size_t spans = 0;
+
+    for(size_t i = m_WriteSegment; i < m_Count && spans < max && bytes; ++i){
+        size_t begin = i == m_WriteSegment ? m_WriteOffset : 0;
+        size_t n = N - begin;
+
+        if(n > bytes){
+            n = bytes;
+        }
+
+        iov[spans].iov_base = bytesOf(segment(i)) + begin;
+        iov[spans].iov_len = n;
+        ++spans;
+
+        bytes -= n;
+    }
+
+    return spans;
+}
+
+template<size_t N, size_t alignment, bool isDynamic, size_t MaxSegments>
+size_t MEM_SENTRY::mem_pool::IoChain<N, alignment, isDynamic, MaxSegments>::commit(size_t bytes) noexcept {
+    if(bytes > room()){
+        bytes = room();
+    }
+
+    size_t left = bytes;
+
+    while(left){
+        if(m_WriteOffset == N){
+            ++m_WriteSegment;
+            m_WriteOffset = 0;
+        }
+
+        size_t n = N - m_WriteOffset;
+
+        if(n > left){
+            n = left;
+        }
+
+        m_WriteOffset += n;
+        left -= n;
+    }
+
+    m_Size += bytes;
+    return bytes;
+}
+
+template<size_t N, size_t alignment, bool isDynamic, size_t MaxSegments>
+void MEM_SENTRY::mem_pool::IoChain<N, alignment, isDynamic, MaxSegments>::clear(){
+    while(m_Count){
+        m_Pool.push(p_Segments[m_Head]);
+
+        m_Head = (m_Head + 1) & (MaxSegments - 1);
+        --m_Count;
+    }
+
+    m_Head = 0;
+    m_ReadOffset = 0;
+    m_WriteSegment = 0;
+    m_WriteOffset = 0;
+    m_Size = 0;
+}
@@ -0,0 +1,358 @@
+#pragma once
+#include "mem_pools/buffer.h"
+#include "mem_pools/pool.h"
+#include "mem_sentry/constants.h"
+#include "mem_sentry/stats.h"
+
+#include <atomic>
+#include <memory>
+
+namespace MEM_SENTRY::mem_pool {
+
+/**
+ * @brief Lock-free multi-producer / multi-consumer pool of Buffer pointers
+ *
+ * @note Implementation: Vyukov bounded MPMC queue.
+ * Every slot carries a sequence number that tells producers and consumers
+ * whether it is free for the current lap or holds a buffer for it:
+ * - a producer at ticket `pos` may fill the slot when `sequence == pos`,
+ *   then publishes it with `sequence = pos + 1`.
+ * - a consumer at ticket `pos` may empty the slot when `sequence == pos + 1`,
+ *   then frees it for the next lap with `sequence = pos + capacity`.
+ * Tickets are claimed with a CAS on the enqueue / dequeue position, so there
+ * is no lock and no shared flag; unlike `RingPool` no slot is wasted.
+ *
+ * `MPMCPool<T, alignment, isDynamic>` mirrors the `RingPool` interface and
+ * ownership modes, for pools shared by N producers and M consumers (e.g. a
+ * thread pool where any worker acquires a buffer and any other returns it):
+ *
+ * - "Full" mode (pool owns buffers): the constructor allocates one `Buffer`
+ *   per slot and the destructor deletes the buffers still in the pool.
+ *
+ * - "Empty" mode (caller owns buffers): the pool starts empty and never
+ *   deletes the pointers pushed into it.
+ *
+ * Key characteristics:
+ * - Capacity is `queue_size` rounded up to the next power-of-two; all of it
+ *   is usable.
+ *
+ * - The enqueue and dequeue positions live in separate `CacheAlignedAtomic`s
+ *   and every slot is padded to a cache line, so producers and consumers
+ *   working on neighbouring slots don't false-share.
+ *
+ * Thread-safety and ordering notes:
+ * - `push()` and `pop()` may be called from any number of threads.
+ *
+ * - A buffer pushed by one thread is fully visible (acquire/release on the
+ *   slot sequence) to the thread that pops it.
+ *
+ * - Non-blocking: `push()` fails when the pool is full and `pop()` returns
+ *   `nullptr` when it is empty.
+ *
+ * Usage examples:
+ * - Pool owns buffers (full):
+ *   `MPMCPool<float, 32, true> pool(false, 8, constructor-args-for-Buffer);`
+ *
+ * - Caller owns buffers (empty):
+ *   `MPMCPool<MyType> pool(true, 8); // then push(Buffer* ownedByCaller)`
+ */
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment = 0, bool isDynamic = true>
+class MPMCPool {
+private:
+    /**
+     * @brief One cell of the queue, padded to a full cache line.
+     */
+    struct alignas(MEM_SENTRY::constants::CACHE_LINE_SIZE) Slot {
+        /**
+         * @brief Lap marker of the slot (see the class notes).
+         */
+        std::atomic<size_t> m_Sequence;
+
+        /**
+         * @brief Buffer stored in the slot, only valid while the sequence says so.
+         */
+        Buffer<T, alignment, isDynamic>* p_Buffer;
+    };
+
+    /**
+     * @brief Next ticket handed to a producer.
+     */
+    CacheAlignedAtomic<size_t> m_EnqueuePos;
+
+    /**
+     * @brief Next ticket handed to a consumer.
+     */
+    CacheAlignedAtomic<size_t> m_DequeuePos;
+
+    /**
+     * @brief The slots, `m_QueueSize` of them.
+     */
+    alignas(MEM_SENTRY::constants::CACHE_LINE_SIZE) std::unique_ptr<Slot[]> p_Slots;
+
+    /**
+     * @brief Total slots in the queue
+     *
+     * Always a power of two for efficient modulo masking.
+     */
+    size_t m_QueueSize{0};
+
+    /**
+     * @brief Mask used for fast wrapping of tickets (m_QueueSize - 1).
+     */
+    size_t m_Mask{0};
+
+    /**
+     * @brief Whether the pool is initialized and ready for use.
+     */
+    bool m_Valid{false};
+
+    /**
+     * @brief Indicates the initial state of the queue (see `RingPool::m_EmptyQueue`).
+     *
+     * @warning In empty mode the queue doesn't own the buffers so it doesn't free them.
+     *   you must return them back to the owner!
+     */
+    bool m_EmptyQueue{false};
+
+private:
+    /**
+     * @brief Round up to next power of 2
+     */
+    static constexpr size_t next_power_of_2(size_t n) {
+        if (n <= 1) return 1;
+        n--;
+        n |= n >> 1;
+        n |= n >> 2;
+        n |= n >> 4;
+        n |= n >> 8;
+        n |= n >> 16;
+        n |= n >> 32;
+        return n + 1;
+    }
+
+    /**
+     * @brief Free the owned buffers still in the queue and release the slots.
+     *
+     * @note Not thread-safe, only called from the destructor or a failed constructor.
+     */
+    void cleanup() {
+        m_Valid = false;
+
+        if (!m_EmptyQueue && p_Slots) {
+            while (auto* buffer = pop()) {
+                delete buffer;
+            }
+        }
+
+        p_Slots.reset();
+
+        m_QueueSize = 0;
+        m_Mask = 0;
+    }
+
+    /**
+     * @brief allocates one buffer per slot (full mode).
+     */
+    template<typename... Args>
+    void allocBuffers(Args&&... args){
+        for(size_t i = 0; i < m_QueueSize; ++i){
+            // keep the args lvalue, every buffer is built from the same arguments.
+            auto* buffer = new Buffer<T, alignment, isDynamic>(args...);
+
+            if constexpr (isDynamic) {
+                if (!buffer->p_Buffer) {
+                    delete buffer;
+                    cleanup();
+                    return;
+                }
+            }
+
+            push(buffer);
+        }
+
+        m_Valid = true;
+    }
+
+public:
+    /**
+     * MPMCPool constructor
+     *
+     * Same parameters as `RingPool`: `empty` selects the ownership mode,
+     * `queue_size` is rounded up to a power of two and `args` are forwarded
+     * to every `Buffer` constructor in full mode.
+     *
+     * - Use `isValid()` to check successful initialization when operating
+     *   in full mode.
+     */
+    template <typename... Args>
+    MPMCPool(bool empty, size_t queue_size, Args&&... args){
+        m_QueueSize = next_power_of_2(queue_size < 2 ? 2 : queue_size);
+        m_Mask = m_QueueSize - 1;
+        m_EmptyQueue = empty;
+
+        p_Slots.reset(new Slot[m_QueueSize]);
+
+        for(size_t i = 0; i < m_QueueSize; ++i){
+            p_Slots[i].m_Sequence.store(i, std::memory_order_relaxed);
+            p_Slots[i].p_Buffer = nullptr;
+        }
+
+        m_EnqueuePos.m_Value.store(0, std::memory_order_relaxed);
+        m_DequeuePos.m_Value.store(0, std::memory_order_relaxed);
+
+        if(empty){
+            m_Valid = true;
+            return;
+        }
+
+        allocBuffers(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Destructor - frees the owned buffers still in the pool.
+     *
+     * @warning Buffers popped and never pushed back are not freed, and in empty
+     *   mode none are: return them to their owner first.
+     */
+    ~MPMCPool(){
+        cleanup();
+    }
+
+    MPMCPool(const MPMCPool&) = delete;
+    MPMCPool& operator=(const MPMCPool&) = delete;
+
+    /**
+     * @brief Check if the pool is valid (properly initialized).
+     *
+     * @return true if valid, false otherwise.
+     */
+    bool isValid() const noexcept {
+        return m_Valid;
+    }
+
+    /**
+     * Try to push a buffer pointer into the pool.
+     *
+     * - Any thread may call it concurrently with other `push`/`pop` calls.
+     *
+     * - Returns `false` when the pool is full (or `buffer` is nullptr).
+     */
+    bool push(Buffer<T, alignment, isDynamic>* buffer);
+
+    /**
+     * Pop a buffer pointer from the pool.
+     *
+     * - Any thread may call it concurrently with other `push`/`pop` calls.
+     *
+     * - Returns `nullptr` if the pool is currently empty.
+     */
+    Buffer<T, alignment, isDynamic>* pop();
+
+    /**
+     * @brief Get the total size (capacity) of the pool.
+     * @return Number of slots.
+     */
+    size_t queueSize() const noexcept {
+        return m_QueueSize;
+    }
+
+    /**
+     * @brief Buffers the pool can hold.
+     */
+    size_t capacity() const noexcept {
+        return m_QueueSize;
+    }
+
+    /**
+     * @brief Approximate number of buffers in the pool.
+     * @note Exact only when no other thread is pushing or popping.
+     */
+    size_t currentSize() const noexcept;
+};
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+size_t MEM_SENTRY::mem_pool::MPMCPool<T, alignment, isDynamic>::currentSize() const noexcept {
+    size_t dequeue = m_DequeuePos.m_Value.load(std::memory_order_acquire);
+    size_t enqueue = m_EnqueuePos.m_Value.load(std::memory_order_acquire);
+
+    // the two loads race with other threads, clamp to a plausible value.
+    if(enqueue < dequeue){
+        return 0;
+    }
+
+    size_t size = enqueue - dequeue;
+
+    return size > m_QueueSize ? m_QueueSize : size;
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+bool MEM_SENTRY::mem_pool::MPMCPool<T, alignment, isDynamic>::push(MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic> *buffer) {
+    if(!buffer || !p_Slots){
+        return false;
+    }
+
+    size_t pos = m_EnqueuePos.m_Value.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    while(true){
+        slot = &p_Slots[pos & m_Mask];
+        size_t sequence = slot->m_Sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+        if(diff == 0){
+            // the slot is free for this lap, claim the ticket.
+            if(m_EnqueuePos.m_Value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                break;
+            }
+        } else if(diff < 0){
+            // the slot still holds the buffer of the previous lap: full.
+            stats::Count(stats::Counter::MPMCPushFull);
+            return false;
+        } else {
+            // another producer took this ticket, catch up.
+            pos = m_EnqueuePos.m_Value.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->p_Buffer = buffer;
+    slot->m_Sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::MPMCPool<T, alignment, isDynamic>::pop() {
+    if(!p_Slots){
+        return nullptr;
+    }
+
+    size_t pos = m_DequeuePos.m_Value.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    while(true){
+        slot = &p_Slots[pos & m_Mask];
+        size_t sequence = slot->m_Sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+        if(diff == 0){
+            // the slot holds a buffer for this lap, claim the ticket.
+            if(m_DequeuePos.m_Value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                break;
+            }
+        } else if(diff < 0){
+            // no producer has filled this slot yet: empty.
+            stats::Count(stats::Counter::MPMCPopEmpty);
+            return nullptr;
+        } else {
+            // another consumer took this ticket, catch up.
+            pos = m_DequeuePos.m_Value.load(std::memory_order_relaxed);
+        }
+    }
+
+    Buffer<T, alignment, isDynamic>* buffer = slot->p_Buffer;
+    slot->p_Buffer = nullptr;
+    slot->m_Sequence.store(pos + m_Mask + 1, std::memory_order_release);
+
+    return buffer;
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include "mem_sentry/constants.h"
+#include "mem_sentry/stats.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <thread>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace MEM_SENTRY::mem_pool {
+
+/**
+ * @brief Hint to the core that the thread is spinning (pause / yield instruction).
+ */
+inline void cpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+/**
+ * @brief Lets the single thread on one side of a pool sleep until the other side makes progress.
+ *
+ * Used by `RingPool::pop_wait()` / `push_wait()` and their `PoolChain`
+ * counterparts. The waiter retries with a hybrid backoff: `POOL_WAIT_SPINS`
+ * pause instructions, then `POOL_WAIT_YIELDS` yields, then it parks on a
+ * futex until the other side calls `notify()`.
+ *
+ * Steady state costs no syscall and, for pools nobody waits on, no fence:
+ * - `notify()` is one relaxed load of `m_Armed` until a waiter has parked once.
+ * - Once armed, `notify()` acknowledges it (`m_Acked`) and from then on pairs
+ *   the caller's publish with the waiter's `m_Parked` store through a seq_cst
+ *   fence on each side, so it wakes the futex only when the waiter has
+ *   declared itself parked and never misses it.
+ * - Until the waiter sees the acknowledgement, a publish may have skipped the
+ *   fence, so it parks for at most `POOL_WAIT_UNACKED_NS` and retries.
+ *
+ * @note One waiter at a time, as in the SPSC pools; every field shares one
+ * cache line that is only written when a thread parks or gets woken.
+ */
+class alignas(MEM_SENTRY::constants::CACHE_LINE_SIZE) ParkingSpot {
+private:
+    /** @brief Futex word, bumped by every wake. */
+    std::atomic<uint32_t> m_Epoch{0};
+
+    /** @brief 1 while the waiter is parked or about to park. */
+    std::atomic<uint32_t> m_Parked{0};
+
+    /** @brief Set once by the first waiter that runs out of spins. */
+    std::atomic<uint32_t> m_Armed{0};
+
+    /** @brief Set once by the notifying side when it first sees m_Armed. */
+    std::atomic<uint32_t> m_Acked{0};
+
+    /**
+     * @brief futex wait on m_Epoch while it still holds `epoch`, for at most `timeout`.
+     */
+    void park(uint32_t epoch, std::chrono::nanoseconds timeout) noexcept {
+        timespec ts;
+        ts.tv_sec = (time_t)(timeout.count() / 1000000000);
+        ts.tv_nsec = (long)(timeout.count() % 1000000000);
+
+        stats::Count(stats::Counter::PoolParks);
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_Epoch), FUTEX_WAIT_PRIVATE, epoch, &ts, nullptr, 0);
+    }
+
+    /**
+     * @brief Slow half of notify(), once a waiter armed the spot.
+     */
+    void notifyArmed() noexcept {
+        // every publish after this store goes through the fence below.
+        if(!m_Acked.load(std::memory_order_relaxed)){
+            m_Acked.store(1, std::memory_order_release);
+        }
+
+        // orders the caller's publish before the m_Parked load (pairs with the fence in wait()).
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if(m_Parked.load(std::memory_order_relaxed)){
+            m_Epoch.fetch_add(1, std::memory_order_release);
+            stats::Count(stats::Counter::PoolWakes);
+            ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_Epoch), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+        }
+    }
+
+public:
+    /**
+     * @brief Retries `attempt` until it succeeds or `deadline` passes.
+     *
+     * @param attempt Callable returning a value that converts to `true` on success
+     *   (a buffer pointer, a push result, ...).
+     * @param deadline When to give up; `time_point::max()` waits forever.
+     * @return The first successful result, or the last failed one on timeout.
+     */
+    template<typename Attempt>
+    auto wait(Attempt&& attempt, std::chrono::steady_clock::time_point deadline) noexcept -> decltype(attempt()) {
+        for(uint32_t i = 0; i < MEM_SENTRY::constants::POOL_WAIT_SPINS; ++i){
+            if(auto result = attempt())
+                return result;
+
+            cpuRelax();
+        }
+
+        for(uint32_t i = 0; i < MEM_SENTRY::constants::POOL_WAIT_YIELDS; ++i){
+            if(auto result = attempt())
+                return result;
+
+            std::this_thread::yield();
+        }
+
+        if(!m_Armed.load(std::memory_order_relaxed)){
+            m_Armed.store(1, std::memory_order_relaxed);
+        }
+
+        for(;;){
+            uint32_t epoch = m_Epoch.load(std::memory_order_acquire);
+
+            // read before the attempt: once acknowledged, every publish the attempt can miss will wake us.
+            bool acked = m_Acked.load(std::memory_order_acquire);
+
+            m_Parked.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            auto result = attempt();
+
+            if(result){
+                m_Parked.store(0, std::memory_order_relaxed);
+                return result;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+
+            if(now >= deadline){
+                m_Parked.store(0, std::memory_order_relaxed);
+                return result;
+            }
+
+            std::chrono::nanoseconds timeout = deadline == std::chrono::steady_clock::time_point::max()
+                ? std::chrono::nanoseconds(std::chrono::hours(1))
+                : std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+
+            if(!acked && timeout > std::chrono::nanoseconds(MEM_SENTRY::constants::POOL_WAIT_UNACKED_NS)){
+                timeout = std::chrono::nanoseconds(MEM_SENTRY::constants::POOL_WAIT_UNACKED_NS);
+            }
+
+            park(epoch, timeout);
+            m_Parked.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Called by the other side after it published progress (a push or a pop).
+     * @note A relaxed load on a line nobody writes, unless a waiter ever parked here.
+     */
+    void notify() noexcept {
+        if(m_Armed.load(std::memory_order_relaxed)) [[unlikely]] {
+            notifyArmed();
+        }
+    }
+};
+}
@@ -1,8 +1,12 @@
 #pragma once 
 #include "mem_pools/buffer.h"
+#include "mem_pools/arena.h"
+#include "mem_pools/parking.h"
 #include "mem_sentry/constants.h"
+#include "mem_sentry/stats.h"
 
 #include <atomic>
+#include <chrono>
 #include <vector>
 
 namespace MEM_SENTRY::mem_pool {
@@ -40,9 +44,27 @@ struct alignas(MEM_SENTRY::constants::CACHE_LINE_SIZE) CacheAlignedAtomic {
  *     empty and the caller pushes owned `Buffer*` pointers into the
  *     ring. The pool will not delete those pointers on destruction.
  * 
+ *   - "Arena" mode (pool owns buffers, `ArenaStorage` constructor): like
+ *     full mode, but every `Buffer` and its payload live in one
+ *     contiguous `BufferArena`, freed at once in the destructor. The
+ *     arena can be bound to a NUMA node (`ArenaStorage::m_Node`).
+ * 
  * - Single-producer / single-consumer intended: `m_WriteIndex` is only
  *   modified by the producer, `m_ReadIndex` only by the consumer.
  * 
+ * - Each side keeps a private copy of the other side's index and only
+ *   reloads the shared one when the copy shows too little room (producer)
+ *   or too few buffers (consumer) for the request, so the other core's
+ *   cache line is rarely touched.
+ * 
+ * - `push_bulk()` / `pop_bulk()` move a whole burst of buffers for one
+ *   index load and one release store.
+ * 
+ * - `pop_wait()` / `push_wait()` block until the other side makes room or
+ *   hands a buffer over: spin, yield, then park on a futex (see
+ *   `ParkingSpot`). The other side only pays a relaxed load per operation
+ *   until a waiter has actually parked, and a syscall only to wake one.
+ * 
  * - The class stores raw pointers to `Buffer<T,...>`; ownership is
  *   determined by the mode described above.
  *
@@ -53,8 +75,8 @@ struct alignas(MEM_SENTRY::constants::CACHE_LINE_SIZE) CacheAlignedAtomic {
  *   `Buffer` objects perform heap allocations for their `T`.
  *
  * Thread-safety and ordering notes:
- * - `push()` is intended to be called only by the producer thread.
- * - `pop()` is intended to be called only by the consumer thread.
+ * - `push()` / `push_bulk()` / `push_wait()` are intended to be called only by the producer thread.
+ * - `pop()` / `pop_bulk()` / `pop_wait()` are intended to be called only by the consumer thread.
  * 
  * - The implementation uses `std::memory_order_acquire`/`release`
  *   semantics for the hand-off points.
@@ -65,6 +87,9 @@ struct alignas(MEM_SENTRY::constants::CACHE_LINE_SIZE) CacheAlignedAtomic {
  * 
  * - Caller owns buffers (empty):
  *   `RingPool<MyType> pool(true, 8); // then push(Buffer* ownedByCaller)`
+ * 
+ * - Pool owns buffers in one arena:
+ *   `RingPool<float, 32, true> pool(ArenaStorage{}, 4096, constructor-args-for-T);`
 */
 template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment = 0, bool isDynamic = true>
 class RingPool {
@@ -85,6 +110,22 @@ private:
      */
     CacheAlignedAtomic<size_t> m_ReadIndex;
 
+    /**
+     * @brief Producer's last seen value of m_ReadIndex.
+     *
+     * Only read and written by the producer. Lagging behind the real index
+     * only makes the ring look fuller than it is, which is safe.
+     */
+    alignas(MEM_SENTRY::constants::CACHE_LINE_SIZE) size_t m_CachedReadIndex{0};
+
+    /**
+     * @brief Consumer's last seen value of m_WriteIndex.
+     *
+     * Only read and written by the consumer. Lagging behind the real index
+     * only makes the ring look emptier than it is, which is safe.
+     */
+    alignas(MEM_SENTRY::constants::CACHE_LINE_SIZE) size_t m_CachedWriteIndex{0};
+
     /**
      * @brief vector holding pointers to the allocated buffers.
      */
@@ -121,6 +162,21 @@ private:
      */
     bool m_EmptyQueue{false};
 
+    /**
+     * @brief Contiguous storage of the buffers in arena mode, nullptr otherwise.
+     */
+    BufferArena<T, alignment, isDynamic>* p_Arena{nullptr};
+
+    /**
+     * @brief Where the consumer parks in `pop_wait()`; notified by every push.
+     */
+    ParkingSpot m_ConsumerSpot;
+
+    /**
+     * @brief Where the producer parks in `push_wait()`; notified by every pop.
+     */
+    ParkingSpot m_ProducerSpot;
+
 private:
     /**
      * @brief Round up to next power of 2
@@ -140,12 +196,50 @@ private:
     /**
      * @brief Get available space for writing (from writer's perspective)
      */
-    size_t getFreeSpace(size_t currentWrite){
-        size_t currentRead = m_ReadIndex.m_Value.load(std::memory_order_acquire);
-
+    size_t getFreeSpace(size_t currentWrite, size_t currentRead){
         return m_QueueSize - getAvailableBuffers(currentWrite, currentRead) - 1;
     }
 
+    /**
+     * @brief Free slots seen by the producer, reloading m_ReadIndex only
+     * when the cached copy has fewer than `wanted` slots.
+     */
+    size_t producerSpace(size_t currentWrite, size_t wanted){
+        size_t space = getFreeSpace(currentWrite, m_CachedReadIndex);
+
+        if(space < wanted){
+            m_CachedReadIndex = m_ReadIndex.m_Value.load(std::memory_order_acquire);
+            space = getFreeSpace(currentWrite, m_CachedReadIndex);
+        }
+
+        return space;
+    }
+
+    /**
+     * @brief Buffers seen by the consumer, reloading m_WriteIndex only
+     * when the cached copy has fewer than `wanted` buffers.
+     */
+    size_t consumerAvailable(size_t currentRead, size_t wanted){
+        size_t buffers = getAvailableBuffers(m_CachedWriteIndex, currentRead);
+
+        if(buffers < wanted){
+            m_CachedWriteIndex = m_WriteIndex.m_Value.load(std::memory_order_acquire);
+            buffers = getAvailableBuffers(m_CachedWriteIndex, currentRead);
+        }
+
+        return buffers;
+    }
+
+    /**
+     * @brief `push()` without the full-ring counter.
+     */
+    bool put(Buffer<T, alignment, isDynamic>* buffer);
+
+    /**
+     * @brief `pop()` without the empty-ring counter.
+     */
+    Buffer<T, alignment, isDynamic>* take();
+
     /**
      * @brief Get available data for reading (from reader's perspective)
      */
@@ -166,9 +260,14 @@ private:
         m_Valid = false;
         m_WriteIndex.m_Value.store(0, std::memory_order_seq_cst);
         m_ReadIndex.m_Value.store(0, std::memory_order_seq_cst);
-
-        // free only if we own the buffers
-        if (!m_EmptyQueue) {
+        m_CachedReadIndex = 0;
+        m_CachedWriteIndex = 0;
+
+        // arena buffers are destroyed together with the arena.
+        if (p_Arena) {
+            delete p_Arena;
+            p_Arena = nullptr;
+        } else if (!m_EmptyQueue) {
             for (auto& buffer : m_Queue) {
                 if (buffer) {
                     delete buffer;
@@ -265,6 +364,50 @@ public:
         allocBuffers(queue_size, std::forward<Args>(args)...);
     }
 
+    /**
+     * RingPool constructor (arena mode)
+     *
+     * Same as the full-mode constructor, but the `queue_size - 1` buffers
+     * and their payloads are constructed in place in a single aligned
+     * `BufferArena` (optionally huge-page backed and/or bound to a NUMA
+     * node, see `ArenaStorage`) instead of 2 x N
+     * separate allocations. `args` are forwarded to every `T`.
+     *
+     * - Use `isValid()` to check that the arena could be allocated.
+     * 
+     * @warning Every buffer is destroyed with the pool, including the
+     *   ones a consumer still holds.
+     */
+    template <typename... Args>
+    RingPool(ArenaStorage storage, size_t queue_size, Args&&... args){
+        m_Valid = false;
+
+        queue_size = next_power_of_2(queue_size);
+
+        if(queue_size < 2){
+            queue_size = 2;
+        }
+
+        m_QueueSize = queue_size;
+        m_Mask = queue_size - 1;
+
+        m_Queue.resize(queue_size, nullptr);
+
+        p_Arena = new BufferArena<T, alignment, isDynamic>(queue_size - 1, storage, args...);
+
+        if(!p_Arena->isValid()){
+            cleanup();
+            return;
+        }
+
+        for(size_t i = 0; i < queue_size - 1; ++i){
+            m_Queue[i] = p_Arena->at(i);
+        }
+
+        m_WriteIndex.m_Value.store(queue_size - 1, std::memory_order_relaxed);
+        m_Valid = true;
+    }
+
     /**
      * @brief Destructor - clean up all allocated memory
      * 
@@ -323,6 +466,81 @@ public:
      */
     Buffer<T, alignment, isDynamic>* pop();
 
+    /**
+     * Push up to `count` buffer pointers into the ring in one batch.
+     *
+     * - Producer only, like `push`.
+     * 
+     * - Pushes `buffers[0..n)` in order, where `n` is the smaller of `count`
+     *   and the free space; a `nullptr` entry ends the batch early.
+     * 
+     * - Costs at most one acquire load of the read index and a single
+     *   release store of the write index for the whole batch.
+     *
+     * Returns the number of buffers pushed (0 if the queue is full).
+     */
+    size_t push_bulk(Buffer<T, alignment, isDynamic>** buffers, size_t count);
+
+    /**
+     * Pop up to `max` buffer pointers from the ring in one batch.
+     *
+     * - Consumer only, like `pop`.
+     * 
+     * - Writes the buffers to `out[0..n)` in FIFO order.
+     * 
+     * - Costs at most one acquire load of the write index and a single
+     *   release store of the read index for the whole batch.
+     *
+     * Returns the number of buffers popped (0 if the queue is empty).
+     */
+    size_t pop_bulk(Buffer<T, alignment, isDynamic>** out, size_t max);
+
+    /**
+     * Pop a buffer pointer, waiting for the producer if the ring is empty.
+     *
+     * - Consumer only, like `pop`.
+     * 
+     * - Tries `pop` first; when the ring is empty it spins with pause
+     *   instructions, then yields, then parks on a futex until the next
+     *   `push` / `push_bulk` / `push_wait` wakes it.
+     * 
+     * Returns the buffer (never `nullptr`: it waits as long as it takes).
+     */
+    Buffer<T, alignment, isDynamic>* pop_wait();
+
+    /**
+     * Like `pop_wait()`, but gives up after `timeout`.
+     *
+     * Returns the buffer, or `nullptr` if the ring stayed empty for the whole timeout.
+     */
+    Buffer<T, alignment, isDynamic>* pop_wait(std::chrono::nanoseconds timeout);
+
+    /**
+     * Push a buffer pointer, waiting for the consumer if the ring is full.
+     *
+     * - Producer only, like `push`; parks like `pop_wait()` and is woken by the
+     *   next `pop` / `pop_bulk` / `pop_wait`.
+     * 
+     * Returns `true` once pushed, `false` only for a `nullptr` buffer.
+     */
+    bool push_wait(Buffer<T, alignment, isDynamic>* buffer);
+
+    /**
+     * Like `push_wait()`, but gives up after `timeout`.
+     *
+     * Returns `false` if the ring stayed full for the whole timeout.
+     */
+    bool push_wait(Buffer<T, alignment, isDynamic>* buffer, std::chrono::nanoseconds timeout);
+
+    /**
+     * @brief The arena holding the buffers in arena mode, nullptr otherwise.
+     * @note Its buffers can be walked linearly with `at(i)`, e.g. to reset them
+     *   while no thread uses the pool.
+     */
+    BufferArena<T, alignment, isDynamic>* arena() noexcept {
+        return p_Arena;
+    }
+
     /**
      * @brief Get the total size (capacity) of the Queue.
      * @return Number of buffers in the queue.
@@ -331,6 +549,13 @@ public:
         return m_QueueSize;
     }
 
+    /**
+     * @brief Buffers the pool can hold (one slot always stays empty).
+     */
+    size_t capacity() const noexcept {
+        return m_QueueSize - 1;
+    }
+
     /**
      * @brief the current size of the queue.
      * @note perform atomic operations (aquire loads) for both m_WriteIndex, m_ReadIndex.
@@ -350,14 +575,10 @@ size_t MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::currentSize() {
 }
 
 template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
-bool MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::push(MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic> *buffer) {
-    if(!buffer){
-        return false;
-    }
-
+bool MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::put(MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic> *buffer) {
     size_t currentWrite = m_WriteIndex.m_Value.load(std::memory_order_relaxed); 
 
-    size_t space = getFreeSpace(currentWrite);
+    size_t space = producerSpace(currentWrite, 1);
     
     if(space == 0){
         return false;
@@ -366,16 +587,30 @@ bool MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::push(MEM_SENTRY::m
     m_Queue[currentWrite] = buffer;
     m_WriteIndex.m_Value.store((currentWrite + 1) & m_Mask, std::memory_order_release);
 
+    m_ConsumerSpot.notify();
+
+    return true;
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+bool MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::push(MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic> *buffer) {
+    if(!buffer){
+        return false;
+    }
+
+    if(!put(buffer)){
+        stats::Count(stats::Counter::RingPushFull);
+        return false;
+    }
+
     return true;
 }
 
 template<MEM_SENTRY::concepts::NotRawArray  T, size_t alignment, bool isDynamic>
-MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::pop() {
-    size_t currentWrite = m_WriteIndex.m_Value.load(std::memory_order_acquire);
-    
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::take() {
     size_t currentRead = m_ReadIndex.m_Value.load(std::memory_order_relaxed);
     
-    size_t buffers = getAvailableBuffers(currentWrite, currentRead);
+    size_t buffers = consumerAvailable(currentRead, 1);
 
     if(buffers == 0){
         return nullptr;
@@ -388,5 +623,120 @@ MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::Rin
     
     m_ReadIndex.m_Value.store(new_index, std::memory_order_release);
 
+    m_ProducerSpot.notify();
+
     return buffer;
 }
+
+template<MEM_SENTRY::concepts::NotRawArray  T, size_t alignment, bool isDynamic>
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::pop() {
+    Buffer<T, alignment, isDynamic>* buffer = take();
+
+    if(!buffer){
+        stats::Count(stats::Counter::RingPopEmpty);
+    }
+
+    return buffer;
+}
+
+template<MEM_SENTRY::concepts::NotRawArray  T, size_t alignment, bool isDynamic>
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::pop_wait() {
+    // the fast path is a plain pop: no fence, no syscall.
+    if(Buffer<T, alignment, isDynamic>* buffer = take()){
+        return buffer;
+    }
+
+    return m_ConsumerSpot.wait([this]() { return take(); }, std::chrono::steady_clock::time_point::max());
+}
+
+template<MEM_SENTRY::concepts::NotRawArray  T, size_t alignment, bool isDynamic>
+MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic>* MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::pop_wait(std::chrono::nanoseconds timeout) {
+    if(Buffer<T, alignment, isDynamic>* buffer = take()){
+        return buffer;
+    }
+
+    return m_ConsumerSpot.wait([this]() { return take(); }, std::chrono::steady_clock::now() + timeout);
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+bool MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::push_wait(MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic> *buffer) {
+    if(!buffer){
+        return false;
+    }
+
+    if(put(buffer)){
+        return true;
+    }
+
+    return m_ProducerSpot.wait([this, buffer]() { return put(buffer); }, std::chrono::steady_clock::time_point::max());
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+bool MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::push_wait(MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic> *buffer, std::chrono::nanoseconds timeout) {
+    if(!buffer){
+        return false;
+    }
+
+    if(put(buffer)){
+        return true;
+    }
+
+    return m_ProducerSpot.wait([this, buffer]() { return put(buffer); }, std::chrono::steady_clock::now() + timeout);
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+size_t MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::push_bulk(MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic> **buffers, size_t count) {
+    if(!buffers || count == 0){
+        return 0;
+    }
+
+    size_t currentWrite = m_WriteIndex.m_Value.load(std::memory_order_relaxed);
+
+    size_t space = producerSpace(currentWrite, count);
+    size_t n = count < space ? count : space;
+
+    if(n < count){
+        stats::Count(stats::Counter::RingPushFull);
+    }
+
+    size_t pushed = 0;
+    for(; pushed < n && buffers[pushed]; ++pushed){
+        m_Queue[(currentWrite + pushed) & m_Mask] = buffers[pushed];
+    }
+
+    if(pushed){
+        m_WriteIndex.m_Value.store((currentWrite + pushed) & m_Mask, std::memory_order_release);
+        m_ConsumerSpot.notify();
+    }
+
+    return pushed;
+}
+
+template<MEM_SENTRY::concepts::NotRawArray T, size_t alignment, bool isDynamic>
+size_t MEM_SENTRY::mem_pool::RingPool<T, alignment, isDynamic>::pop_bulk(MEM_SENTRY::mem_pool::Buffer<T, alignment, isDynamic> **out, size_t max) {
+    if(!out || max == 0){
+        return 0;
+    }
+
+    size_t currentRead = m_ReadIndex.m_Value.load(std::memory_order_relaxed);
+
+    size_t buffers = consumerAvailable(currentRead, max);
+    size_t n = max < buffers ? max : buffers;
+
+    if(n < max){
+        stats::Count(stats::Counter::RingPopEmpty);
+    }
+
+    for(size_t i = 0; i < n; ++i){
+        size_t index = (currentRead + i) & m_Mask;
+        out[i] = m_Queue[index];
+        m_Queue[index] = nullptr;
+    }
+
+    if(n){
+        m_ReadIndex.m_Value.store((currentRead + n) & m_Mask, std::memory_order_release);
+        m_ProducerSpot.notify();
+    }
+
+    return n;
+}
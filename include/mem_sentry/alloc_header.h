@@ -1,24 +1,100 @@
 #pragma once 
 #include <cstdint>
+#include <cstddef>
+
+#include "mem_sentry/constants.h"
 
 namespace MEM_SENTRY::heap {
     class Heap;
 }
 
 namespace MEM_SENTRY::alloc_header {
+    /**
+     * @enum BlockKind
+     * @brief Records which backend produced the raw memory of an allocation.
+     * The free path reads it to hand the memory back to the same backend.
+     */
+    enum class BlockKind : uint8_t {
+        /// @brief one malloc() call per allocation.
+        Malloc = 0xA1,
+
+        /// @brief a fixed-size chunk carved from a heap's slab pages.
+        Slab   = 0xA2,
+
+        /// @brief a large block with its own anonymous mapping (see Heap::SetMappedThreshold()).
+        Mapped = 0xA3,
+
+        /// @brief unsampled block from malloc(), carrying a LightHeader.
+        MallocLight = 0xB1,
+
+        /// @brief unsampled block from the slab backend, carrying a LightHeader.
+        SlabLight   = 0xB2,
+
+        /// @brief unsampled block with its own mapping, carrying a LightHeader.
+        MappedLight = 0xB3,
+
+        /// @brief object bumped from an ArenaHeap chunk; only this byte precedes it,
+        /// and delete leaves it to ArenaHeap::Reset().
+        Arena  = 0xC1,
+
+        /// @brief written over the kind on free by the compact and light layouts,
+        /// which have no room for a separate 32-bit signature.
+        Freed  = 0xFE
+    };
+
+    /**
+     * @brief Returns true for blocks carrying a LightHeader (not sampled, not tracked).
+     */
+    constexpr bool IsLight(BlockKind kind) noexcept {
+        return (static_cast<uint8_t>(kind) & 0xF0) == 0xB0;
+    }
+
+    /**
+     * @brief Returns true for blocks whose raw memory comes from the slab backend.
+     */
+    constexpr bool IsSlab(BlockKind kind) noexcept {
+        return kind == BlockKind::Slab || kind == BlockKind::SlabLight;
+    }
+
+    /**
+     * @brief Returns true for blocks whose raw memory is a mapping of their own.
+     */
+    constexpr bool IsMapped(BlockKind kind) noexcept {
+        return kind == BlockKind::Mapped || kind == BlockKind::MappedLight;
+    }
+
+    /**
+     * @brief Returns the light variant of a tracked kind (Malloc -> MallocLight, ...).
+     */
+    constexpr BlockKind ToLight(BlockKind kind) noexcept {
+        return static_cast<BlockKind>((static_cast<uint8_t>(kind) & 0x0F) | 0xB0);
+    }
+
+    /**
+     * @brief Reads the kind byte every layout stores right before the user data.
+     * This is what lets the free path tell the header layouts apart.
+     */
+    inline BlockKind KindOf(const void* pMem) noexcept {
+        return *(reinterpret_cast<const BlockKind*>(pMem) - 1);
+    }
+
+#if !MEM_SENTRY_COMPACT_HEADER
     /**
      * @struct AllocHeader
      * @brief Metadata header attached to every allocation.
      *
      * This header acts as a node in the memory tracking doubly-linked list. 
-     * It stores ownership details, integrity signatures, and the original pointer
-     * required to correctly free aligned memory.
+     * It stores ownership details, integrity signatures and the call site of the
+     * allocation. As in the compact layout, aligned blocks keep their original
+     * pointer in the 8 bytes right before the header (see GetOriginalAddress()).
      *
      * @note Memory Layout:
-     * - Pointers (32 bytes): p_Heap, p_Next, p_Prev, p_OriginalAddress
-     * - Integers (13 bytes): m_Size(4), m_Signature(4), m_AllocId(4), m_Alignment(1)
-     * - Padding  (3 bytes):  To align struct to 8-byte boundary.
-     * - Total Size: 48 Bytes.
+     * - Pointers (24 bytes): p_Heap, p_Next, p_Prev
+     * - Integers (24 bytes): m_Size(4), m_Signature(4), m_AllocId(4), m_StackId(4), m_Reserved(4),
+     *   m_AlignShift(1), m_Shard(1), m_SlabShard(1), m_Kind(1)
+     * - Total Size: 48 Bytes. m_Kind is the last byte, right before the user data (see KindOf()).
+     *
+     * @see MEM_SENTRY_COMPACT_HEADER for the 16-byte layout.
      */
     struct AllocHeader {
         // --- Pointers (8 bytes each) ---
@@ -32,10 +108,6 @@ namespace MEM_SENTRY::alloc_header {
         /// @brief Pointer to the previous allocation in the linked list.
         AllocHeader* p_Prev;
 
-        /// @brief Original raw pointer returned by malloc.
-        /// Essential for freeing aligned allocations where the user pointer is offset.
-        void* p_OriginalAddress;
-
         // --- Data Fields ---
 
         /// @brief Size of the user data (excluding header/footer).
@@ -48,9 +120,269 @@ namespace MEM_SENTRY::alloc_header {
         /// @brief Unique allocation ID for tracking/reporting.
         uint32_t m_AllocId;
 
-        /// @brief Alignment used for this allocation.
-        uint8_t m_Alignment;
+        /// @brief Call site of the allocation in the callsite table, callsite::NO_STACK when not captured.
+        uint32_t m_StackId;
+
+        /// @brief Explicit padding, so m_Kind is the last byte.
+        uint32_t m_Reserved;
+
+        /// @brief log2 of the alignment used for this allocation, 0 when unaligned.
+        uint8_t m_AlignShift;
+
+        /// @brief Index of the heap shard whose list holds this allocation.
+        /// Set by Heap::AddAllocation() so the block can be unlinked from any thread.
+        uint8_t m_Shard;
+
+        /// @brief Shard of the slab cache that carved the block, SLAB_NO_SHARD for malloc blocks.
+        /// Lets sized delete return the chunk without reading its page header.
+        uint8_t m_SlabShard;
+
+        /// @brief Backend that owns the raw memory (see BlockKind).
+        BlockKind m_Kind;
+    };
+
+    static_assert(sizeof(AllocHeader) == 48, "full AllocHeader must stay 48 bytes");
+#else
+    /**
+     * @struct AllocHeader
+     * @brief Compact 16-byte metadata header (MEM_SENTRY_COMPACT_HEADER=1).
+     *
+     * Same role as the full header, with every field shrunk:
+     * - The heap is stored as its 16-bit registry index (HeapFactory::GetHeapByIndex()).
+     * - Instead of prev/next pointers, the block stores its 26-bit position in the
+     *   block table of the shard that tracks it; unlinking swaps the last entry into
+     *   that position, so it stays O(1).
+     * - The alignment is stored as its log2.
+     * - The original malloc pointer is only kept for aligned blocks, in the 8 bytes
+     *   right before the header (unaligned blocks start at the header itself).
+     * - `m_Kind` doubles as the integrity signature: it is one of the live
+     *   BlockKind values while allocated and BlockKind::Freed after free.
+     *
+     * @note Memory Layout:
+     * - m_Slot(26 bits) + m_Shard(6 bits), m_Size(4), m_AllocId(4),
+     *   m_HeapIndex(2), m_AlignShift(1), m_Kind(1)
+     * - Total Size: 16 Bytes.
+     */
+    struct AllocHeader {
+        /// @brief Position of this block in its shard's block table.
+        uint32_t m_Slot : 26;
+
+        /// @brief Index of the heap shard whose block table holds this allocation.
+        uint32_t m_Shard : 6;
+
+        /// @brief Size of the user data (excluding header/footer).
+        uint32_t m_Size;
+
+        /// @brief Unique allocation ID for tracking/reporting.
+        uint32_t m_AllocId;
+
+        /// @brief Registry index of the heap that tracks this allocation.
+        uint16_t m_HeapIndex;
 
-        // 3 bytes of implicit padding here on 64-bit systems
+        /// @brief log2 of the alignment used for this allocation, 0 when unaligned.
+        uint8_t m_AlignShift;
+
+        /// @brief Backend that owns the raw memory, or BlockKind::Freed.
+        BlockKind m_Kind;
     };
-};
\ No newline at end of file
+
+    static_assert(sizeof(AllocHeader) == 16, "compact AllocHeader must stay 16 bytes");
+#endif
+
+    static_assert(offsetof(AllocHeader, m_Kind) == sizeof(AllocHeader) - 1,
+        "the kind must be the last byte before the user data");
+
+    /**
+     * @struct LightHeader
+     * @brief 16-byte header of blocks skipped by heap sampling (see Heap::SetSamplingInterval()).
+     *
+     * Light blocks are not linked into any list, counted or reported; the header only
+     * holds what the free path needs. As in the compact layout, aligned light blocks
+     * keep their original pointer in the 8 bytes right before the header.
+     */
+    struct LightHeader {
+        /// @brief Heap the block was allocated from (needed to return slab chunks).
+        MEM_SENTRY::heap::Heap* p_Heap;
+
+        /// @brief Size of the user data (excluding header/footer).
+        uint32_t m_Size;
+
+        /// @brief log2 of the alignment used for this allocation, 0 when unaligned.
+        uint8_t m_AlignShift;
+
+        /// @brief Shard of the slab cache that carved the block, SLAB_NO_SHARD for malloc blocks.
+        uint8_t m_SlabShard;
+
+        /// @brief Explicit padding, so m_Kind is the last byte.
+        uint8_t m_Reserved;
+
+        /// @brief MallocLight or SlabLight while allocated, Freed after free.
+        BlockKind m_Kind;
+    };
+
+    static_assert(sizeof(LightHeader) == 16, "LightHeader must keep user data 16-byte aligned");
+    static_assert(offsetof(LightHeader, m_Kind) == sizeof(LightHeader) - 1,
+        "the kind must be the last byte before the user data");
+
+#if !MEM_SENTRY_COMPACT_HEADER
+    /// @brief m_Reserved of a header that is a HeaderCopy (live headers keep 0 there).
+    constexpr uint32_t HEADER_COPY_MARK = 0xC0C0C0C0;
+#else
+    /// @brief m_Slot of a header that is a HeaderCopy; the last slot of a block table is never used.
+    constexpr uint32_t HEADER_COPY_MARK = (1u << 26) - 1;
+#endif
+
+    /**
+     * @struct HeaderCopy
+     * @brief Copy of a block header taken out from under a shard lock for reporting.
+     *
+     * The original pointer of an aligned block lives in front of its header, so
+     * the copy keeps it there too and GetOriginalAddress() works on `m_Header`.
+     * The address of the user data sits in front of that, for GetAddress().
+     */
+    struct HeaderCopy {
+        /** @brief Address of the user data of the block. */
+        void* p_Address;
+
+        /** @brief Raw address of the block. */
+        void* p_OriginalAddress;
+
+        /** @brief Copy of the block header, list links cleared. */
+        AllocHeader m_Header;
+    };
+
+    static_assert(offsetof(HeaderCopy, m_Header) == 2 * sizeof(void*),
+        "the original pointer must sit right before the copied header, the address before it");
+
+    /// @brief Largest user size a tracked block can have: every header layout records it in 32 bits.
+    constexpr size_t MAX_BLOCK_SIZE = UINT32_MAX;
+
+    /**
+     * @brief Bytes reserved in front of the user data of a block with the given alignment.
+     * Aligned blocks also store their original pointer before the header.
+     */
+    constexpr size_t HeaderFootprint(size_t alignment) noexcept {
+        return sizeof(AllocHeader) + (alignment ? sizeof(void*) : 0);
+    }
+
+    /**
+     * @brief Raw bytes requested for a tracked block of `size` user bytes: header,
+     * alignment padding, end marker and redzone.
+     * constexpr, so ISentry types get their block size at compile time (see sentry::FixedBlock).
+     */
+    constexpr size_t BlockBytes(size_t size, size_t alignment) noexcept {
+        return size + alignment + HeaderFootprint(alignment) + sizeof(int) + constants::REDZONE_BYTES;
+    }
+
+    /**
+     * @brief Returns the alignment recorded in the header (0 when unaligned).
+     */
+    inline size_t GetAlignment(const AllocHeader* alloc) noexcept {
+        return alloc->m_AlignShift ? (size_t)1 << alloc->m_AlignShift : 0;
+    }
+
+    /**
+     * @brief Returns the raw pointer the block's memory was obtained at.
+     */
+    inline void* GetOriginalAddress(const AllocHeader* alloc) noexcept {
+        if(GetAlignment(alloc)){
+            return *reinterpret_cast<void* const*>(reinterpret_cast<const char*>(alloc) - sizeof(void*));
+        }
+        return const_cast<AllocHeader*>(alloc);
+    }
+
+    /**
+     * @brief Returns the address of the user data, for a live header or a HeaderCopy alike.
+     * Reporters get copies from ReportMemory(), Scrub() and AsyncReporter, so they
+     * must use this instead of `alloc + 1`.
+     */
+    inline void* GetAddress(const AllocHeader* alloc) noexcept {
+#if !MEM_SENTRY_COMPACT_HEADER
+        const bool copy = alloc->m_Reserved == HEADER_COPY_MARK;
+#else
+        const bool copy = alloc->m_Slot == HEADER_COPY_MARK;
+#endif
+        if(copy){
+            return *reinterpret_cast<void* const*>(reinterpret_cast<const char*>(alloc) - 2 * sizeof(void*));
+        }
+        return const_cast<AllocHeader*>(alloc) + 1;
+    }
+
+    /**
+     * @brief Copies a header for reporting, with its original pointer and address in front.
+     */
+    inline void CopyHeader(const AllocHeader* alloc, HeaderCopy& copy) noexcept {
+        copy.p_Address = GetAddress(alloc);
+        copy.p_OriginalAddress = GetOriginalAddress(alloc);
+        copy.m_Header = *alloc;
+#if !MEM_SENTRY_COMPACT_HEADER
+        copy.m_Header.p_Next = nullptr;
+        copy.m_Header.p_Prev = nullptr;
+        copy.m_Header.m_Reserved = HEADER_COPY_MARK;
+#else
+        copy.m_Header.m_Slot = HEADER_COPY_MARK;
+#endif
+    }
+
+    /**
+     * @brief Returns the call site recorded for the block, see Heap::SetCallSiteDepth().
+     * @note The compact layout has no room for it and always returns callsite::NO_STACK.
+     */
+    inline uint32_t GetStackId(const AllocHeader* alloc) noexcept {
+#if MEM_SENTRY_COMPACT_HEADER
+        (void)alloc;
+        return constants::CALLSITE_NO_STACK;
+#else
+        return alloc->m_StackId;
+#endif
+    }
+
+    /**
+     * @brief Records the call site of the block (ignored by the compact layout).
+     */
+    inline void SetStackId(AllocHeader* alloc, uint32_t id) noexcept {
+#if MEM_SENTRY_COMPACT_HEADER
+        (void)alloc;
+        (void)id;
+#else
+        alloc->m_StackId = id;
+#endif
+    }
+
+    /**
+     * @brief Returns the shard of the slab cache that carved the block.
+     * @note The compact layout has no room for it and always returns SLAB_NO_SHARD,
+     * the free path then finds the cache through the page header.
+     */
+    inline uint8_t GetSlabShard(const AllocHeader* alloc) noexcept {
+#if MEM_SENTRY_COMPACT_HEADER
+        (void)alloc;
+        return constants::SLAB_NO_SHARD;
+#else
+        return alloc->m_SlabShard;
+#endif
+    }
+
+    /**
+     * @brief Returns true while the block is allocated (signature intact).
+     */
+    inline bool IsLive(const AllocHeader* alloc) noexcept {
+#if MEM_SENTRY_COMPACT_HEADER
+        return alloc->m_Kind == BlockKind::Malloc || alloc->m_Kind == BlockKind::Slab ||
+               alloc->m_Kind == BlockKind::Mapped;
+#else
+        return alloc->m_Signature == static_cast<uint32_t>(constants::MEMSYSTEM_SIGNATURE);
+#endif
+    }
+
+    /**
+     * @brief Stamps the block as freed so a second free trips the signature check.
+     */
+    inline void MarkFreed(AllocHeader* alloc) noexcept {
+#if MEM_SENTRY_COMPACT_HEADER
+        alloc->m_Kind = BlockKind::Freed;
+#else
+        alloc->m_Signature = constants::MEMSYSTEM_FREED_SIGNATURE;
+#endif
+    }
+};
@@ -0,0 +1,149 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "mem_sentry/constants.h"
+#include "mem_sentry/heap.h"
+
+namespace MEM_SENTRY::heap {
+
+    /**
+     * @struct ArenaChunk
+     * @brief Front of one ArenaHeap chunk, followed by the bytes objects are bumped from.
+     *
+     * A chunk is an ordinary tracked block of its arena, so the heap counters,
+     * ReportMemory(), the reporter and the scrubber see chunks, not objects.
+     */
+    struct ArenaChunk {
+        /** @brief Next chunk of the arena (older, or an oversized one). */
+        ArenaChunk* p_Next;
+
+        /** @brief Bytes objects can be bumped from, after this struct. */
+        size_t m_Capacity;
+
+        /** @brief Bytes handed out so far, advanced with a CAS by Allocate(). */
+        std::atomic<size_t> m_Used;
+
+        /** @brief First byte objects are bumped from. */
+        char* Data() noexcept {
+            return reinterpret_cast<char*>(this + 1);
+        }
+    };
+
+    /**
+     * @class ArenaHeap
+     * @brief Heap that bumps objects out of large chunks and frees them all at once.
+     *
+     * `new (arena) T` (and ISentry types routed to it) costs a compare-and-swap on
+     * the current chunk: no malloc, no list insert, no lock. Only one byte (the
+     * BlockKind) sits in front of every object, so delete recognizes arena objects
+     * and only runs the destructor; the memory comes back with Reset().
+     *
+     * Chunks are tracked blocks of the arena itself, so everything that works on a
+     * Heap (GetStats(), GetTotalHH() through AddHeap(), IReporter, Scrubber) sees the
+     * chunk-level totals. GetUsed() gives the bytes actually handed out.
+     *
+     * ```cpp
+     * ArenaHeap frame("Frame");
+     * FrameObject::setHeap(&frame);   // ISentry type
+     * ...
+     * frame.Reset();                  // end of frame: every object at once
+     * ```
+     *
+     * @warning Reset() does not run destructors: destroy objects that own resources
+     * first. No allocation may run concurrently with Reset() or Release().
+     * @warning Never delete an ArenaHeap through a Heap pointer.
+     */
+    class ArenaHeap : public Heap {
+    private:
+        /** @brief Chunk objects are bumped from, nullptr before the first allocation. */
+        std::atomic<ArenaChunk*> p_Current{nullptr};
+
+        /** @brief Every chunk of the arena, newest first. Guarded by m_GrowMutex. */
+        ArenaChunk* p_Chunks{nullptr};
+
+        /** @brief Taken to add a chunk, reset or read the chunk list. */
+        std::mutex m_GrowMutex;
+
+        /** @brief Capacity of a regular chunk. */
+        size_t m_ChunkSize;
+
+        /** @brief Chunks currently held. Guarded by m_GrowMutex. */
+        size_t m_ChunkCount{0};
+
+        /**
+         * @brief Bumps `size` bytes aligned to `alignment` from `chunk`.
+         * @return void* The object, or nullptr if the chunk is full.
+         */
+        static void* bump(ArenaChunk* chunk, size_t size, size_t alignment) noexcept;
+
+        /**
+         * @brief Allocates a chunk with room for `bytes` and links it in.
+         * @note Caller must hold m_GrowMutex.
+         * @return ArenaChunk* The chunk, or nullptr when out of memory.
+         */
+        ArenaChunk* newChunk(size_t bytes);
+
+        /**
+         * @brief Frees every chunk of the arena except `keep`.
+         * @note Caller must hold m_GrowMutex.
+         */
+        void freeChunks(ArenaChunk* keep);
+
+    public:
+        /**
+         * @brief Construct an empty ArenaHeap; the first chunk is allocated by the first object.
+         * @param name The display name for this memory category.
+         * @param chunkSize Capacity of one chunk; objects bigger than a quarter of it get their own.
+         * @param mode How the chunks are tracked between threads (see TrackingMode).
+         */
+        explicit ArenaHeap(const char* name, size_t chunkSize = constants::ARENA_CHUNK_SIZE,
+            TrackingMode mode = TrackingMode::Shared);
+
+        /**
+         * @brief Releases every chunk.
+         */
+        ~ArenaHeap();
+
+        /**
+         * @brief Bumps a new object out of the current chunk, adding a chunk if it is full.
+         *
+         * Safe to call from several threads at once.
+         *
+         * @param size Bytes requested.
+         * @param alignment Alignment (power of 2), 0 for the alignment of plain `new`.
+         * @return void* The object, or nullptr when out of memory.
+         */
+        void* Allocate(size_t size, size_t alignment = 0);
+
+        /**
+         * @brief Frees every object at once.
+         *
+         * Every chunk but the current one is freed, the current one is rewound, so an
+         * arena reset every frame settles on one chunk and stops calling malloc.
+         */
+        void Reset();
+
+        /**
+         * @brief Frees every object and every chunk.
+         */
+        void Release();
+
+        /**
+         * @brief Returns the bytes handed out to objects (padding included) since the last reset.
+         */
+        size_t GetUsed();
+
+        /**
+         * @brief Returns the bytes held in chunks.
+         */
+        size_t GetCapacity();
+
+        /**
+         * @brief Returns the number of chunks held.
+         */
+        size_t GetChunkCount();
+    };
+}
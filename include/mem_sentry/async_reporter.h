@@ -0,0 +1,181 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mem_sentry/alloc_header.h"
+#include "mem_sentry/constants.h"
+#include "mem_sentry/reporter.h"
+#include "mem_pools/pool.h"
+
+namespace MEM_SENTRY::reporter {
+
+    /**
+     * @enum EventType
+     * @brief Which IReporter callback an AsyncReporter event is replayed into.
+     */
+    enum class EventType : uint8_t {
+        Alloc,
+        Dealloc
+    };
+
+    /**
+     * @struct ReportEvent
+     * @brief POD copy of an allocation event, queued by AsyncReporter.
+     *
+     * The header is a HeaderCopy, so GetOriginalAddress() and GetAddress() still
+     * resolve the block's addresses from the copy.
+     */
+    struct ReportEvent {
+        /** @brief Copy of the block header and its addresses at the time of the event. */
+        alloc_header::HeaderCopy m_Copy;
+
+        /** @brief Callback to replay. */
+        EventType m_Type;
+    };
+
+    /**
+     * @class AsyncReporter
+     * @brief Decorator that moves the work of any IReporter off the allocating threads.
+     *
+     * `onAlloc()`/`onDealloc()` copy the header into a pre-allocated event and hand it
+     * over through a lock-free SPSC ring of the calling thread's slot (see thread_slot).
+     * A background thread drains every slot in batches and replays the events into
+     * the wrapped reporter. The allocating thread never does I/O, never allocates
+     * and never blocks.
+     *
+     * Each slot owns two RingPools over the same buffers:
+     * - `m_Free`:   full-mode ring of empty events (producer: drain thread, consumer: allocating thread).
+     * - `m_Filled`: empty-mode ring of written events (producer: allocating thread, consumer: drain thread).
+     *
+     * Events are dropped (and counted, see GetDropped()) instead of blocking when a
+     * slot's ring is full or when two threads that share a slot report at the same time.
+     *
+     * `report()` is forwarded synchronously, since Heap::ReportMemory() already
+     * calls it outside of any heap lock. So is `onCorruption()`, which is rare and
+     * must reach the target before the corrupted block is released.
+     *
+     * @note The wrapped reporter receives copies. Heaps must outlive the events they
+     * produced: call Flush() before destroying a heap that reports through this object.
+     * @note Allocations made by the wrapped reporter on the drain thread are not reported.
+     *
+     * Example:
+     * ```cpp
+     * ConsoleReporter console;
+     * AsyncReporter async(&console);
+     * heap->SetReporter(&async);
+     * ```
+     */
+    class AsyncReporter : public IReporter {
+    private:
+        /** @brief Per-slot pair of rings, see the class description. */
+        struct alignas(constants::CACHE_LINE_SIZE) Slot {
+            /** @brief set while a producer thread is writing into this slot. */
+            std::atomic<bool> m_Busy{false};
+
+            /** @brief empty events, owned by this ring. */
+            mem_pool::RingPool<ReportEvent, alignof(ReportEvent), false> m_Free;
+
+            /** @brief written events waiting for the drain thread. */
+            mem_pool::RingPool<ReportEvent, alignof(ReportEvent), false> m_Filled;
+
+            explicit Slot(size_t capacity) : m_Free(false, capacity), m_Filled(true, capacity) {}
+        };
+
+        /** @brief Reporter the events are replayed into. */
+        IReporter* p_Target;
+
+        /** @brief Serializes calls into p_Target (drain thread vs report()). */
+        std::mutex m_TargetMutex;
+
+        /** @brief One slot per thread slot. */
+        std::vector<std::unique_ptr<Slot>> m_Slots;
+
+        /** @brief How long the drain thread sleeps when it found nothing to do. */
+        std::chrono::microseconds m_Interval;
+
+        /** @brief Asks the drain thread to exit. */
+        std::atomic<bool> m_Stop{false};
+
+        /** @brief Incremented by Flush(); the drain thread acknowledges through m_FlushDone. */
+        std::atomic<uint64_t> m_FlushRequest{0};
+
+        /** @brief Last flush request fully drained. */
+        std::atomic<uint64_t> m_FlushDone{0};
+
+        /** @brief Events replayed into the wrapped reporter. */
+        std::atomic<uint64_t> m_Delivered{0};
+
+        /** @brief Events dropped because a ring was full or a slot was busy. */
+        std::atomic<uint64_t> m_Dropped{0};
+
+        /** @brief Background drain thread. */
+        std::thread m_Worker;
+
+        /**
+         * @brief Copies an event into the calling thread's slot.
+         */
+        void enqueue(EventType type, alloc_header::AllocHeader* alloc) noexcept;
+
+        /**
+         * @brief Replays every queued event of every slot once.
+         * @note Must only run on one thread at a time (the single consumer).
+         * @return size_t Number of events replayed.
+         */
+        size_t drain();
+
+        /**
+         * @brief Body of the drain thread.
+         */
+        void run();
+
+    public:
+        /**
+         * @brief Construct an AsyncReporter and start its drain thread.
+         *
+         * @param target The reporter events are replayed into (not owned).
+         * @param ringCapacity Events buffered per thread slot (rounded up to a power of two).
+         * @param interval Sleep of the drain thread when all rings are empty.
+         */
+        explicit AsyncReporter(IReporter* target, size_t ringCapacity = 256,
+            std::chrono::microseconds interval = std::chrono::microseconds(1000));
+
+        /**
+         * @brief Stops the drain thread after replaying the remaining events.
+         * @warning Detach it from every heap first.
+         */
+        ~AsyncReporter();
+
+        AsyncReporter(const AsyncReporter&) = delete;
+        AsyncReporter& operator=(const AsyncReporter&) = delete;
+
+        virtual void onAlloc(alloc_header::AllocHeader* alloc) override;
+        virtual void onDealloc(alloc_header::AllocHeader* alloc) override;
+        virtual void report(alloc_header::AllocHeader* alloc) override;
+        virtual void onCorruption(alloc_header::AllocHeader* alloc, canary::Corruption corruption) override;
+
+        /**
+         * @brief Blocks until every event queued before the call has been replayed.
+         */
+        void Flush();
+
+        /**
+         * @brief Number of events replayed into the wrapped reporter so far.
+         */
+        uint64_t GetDelivered() const noexcept {
+            return m_Delivered.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Number of events dropped so far (full ring or busy slot).
+         */
+        uint64_t GetDropped() const noexcept {
+            return m_Dropped.load(std::memory_order_relaxed);
+        }
+    };
+}
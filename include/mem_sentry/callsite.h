@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "mem_sentry/constants.h"
+
+namespace MEM_SENTRY::callsite {
+
+    /**
+     * @struct CallSite
+     * @brief Copy of one entry of the call-site table, see Capture() and TopSites().
+     *
+     * A call site is a distinct stack of return addresses. The counters cover
+     * every tracked block captured with it, over all heaps.
+     */
+    struct CallSite {
+        /** @brief Stack id stored in the headers of its blocks (never CALLSITE_NO_STACK). */
+        uint32_t m_Id;
+
+        /** @brief Number of return addresses in `p_Frames`. */
+        uint32_t m_Depth;
+
+        /** @brief Return addresses, innermost first. */
+        void* p_Frames[constants::CALLSITE_MAX_DEPTH];
+
+        /** @brief Bytes of user data of its blocks still allocated. */
+        int64_t m_LiveBytes;
+
+        /** @brief Number of its blocks still allocated. */
+        int64_t m_LiveCount;
+
+        /** @brief Blocks allocated from it since the start. */
+        uint64_t m_TotalAllocs;
+
+        /** @brief Bytes allocated from it since the start. */
+        uint64_t m_TotalBytes;
+    };
+
+    /**
+     * @brief Captures the calling stack and returns its id in the call-site table.
+     *
+     * Walks the frame-pointer chain (`[saved frame pointer][return address]`) of the
+     * calling thread, checking every frame against the thread's stack bounds, so it
+     * never reads outside the stack. The addresses are hashed and looked up in a
+     * lock-free, open-addressed table: a stack seen before costs the walk, a hash
+     * and one load; a new one claims a slot with a compare-and-swap. The table lives
+     * in malloc'd memory and never allocates on a tracked heap.
+     *
+     * @param depth Most frames to record, up to CALLSITE_MAX_DEPTH.
+     * @param skip Innermost frames to leave out (the allocator's own).
+     * @return uint32_t The stack id, CALLSITE_NO_STACK if nothing could be walked
+     * or the table is full (see GetDropped()).
+     * @note Code built without frame pointers breaks the chain early; build with
+     * MEM_SENTRY_FRAME_POINTERS (-fno-omit-frame-pointer) for complete stacks.
+     */
+    uint32_t Capture(size_t depth, size_t skip = 0) noexcept;
+
+    /**
+     * @brief Adds `bytes` and `count` to the live totals of a call site.
+     * A positive `count` is also added to the lifetime totals.
+     * @note Used by the allocation path, not meant to be called directly.
+     */
+    void Account(uint32_t id, int64_t bytes, int64_t count) noexcept;
+
+    /**
+     * @brief Copies one call site.
+     * @return false if `id` is not in the table.
+     */
+    bool GetSite(uint32_t id, CallSite& site) noexcept;
+
+    /**
+     * @brief Copies the call sites holding the most live bytes, largest first.
+     * @param sites Receives up to `max` call sites.
+     * @param max Capacity of `sites`.
+     * @return size_t Call sites written.
+     */
+    size_t TopSites(CallSite* sites, size_t max) noexcept;
+
+    /**
+     * @brief Returns the number of distinct call sites in the table.
+     */
+    size_t GetSiteCount() noexcept;
+
+    /**
+     * @brief Returns how many captures found the table full and returned CALLSITE_NO_STACK.
+     */
+    uint64_t GetDropped() noexcept;
+
+    /**
+     * @brief Writes the symbolized frames of a call site, one per line, to a file descriptor.
+     * Uses backtrace_symbols_fd(), which does not allocate.
+     */
+    void Print(uint32_t id, int fd = 1) noexcept;
+}
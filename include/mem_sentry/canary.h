@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "mem_sentry/constants.h"
+
+namespace MEM_SENTRY::canary {
+    /**
+     * @enum Corruption
+     * @brief What a canary check found behind a block's user data.
+     */
+    enum class Corruption : uint8_t {
+        /** @brief End marker and redzone are intact. */
+        None,
+        /** @brief The 4-byte end marker right after the user data was overwritten. */
+        EndMarker,
+        /** @brief The end marker is intact but the redzone behind it was written. */
+        Redzone
+    };
+
+    /**
+     * @brief Fills `bytes` bytes at `dst` with REDZONE_PATTERN, 16 bytes per store.
+     */
+    inline void FillRedzone(void* dst, size_t bytes) noexcept {
+        unsigned char* p = static_cast<unsigned char*>(dst);
+
+#if defined(__SSE2__)
+        const __m128i pattern = _mm_set1_epi8(static_cast<char>(constants::REDZONE_PATTERN));
+        for (; bytes >= 16; p += 16, bytes -= 16) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p), pattern);
+        }
+#elif defined(__ARM_NEON)
+        const uint8x16_t pattern = vdupq_n_u8(constants::REDZONE_PATTERN);
+        for (; bytes >= 16; p += 16, bytes -= 16) {
+            vst1q_u8(p, pattern);
+        }
+#endif
+
+        std::memset(p, constants::REDZONE_PATTERN, bytes);
+    }
+
+    /**
+     * @brief Returns true if every one of the `bytes` bytes at `src` still holds REDZONE_PATTERN.
+     */
+    inline bool RedzoneIntact(const void* src, size_t bytes) noexcept {
+        const unsigned char* p = static_cast<const unsigned char*>(src);
+
+#if defined(__SSE2__)
+        const __m128i pattern = _mm_set1_epi8(static_cast<char>(constants::REDZONE_PATTERN));
+        for (; bytes >= 16; p += 16, bytes -= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern)) != 0xFFFF)
+                return false;
+        }
+#elif defined(__ARM_NEON)
+        const uint8x16_t pattern = vdupq_n_u8(constants::REDZONE_PATTERN);
+        for (; bytes >= 16; p += 16, bytes -= 16) {
+            if (vminvq_u8(vceqq_u8(vld1q_u8(p), pattern)) != 0xFF)
+                return false;
+        }
+#endif
+
+        for (; bytes; ++p, --bytes) {
+            if (*p != constants::REDZONE_PATTERN)
+                return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Writes the end marker and the redzone behind `size` bytes of user data.
+     */
+    inline void Arm(void* pMem, size_t size) noexcept {
+        char* pEnd = static_cast<char*>(pMem) + size;
+        int marker = constants::MEMSYSTEM_ENDMARKER;
+
+        // the marker is not aligned when the size isn't a multiple of 4.
+        std::memcpy(pEnd, &marker, sizeof(int));
+
+        if constexpr (constants::REDZONE_BYTES > 0) {
+            FillRedzone(pEnd + sizeof(int), constants::REDZONE_BYTES);
+        }
+    }
+
+    /**
+     * @brief Checks the end marker and the redzone behind `size` bytes of user data.
+     */
+    inline Corruption Inspect(const void* pMem, size_t size) noexcept {
+        const char* pEnd = static_cast<const char*>(pMem) + size;
+        int marker;
+        std::memcpy(&marker, pEnd, sizeof(int));
+
+        if (marker != constants::MEMSYSTEM_ENDMARKER)
+            return Corruption::EndMarker;
+
+        if constexpr (constants::REDZONE_BYTES > 0) {
+            if (!RedzoneIntact(pEnd + sizeof(int), constants::REDZONE_BYTES))
+                return Corruption::Redzone;
+        }
+
+        return Corruption::None;
+    }
+
+    /**
+     * @brief Display name of a corruption kind.
+     */
+    constexpr const char* CorruptionName(Corruption corruption) noexcept {
+        switch (corruption) {
+            case Corruption::None:      return "None";
+            case Corruption::EndMarker: return "EndMarker";
+            case Corruption::Redzone:   return "Redzone";
+            default:                    return "?";
+        }
+    }
+}
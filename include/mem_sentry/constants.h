@@ -1,4 +1,7 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
 
 namespace MEM_SENTRY::constants {
     /// @brief signature value for valid active memory
@@ -25,6 +28,136 @@ namespace MEM_SENTRY::constants {
         #endif
     #endif
 
+    /// @brief check if user defined MEM_SENTRY_COMPACT_HEADER already.
+    /// When 1, every allocation carries the 16-byte AllocHeader layout instead of the 48-byte one.
+    #ifndef MEM_SENTRY_COMPACT_HEADER
+        #define MEM_SENTRY_COMPACT_HEADER 0
+    #endif
+
+    /// @brief check if user defined MEM_SENTRY_STATS already.
+    /// When 1, hot-path events (lock contention, new_handler retries, pool full/empty,
+    /// chain growth) are counted per thread, see mem_sentry/stats.h. When 0 they compile out.
+    #ifndef MEM_SENTRY_STATS
+        #define MEM_SENTRY_STATS 0
+    #endif
+
+    /// @brief check if user defined MEM_SENTRY_REDZONE already.
+    /// Bytes of guard pattern written after the end marker of every block, 0 for none.
+    /// Changes the block layout, so it must be the same for every translation unit.
+    #ifndef MEM_SENTRY_REDZONE
+        #define MEM_SENTRY_REDZONE 0
+    #endif
+
     constexpr size_t CACHE_LINE_SIZE = std::hardware_destructive_interference_size;
+
+    /// @brief number of per-thread shards kept by every heap in thread-local tracking mode.
+    /// Threads beyond this count share shards round-robin.
+    constexpr size_t THREAD_SLOTS = 64;
+
+    /// @brief maximum number of heaps alive at the same time.
+    /// Heaps are registered by index so the compact header can refer to them with 16 bits.
+    constexpr size_t MAX_HEAPS = 4096;
+
+    /// @brief log2 of the number of consecutive allocation IDs covered by one ID index bucket.
+    /// Range queries scan at most this many blocks past the first bucket they land in.
+    constexpr uint32_t ID_BUCKET_SHIFT = 10;
+
+    /*------------- SLAB BACKEND CONFIG -----------------*/
+
+    /// @brief size (and alignment) of one slab page carved into fixed-size chunks.
+    constexpr size_t SLAB_PAGE_SIZE = 64 * 1024;
+
+    /// @brief step between two neighbour size classes. Keeps every chunk 16-byte aligned.
+    constexpr size_t SLAB_CLASS_GRANULARITY = 16;
+
+    /// @brief largest chunk (header + data + end marker) served by the slab backend.
+    /// Bigger requests fall back to malloc.
+    constexpr size_t SLAB_MAX_CHUNK = 512;
+
+    /// @brief number of size classes per slab cache.
+    constexpr size_t SLAB_CLASSES = SLAB_MAX_CHUNK / SLAB_CLASS_GRANULARITY;
+
+    /// @brief slab shard stored in headers that don't know which cache carved their block.
+    constexpr uint8_t SLAB_NO_SHARD = 0xFF;
+
+    /*------------- CANARY CONFIG -----------------*/
+
+    /// @brief bytes of guard pattern after every end marker (see MEM_SENTRY_REDZONE).
+    constexpr size_t REDZONE_BYTES = MEM_SENTRY_REDZONE;
+
+    /// @brief byte value the redzone is filled with.
+    constexpr uint8_t REDZONE_PATTERN = 0xFD;
+
+    /// @brief live blocks the scrubber checks per shard lock before letting allocators in again.
+    constexpr size_t SCRUB_BATCH = 256;
+
+    /// @brief corrupted blocks one scrub slice copies out for reporting; the slice stops early after that.
+    constexpr size_t SCRUB_REPORT_BATCH = 16;
+
+    /*------------- ARENA CONFIG -----------------*/
+
+    /// @brief default bytes of one ArenaHeap chunk.
+    constexpr size_t ARENA_CHUNK_SIZE = 64 * 1024;
+
+    /// @brief alignment of every arena object, the alignment plain `new` guarantees.
+    constexpr size_t ARENA_MIN_ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    /*------------- CALLSITE CONFIG -----------------*/
+
+    /// @brief stack id of blocks whose call site was not captured.
+    constexpr uint32_t CALLSITE_NO_STACK = 0;
+
+    /// @brief distinct call stacks the callsite table holds (power of 2); later ones are dropped.
+    constexpr size_t CALLSITE_TABLE_SIZE = 16 * 1024;
+
+    /// @brief most return addresses captured per call stack.
+    constexpr size_t CALLSITE_MAX_DEPTH = 16;
+
+    /// @brief slots probed for a call stack before it counts as dropped.
+    constexpr size_t CALLSITE_MAX_PROBES = 64;
+
+    /*------------- RECYCLING CONFIG -----------------*/
+
+    /// @brief blocks one thread keeps per object size in a sentry::RecyclingPolicy cache.
+    constexpr size_t RECYCLE_CAPACITY = 64;
+
+    /*------------- POOL WAIT CONFIG -----------------*/
+
+    /// @brief retries with a pause instruction before a pop_wait()/push_wait() caller yields its core.
+    constexpr uint32_t POOL_WAIT_SPINS = 256;
+
+    /// @brief retries with std::this_thread::yield() before the caller parks on a futex.
+    constexpr uint32_t POOL_WAIT_YIELDS = 16;
+
+    /// @brief longest park until the other side has acknowledged that waits are on (see mem_pool::ParkingSpot).
+    constexpr uint64_t POOL_WAIT_UNACKED_NS = 100 * 1000;
+
+    /*------------- IO CHAIN CONFIG -----------------*/
+
+    /// @brief default pooled buffers one mem_pool::IoChain can hold (a power of 2, well under IOV_MAX).
+    constexpr size_t IO_CHAIN_MAX_SEGMENTS = 64;
+
+    /*------------- TELEMETRY CONFIG -----------------*/
+
+    /// @brief heap records of a telemetry::TelemetryExporter region; heaps with a higher registry index are left out.
+    constexpr uint32_t TELEMETRY_HEAP_SLOTS = 256;
+
+    /// @brief pool records of a telemetry::TelemetryExporter region.
+    constexpr uint32_t TELEMETRY_POOL_SLOTS = 64;
+
+    /*------------- MAPPED CONFIG -----------------*/
+
+    /// @brief size of the explicit huge pages the mapped backend asks for (MAP_HUGETLB default size on x86-64).
+    constexpr size_t MAPPED_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    /*------------- NUMA CONFIG -----------------*/
+
+    /// @brief highest number of NUMA nodes MemSentry places memory on (one bit per node in a mask).
+    constexpr size_t MAX_NUMA_NODES = 64;
+
+    /// @brief smallest block a node-bound heap gives a mapping of its own (mapped backend).
+    /// Only memory MemSentry maps itself is bound: malloc'd memory may share pages and
+    /// mappings with unrelated allocations whatever its size, so it is never bound.
+    constexpr size_t NUMA_BIND_MIN_BYTES = 128 * 1024;
 };
 
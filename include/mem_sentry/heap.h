@@ -3,15 +3,213 @@
 #include <cstring>
 #include <atomic>
 #include <mutex>
-#include <vector>
-#include <functional>
-#include <unordered_set>
 
 #include "mem_sentry/alloc_header.h"
+#include "mem_sentry/canary.h"
+#include "mem_sentry/constants.h"
+#include "mem_sentry/mapped.h"
+#include "mem_sentry/numa.h"
 #include "mem_sentry/reporter.h"
+#include "mem_sentry/slab.h"
+#include "mem_sentry/snapshot.h"
+#include "mem_sentry/stats.h"
+#include "mem_sentry/thread_slot.h"
 
 namespace MEM_SENTRY::heap {       
+
+    /**
+     * @enum TrackingMode
+     * @brief Selects how a heap distributes its allocation list between threads.
+     *
+     * - `Shared`: every thread links into one list guarded by one mutex (default).
+     * - `ThreadLocal`: every thread links into its own shard, so concurrent
+     *   allocations don't touch the same lock or cache line. Shards are merged
+     *   only when the heap is queried (CountAllocations, ReportMemory, GetTotal).
+     *
+     * Either way the list is guarded by shard mutexes: in `ThreadLocal` mode the
+     * owning thread still locks its shard, uncontended unless another thread frees
+     * into it, shares its slot, or queries the heap. Every heap embeds all
+     * `THREAD_SLOTS` shards regardless of the mode.
+     *
+     * @note The mode can be switched at any time. Every allocation remembers the
+     * shard it was linked into, so blocks are always unlinked from the right list.
+     */
+    enum class TrackingMode : uint8_t {
+        Shared,
+        ThreadLocal
+    };
+
+    static_assert(constants::THREAD_SLOTS <= 64, "AllocHeader stores the shard index in 6 bits");
+
+    /**
+     * @struct IdBucket
+     * @brief Index entry covering `2^ID_BUCKET_SHIFT` consecutive allocation IDs of one shard.
+     *
+     * A shard's list is sorted by ID (IDs are handed out under the shard lock), so every
+     * bucket is a contiguous run of the list; p_First is the first live block of that run.
+     */
+    struct IdBucket {
+        /** @brief Bucket number, `m_AllocId >> ID_BUCKET_SHIFT`. */
+        uint32_t m_Bucket;
+
+        /** @brief Live blocks in this bucket; 0 marks a dead entry awaiting compaction. */
+        uint32_t m_Live;
+
+        /** @brief First live block of the bucket in the shard list. */
+        alloc_header::AllocHeader* p_First;
+    };
+
+    /**
+     * @struct HeapShard
+     * @brief One slice of a heap's allocation list.
+     *
+     * Each shard owns a doubly-linked list of allocations (a block table in
+     * compact header mode) and its own byte total.
+     * Shards are cache-line aligned so two threads working on neighbour shards
+     * do not false-share.
+     */
+    struct alignas(constants::CACHE_LINE_SIZE) HeapShard {
+        /** @brief guards the list of this shard only. */
+        std::mutex m_Mutex;
+
+#if !MEM_SENTRY_COMPACT_HEADER
+        /** @brief Pointer to the first allocation in this shard. */
+        alloc_header::AllocHeader* p_Head{nullptr};
+
+        /** @brief Pointer to the last allocation in this shard. */
+        alloc_header::AllocHeader* p_Tail{nullptr};
+
+        /**
+         * @brief ID index of the list, sorted by m_Bucket; grown with realloc.
+         * Lets ReportMemory() jump to the first block of a range in O(log n).
+         */
+        IdBucket* p_Buckets{nullptr};
+
+        /** @brief Number of entries (live and dead) in p_Buckets. */
+        uint32_t m_BucketCount{0};
+
+        /** @brief Number of entries p_Buckets has room for. */
+        uint32_t m_BucketCapacity{0};
+
+        /** @brief Number of dead entries in p_Buckets. */
+        uint32_t m_DeadBuckets{0};
+
+        /** @brief Cleared if the index could not grow; queries then walk the list. */
+        bool m_Indexed{true};
+#else
+        /**
+         * @brief Table of the allocations in this shard (compact headers have no links).
+         * Every header stores its position in `m_Slot`; grown with realloc.
+         */
+        alloc_header::AllocHeader** p_Blocks{nullptr};
+
+        /** @brief Number of live entries in p_Blocks. */
+        uint32_t m_Count{0};
+
+        /** @brief Number of entries p_Blocks has room for. */
+        uint32_t m_Capacity{0};
+#endif
+
+        /**
+         * @brief Bytes currently allocated through this shard.
+         * Written under m_Mutex, read without it by Heap::GetTotal().
+         * @note Blocks freed from another shard's thread are subtracted from the shard
+         * that tracked them, so every counter stays non-negative.
+         */
+        std::atomic<int64_t> m_LiveBytes{0};
+
+        /** @brief Blocks currently tracked by this shard, read by Heap::CountAllocations(). */
+        std::atomic<int64_t> m_LiveCount{0};
+
+        /** @brief Blocks ever added to this shard. */
+        std::atomic<uint64_t> m_TotalAllocs{0};
+
+        /** @brief Blocks ever removed from this shard. */
+        std::atomic<uint64_t> m_TotalFrees{0};
+
+        /**
+         * @brief Size-class cache for small blocks, created on first use.
+         * @note Only used when the heap has the slab backend enabled.
+         */
+        slab::SlabCache* p_Slab{nullptr};
+
+        /**
+         * @brief Bytes left until the next sampled allocation of the threads mapped to
+         * this slot (indexed by thread slot in every tracking mode).
+         * @note Only used when the heap has a sampling interval.
+         */
+        std::atomic<int64_t> m_SampleCountdown{0};
+
+        /**
+         * @brief Bytes of the blocks parked in recycling caches by the threads mapped
+         * to this slot (indexed by thread slot in every tracking mode).
+         * @note Can go negative when a block is parked by one thread and reused by another;
+         * only the sum over every slot is meaningful, see Heap::GetStats().
+         */
+        std::atomic<int64_t> m_CachedBytes{0};
+
+        /** @brief Blocks parked in recycling caches, indexed like m_CachedBytes. */
+        std::atomic<int64_t> m_CachedCount{0};
+
+        /**
+         * @brief Bytes mapped for mapped blocks by the threads mapped to this slot
+         * (indexed by thread slot in every tracking mode); like m_CachedBytes, only the
+         * sum over every slot is meaningful.
+         */
+        std::atomic<int64_t> m_MappedBytes{0};
+
+        /** @brief Mapped blocks, indexed like m_MappedBytes. */
+        std::atomic<int64_t> m_MappedCount{0};
+    };
     
+    /**
+     * @struct HeapStats
+     * @brief Point-in-time counters of a heap, see Heap::GetStats().
+     */
+    struct HeapStats {
+        /** @brief Bytes currently allocated (user data + alignment padding). */
+        int64_t m_LiveBytes;
+
+        /** @brief Blocks currently allocated. */
+        int64_t m_LiveCount;
+
+        /** @brief Blocks allocated since the heap was created. */
+        uint64_t m_TotalAllocs;
+
+        /** @brief Blocks freed since the heap was created. */
+        uint64_t m_TotalFrees;
+
+        /** @brief Bytes of the blocks parked in recycling caches (see sentry::RecyclingPolicy), not in m_LiveBytes. */
+        int64_t m_CachedBytes;
+
+        /** @brief Blocks parked in recycling caches, not included in m_LiveCount. */
+        int64_t m_CachedCount;
+
+        /**
+         * @brief Bytes of the mappings of mapped blocks (see Heap::SetMappedThreshold()),
+         * page granular and including their header pages; unsampled blocks count too.
+         */
+        int64_t m_MappedBytes;
+
+        /** @brief Mapped blocks currently allocated, sampled or not. */
+        int64_t m_MappedCount;
+    };
+
+    /**
+     * @struct ScrubCursor
+     * @brief Position of an incremental scrub of one heap, see Heap::Scrub().
+     */
+    struct ScrubCursor {
+        /** @brief Shard scrubbed next. */
+        size_t m_Shard{0};
+
+        /** @brief First allocation ID (block table position in compact mode) left to check in m_Shard. */
+        uint32_t m_Next{0};
+
+        /** @brief Full passes over every shard completed so far. */
+        uint64_t m_Passes{0};
+    };
+
     /**
      * @class Heap
      * @brief Manages a specific memory arena (category).
@@ -20,23 +218,55 @@ namespace MEM_SENTRY::heap {
      * a doubly-linked list of all active allocations belonging to this category.
      * It allows for detailed reporting and leak detection.
      * 
+     * The list is split into shards (see TrackingMode). In `Shared` mode only
+     * the first shard is used; in `ThreadLocal` mode each thread uses its own.
      */
     class Heap {
     private:
         /** @brief Name of the heap (e.g., "Physics", "AI"). */
         char m_name[100];
-
-        /** @brief Total bytes currently allocated in this heap. */
-        int m_total;
         
+        /** @brief Index of this heap in the heap registry, see HeapFactory::GetHeapByIndex(). */
+        uint16_t m_Index;
+
+        /** @brief Registration number of this heap, unique across heaps that reuse an index. */
+        uint32_t m_Generation;
+
         /** @brief Counter to generate unique IDs for allocations. */
         std::atomic<int> m_NextAllocId;
 
-        /** @brief Pointer to the first allocation in the tracking list. */
-        alloc_header::AllocHeader* p_HeadList;
+        /** @brief Current tracking mode, read on every allocation. */
+        std::atomic<TrackingMode> m_Mode;
+
+        /**
+         * @brief Number of shards that have ever been used.
+         * Merging queries only visit shards [0, m_ShardCount).
+         */
+        std::atomic<size_t> m_ShardCount;
+
+        /** @brief Allocation list shards, see TrackingMode. */
+        HeapShard m_Shards[constants::THREAD_SLOTS];
+
+        /** @brief Whether small blocks are served from slab pages instead of malloc. */
+        std::atomic<bool> m_UseSlab;
+
+        /** @brief Mean bytes between two sampled allocations, 0 to track every allocation. */
+        std::atomic<size_t> m_SampleInterval;
+
+        /** @brief NUMA node the heap places its memory on, numa::NO_NODE for none. */
+        std::atomic<int> m_NumaNode;
+
+        /** @brief Whether the free path checks the end marker and redzone of every block. */
+        std::atomic<bool> m_CheckOnFree;
+
+        /** @brief Frames captured per allocation for call-site attribution, 0 when off. */
+        std::atomic<uint8_t> m_CallSiteDepth;
 
-        /** @brief Pointer to the last allocation in the tracking list. */
-        alloc_header::AllocHeader* p_TailList;
+        /** @brief Raw block size from which blocks get a mapping of their own, 0 when off. */
+        std::atomic<size_t> m_MappedThreshold;
+
+        /** @brief Page size asked for by mapped blocks. */
+        std::atomic<mapped::HugePages> m_HugePages;
 
         /**
          * @brief Pointer to the reporter interface for logging memory events.
@@ -45,18 +275,41 @@ namespace MEM_SENTRY::heap {
         reporter::IReporter* p_Reporter;
 
         /**
-         * @brief Adjacency list storing pointers to connected neighbor heaps.
-         * @note Used for graph traversal operations like GetTotalHH().
+         * @brief Adjacency array storing pointers to connected neighbor heaps; grown with realloc.
+         * @note Used for graph traversal operations like GetTotalHH(). Guarded by m_graphMutex.
          */
-        std::vector<Heap*> m_AdjHeaps;
+        Heap** p_AdjHeaps{nullptr};
+
+        /** @brief Number of neighbors in p_AdjHeaps. */
+        uint32_t m_AdjCount{0};
+
+        /** @brief Number of entries p_AdjHeaps has room for. */
+        uint32_t m_AdjCapacity{0};
 
         /**
-         * @brief linked list mutex.
-         * 
-         * used to make sure the heap list is thread safe.
+         * @brief Cached set of heaps reachable from this one (itself first); grown with realloc.
+         * Rebuilt by the first hierarchy query after it is invalidated. Guarded by m_graphMutex.
          */
-        std::mutex m_llMutex;
-        
+        Heap** p_Reach{nullptr};
+
+        /** @brief Number of heaps in p_Reach. */
+        uint32_t m_ReachCount{0};
+
+        /** @brief Number of entries p_Reach has room for. */
+        uint32_t m_ReachCapacity{0};
+
+        /** @brief Whether p_Reach matches the current topology. */
+        bool m_ReachValid{false};
+
+        /** @brief Traversal generation that last visited this heap, see m_VisitGeneration. */
+        uint64_t m_VisitMark{0};
+
+        /**
+         * @brief Generation of the running traversal. A heap is visited when its
+         * m_VisitMark equals it, so marks never need to be cleared.
+         */
+        static uint64_t m_VisitGeneration;
+
         /**
          * @brief GLOBAL lock for the Heap Hierarchy.
          * Locks ALL heaps to prevent neighbor race conditions.
@@ -64,46 +317,388 @@ namespace MEM_SENTRY::heap {
         static std::mutex m_graphMutex;
 
         /**
-         * @brief Internal helper to append a node to the linked list.
+         * @brief Internal helper to append a node to a shard's linked list.
+         * @note Caller must hold `shard.m_Mutex`.
+         * @param shard The shard owning the list.
          * @param alloc Pointer to the new header to add.
          * @return true if successful, false otherwise.
          */ 
-        bool addAllocLL(alloc_header::AllocHeader* alloc);
+        bool addAllocLL(HeapShard& shard, alloc_header::AllocHeader* alloc);
 
         /**
-         * @brief Internal helper to unlink a node from the linked list.
+         * @brief Internal helper to unlink a node from a shard's linked list.
          * @note This does NOT free the memory, it only removes it from tracking, removal happens in overridden delete.
+         * @note Caller must hold `shard.m_Mutex`.
+         * @param shard The shard owning the list.
          * @param alloc Pointer to the header to remove.
          * @return true if found and removed, false otherwise.
          */
-        bool removeAllocLL(alloc_header::AllocHeader* alloc);
+        bool removeAllocLL(HeapShard& shard, alloc_header::AllocHeader* alloc);
 
+#if !MEM_SENTRY_COMPACT_HEADER
         /**
-         * @brief Helper function to perform Depth First Search (DFS) on the heap graph.
-         * Traverses connected heaps recursively, maintaining a visited set to handle 
-         * cycles in the graph (which occur naturally due to bidirectional connections).
-         * 
-         * @param heap The current heap node being visited.
-         * @param visited Set of already visited heaps to prevent infinite loops.
-         * @param val Reference to the accumulator value (size or count).
-         * @param func The operation to perform on each visited heap (e.g., add size to val).
+         * @brief Records a block just appended to the shard list in the ID index.
+         * @note Caller must hold `shard.m_Mutex`.
+         */
+        void indexAdd(HeapShard& shard, alloc_header::AllocHeader* alloc);
+
+        /**
+         * @brief Drops a block from the ID index, before it is unlinked from the list.
+         * @note Caller must hold `shard.m_Mutex`.
+         */
+        void indexRemove(HeapShard& shard, alloc_header::AllocHeader* alloc);
+
+        /**
+         * @brief Returns the first block of the shard whose ID is >= `id`.
+         * @note Caller must hold `shard.m_Mutex`.
+         */
+        alloc_header::AllocHeader* indexFind(HeapShard& shard, uint32_t id);
+#endif
+
+        /**
+         * @brief Takes a free slot in the heap registry and stores it in m_Index,
+         * along with a new m_Generation.
+         * @note In compact header mode running out of slots is fatal, since the
+         * header has no other way to refer to its heap.
          */
-        void dfs(Heap* heap, std::unordered_set<Heap*>& visited, size_t& val,
-                 const std::function<void(Heap*, size_t&)>& func);
+        void registerHeap();
+
+        /**
+         * @brief Counts `bytes` against the calling thread's sampling countdown.
+         * @return true if this allocation is the sampled one.
+         */
+        bool sampleTick(size_t bytes, size_t interval) noexcept;
+
+        /**
+         * @brief Picks the shard the calling thread links new allocations into.
+         * @return size_t Index into m_Shards.
+         */
+        size_t currentShard() noexcept;
+
+        /**
+         * @brief Returns the heaps reachable from this one, rebuilding the cache if needed.
+         *
+         * Breadth-first traversal that uses p_Reach itself as the queue and a fresh
+         * m_VisitGeneration as the visited set, so it neither recurses nor allocates
+         * once the array has grown to the size of the hierarchy.
+         *
+         * @note Caller must hold m_graphMutex.
+         * @return uint32_t Number of entries of p_Reach to visit.
+         */
+        uint32_t reach();
+
+        /**
+         * @brief Drops the cached reach of every heap that reaches `from` but not `to`,
+         * after the edge `from -> to` was added.
+         * @note Caller must hold m_graphMutex.
+         */
+        static void invalidateReach(Heap* from, Heap* to);
+
+        /**
+         * @brief Removes `heap` from every adjacency array and cached reach, before it dies.
+         * @note Caller must hold m_graphMutex.
+         */
+        static void unlinkHeap(Heap* heap);
+    protected:
+        /**
+         * @brief Set by ArenaHeap: `new (heap) T` then bumps objects from its chunks
+         * instead of allocating a tracked block each.
+         */
+        bool m_IsArena{false};
     public:
         /**
          * @brief Construct a new Heap object.
          * @param name The display name for this memory category.
+         * @param mode How allocations are distributed between threads.
          */
-        Heap(const char *name) {
+        Heap(const char *name, TrackingMode mode = TrackingMode::Shared) {
             std::strncpy(m_name, name, 99);
             m_name[99] = '\0';
-            m_total = 0;
             m_NextAllocId = 1;
+            m_Mode = mode;
+            m_ShardCount = 1;
+            m_UseSlab = false;
+            m_SampleInterval = 0;
+            m_NumaNode = numa::NO_NODE;
+            m_CheckOnFree = true;
+            m_CallSiteDepth = 0;
+            m_MappedThreshold = 0;
+            m_HugePages = mapped::HugePages::None;
 
-            p_HeadList = nullptr;
-            p_TailList = nullptr;
             p_Reporter = nullptr;
+
+            registerHeap();
+        }
+
+        /**
+         * @brief Destroy the Heap and release its slab pages.
+         * @note Slab pages of a shard that still has live blocks are leaked on
+         * purpose, so late frees (e.g. during static destruction) stay valid.
+         */
+        ~Heap();
+
+        Heap(const Heap&) = delete;
+        Heap& operator=(const Heap&) = delete;
+
+        /**
+         * @brief Enables or disables the slab backend for small blocks.
+         *
+         * When enabled, every allocation whose total size (header + data + end marker)
+         * fits `SLAB_MAX_CHUNK` is carved from 64 KiB pages split into 16-byte size
+         * classes instead of calling malloc. This applies to every path that allocates
+         * from this heap (`new (heap) T`, ISentry types routed to it, ...), so
+         * call sites don't change.
+         *
+         * Safe to toggle at any time: every block records its backend in its header.
+         *
+         * @param enabled true to serve small blocks from slab pages.
+         */
+        void SetSlabBackend(bool enabled) noexcept {
+            m_UseSlab.store(enabled, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns true if small blocks are served from slab pages.
+         */
+        bool UsesSlabBackend() const noexcept {
+            return m_UseSlab.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns the bytes of slab pages currently reserved by this heap.
+         */
+        size_t GetSlabReserved() noexcept;
+
+        /**
+         * @brief Carves a chunk of at least `bytes` bytes from the calling thread's slab cache.
+         * @note Used by the allocation path, not meant to be called directly.
+         * @param shard Receives the shard of the cache that carved the chunk.
+         * @return void* The chunk, or nullptr if `bytes` is too big for the slab backend.
+         */
+        void* SlabAllocate(size_t bytes, uint8_t& shard);
+
+        /**
+         * @brief Returns a chunk obtained from SlabAllocate() to the cache that carved it.
+         * @note Used by the free path, not meant to be called directly.
+         */
+        void SlabFree(void* chunk);
+
+        /**
+         * @brief SlabFree() for callers that know the shard and the requested `bytes`
+         * (sized delete): the chunk goes back without touching its page header.
+         */
+        void SlabFree(void* chunk, uint8_t shard, size_t bytes);
+
+        /**
+         * @brief Binds the memory of this heap to a NUMA node.
+         *
+         * From now on slab pages mapped by this heap, and blocks of at least
+         * `NUMA_BIND_MIN_BYTES` (which then get a mapping of their own, as if the
+         * mapped threshold were that low), are placed on `node` with a preferred
+         * policy (see numa::BindMemory()). malloc'd blocks share pages with other
+         * allocations and are never bound: they keep the kernel's first-touch
+         * placement, so enable the slab backend to keep small blocks node-local
+         * as well (HeapFactory::GetNodeHeap() does).
+         *
+         * @param node Node in [0, numa::NodeCount()), or numa::NO_NODE to unbind.
+         * @return true if the binding changed, false if `node` is out of range.
+         * @note Memory allocated before the call keeps its placement.
+         */
+        bool SetNumaNode(int node) noexcept {
+            if(node != numa::NO_NODE && (node < 0 || node >= numa::NodeCount()))
+                return false;
+
+            m_NumaNode.store(node, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * @brief Returns the NUMA node this heap is bound to, numa::NO_NODE if none.
+         */
+        int GetNumaNode() const noexcept {
+            return m_NumaNode.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Enables allocation sampling with the given mean interval in bytes.
+         *
+         * Like tcmalloc's heap profiler, allocations are picked with a probability
+         * proportional to their size: on average one sampled allocation every `bytes`
+         * bytes allocated, with exponentially distributed gaps. Only sampled blocks get
+         * a full header, are linked into the heap list, counted and reported; every
+         * other block takes a 16-byte LightHeader fast path (no lock, no list, no
+         * reporter) and is still freed correctly by the usual delete.
+         *
+         * Counters and reports then describe the sample; use GetSampledEstimate()
+         * for scaled numbers.
+         *
+         * @param bytes Mean sampling interval, 0 (the default) tracks every allocation.
+         */
+        void SetSamplingInterval(size_t bytes) noexcept {
+            m_SampleInterval.store(bytes, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns the mean sampling interval in bytes, 0 when every allocation is tracked.
+         */
+        size_t GetSamplingInterval() const noexcept {
+            return m_SampleInterval.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Decides whether an allocation of `bytes` is tracked.
+         * @note Used by the allocation path, not meant to be called directly.
+         */
+        bool ShouldSample(size_t bytes) noexcept {
+            size_t interval = m_SampleInterval.load(std::memory_order_relaxed);
+            return interval == 0 || sampleTick(bytes, interval);
+        }
+
+        /**
+         * @brief Estimates the live blocks and bytes of the whole heap from the sample.
+         *
+         * Every live sampled block of size `s` stands for `1 / (1 - exp(-s / interval))`
+         * blocks. Walks the sampled blocks of each shard under its lock, which is cheap
+         * because only a fraction of the blocks is sampled.
+         *
+         * @note Only the live fields are scaled; the cumulative ones stay sample counts.
+         * @note Uses the current interval: estimates are off for blocks sampled before
+         * the interval was changed. Without sampling this returns the exact counters.
+         */
+        HeapStats GetSampledEstimate() noexcept;
+
+        /**
+         * @brief Enables or disables the canary check of the free path.
+         *
+         * Every block carries an end marker after its user data, followed by
+         * `REDZONE_BYTES` of guard pattern (see MEM_SENTRY_REDZONE). By default
+         * every free checks both and reports an overwrite through
+         * IReporter::onCorruption(). Disable it to keep frees cheap and let a
+         * Scrubber (or Scrub()) find overwrites of live blocks in the background.
+         *
+         * @note Unsampled blocks (see SetSamplingInterval()) are not tracked: their
+         * canaries are only checked by debug asserts on free.
+         */
+        void SetCanaryCheckOnFree(bool enabled) noexcept {
+            m_CheckOnFree.store(enabled, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns true if the free path checks canaries.
+         */
+        bool ChecksCanariesOnFree() const noexcept {
+            return m_CheckOnFree.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Records the call stack of every tracked allocation, `depth` frames deep.
+         *
+         * Each allocation walks its frame-pointer chain and stores the id of the stack
+         * in the header (see callsite::Capture()); the call-site table keeps the live
+         * bytes and count of every distinct stack, over all heaps, so
+         * callsite::TopSites() points at the code holding the memory. With sampling on
+         * (SetSamplingInterval()) only sampled blocks pay for the walk.
+         *
+         * @param depth Frames per stack, clamped to CALLSITE_MAX_DEPTH; 0 turns capture off.
+         * @note The compact header layout has no room for the stack id and records nothing.
+         */
+        void SetCallSiteDepth(size_t depth) noexcept {
+            if(depth > constants::CALLSITE_MAX_DEPTH)
+                depth = constants::CALLSITE_MAX_DEPTH;
+
+            m_CallSiteDepth.store((uint8_t)depth, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns the frames captured per allocation, 0 when call-site capture is off.
+         */
+        size_t GetCallSiteDepth() const noexcept {
+            return m_CallSiteDepth.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Gives every block of at least `bytes` raw bytes a mapping of its own.
+         *
+         * Such blocks skip malloc: they are mmap'd directly, with the header in its
+         * own page in front of the user data, so the data starts page aligned (any
+         * alignment up to a page costs nothing) and `delete` hands the pages straight
+         * back to the OS instead of leaving them in the malloc arena. realloc() grows
+         * and shrinks them in place with mremap() when it can. HeapStats::m_MappedBytes
+         * and m_MappedCount account them separately from the other blocks.
+         *
+         * @param bytes Threshold on the raw block size (header + data + end marker), 0 turns the path off.
+         * @param pages Page size to ask for: normal pages, a transparent huge page hint
+         * (MADV_HUGEPAGE) or explicit huge pages (MAP_HUGETLB, falling back to normal
+         * pages when none are reserved).
+         * @note Applies to blocks allocated after the call; the free path reads the
+         * backend from each block.
+         */
+        void SetMappedThreshold(size_t bytes, mapped::HugePages pages = mapped::HugePages::None) noexcept {
+            m_HugePages.store(pages, std::memory_order_relaxed);
+            m_MappedThreshold.store(bytes, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns the raw block size from which blocks are mapped, 0 when the path is off.
+         */
+        size_t GetMappedThreshold() const noexcept {
+            return m_MappedThreshold.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns the page size mapped blocks ask for.
+         */
+        mapped::HugePages GetMappedHugePages() const noexcept {
+            return m_HugePages.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Hands a corrupted block to the reporter, or prints it when there is none.
+         * @note Used by the free path, not meant to be called directly.
+         * @return true if a reporter received it.
+         */
+        bool ReportCorruption(alloc_header::AllocHeader* alloc, canary::Corruption corruption);
+
+        /**
+         * @brief Checks the canaries of up to `budget` live blocks, resuming at `cursor`.
+         *
+         * Only one shard is visited per call and its lock is held for at most
+         * `budget` blocks, so allocators of that shard are blocked only briefly and
+         * the others not at all. Corrupted blocks are copied out and reported through
+         * IReporter::onCorruption() after the lock is released; a call stops early
+         * once it has `SCRUB_REPORT_BATCH` of them.
+         *
+         * @param cursor Progress of the scrub, advanced by the call (start with a default one).
+         * @param budget Most blocks to check.
+         * @return size_t Corrupted blocks found by this call.
+         */
+        size_t Scrub(ScrubCursor& cursor, size_t budget = constants::SCRUB_BATCH);
+
+        /**
+         * @brief Returns true if this heap is an ArenaHeap.
+         * @note Used by the allocation path, not meant to be called directly.
+         */
+        bool IsArena() const noexcept {
+            return m_IsArena;
+        }
+
+        /**
+         * @brief Switches between shared and per-thread allocation lists.
+         *
+         * Safe to call while allocations are live: existing blocks stay in the
+         * shard they were linked into and are unlinked from it on free.
+         *
+         * @param mode The new tracking mode.
+         */
+        void SetTrackingMode(TrackingMode mode) noexcept {
+            m_Mode.store(mode, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Returns the current tracking mode.
+         */
+        TrackingMode GetTrackingMode() const noexcept {
+            return m_Mode.load(std::memory_order_relaxed);
         }
         
         /**
@@ -128,6 +723,19 @@ namespace MEM_SENTRY::heap {
          * @return const char* The name string.
          */
         const char * GetName() const noexcept { return m_name; }
+
+        /**
+         * @brief Get the index of this heap in the heap registry.
+         * @return uint16_t The index, or constants::MAX_HEAPS if the registry was full.
+         */
+        uint16_t GetIndex() const noexcept { return m_Index; }
+
+        /**
+         * @brief Get the registration number of this heap (never 0).
+         * A heap created after another one was destroyed may get its index, but never
+         * its generation: readers keyed on GetIndex() compare it to tell them apart.
+         */
+        uint32_t GetGeneration() const noexcept { return m_Generation; }
         
         /**
          * @brief return a unique Id for a new allocation and increments the counter.
@@ -139,17 +747,48 @@ namespace MEM_SENTRY::heap {
 
         /**
          * @brief Returns the current total bytes allocated on this heap.
+         * Sums the per-shard counters without taking any lock (wait-free).
          */
-        int GetTotal() const noexcept { return m_total; }
+        int64_t GetTotal() const noexcept;
 
         /**
          * @brief Count active allocations tracked by this heap.
+         * Sums the per-shard counters without taking any lock (wait-free).
          */
-        int CountAllocations() noexcept;
+        int64_t CountAllocations() const noexcept;
+
+        /**
+         * @brief Returns all counters of this heap in one call.
+         * @note The fields are read one by one without a lock, so under concurrent
+         * allocation they can be a few operations apart from each other.
+         */
+        HeapStats GetStats() const noexcept;
+
+        /**
+         * @brief Counts blocks parked in (positive) or taken out of (negative) a recycling cache.
+         * Parked blocks are unregistered from the heap; GetStats() reports the memory they hold.
+         * @note Used by sentry::RecyclingPolicy, not meant to be called directly.
+         */
+        void AddCached(int64_t bytes, int64_t count) noexcept {
+            HeapShard& slot = m_Shards[thread_slot::Current()];
+            slot.m_CachedBytes.fetch_add(bytes, std::memory_order_relaxed);
+            slot.m_CachedCount.fetch_add(count, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Counts bytes mapped (positive) or unmapped (negative) for mapped blocks.
+         * @note Used by the allocation path, not meant to be called directly.
+         */
+        void AddMapped(int64_t bytes, int64_t count) noexcept {
+            HeapShard& slot = m_Shards[thread_slot::Current()];
+            slot.m_MappedBytes.fetch_add(bytes, std::memory_order_relaxed);
+            slot.m_MappedCount.fetch_add(count, std::memory_order_relaxed);
+        }
 
         /**
          * @brief Registers a new allocation with this heap.
-         * Updates the total byte count and adds the header to the internal linked list.
+         * Assigns its allocation ID, updates the counters and adds the header
+         * to the internal linked list.
          * 
          * @param alloc Pointer to the header of the newly allocated memory.
          */
@@ -157,49 +796,90 @@ namespace MEM_SENTRY::heap {
     
         /**
          * @brief Unregisters an allocation from this heap.
-         * Decreases total byte count and removes the header from the internal linked list.
+         * Updates the counters and removes the header from the internal linked list.
          * 
          * @param alloc Pointer to the header of the memory being freed.
          */
         void RemoveAlloc(alloc_header::AllocHeader* alloc);
 
+        /**
+         * @brief Changes the size of a live allocation that grew or shrank in place.
+         * Updates `m_Size`, moves the end marker and redzone, and adjusts the byte
+         * counters of the shard that tracks it; the block stays linked where it is.
+         * @note Used by the reallocation path, not meant to be called directly.
+         *
+         * @param alloc Pointer to the header of the resized block.
+         * @param size New number of user bytes, which the raw memory must have room for.
+         */
+        void ResizeAllocation(alloc_header::AllocHeader* alloc, size_t size);
+
         /**
          * @brief Prints all active allocations between two IDs.
          * Used to detect leaks or inspect memory usage between two points in time.
+         * In ThreadLocal mode the shard lists are merged so blocks are still
+         * reported in allocation ID order.
+         *
+         * The first block of the range is found through the per-shard ID index,
+         * and the matching headers are copied while the shards are locked; the
+         * reporter runs on that copy after the locks are released.
          * 
          * @param bookMark1 The starting Allocation ID (inclusive).
          * @param bookMark2 The ending Allocation ID (inclusive).
          */
         void ReportMemory(int bookMark1, int bookMark2);
 
+        /**
+         * @brief Copies the live tracked blocks (ID, size, alignment, address), sorted by ID.
+         *
+         * Shards are copied one at a time in slices of `batch` blocks, each under the
+         * shard lock; the arrays are grown before the lock is taken. An allocator thus
+         * waits for at most one slice, never for the whole heap, and nothing is reported
+         * while a lock is held. Compare two snapshots with Diff() to find leaks.
+         *
+         * @param batch Most blocks copied per shard lock.
+         * @return HeapSnapshot The copy; a later slice can miss a block freed, or see a block
+         * added, while an earlier one was copied. Stops early when out of memory.
+         * @note Unsampled blocks (see SetSamplingInterval()) are not tracked, so not included.
+         */
+        HeapSnapshot Snapshot(size_t batch = constants::SCRUB_BATCH);
+
         /**
          * @brief Reserves memory for the adjacency list of connected heaps.
          * Use this if you know ahead of time how many heaps will be connected 
          * to this one to avoid reallocations.
          * 
          * @param size The number of heaps to reserve space for.
+         * @return false if the memory couldn't be reserved.
          */
-        void allocateAdjList(size_t size) {
-            m_AdjHeaps.reserve(size);
-        }
+        bool allocateAdjList(size_t size);
 
         /**
          * @brief Adds a one-way connection from this heap to another target heap.
          * This adds the target heap to this heap's adjacency list. 
          * For bidirectional linking, use HeapFactory::ConnectHeaps().
+         *
+         * Adding an edge that already exists does nothing. Only the cached reach of
+         * heaps that gain new heaps through the edge is invalidated.
+         *
+         * Both heaps must be in the heap registry (GetIndex() below MAX_HEAPS): a
+         * destroyed heap is unlinked from the registered heaps only, so an edge
+         * to or from a heap that found the registry full is refused.
          * 
          * @param heap Pointer to the target heap to connect.
+         * @return true if the edge exists after the call, false if `heap` is null,
+         * either heap is unregistered, or the neighbor list couldn't grow.
          * 
          * @warning [THREAD WARNING] This function acquires a GLOBAL STATIC LOCK on the heap topology.
          * It will block ALL other threads trying to modify heap connections or query hierarchy stats
          * until it completes. It does NOT block standard Alloc/Dealloc on other heaps.
          */
-        void AddHeap(Heap* heap);
+        bool AddHeap(Heap* heap);
 
         /**
          * @brief Calculates the total memory usage for hierarchical heaps.
-         * This performs a graph traversal (DFS) to sum the total memory size 
-         * of the entire connected component (Cluster) of heaps.
+         * Sums the wait-free counters of every heap reachable from this one
+         * (the Cluster). The reachable set is cached, so repeated queries on an
+         * unchanged hierarchy don't traverse the graph again.
          * 
          * @return size_t Total bytes allocated across the heap graph.
          * 
@@ -207,27 +887,23 @@ namespace MEM_SENTRY::heap {
          * It will block ALL other threads trying to modify heap connections or query hierarchy stats
          * until it completes. It does NOT block standard Alloc/Dealloc on other heaps.
          * 
-         * @warning [PERF WARNING] This uses std::unordered_set for traversal, which triggers
-         * dynamic memory allocations on the Default Heap. 
-         * DO NOT use this in high-performance loops (e.g., Game Update) or memory stress tests.
-         * Intended for Debugging/Snapshots only.
+         * @note Never allocates once the cache has grown to the size of the hierarchy;
+         * the first query after a topology change rebuilds it with an iterative traversal.
          */
         size_t GetTotalHH();
 
         /**
          * @brief Counts the total number of active allocations in heap hierarchy.
-         * This performs a graph traversal (DFS) to sum the allocation count
-         * of the entire connected heaps (Hierarchy) of heaps.
+         * Sums the wait-free counters of every heap reachable from this one,
+         * using the same cached reachable set as GetTotalHH().
          * @return size_t Total count of allocations across the heap graph.
          * 
          * @warning [THREAD WARNING] This function acquires a GLOBAL STATIC LOCK on the heap topology.
          * It will block ALL other threads trying to modify heap connections or query hierarchy stats
          * until it completes. It does NOT block standard Alloc/Dealloc on other heaps.
          * 
-         * @warning [PERF WARNING] This uses std::unordered_set for traversal, which triggers
-         * dynamic memory allocations on the Default Heap. 
-         * DO NOT use this in high-performance loops (e.g., Game Update) or memory stress tests.
-         * Intended for Debugging/Snapshots only.
+         * @note Never allocates once the cache has grown to the size of the hierarchy;
+         * the first query after a topology change rebuilds it with an iterative traversal.
          */
         size_t CountAllocationsHH();
     };
@@ -247,6 +923,32 @@ namespace MEM_SENTRY::heap {
             return &defaultHeap;
         }
 
+        /**
+         * @brief Returns the heap bound to NUMA node `node`, creating it on first use.
+         *
+         * Node heaps are named "NodeHeap<n>", use the ThreadLocal tracking mode
+         * and the slab backend, and are bound to their node (Heap::SetNumaNode()).
+         * Each one is connected to the default heap, so `GetTotalHH()` on the
+         * default heap adds up every node, while `GetStats()` on a node heap
+         * gives the numbers of that node alone.
+         *
+         * @param node Node in [0, numa::NodeCount()).
+         * @return Heap* The node heap, or nullptr if `node` is out of range.
+         * @note Node heaps live until the process exits.
+         */
+        static Heap* GetNodeHeap(int node);
+
+        /**
+         * @brief Returns the node heap of the node the calling thread runs on.
+         *
+         * Shortcut for `GetNodeHeap(numa::CurrentNode())`. A thread that is not
+         * pinned may migrate afterwards: memory stays on the node it was placed on
+         * and can be freed from any thread.
+         */
+        static Heap* GetLocalHeap() {
+            return GetNodeHeap(numa::CurrentNode());
+        }
+
         /**
          * @brief Establishes a bidirectional connection between two heaps.
          * This effectively merges the two heaps into the same `Heap Hierarchy`
@@ -254,16 +956,48 @@ namespace MEM_SENTRY::heap {
          * 
          * @param heap1 Pointer to the first heap.
          * @param heap2 Pointer to the second heap.
+         * @return true if both edges exist after the call (see Heap::AddHeap()).
          * 
          * @warning [THREAD WARNING] This function acquires a GLOBAL STATIC LOCK on the heap topology.
          * It will block ALL other threads trying to modify heap connections or query hierarchy stats
          * until it completes. It does NOT block standard Alloc/Dealloc on other heaps.
          */
-        static void ConnectHeaps(Heap* heap1, Heap* heap2){
-            if(heap1 && heap2){
-                heap1->AddHeap(heap2);
-                heap2->AddHeap(heap1);
-            }
+        static bool ConnectHeaps(Heap* heap1, Heap* heap2){
+            if(!heap1 || !heap2)
+                return false;
+
+            // evaluate both: a one-way edge left by a failed second half is still valid.
+            const bool forward = heap1->AddHeap(heap2);
+            const bool backward = heap2->AddHeap(heap1);
+
+            return forward && backward;
         }
+
+        /**
+         * @brief Looks up a live heap by its registry index.
+         * @param index The value returned by Heap::GetIndex().
+         * @return Heap* The heap, or nullptr if no heap holds that index.
+         */
+        static Heap* GetHeapByIndex(uint16_t index) noexcept;
+
+        /**
+         * @brief Calls `visit(heap, context)` for every live heap, in registry order.
+         * @note Runs under the registry lock, so no heap is destroyed meanwhile;
+         * `visit` must not create or destroy heaps itself.
+         */
+        static void ForEachHeap(void (*visit)(Heap* heap, void* context), void* context);
     };
+};
+
+namespace MEM_SENTRY::alloc_header {
+    /**
+     * @brief Returns the heap that tracks the allocation, for both header layouts.
+     */
+    inline heap::Heap* GetHeap(const AllocHeader* alloc) noexcept {
+#if MEM_SENTRY_COMPACT_HEADER
+        return heap::HeapFactory::GetHeapByIndex(alloc->m_HeapIndex);
+#else
+        return alloc->p_Heap;
+#endif
+    }
 };
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+// Opt-in interposition of the C allocation calls.
+//
+// Include this header LAST, and only in C-style translation units: from there on,
+// the `malloc`, `calloc`, `realloc` and `free` names of that file go to the
+// tracked ms_* functions (default heap), so C-style buffers show up in the heap
+// totals and `realloc` grows them in place when it can. Headers included before
+// it, and every other translation unit, keep the C library allocator.
+//
+// The names are replaced by object-like macros, which also catch `&free` and
+// `(malloc)(n)` but rename every later use of the four names:
+// - `std::malloc()` / `std::free()` don't compile after this header (they become
+//   `std::ms_malloc()` / `std::ms_free()`): call the unqualified names instead.
+// - members or locals called malloc, calloc, realloc or free are renamed too, so
+//   no C++ header may be included after this one.
+// A file that needs either keeps the C library allocator, or calls ms_* directly.
+//
+// The process-wide symbols are deliberately left alone: MemSentry takes its own
+// raw memory from malloc, and blocks from the C library can't be told apart from
+// tracked ones on free. Never mix the two kinds of blocks between files.
+
+#include <cstdlib>
+#include <stdlib.h>
+
+#include "mem_sentry/mem_sentry.h"
+
+// the ms_* allocation calls have a defaulted heap argument: fixed to the default heap here.
+inline void* ms_interposed_malloc(size_t size) noexcept { return ms_malloc(size); }
+inline void* ms_interposed_calloc(size_t count, size_t size) noexcept { return ms_calloc(count, size); }
+
+#define malloc  ms_interposed_malloc
+#define calloc  ms_interposed_calloc
+#define realloc ms_realloc
+#define free    ms_free
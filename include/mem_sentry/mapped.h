@@ -0,0 +1,92 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "mem_sentry/constants.h"
+
+namespace MEM_SENTRY::mapped {
+
+    /**
+     * @enum HugePages
+     * @brief Page size the mapped backend asks for, see Heap::SetMappedThreshold().
+     */
+    enum class HugePages : uint8_t {
+        /// @brief normal pages.
+        None = 0,
+
+        /// @brief normal pages with MADV_HUGEPAGE, so transparent huge pages back them when the kernel can.
+        Transparent = 1,
+
+        /// @brief MAP_HUGETLB pages of MAPPED_HUGE_PAGE_SIZE, falling back to normal pages when none are free.
+        Explicit = 2
+    };
+
+    /**
+     * @struct Region
+     * @brief The mapping of one mapped block, stored right before its raw pointer.
+     *
+     * Layout:
+     * `[Region] [Original Pointer?] [Header] | [User Data (page aligned)] [Footer] [?Padding]`.
+     * Everything before the user data sits in its own page(s) at the start of the
+     * mapping, so the user data starts on a page boundary and needs no alignment
+     * padding up to the page size.
+     */
+    struct Region {
+        /** @brief Start of the mapping. */
+        void* p_Base;
+
+        /** @brief Bytes mapped, a multiple of m_PageSize. */
+        size_t m_Length;
+
+        /** @brief Page size of the mapping (normal or explicit huge page). */
+        size_t m_PageSize;
+    };
+
+    /**
+     * @brief Returns the normal page size of the machine, read once.
+     */
+    size_t PageSize() noexcept;
+
+    /**
+     * @brief Maps a block of its own.
+     *
+     * The user data starts at the first page boundary after `headerBytes` (plus
+     * the Region), or at the next multiple of `alignment` when that is larger
+     * than a page. Pages are zero-filled by the kernel and only take physical
+     * memory once they are touched.
+     *
+     * @param headerBytes Bytes the block layout puts before the user data (header + original pointer).
+     * @param dataBytes Bytes from the user data to the end of the block (data + footer + redzone).
+     * @param alignment Alignment of the user data, 0 for the default alignment.
+     * @param pages Page size to ask for.
+     * @return void* The raw pointer (user data - `headerBytes`), nullptr if mmap() failed.
+     */
+    void* Map(size_t headerBytes, size_t dataBytes, size_t alignment, HugePages pages) noexcept;
+
+    /**
+     * @brief Returns the Region of a raw pointer returned by Map().
+     */
+    inline Region* RegionOf(void* raw) noexcept {
+        return static_cast<Region*>(raw) - 1;
+    }
+
+    /**
+     * @brief Returns a mapped block's pages to the OS.
+     * @return size_t Bytes unmapped.
+     */
+    size_t Unmap(void* raw) noexcept;
+
+    /**
+     * @brief Resizes a mapped block without moving it.
+     *
+     * Growing extends the mapping in place with mremap() (which fails when the
+     * next pages are taken); shrinking unmaps the pages past the new end.
+     *
+     * @param raw The raw pointer returned by Map().
+     * @param pMem The user data.
+     * @param dataBytes New bytes from the user data to the end of the block.
+     * @param delta Receives the change of the mapped bytes.
+     * @return false if the block can't grow in place.
+     */
+    bool Resize(void* raw, void* pMem, size_t dataBytes, int64_t& delta) noexcept;
+}
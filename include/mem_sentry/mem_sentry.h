@@ -49,4 +49,54 @@ void* operator new[](std::size_t count, std::align_val_t al, const std::nothrow_
 void operator delete(void* ptr, const std::nothrow_t& tag) noexcept;
 void operator delete[](void* ptr, const std::nothrow_t& tag) noexcept;
 void operator delete(void* ptr, std::align_val_t al, const std::nothrow_t& tag) noexcept;
-void operator delete[](void* ptr, std::align_val_t al, const std::nothrow_t& tag) noexcept;
\ No newline at end of file
+void operator delete[](void* ptr, std::align_val_t al, const std::nothrow_t& tag) noexcept;
+
+// --------------------------------------------------------------------------
+// 4. Tracked Blocks (no arena dispatch, used by ArenaHeap for its chunks)
+// --------------------------------------------------------------------------
+void* sentry_allocate(size_t size, MEM_SENTRY::heap::Heap* pHeap);
+void  sentry_deallocate(void* pMem);
+
+// --------------------------------------------------------------------------
+// 5. C-Style Allocation (tracked malloc/calloc/realloc/free, see mem_sentry/interpose.h)
+// --------------------------------------------------------------------------
+
+/// @brief Tracked malloc() from `pHeap`, nullptr for the default heap.
+void* ms_malloc(size_t size, MEM_SENTRY::heap::Heap* pHeap = nullptr) noexcept;
+
+/// @brief Tracked calloc() from `pHeap`, nullptr for the default heap.
+void* ms_calloc(size_t count, size_t size, MEM_SENTRY::heap::Heap* pHeap = nullptr) noexcept;
+
+/// @brief Tracked realloc(): grows or shrinks in place when the block has room, else moves it within its heap.
+void* ms_realloc(void* pMem, size_t size) noexcept;
+
+/// @brief Frees a block from ms_malloc(), ms_calloc(), ms_realloc() or a tracked `new`.
+void  ms_free(void* pMem) noexcept;
+
+/// @brief The tracked realloc() behind ms_realloc().
+void* sentry_reallocate(void* pMem, size_t size);
+
+// --------------------------------------------------------------------------
+// 6. Fixed-Size Blocks (ISentry fast path, see sentry::FixedBlock)
+// --------------------------------------------------------------------------
+
+/// @brief Allocates a tracked block (or an arena object) whose raw size `rawBytes`
+/// (alloc_header::BlockBytes()) was computed at compile time. `size` is never 0.
+/// @return nullptr when out of memory.
+void* sentry_allocate_fixed(size_t size, size_t alignment, size_t rawBytes, MEM_SENTRY::heap::Heap* pHeap);
+
+/// @brief Frees a block from sentry_allocate_fixed() (or any tracked block of that size and alignment).
+void  sentry_deallocate_fixed(void* pMem, size_t size, size_t alignment, size_t rawBytes) noexcept;
+
+// --------------------------------------------------------------------------
+// 7. Recycled Blocks (tracked blocks parked by sentry::RecyclingPolicy)
+// --------------------------------------------------------------------------
+
+/// @brief Unregisters a live tracked block from its heap and call site without freeing it.
+void  sentry_detach_block(void* pMem) noexcept;
+
+/// @brief Registers a detached block again as a new allocation: fresh allocation ID and call site.
+void  sentry_attach_block(void* pMem) noexcept;
+
+/// @brief Frees a detached block for good.
+void  sentry_free_detached(void* pMem) noexcept;
@@ -0,0 +1,120 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "mem_sentry/constants.h"
+
+namespace MEM_SENTRY::numa {
+    /// @brief node value meaning "not bound to any node".
+    constexpr int NO_NODE = -1;
+
+    /**
+     * @brief Number of NUMA nodes of the machine, read once from sysfs.
+     *
+     * Parses the highest node of `/sys/devices/system/node/possible`, so nodes
+     * are numbered [0, NodeCount()). Machines (or containers) without NUMA
+     * information report a single node.
+     *
+     * @return int Node count, clamped to [1, MAX_NUMA_NODES].
+     */
+    inline int NodeCount() noexcept {
+        static const int s_Count = []() noexcept {
+            FILE* file = std::fopen("/sys/devices/system/node/possible", "r");
+
+            if(!file)
+                return 1;
+
+            // format is a range list such as "0" or "0-1"; the last number is the highest node.
+            int highest = 0;
+            int value = 0;
+            bool digits = false;
+
+            for(int c = std::fgetc(file); c != EOF; c = std::fgetc(file)){
+                if(c >= '0' && c <= '9'){
+                    value = value * 10 + (c - '0');
+                    digits = true;
+                } else {
+                    if(digits && value > highest)
+                        highest = value;
+
+                    value = 0;
+                    digits = false;
+                }
+            }
+
+            if(digits && value > highest)
+                highest = value;
+
+            std::fclose(file);
+
+            return highest + 1 > (int)constants::MAX_NUMA_NODES ? (int)constants::MAX_NUMA_NODES : highest + 1;
+        }();
+
+        return s_Count;
+    }
+
+    /**
+     * @brief Node of the CPU the calling thread is running on right now.
+     *
+     * Uses getcpu (a vDSO call on glibc 2.29+, a plain syscall before that).
+     * The thread may migrate right after the call, so treat the result as a hint.
+     *
+     * @return int Node index in [0, NodeCount()), 0 when the kernel can't tell.
+     */
+    inline int CurrentNode() noexcept {
+        unsigned cpu = 0;
+        unsigned node = 0;
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+        if(::getcpu(&cpu, &node) != 0)
+            return 0;
+#else
+        if(::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+            return 0;
+#endif
+
+        return node < (unsigned)NodeCount() ? static_cast<int>(node) : 0;
+    }
+
+    /**
+     * @brief Asks the kernel to place the pages of `[addr, addr + bytes)` on `node`.
+     *
+     * Only the pages fully inside the range are bound, so neighbour memory
+     * sharing the first or last page keeps its policy. The policy is
+     * `MPOL_PREFERRED`: pages go to `node` while it has free memory and fall
+     * back to other nodes instead of failing. Pages already faulted in are
+     * migrated (`MPOL_MF_MOVE`), so recycled memory is moved as well.
+     *
+     * Calls mbind directly, MemSentry doesn't depend on libnuma.
+     *
+     * @return true if the range (or the empty part of it) is bound, false if
+     * the node is out of range or the kernel refused (no NUMA support, seccomp, ...).
+     */
+    inline bool BindMemory(void* addr, size_t bytes, int node) noexcept {
+        // values from <linux/mempolicy.h>, spelled out to avoid the numaif.h dependency.
+        constexpr int MPOL_PREFERRED_MODE = 1;
+        constexpr unsigned MPOL_MF_MOVE_FLAG = 1u << 1;
+
+        if(node < 0 || node >= NodeCount())
+            return false;
+
+        long page = ::sysconf(_SC_PAGESIZE);
+        uintptr_t pageSize = page > 0 ? static_cast<uintptr_t>(page) : 4096;
+
+        uintptr_t begin = (reinterpret_cast<uintptr_t>(addr) + pageSize - 1) & ~(pageSize - 1);
+        uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + bytes) & ~(pageSize - 1);
+
+        if(end <= begin)
+            return true;
+
+        unsigned long mask = 1ul << node;
+
+        // maxnode counts bits plus one: the kernel drops the last bit it is given.
+        return ::syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED_MODE, &mask,
+            sizeof(mask) * 8 + 1, MPOL_MF_MOVE_FLAG) == 0;
+    }
+}
@@ -0,0 +1,297 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "mem_sentry/alloc_header.h"
+#include "mem_sentry/canary.h"
+#include "mem_sentry/constants.h"
+#include "mem_sentry/heap.h"
+#include "mem_sentry/sentry.h"
+
+namespace MEM_SENTRY::sentry {
+
+    /**
+     * @class RecycleBin
+     * @brief Freed blocks of one object size and alignment, kept for reuse by RecyclingPolicy.
+     *
+     * Every thread keeps up to `Capacity` blocks in a thread-local stack. A thread
+     * whose stack is full moves half of it to a global overflow stack, and a thread
+     * whose stack is empty takes half a stack back from there before it allocates,
+     * so blocks freed on one thread are reused on another. Blocks are linked
+     * through their first bytes; their header and canaries stay as they are, but a
+     * parked tracked block is unregistered from its heap (sentry_detach_block())
+     * and registered again as a new allocation when it is taken.
+     *
+     * All blocks of a bin belong to one heap at a time (in practice the class heap
+     * of the types using it): a block of another heap is freed normally while the
+     * bin still holds blocks.
+     */
+    template<size_t Size, size_t Alignment, size_t Capacity>
+    class RecycleBin {
+        static_assert(Size >= sizeof(void*), "a recycled block must hold the link to the next one");
+        static_assert(Capacity >= 2, "a cache must hold at least two blocks to move half of them");
+
+    private:
+        /** @brief Link written over the user data of a parked block. */
+        struct Node {
+            Node* p_Next;
+        };
+
+        /** @brief A stack of parked blocks, all of `p_Heap`. */
+        struct Stack {
+            Node* p_Head{nullptr};
+            size_t m_Count{0};
+            heap::Heap* p_Heap{nullptr};
+
+            void push(Node* node) noexcept {
+                node->p_Next = p_Head;
+                p_Head = node;
+                ++m_Count;
+            }
+
+            Node* pop() noexcept {
+                Node* node = p_Head;
+                p_Head = node->p_Next;
+                --m_Count;
+                return node;
+            }
+        };
+
+        /** @brief The calling thread's stack; returned to the overflow stack when the thread exits. */
+        struct LocalStack : Stack {
+            ~LocalStack() { RecycleBin::spill(*this, this->m_Count); }
+        };
+
+        /** @brief Blocks parked by threads with a full stack, or by threads that exited. */
+        struct Overflow : Stack {
+            std::mutex m_Mutex;
+        };
+
+        static inline thread_local LocalStack t_Local;
+        static inline Overflow s_Overflow;
+
+        /** @brief Bytes of a block as the heap counts them (see Heap::GetTotal()). */
+        static int64_t liveBytes(void* pMem) noexcept {
+            const alloc_header::AllocHeader* header = static_cast<const alloc_header::AllocHeader*>(pMem) - 1;
+            return (int64_t)(header->m_Size + alloc_header::GetAlignment(header));
+        }
+
+        /** @brief Frees a parked block for good. */
+        static void release(void* pMem, heap::Heap* pHeap) noexcept {
+            if(alloc_header::IsLight(alloc_header::KindOf(pMem))){
+                TrackedPolicy::Deallocate<Size, Alignment>(pMem);
+                return;
+            }
+
+            pHeap->AddCached(-liveBytes(pMem), -1);
+            sentry_free_detached(pMem);
+        }
+
+        /** @brief Moves `count` blocks of `local` to the overflow stack, or frees them if it holds another heap's. */
+        static void spill(Stack& local, size_t count) noexcept {
+            if(count == 0)
+                return;
+
+            {
+                std::lock_guard<std::mutex> lock(s_Overflow.m_Mutex);
+
+                if(s_Overflow.m_Count == 0 || s_Overflow.p_Heap == local.p_Heap){
+                    s_Overflow.p_Heap = local.p_Heap;
+
+                    for(size_t i = 0; i < count; ++i){
+                        s_Overflow.push(local.pop());
+                    }
+
+                    return;
+                }
+            }
+
+            for(size_t i = 0; i < count; ++i){
+                release(local.pop(), local.p_Heap);
+            }
+        }
+
+        /** @brief Takes up to half a stack of `pHeap` blocks from the overflow stack. */
+        static void refill(Stack& local, heap::Heap* pHeap) noexcept {
+            std::lock_guard<std::mutex> lock(s_Overflow.m_Mutex);
+
+            if(s_Overflow.m_Count == 0 || s_Overflow.p_Heap != pHeap)
+                return;
+
+            local.p_Heap = pHeap;
+
+            for(size_t i = 0; i < Capacity / 2 && s_Overflow.m_Count; ++i){
+                local.push(s_Overflow.pop());
+            }
+        }
+
+    public:
+        /**
+         * @brief Returns a parked block of `pHeap`, or nullptr if there is none.
+         * A tracked block is registered again with a fresh allocation ID and the
+         * caller's call site, so bookmarks, snapshots and call-site totals see a
+         * new allocation.
+         */
+        static void* Take(heap::Heap* pHeap) noexcept {
+            LocalStack& local = t_Local;
+
+            if(local.m_Count == 0){
+                refill(local, pHeap);
+            }
+
+            if(local.m_Count == 0 || local.p_Heap != pHeap)
+                return nullptr;
+
+            void* pMem = local.pop();
+
+            if(!alloc_header::IsLight(alloc_header::KindOf(pMem))){
+                pHeap->AddCached(-liveBytes(pMem), -1);
+                sentry_attach_block(pMem);
+            }
+
+            return pMem;
+        }
+
+        /**
+         * @brief Parks a block freed by `delete`.
+         * A tracked block is unregistered from its heap and call site as if it
+         * were freed; its memory is counted in HeapStats::m_CachedBytes instead.
+         * @return false if the block can't be parked and must be freed normally.
+         */
+        static bool Park(void* pMem) noexcept {
+            alloc_header::BlockKind kind = alloc_header::KindOf(pMem);
+            heap::Heap* pHeap;
+
+            if(alloc_header::IsLight(kind)){
+                pHeap = (static_cast<alloc_header::LightHeader*>(pMem) - 1)->p_Heap;
+            } else {
+                const alloc_header::AllocHeader* header = static_cast<const alloc_header::AllocHeader*>(pMem) - 1;
+
+                // the free path reports overwrites, so a corrupted block takes it.
+                if(kind == alloc_header::BlockKind::Arena || !alloc_header::IsLive(header))
+                    return false;
+
+                pHeap = alloc_header::GetHeap(header);
+
+                if(pHeap->ChecksCanariesOnFree() && canary::Inspect(pMem, header->m_Size) != canary::Corruption::None)
+                    return false;
+            }
+
+            LocalStack& local = t_Local;
+
+            if(local.m_Count && local.p_Heap != pHeap)
+                return false;
+
+            local.p_Heap = pHeap;
+
+            if(local.m_Count == Capacity){
+                spill(local, Capacity / 2);
+            }
+
+            // unregistered before the link overwrites the user data a reporter may read.
+            if(!alloc_header::IsLight(kind)){
+                sentry_detach_block(pMem);
+                pHeap->AddCached(liveBytes(pMem), 1);
+            }
+
+            local.push(static_cast<Node*>(pMem));
+
+            return true;
+        }
+
+        /**
+         * @brief Frees every block parked by the calling thread and in the overflow stack.
+         * @note Blocks parked by other running threads stay where they are.
+         */
+        static void Release() noexcept {
+            LocalStack& local = t_Local;
+
+            while(local.m_Count){
+                release(local.pop(), local.p_Heap);
+            }
+
+            // detached first: the free path may run a reporter, which may allocate.
+            Stack overflow;
+
+            {
+                std::lock_guard<std::mutex> lock(s_Overflow.m_Mutex);
+                overflow.p_Head = s_Overflow.p_Head;
+                overflow.m_Count = s_Overflow.m_Count;
+                overflow.p_Heap = s_Overflow.p_Heap;
+                s_Overflow.p_Head = nullptr;
+                s_Overflow.m_Count = 0;
+            }
+
+            while(overflow.m_Count){
+                release(overflow.pop(), overflow.p_Heap);
+            }
+        }
+
+        /** @brief Blocks parked by the calling thread. */
+        static size_t LocalCount() noexcept { return t_Local.m_Count; }
+
+        /** @brief Blocks in the overflow stack. */
+        static size_t OverflowCount() noexcept {
+            std::lock_guard<std::mutex> lock(s_Overflow.m_Mutex);
+            return s_Overflow.m_Count;
+        }
+    };
+
+    /**
+     * @struct RecyclingPolicy
+     * @brief ISentry policy that reuses freed objects instead of returning them to the heap.
+     *
+     * `delete` parks the block in a RecycleBin of the object's size and the next
+     * `new` on that thread takes it back: no malloc and no free. For the heap a
+     * parked block is freed (it leaves the totals, reports and snapshots) and a
+     * taken one is a new allocation with a fresh ID and call site, so only the
+     * shard lock of the heap list is left on the path; HeapStats::m_CachedBytes
+     * and m_CachedCount tell how much memory the caches hold. Types of the same
+     * size and alignment share a bin.
+     *
+     * ```cpp
+     * class Message : public ISentry<Message, RecyclingPolicy<>> { ... };
+     * ...
+     * Message::releaseCache();   // before a leak report, or destroying the heap
+     * ```
+     *
+     * @tparam Capacity Blocks one thread keeps per object size (half move to the
+     * overflow stack when it is full).
+     * @warning A double delete of a parked block goes unnoticed. Release the cache
+     * before destroying its heap.
+     */
+    template<size_t Capacity = constants::RECYCLE_CAPACITY>
+    struct RecyclingPolicy {
+        template<size_t Size, size_t Alignment>
+        using Bin = RecycleBin<Size, Alignment, Capacity>;
+
+        template<size_t Size, size_t Alignment>
+        static void* Allocate(MEM_SENTRY::heap::Heap* heap) {
+#if MEM_SENTRY_ENABLE
+            if(void* pMem = Bin<Size, Alignment>::Take(heap))
+                return pMem;
+#endif
+            return TrackedPolicy::Allocate<Size, Alignment>(heap);
+        }
+
+        template<size_t Size, size_t Alignment>
+        static void Deallocate(void* pMem) noexcept {
+#if MEM_SENTRY_ENABLE
+            if(!pMem || Bin<Size, Alignment>::Park(pMem))
+                return;
+#endif
+            TrackedPolicy::Deallocate<Size, Alignment>(pMem);
+        }
+
+        /**
+         * @brief Frees the blocks parked by the calling thread and in the overflow stack.
+         */
+        template<size_t Size, size_t Alignment>
+        static void Release() noexcept {
+#if MEM_SENTRY_ENABLE
+            Bin<Size, Alignment>::Release();
+#endif
+        }
+    };
+}
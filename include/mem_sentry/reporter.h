@@ -1,5 +1,6 @@
 #pragma once
 #include "mem_sentry/alloc_header.h"
+#include "mem_sentry/canary.h"
 
 // Forward declaration: We don't include heap.h here!
 namespace MEM_SENTRY::heap { class Heap; }
@@ -11,6 +12,16 @@ namespace MEM_SENTRY::reporter {
         virtual void onAlloc(alloc_header::AllocHeader* alloc) = 0;
         virtual void onDealloc(alloc_header::AllocHeader* alloc) = 0;
         virtual void report(alloc_header::AllocHeader* alloc) = 0;
+
+        /**
+         * @brief Called when a block's end marker or redzone was found overwritten,
+         * by the free path (before the block is released) or by Heap::Scrub()
+         * (with a copy of the header). Does nothing by default.
+         */
+        virtual void onCorruption(alloc_header::AllocHeader* alloc, canary::Corruption corruption) {
+            (void)alloc;
+            (void)corruption;
+        }
     };
 
     class ConsoleReporter : public IReporter {
@@ -19,5 +30,6 @@ namespace MEM_SENTRY::reporter {
         virtual void onAlloc(alloc_header::AllocHeader* alloc) override;
         virtual void onDealloc(alloc_header::AllocHeader* alloc) override;
         virtual void report(alloc_header::AllocHeader* alloc) override;
+        virtual void onCorruption(alloc_header::AllocHeader* alloc, canary::Corruption corruption) override;
     };
 }
\ No newline at end of file
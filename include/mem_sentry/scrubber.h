@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mem_sentry/constants.h"
+#include "mem_sentry/heap.h"
+
+namespace MEM_SENTRY::heap {
+
+    /**
+     * @class Scrubber
+     * @brief Background thread that checks the canaries of live blocks.
+     *
+     * Every `interval` the thread runs one Step(): a Heap::Scrub() slice of at most
+     * `batch` blocks on every watched heap. A slice holds one shard lock at a time,
+     * so allocators are never blocked for longer than one batch, and a heap is
+     * covered completely after a few slices per shard. Overwrites are reported
+     * through the heap's IReporter::onCorruption().
+     *
+     * Pair it with Heap::SetCanaryCheckOnFree(false) to move the check off the
+     * free path entirely:
+     * ```cpp
+     * Scrubber scrubber(std::chrono::milliseconds(5));
+     * heap->SetCanaryCheckOnFree(false);
+     * scrubber.Watch(heap);
+     * ```
+     *
+     * @warning Unwatch() a heap before destroying it.
+     */
+    class Scrubber {
+    private:
+        /** @brief A watched heap and how far its scrub got. */
+        struct Watched {
+            Heap* p_Heap;
+            ScrubCursor m_Cursor;
+        };
+
+        /** @brief Guards m_Heaps; held for a whole Step(), so Unwatch() waits for it. */
+        std::mutex m_Mutex;
+
+        /** @brief Heaps scrubbed by every Step(). */
+        std::vector<Watched> m_Heaps;
+
+        /** @brief Sleep between two steps. */
+        std::chrono::microseconds m_Interval;
+
+        /** @brief Blocks checked per heap and step. */
+        size_t m_Batch;
+
+        /** @brief Asks the thread to exit. */
+        std::atomic<bool> m_Stop{false};
+
+        /** @brief Corrupted blocks found so far. */
+        std::atomic<uint64_t> m_Found{0};
+
+        /** @brief Background scrub thread. */
+        std::thread m_Worker;
+
+        /**
+         * @brief Body of the scrub thread.
+         */
+        void run();
+
+    public:
+        /**
+         * @brief Construct a Scrubber and start its thread.
+         * @param interval Sleep between two steps.
+         * @param batch Blocks checked per heap and step.
+         */
+        explicit Scrubber(std::chrono::microseconds interval = std::chrono::milliseconds(1),
+            size_t batch = constants::SCRUB_BATCH);
+
+        /**
+         * @brief Stops the scrub thread.
+         */
+        ~Scrubber();
+
+        Scrubber(const Scrubber&) = delete;
+        Scrubber& operator=(const Scrubber&) = delete;
+
+        /**
+         * @brief Starts scrubbing `heap`. Watching a heap twice does nothing.
+         */
+        void Watch(Heap* heap);
+
+        /**
+         * @brief Stops scrubbing `heap`; no slice of it runs once this returns.
+         */
+        void Unwatch(Heap* heap);
+
+        /**
+         * @brief Runs one slice on every watched heap (what the thread does every interval).
+         * @return size_t Corrupted blocks found.
+         */
+        size_t Step();
+
+        /**
+         * @brief Returns the full passes completed over `heap`, 0 if it isn't watched.
+         */
+        uint64_t GetPasses(Heap* heap);
+
+        /**
+         * @brief Returns the corrupted blocks found since construction.
+         */
+        uint64_t GetFound() const noexcept {
+            return m_Found.load(std::memory_order_relaxed);
+        }
+    };
+}
@@ -5,6 +5,47 @@
 
 namespace MEM_SENTRY::sentry {
 
+    /**
+     * @struct FixedBlock
+     * @brief Compile-time layout of a tracked block holding one object of `Size` bytes.
+     *
+     * Selects between the unaligned and the aligned block layout from `Alignment`,
+     * the way the compiler selects between plain and aligned `new`.
+     */
+    template<size_t Size, size_t Alignment>
+    struct FixedBlock {
+        static_assert(Size > 0, "objects are never 0 bytes");
+        static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of 2");
+
+        /// @brief Alignment the block is allocated with, 0 when plain `new` already guarantees it.
+        static constexpr size_t ALIGNMENT = Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__ ? Alignment : 0;
+
+        /// @brief Raw bytes of the block (header, padding, data, end marker, redzone).
+        static constexpr size_t RAW_BYTES = alloc_header::BlockBytes(Size, ALIGNMENT);
+    };
+
+    /**
+     * @struct TrackedPolicy
+     * @brief Default ISentry allocation policy: every object is a tracked block of the class heap.
+     *
+     * A policy provides `Allocate<Size, Alignment>(heap)`, returning nullptr when out
+     * of memory, and `Deallocate<Size, Alignment>(ptr)`. Both get the object's size
+     * and alignment as template arguments, so the block layout is fixed at compile time.
+     */
+    struct TrackedPolicy {
+        template<size_t Size, size_t Alignment>
+        static void* Allocate(MEM_SENTRY::heap::Heap* heap) {
+            using Block = FixedBlock<Size, Alignment>;
+            return sentry_allocate_fixed(Size, Block::ALIGNMENT, Block::RAW_BYTES, heap);
+        }
+
+        template<size_t Size, size_t Alignment>
+        static void Deallocate(void* pMem) noexcept {
+            using Block = FixedBlock<Size, Alignment>;
+            sentry_deallocate_fixed(pMem, Size, Block::ALIGNMENT, Block::RAW_BYTES);
+        }
+    };
+
     /**
      * @class ISentry
      * @brief A CRTP base class that automates memory tracking for derived classes.
@@ -13,10 +54,15 @@ namespace MEM_SENTRY::sentry {
      * to be routed through the MEM_SENTRY memory system. It automatically manages 
      * a static heap pointer unique to each derived class type.
      * 
+     * Allocations of exactly `sizeof(T)` go through `Policy` with the size and
+     * alignment of T as template arguments (see FixedBlock); anything else (arrays,
+     * bigger derived classes) takes the generic `::operator new(size, Heap*)` path.
+     * 
      * @tparam T The derived class type (Curiously Recurring Template Pattern).
+     * @tparam Policy How single objects are allocated and freed (see TrackedPolicy).
      * Example: class MyClass : public ISentry<MyClass> {};
      */
-    template<typename T>
+    template<typename T, typename Policy = TrackedPolicy>
     class ISentry { 
     private:
         /**
@@ -26,7 +72,54 @@ namespace MEM_SENTRY::sentry {
          * we default to the global default heap rather than crashing on a null pointer.
          */
         static void checkHeap() noexcept {
-            pHeap = !pHeap ? MEM_SENTRY::heap::HeapFactory::GetDefaultHeap() : pHeap;
+            if(!pHeap) [[unlikely]]
+                pHeap = MEM_SENTRY::heap::HeapFactory::GetDefaultHeap();
+        }
+
+        /**
+         * @brief Allocates one T from `heap` through the policy.
+         * @throws std::bad_alloc when out of memory.
+         */
+        static void* allocateObject(MEM_SENTRY::heap::Heap* heap) {
+            void* ptr = Policy::template Allocate<sizeof(T), alignof(T)>(heap);
+
+            if(!ptr) [[unlikely]]
+                throw std::bad_alloc();
+
+            return ptr;
+        }
+
+        /**
+         * @brief Frees a block whose constructor threw, for the placement deletes below.
+         *
+         * They get no size, so the block header tells whether the object took the
+         * policy (one T with the alignment of T) or the generic path (a bigger
+         * derived class, or a stronger alignment).
+         */
+        static void deallocatePlaced(void* pMem, size_t alignment) noexcept {
+#if MEM_SENTRY_ENABLE
+            if(!pMem)
+                return;
+
+            alloc_header::BlockKind kind = alloc_header::KindOf(pMem);
+
+            if(kind != alloc_header::BlockKind::Arena){
+                uint32_t size = alloc_header::IsLight(kind)
+                    ? (static_cast<const alloc_header::LightHeader*>(pMem) - 1)->m_Size
+                    : (static_cast<const alloc_header::AllocHeader*>(pMem) - 1)->m_Size;
+
+                if(size != sizeof(T) || alignment != alignof(T)){
+                    if(alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+                        ::operator delete(pMem, std::align_val_t(alignment));
+                    else
+                        ::operator delete(pMem);
+                    return;
+                }
+            }
+#else
+            (void)alignment;
+#endif
+            Policy::template Deallocate<sizeof(T), alignof(T)>(pMem);
         }
 
     public:
@@ -53,6 +146,15 @@ namespace MEM_SENTRY::sentry {
             pHeap = heap;
         }
 
+        /**
+         * @brief Frees the objects the policy keeps for reuse, if it keeps any (see RecyclingPolicy).
+         */
+        static void releaseCache() noexcept {
+            if constexpr (requires { Policy::template Release<sizeof(T), alignof(T)>(); }) {
+                Policy::template Release<sizeof(T), alignof(T)>();
+            }
+        }
+
         // ========================================================================
         // STANDARD ALLOCATION
         // Routes standard `new T` and `new T[]` to the tracked heap.
@@ -64,6 +166,10 @@ namespace MEM_SENTRY::sentry {
          */
         void* operator new(size_t size){
             checkHeap();
+
+            if(size == sizeof(T)) [[likely]]
+                return allocateObject(pHeap);
+
             return ::operator new(size, pHeap);
         }
 
@@ -87,6 +193,10 @@ namespace MEM_SENTRY::sentry {
          */
         void* operator new(size_t size, std::align_val_t alignment){
             checkHeap();
+
+            if(size == sizeof(T) && static_cast<size_t>(alignment) == alignof(T)) [[likely]]
+                return allocateObject(pHeap);
+
             return ::operator new(size, alignment, pHeap);
         }
 
@@ -103,25 +213,23 @@ namespace MEM_SENTRY::sentry {
         // Handles `new (std::nothrow) T`. Returns nullptr on failure instead of throwing.
         // ========================================================================
 
-        void* operator new(size_t size, const std::nothrow_t& tag) noexcept {
-            checkHeap();
-            try { return ::operator new(size, pHeap); }
+        void* operator new(size_t size, const std::nothrow_t&) noexcept {
+            try { return ISentry::operator new(size); }
             catch(...) { return nullptr; }
         }
 
-        void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+        void* operator new[](size_t size, const std::nothrow_t&) noexcept {
             checkHeap();
             try { return ::operator new(size, pHeap); }
             catch(...) { return nullptr; }
         }
 
-        void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
-            checkHeap();
-            try { return ::operator new(size, alignment, pHeap); }
+        void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+            try { return ISentry::operator new(size, alignment); }
             catch(...) { return nullptr; }
         }
 
-        void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept {
+        void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
             checkHeap();
             try { return ::operator new(size, alignment, pHeap); }
             catch(...) { return nullptr; }
@@ -152,6 +260,9 @@ namespace MEM_SENTRY::sentry {
          * Usage: `new (mySpecificHeap) T()`
          */
         void* operator new(size_t size, MEM_SENTRY::heap::Heap* h) {
+            if(size == sizeof(T)) [[likely]]
+                return allocateObject(h);
+
             return ::operator new(size, h);
         }
 
@@ -159,11 +270,87 @@ namespace MEM_SENTRY::sentry {
          * @brief Explicit Heap Override (Aligned).
          */
         void* operator new(size_t size, std::align_val_t al, MEM_SENTRY::heap::Heap* h) {
+            if(size == sizeof(T) && static_cast<size_t>(al) == alignof(T)) [[likely]]
+                return allocateObject(h);
+
             return ::operator new(size, al, h);
         }
+
+        // ========================================================================
+        // DEALLOCATION
+        // `delete` passes the size of the dynamic type, so single T objects go
+        // back through the policy and everything else through sized delete.
+        // ========================================================================
+
+        /**
+         * @brief Sized operator delete override.
+         */
+        void operator delete(void* pMem, size_t size) noexcept {
+            if(size == sizeof(T)) [[likely]]
+                Policy::template Deallocate<sizeof(T), alignof(T)>(pMem);
+            else
+                ::operator delete(pMem, size);
+        }
+
+        /**
+         * @brief Sized aligned operator delete override.
+         */
+        void operator delete(void* pMem, size_t size, std::align_val_t alignment) noexcept {
+            if(size == sizeof(T) && static_cast<size_t>(alignment) == alignof(T)) [[likely]]
+                Policy::template Deallocate<sizeof(T), alignof(T)>(pMem);
+            else
+                ::operator delete(pMem, size, alignment);
+        }
+
+        /**
+         * @brief Array operator delete[] override, the partner of operator new[] above.
+         * Arrays always take the generic path, which the global delete[] frees.
+         */
+        void operator delete[](void* pMem) noexcept {
+            ::operator delete[](pMem);
+        }
+
+        /**
+         * @brief Aligned array operator delete[] override.
+         */
+        void operator delete[](void* pMem, std::align_val_t alignment) noexcept {
+            ::operator delete[](pMem, alignment);
+        }
+
+        // ========================================================================
+        // PLACEMENT DEALLOCATION
+        // Called only when a constructor throws inside `new (std::nothrow) T`,
+        // `new (std::nothrow) T[n]` or `new (heap) T`. The class-scope deletes above
+        // hide the global ones, so every placement new needs its partner here or
+        // the block would leak.
+        // ========================================================================
+
+        void operator delete(void* pMem, const std::nothrow_t&) noexcept {
+            deallocatePlaced(pMem, alignof(T));
+        }
+
+        void operator delete(void* pMem, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+            deallocatePlaced(pMem, static_cast<size_t>(alignment));
+        }
+
+        void operator delete[](void* pMem, const std::nothrow_t&) noexcept {
+            ::operator delete[](pMem);
+        }
+
+        void operator delete[](void* pMem, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+            ::operator delete[](pMem, alignment);
+        }
+
+        void operator delete(void* pMem, MEM_SENTRY::heap::Heap*) noexcept {
+            deallocatePlaced(pMem, alignof(T));
+        }
+
+        void operator delete(void* pMem, std::align_val_t alignment, MEM_SENTRY::heap::Heap*) noexcept {
+            deallocatePlaced(pMem, static_cast<size_t>(alignment));
+        }
     };
 
     // Static member initialization
-    template<typename T>
-    MEM_SENTRY::heap::Heap* ISentry<T>::pHeap = nullptr;
+    template<typename T, typename Policy>
+    MEM_SENTRY::heap::Heap* ISentry<T, Policy>::pHeap = nullptr;
 };
\ No newline at end of file
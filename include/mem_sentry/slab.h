@@ -0,0 +1,156 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "mem_sentry/constants.h"
+#include "mem_sentry/numa.h"
+
+namespace MEM_SENTRY::slab {
+
+    class SlabCache;
+
+    /**
+     * @struct SlabPage
+     * @brief Header placed at the start of every slab page.
+     *
+     * Pages are `SLAB_PAGE_SIZE` bytes and aligned to their own size, so the
+     * page of any chunk is found by masking the chunk address. Every page
+     * serves a single size class.
+     *
+     * @note Padded to a cache line so the first chunk stays 16-byte aligned.
+     */
+    struct alignas(constants::CACHE_LINE_SIZE) SlabPage {
+        /** @brief Next page owned by the same cache (used to release pages). */
+        SlabPage* p_Next;
+
+        /** @brief Cache that carved this page. Frees return chunks to it. */
+        SlabCache* p_Owner;
+
+        /** @brief Shard index of the owning cache inside its heap. */
+        uint32_t m_Shard;
+
+        /** @brief Size class served by this page. */
+        uint32_t m_Class;
+
+        /** @brief Size of every chunk in this page. */
+        uint32_t m_ChunkSize;
+
+        /** @brief Bytes carved so far, counted from the start of the page. */
+        uint32_t m_Carved;
+    };
+
+    /**
+     * @class SlabCache
+     * @brief Size-class allocator serving small blocks out of large pages.
+     *
+     * Requests are rounded up to a multiple of `SLAB_CLASS_GRANULARITY` and
+     * served from the per-class free list. When a class runs dry the current
+     * page is carved further, and a new page is mapped when that is full.
+     * Freed chunks go back to the free list of their class; pages are only
+     * returned by release().
+     *
+     * @note Not thread-safe. Every Heap shard owns one cache and guards it
+     * with the shard mutex.
+     */
+    class SlabCache {
+    private:
+        /** @brief Intrusive node stored in the first bytes of a free chunk. */
+        struct FreeChunk {
+            FreeChunk* p_Next;
+        };
+
+        /** @brief Free chunks of every size class. */
+        FreeChunk* p_FreeLists[constants::SLAB_CLASSES]{};
+
+        /** @brief Page currently being carved for every size class. */
+        SlabPage* p_Current[constants::SLAB_CLASSES]{};
+
+        /** @brief Every page owned by this cache. */
+        SlabPage* p_Pages{nullptr};
+
+        /** @brief Shard index stamped into new pages. */
+        uint32_t m_Shard{0};
+
+        /** @brief Chunks handed out and not freed yet. */
+        size_t m_LiveChunks{0};
+
+        /** @brief Number of pages owned by this cache. */
+        size_t m_PageCount{0};
+
+        /** @brief NUMA node new pages are bound to, numa::NO_NODE for none. */
+        int m_Node{numa::NO_NODE};
+
+        /**
+         * @brief Maps a fresh page for `classIndex` and makes it current.
+         * @return SlabPage* The new page, or nullptr when out of memory.
+         */
+        SlabPage* newPage(size_t classIndex);
+
+    public:
+        /**
+         * @brief Construct an empty cache.
+         * @param shard Shard index recorded in every page of this cache.
+         */
+        explicit SlabCache(uint32_t shard) : m_Shard(shard) {}
+
+        ~SlabCache() { release(); }
+
+        SlabCache(const SlabCache&) = delete;
+        SlabCache& operator=(const SlabCache&) = delete;
+
+        /**
+         * @brief Returns the size class serving `bytes`, or SLAB_CLASSES when too big.
+         */
+        static constexpr size_t ClassOf(size_t bytes) noexcept {
+            return bytes == 0 || bytes > constants::SLAB_MAX_CHUNK
+                ? constants::SLAB_CLASSES
+                : (bytes - 1) / constants::SLAB_CLASS_GRANULARITY;
+        }
+
+        /**
+         * @brief Returns the page that holds `chunk`.
+         */
+        static SlabPage* PageOf(void* chunk) noexcept {
+            return reinterpret_cast<SlabPage*>(
+                reinterpret_cast<uintptr_t>(chunk) & ~(uintptr_t)(constants::SLAB_PAGE_SIZE - 1));
+        }
+
+        /**
+         * @brief Hands out a chunk of at least `bytes` bytes.
+         * @return void* 16-byte aligned chunk, or nullptr when `bytes` is too big or out of memory.
+         */
+        void* allocate(size_t bytes);
+
+        /**
+         * @brief Returns a chunk previously handed out by this cache.
+         */
+        void free(void* chunk);
+
+        /**
+         * @brief Returns a chunk of size class `classIndex` previously handed out by this cache.
+         * @note Sized free path: the class comes from the caller, so the page header isn't read.
+         */
+        void free(void* chunk, size_t classIndex);
+
+        /**
+         * @brief Frees every page. Only allowed when no chunk is live.
+         * @return true if the pages were released, false if chunks are still live.
+         */
+        bool release();
+
+        /**
+         * @brief Binds the pages mapped from now on to `node` (numa::NO_NODE to stop).
+         * @note Pages mapped before keep their placement.
+         */
+        void setNode(int node) noexcept { m_Node = node; }
+
+        /** @brief NUMA node new pages are bound to, numa::NO_NODE for none. */
+        int node() const noexcept { return m_Node; }
+
+        /** @brief Number of chunks handed out and not freed yet. */
+        size_t liveChunks() const noexcept { return m_LiveChunks; }
+
+        /** @brief Number of pages owned by this cache. */
+        size_t pageCount() const noexcept { return m_PageCount; }
+    };
+}
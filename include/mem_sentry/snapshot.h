@@ -0,0 +1,139 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace MEM_SENTRY::heap {
+    class Heap;
+    struct SnapshotDiff;
+
+    /**
+     * @class HeapSnapshot
+     * @brief Copy of a heap's live blocks, sorted by allocation ID, see Heap::Snapshot().
+     *
+     * Stored as parallel arrays (one per field), so Diff() streams the IDs alone.
+     * The arrays come from malloc, not from a tracked heap, so taking a snapshot
+     * never shows up in the snapshot of the next one.
+     */
+    class HeapSnapshot {
+    private:
+        /** @brief Allocation IDs, ascending. */
+        uint32_t* p_Ids{nullptr};
+
+        /** @brief Bytes of user data of each block. */
+        uint32_t* p_Sizes{nullptr};
+
+        /** @brief Alignment of each block, 0 when unaligned. */
+        uint32_t* p_Alignments{nullptr};
+
+        /** @brief User data address of each block. */
+        const void** p_Addresses{nullptr};
+
+        /** @brief Number of blocks. */
+        size_t m_Count{0};
+
+        /** @brief Number of blocks the arrays have room for. */
+        size_t m_Capacity{0};
+
+        /** @brief Appends a block copied from `other`. */
+        void pushFrom(const HeapSnapshot& other, size_t i) noexcept {
+            Push(other.p_Ids[i], other.p_Sizes[i], other.p_Alignments[i], other.p_Addresses[i]);
+        }
+
+        friend SnapshotDiff Diff(const HeapSnapshot& before, const HeapSnapshot& after);
+
+    public:
+        HeapSnapshot() = default;
+
+        ~HeapSnapshot();
+
+        HeapSnapshot(HeapSnapshot&& other) noexcept;
+        HeapSnapshot& operator=(HeapSnapshot&& other) noexcept;
+
+        HeapSnapshot(const HeapSnapshot&) = delete;
+        HeapSnapshot& operator=(const HeapSnapshot&) = delete;
+
+        /**
+         * @brief Grows the arrays to hold at least `capacity` blocks.
+         * @return false when out of memory (the snapshot is left as it was).
+         */
+        bool Reserve(size_t capacity) noexcept;
+
+        /**
+         * @brief Appends a block.
+         * @note Never allocates when Reserve() made room for it, so it can run under a shard lock.
+         * @return false when out of memory.
+         */
+        bool Push(uint32_t id, uint32_t size, uint32_t alignment, const void* address) noexcept {
+            if(m_Count == m_Capacity && !Reserve(m_Capacity ? m_Capacity * 2 : 64))
+                return false;
+
+            p_Ids[m_Count] = id;
+            p_Sizes[m_Count] = size;
+            p_Alignments[m_Count] = alignment;
+            p_Addresses[m_Count] = address;
+            ++m_Count;
+
+            return true;
+        }
+
+        /**
+         * @brief Sorts the blocks by ID and drops repeated IDs.
+         */
+        void Sort();
+
+        /**
+         * @brief Drops every block, keeping the arrays.
+         */
+        void Clear() noexcept { m_Count = 0; }
+
+        /** @brief Number of blocks. */
+        size_t Size() const noexcept { return m_Count; }
+
+        /** @brief True when there are no blocks. */
+        bool Empty() const noexcept { return m_Count == 0; }
+
+        /** @brief Allocation ID of block `i`. */
+        uint32_t GetId(size_t i) const noexcept { return p_Ids[i]; }
+
+        /** @brief Bytes of user data of block `i`. */
+        uint32_t GetSize(size_t i) const noexcept { return p_Sizes[i]; }
+
+        /** @brief Alignment of block `i`, 0 when unaligned. */
+        uint32_t GetAlignment(size_t i) const noexcept { return p_Alignments[i]; }
+
+        /** @brief User data address of block `i` (the block may be gone by now). */
+        const void* GetAddress(size_t i) const noexcept { return p_Addresses[i]; }
+
+        /** @brief The sorted ID array. */
+        const uint32_t* Ids() const noexcept { return p_Ids; }
+
+        /** @brief Bytes of user data of every block. */
+        uint64_t GetTotalBytes() const noexcept;
+    };
+
+    /**
+     * @struct SnapshotDiff
+     * @brief Blocks that appeared and disappeared between two snapshots, see Diff().
+     */
+    struct SnapshotDiff {
+        /** @brief Blocks of the later snapshot missing from the earlier one (leak candidates). */
+        HeapSnapshot m_Added;
+
+        /** @brief Blocks of the earlier snapshot freed by the time of the later one. */
+        HeapSnapshot m_Freed;
+    };
+
+    /**
+     * @brief Compares two snapshots of the same heap by allocation ID.
+     *
+     * One linear merge of the two sorted ID arrays. With SSE2 or NEON it compares
+     * blocks of 4 IDs of each side against each other (all 16 pairs at once) and
+     * advances the block with the smaller last ID.
+     *
+     * @param before The earlier snapshot.
+     * @param after The later snapshot.
+     * @return SnapshotDiff Blocks added and freed, each sorted by ID.
+     * @note A block resized in place keeps its ID and counts as the same block.
+     */
+    SnapshotDiff Diff(const HeapSnapshot& before, const HeapSnapshot& after);
+}
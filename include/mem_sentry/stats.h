@@ -0,0 +1,305 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "mem_sentry/constants.h"
+#include "mem_sentry/thread_slot.h"
+
+namespace MEM_SENTRY::stats {
+    /// @brief true when the hot-path counters are compiled in (MEM_SENTRY_STATS=1).
+    constexpr bool ENABLED = MEM_SENTRY_STATS;
+
+    /**
+     * @enum Counter
+     * @brief Hot-path events counted when MEM_SENTRY_STATS is enabled.
+     */
+    enum class Counter : uint8_t {
+        /** @brief Heap shard lock taken (allocation, free and slab paths). */
+        ShardLockAcquired,
+        /** @brief Heap shard lock found held by another thread, the caller had to wait. */
+        ShardLockContended,
+        /** @brief new_handler calls made by operator new after an allocation failed. */
+        NewHandlerRetries,
+        /** @brief Allocations that failed for good (no new_handler left, or a C-style call). */
+        AllocFailures,
+        /** @brief RingPool push()/push_bulk() limited by a full ring. */
+        RingPushFull,
+        /** @brief RingPool pop()/pop_bulk() limited by an empty ring (includes PoolChain scans). */
+        RingPopEmpty,
+        /** @brief MPMCPool push() that failed on a full queue. */
+        MPMCPushFull,
+        /** @brief MPMCPool pop() that failed on an empty queue. */
+        MPMCPopEmpty,
+        /** @brief Pools appended to a PoolChain. */
+        ChainGrowths,
+        /** @brief Chain growths served by a pre-built spare pool (see GrowthPolicy). */
+        ChainSpareUsed,
+        /** @brief Pools retired by PoolChain::trim(). */
+        ChainTrims,
+        /** @brief pop_wait()/push_wait() calls that ran out of spins and slept on the futex. */
+        PoolParks,
+        /** @brief Futex wakes issued for a parked pop_wait()/push_wait() caller. */
+        PoolWakes,
+
+        COUNT
+    };
+
+    /**
+     * @enum Histogram
+     * @brief Durations recorded in cycles, in power-of-two buckets.
+     */
+    enum class Histogram : uint8_t {
+        /** @brief Time spent waiting for a contended heap shard lock. */
+        ShardLockWait,
+        /** @brief Time a PoolChain spent appending a pool (building it unless a spare was ready). */
+        ChainGrowth,
+
+        COUNT
+    };
+
+    /// @brief number of counters.
+    constexpr size_t COUNTERS = static_cast<size_t>(Counter::COUNT);
+
+    /// @brief number of histograms.
+    constexpr size_t HISTOGRAMS = static_cast<size_t>(Histogram::COUNT);
+
+    /// @brief buckets per histogram; bucket `i` holds durations in [2^i, 2^(i+1)) cycles.
+    constexpr size_t HISTOGRAM_BUCKETS = 64;
+
+    /**
+     * @struct StatsSnapshot
+     * @brief Sum of every thread's counters and histograms at one point in time, see Snapshot().
+     */
+    struct StatsSnapshot {
+        uint64_t m_Counters[COUNTERS]{};
+        uint64_t m_Histograms[HISTOGRAMS][HISTOGRAM_BUCKETS]{};
+
+        /** @brief Value of one counter. */
+        uint64_t get(Counter counter) const noexcept {
+            return m_Counters[static_cast<size_t>(counter)];
+        }
+
+        /** @brief Number of samples recorded in one histogram. */
+        uint64_t samples(Histogram histogram) const noexcept {
+            uint64_t total = 0;
+            for (uint64_t bucket : m_Histograms[static_cast<size_t>(histogram)]) {
+                total += bucket;
+            }
+            return total;
+        }
+    };
+
+    /**
+     * @struct ThreadStats
+     * @brief Counters of the threads mapped to one thread slot.
+     *
+     * The first `THREAD_SLOTS` threads each own a slot (see thread_slot::Current()),
+     * so the relaxed increments stay on a cache line no other thread writes.
+     */
+    struct alignas(constants::CACHE_LINE_SIZE) ThreadStats {
+        std::atomic<uint64_t> m_Counters[COUNTERS]{};
+        std::atomic<uint64_t> m_Histograms[HISTOGRAMS][HISTOGRAM_BUCKETS]{};
+    };
+
+    /**
+     * @brief Per-slot counters of the process.
+     * @note Only referenced when ENABLED, so a disabled build carries no storage.
+     */
+    inline ThreadStats* Slots() noexcept {
+        static ThreadStats s_Slots[constants::THREAD_SLOTS];
+        return s_Slots;
+    }
+
+    /**
+     * @brief Timestamp in cycles (TSC on x86, the virtual counter on aarch64, ns elsewhere).
+     */
+    inline uint64_t Cycles() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t value;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    /**
+     * @brief Adds `n` to a counter of the calling thread. Compiles to nothing when disabled.
+     */
+    inline void Count(Counter counter, uint64_t n = 1) noexcept {
+        if constexpr (ENABLED) {
+            Slots()[thread_slot::Current()].m_Counters[static_cast<size_t>(counter)]
+                .fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Records a duration of `cycles` in a histogram of the calling thread.
+     */
+    inline void Record(Histogram histogram, uint64_t cycles) noexcept {
+        if constexpr (ENABLED) {
+            size_t bucket = cycles ? 63 - __builtin_clzll(cycles) : 0;
+            Slots()[thread_slot::Current()].m_Histograms[static_cast<size_t>(histogram)][bucket]
+                .fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @class ScopedCycles
+     * @brief Records the cycles between its construction and destruction in a histogram.
+     * @note Empty and free when disabled.
+     */
+    template<Histogram histogram>
+    class ScopedCycles {
+    private:
+        struct Nothing {};
+
+        [[no_unique_address]] std::conditional_t<ENABLED, uint64_t, Nothing> m_Start;
+
+    public:
+        ScopedCycles() noexcept {
+            if constexpr (ENABLED) {
+                m_Start = Cycles();
+            }
+        }
+
+        ~ScopedCycles() {
+            if constexpr (ENABLED) {
+                Record(histogram, Cycles() - m_Start);
+            }
+        }
+
+        ScopedCycles(const ScopedCycles&) = delete;
+        ScopedCycles& operator=(const ScopedCycles&) = delete;
+    };
+
+    /**
+     * @class ShardLock
+     * @brief `std::lock_guard` for heap shard mutexes that counts contention.
+     *
+     * When enabled the lock is first tried: a failure counts as contended and the
+     * blocking wait is recorded in the ShardLockWait histogram. When disabled it is
+     * a plain lock_guard.
+     */
+    class ShardLock {
+    private:
+        std::mutex& m_Mutex;
+
+    public:
+        explicit ShardLock(std::mutex& mutex) : m_Mutex(mutex) {
+            if constexpr (ENABLED) {
+                Count(Counter::ShardLockAcquired);
+
+                if (m_Mutex.try_lock())
+                    return;
+
+                Count(Counter::ShardLockContended);
+
+                ScopedCycles<Histogram::ShardLockWait> wait;
+                m_Mutex.lock();
+            } else {
+                m_Mutex.lock();
+            }
+        }
+
+        ~ShardLock() {
+            m_Mutex.unlock();
+        }
+
+        ShardLock(const ShardLock&) = delete;
+        ShardLock& operator=(const ShardLock&) = delete;
+    };
+
+    /**
+     * @brief Sums the counters and histograms of every thread slot.
+     * @note Reads with relaxed loads while other threads keep counting, so the fields
+     * can be a few events apart. Returns all zeros when disabled.
+     */
+    inline StatsSnapshot Snapshot() noexcept {
+        StatsSnapshot snapshot;
+
+        if constexpr (ENABLED) {
+            ThreadStats* slots = Slots();
+
+            for (size_t s = 0; s < constants::THREAD_SLOTS; ++s) {
+                for (size_t c = 0; c < COUNTERS; ++c) {
+                    snapshot.m_Counters[c] += slots[s].m_Counters[c].load(std::memory_order_relaxed);
+                }
+
+                for (size_t h = 0; h < HISTOGRAMS; ++h) {
+                    for (size_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+                        snapshot.m_Histograms[h][b] += slots[s].m_Histograms[h][b].load(std::memory_order_relaxed);
+                    }
+                }
+            }
+        }
+
+        return snapshot;
+    }
+
+    /**
+     * @brief Clears every counter and histogram.
+     * @note Events counted concurrently may survive the reset.
+     */
+    inline void Reset() noexcept {
+        if constexpr (ENABLED) {
+            ThreadStats* slots = Slots();
+
+            for (size_t s = 0; s < constants::THREAD_SLOTS; ++s) {
+                for (auto& counter : slots[s].m_Counters) {
+                    counter.store(0, std::memory_order_relaxed);
+                }
+
+                for (auto& histogram : slots[s].m_Histograms) {
+                    for (auto& bucket : histogram) {
+                        bucket.store(0, std::memory_order_relaxed);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Display name of a counter.
+     */
+    constexpr const char* CounterName(Counter counter) noexcept {
+        switch (counter) {
+            case Counter::ShardLockAcquired:  return "ShardLockAcquired";
+            case Counter::ShardLockContended: return "ShardLockContended";
+            case Counter::NewHandlerRetries:  return "NewHandlerRetries";
+            case Counter::AllocFailures:      return "AllocFailures";
+            case Counter::RingPushFull:       return "RingPushFull";
+            case Counter::RingPopEmpty:       return "RingPopEmpty";
+            case Counter::MPMCPushFull:       return "MPMCPushFull";
+            case Counter::MPMCPopEmpty:       return "MPMCPopEmpty";
+            case Counter::ChainGrowths:       return "ChainGrowths";
+            case Counter::ChainSpareUsed:     return "ChainSpareUsed";
+            case Counter::ChainTrims:         return "ChainTrims";
+            case Counter::PoolParks:          return "PoolParks";
+            case Counter::PoolWakes:          return "PoolWakes";
+            default:                          return "?";
+        }
+    }
+
+    /**
+     * @brief Display name of a histogram.
+     */
+    constexpr const char* HistogramName(Histogram histogram) noexcept {
+        switch (histogram) {
+            case Histogram::ShardLockWait: return "ShardLockWait";
+            case Histogram::ChainGrowth:   return "ChainGrowth";
+            default:                       return "?";
+        }
+    }
+}
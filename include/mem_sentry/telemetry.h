@@ -0,0 +1,206 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mem_sentry/constants.h"
+#include "mem_sentry/heap.h"
+#include "mem_sentry/telemetry_format.h"
+
+namespace MEM_SENTRY::telemetry {
+
+    /**
+     * @class TelemetryExporter
+     * @brief Background thread that publishes heap and pool counters to a shared memory region.
+     *
+     * Every `interval` the thread runs one Publish(): it reads Heap::GetStats() of
+     * every live heap (the relaxed counters the allocation path keeps anyway) and
+     * the occupancy of every watched pool, and writes them into the region under
+     * one sequence lock per record (see telemetry_format.h). Allocations and pool
+     * operations do no extra work, and readers such as `memsentry_top` map the
+     * region read-only and sample it as often as they like without stopping or
+     * instrumenting the process.
+     *
+     * ```cpp
+     * TelemetryExporter exporter;                 // "/memsentry.<pid>", every 100 ms
+     * exporter.WatchPool("rx-buffers", rxPool);   // any RingPool, MPMCPool or PoolChain
+     * ...
+     * exporter.UnwatchPool(rxPool);               // before the pool is destroyed
+     * ```
+     *
+     * The record of a heap is its registry index (Heap::GetIndex()); heaps past
+     * `heapSlots` are counted in TelemetryHeader::m_DroppedHeaps instead.
+     *
+     * @warning UnwatchPool() a pool before destroying it.
+     */
+    class TelemetryExporter {
+    private:
+        /** @brief Reads capacity, available buffers and rings of a watched pool. */
+        using PoolSampler = void (*)(void* pool, PoolRecord& record);
+
+        /** @brief A watched pool; `p_Pool` is nullptr while the record is free. */
+        struct WatchedPool {
+            void* p_Pool;
+            PoolSampler p_Sample;
+        };
+
+        /** @brief What the last publish saw in a heap record, for the rates. */
+        struct HeapTrack {
+            /** @brief Heap::GetGeneration() of the heap in the record, 0 while the record is free. */
+            uint32_t m_Generation;
+            uint64_t m_TotalAllocs;
+            uint64_t m_TotalFrees;
+            uint64_t m_SampleNs;
+            uint64_t m_Pass;
+        };
+
+        /** @brief Name of the shared memory object. */
+        char m_Name[TELEMETRY_NAME_BYTES];
+
+        /** @brief The mapped region, nullptr if it couldn't be created. */
+        TelemetryHeader* p_Region{nullptr};
+
+        /** @brief Bytes mapped. */
+        size_t m_Bytes{0};
+
+        /** @brief Guards m_Pools and m_Heaps; held for a whole Publish(), so every record has one writer. */
+        std::mutex m_Mutex;
+
+        /** @brief One entry per pool record. */
+        std::vector<WatchedPool> m_Pools;
+
+        /** @brief One entry per heap record. */
+        std::vector<HeapTrack> m_Heaps;
+
+        /** @brief Publishes run so far, marks the heaps seen by each. */
+        uint64_t m_Pass{0};
+
+        /** @brief Sleep between two publishes. */
+        std::chrono::microseconds m_Interval;
+
+        /** @brief Asks the thread to exit; guarded by m_WakeMutex. */
+        bool m_Stop{false};
+
+        /** @brief Cuts the sleep between two publishes short on destruction. */
+        std::mutex m_WakeMutex;
+        std::condition_variable m_Wake;
+
+        /** @brief Background publish thread. */
+        std::thread m_Worker;
+
+        /**
+         * @brief Body of the publish thread.
+         */
+        void run();
+
+        /**
+         * @brief Writes the record of `heap` (called for every live heap by Publish()).
+         * @return false if the heap's registry index is past the heap table.
+         */
+        bool publishHeap(heap::Heap* heap, uint64_t now);
+
+        /**
+         * @brief Takes a free pool record for `pool`.
+         */
+        bool watchPool(const char* name, void* pool, PoolSampler sample);
+
+        /**
+         * @brief Frees the pool record of `pool`.
+         */
+        void unwatchPool(const void* pool);
+
+        template<typename Pool>
+        static void samplePool(void* pool, PoolRecord& record) {
+            Pool& watched = *static_cast<Pool*>(pool);
+
+            record.m_Capacity.store(watched.capacity(), std::memory_order_relaxed);
+
+            if constexpr (requires { watched.poolCount(); watched.freeBuffers(); }) {
+                record.m_Available.store(watched.freeBuffers(), std::memory_order_relaxed);
+                record.m_Pools.store(watched.poolCount(), std::memory_order_relaxed);
+            } else {
+                record.m_Available.store(watched.currentSize(), std::memory_order_relaxed);
+                record.m_Pools.store(1, std::memory_order_relaxed);
+            }
+        }
+
+    public:
+        /**
+         * @brief Creates the shared memory region and starts the publish thread.
+         *
+         * An existing object of the same name (e.g. left by a crashed process) is replaced.
+         *
+         * @param name Name of the shared memory object, nullptr for `/memsentry.<pid>`.
+         * @param interval Sleep between two publishes.
+         * @param heapSlots Heap records of the region.
+         * @param poolSlots Pool records of the region.
+         */
+        explicit TelemetryExporter(const char* name = nullptr,
+            std::chrono::microseconds interval = std::chrono::milliseconds(100),
+            uint32_t heapSlots = constants::TELEMETRY_HEAP_SLOTS,
+            uint32_t poolSlots = constants::TELEMETRY_POOL_SLOTS);
+
+        /**
+         * @brief Stops the publish thread and removes the region.
+         */
+        ~TelemetryExporter();
+
+        TelemetryExporter(const TelemetryExporter&) = delete;
+        TelemetryExporter& operator=(const TelemetryExporter&) = delete;
+
+        /**
+         * @brief Returns true if the region was created (and the thread started).
+         */
+        bool IsOpen() const noexcept { return p_Region != nullptr; }
+
+        /**
+         * @brief Returns the name of the shared memory object.
+         */
+        const char* GetName() const noexcept { return m_Name; }
+
+        /**
+         * @brief Returns the mapped region, nullptr if it couldn't be created.
+         */
+        const TelemetryHeader* GetRegion() const noexcept { return p_Region; }
+
+        /**
+         * @brief Starts publishing the occupancy of `pool` under `name`.
+         *
+         * `Pool` is anything with `capacity()` and either `currentSize()`
+         * (RingPool, MPMCPool) or `freeBuffers()` / `poolCount()` (PoolChain);
+         * all of them are safe to read from the publish thread.
+         *
+         * @return false if every pool record is taken (or the region isn't open).
+         * Watching a pool twice does nothing.
+         */
+        template<typename Pool>
+        bool WatchPool(const char* name, Pool& pool) {
+            return watchPool(name, &pool, &TelemetryExporter::samplePool<Pool>);
+        }
+
+        /**
+         * @brief Stops publishing `pool`; no sample of it is taken once this returns.
+         */
+        template<typename Pool>
+        void UnwatchPool(Pool& pool) {
+            unwatchPool(&pool);
+        }
+
+        /**
+         * @brief Writes every record once (what the thread does every interval).
+         */
+        void Publish();
+
+        /**
+         * @brief Returns the publishes completed since construction.
+         */
+        uint64_t GetPublishes() const noexcept {
+            return p_Region ? p_Region->m_Publishes.load(std::memory_order_relaxed) : 0;
+        }
+    };
+}
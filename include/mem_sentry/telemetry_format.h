@@ -0,0 +1,268 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace MEM_SENTRY::telemetry {
+    /**
+     * Shared-memory layout written by TelemetryExporter and read by the `memsentry_top` tool.
+     *
+     * Region layout (one POSIX shared memory object, `/memsentry.<pid>` by default):
+     * - TelemetryHeader at offset 0.
+     * - `m_HeapSlots` HeapRecord entries; the record of a heap is its registry index.
+     * - `m_PoolSlots` PoolRecord entries, one per watched pool.
+     *
+     * Every record has its own sequence lock (`m_Seq`): the exporter makes it odd
+     * while it writes the record and even again when it is done. A reader copies
+     * the record and keeps the copy only if `m_Seq` was even and unchanged around
+     * it, so sampling never blocks the exporter nor the process it watches.
+     *
+     * @note This header has no dependency on the rest of MEM_SENTRY, so external
+     * readers can include it without linking the tracking allocator.
+     */
+
+    /// @brief "MSTL", identifies a telemetry region.
+    constexpr uint32_t TELEMETRY_MAGIC = 0x4C54534D;
+
+    /// @brief bumped whenever the header or a record layout change.
+    constexpr uint32_t TELEMETRY_VERSION = 1;
+
+    /// @brief bytes of a heap or pool name, terminator included.
+    constexpr size_t TELEMETRY_NAME_BYTES = 64;
+
+    /// @brief tries of a reader before it gives up on a record being rewritten.
+    constexpr int TELEMETRY_READ_TRIES = 64;
+
+    // the region is shared between processes: every atomic must be a plain lock-free word.
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "telemetry needs lock-free 64-bit atomics");
+
+    /**
+     * @struct TelemetryHeader
+     * @brief Start of the region, written once except for the publish counters.
+     */
+    struct alignas(64) TelemetryHeader {
+        uint32_t m_Magic;
+        uint32_t m_Version;
+
+        /** @brief Records of the heap table. */
+        uint32_t m_HeapSlots;
+
+        /** @brief Records of the pool table. */
+        uint32_t m_PoolSlots;
+
+        /** @brief Process that exports the region. */
+        int32_t m_Pid;
+        uint32_t m_Reserved;
+
+        /** @brief Time between two publishes, in nanoseconds. */
+        uint64_t m_IntervalNs;
+
+        /** @brief Publishes completed; a reader that sees it stall knows the exporter stopped. */
+        std::atomic<uint64_t> m_Publishes;
+
+        /** @brief steady_clock time of the last publish, in nanoseconds. */
+        std::atomic<uint64_t> m_PublishNs;
+
+        /** @brief Heaps left out because their registry index is past the heap table. */
+        std::atomic<uint64_t> m_DroppedHeaps;
+    };
+
+    /**
+     * @struct HeapRecord
+     * @brief Counters of one heap, as Heap::GetStats() returns them, plus rates.
+     */
+    struct alignas(64) HeapRecord {
+        /** @brief Sequence lock, odd while the record is written. */
+        std::atomic<uint64_t> m_Seq;
+
+        /** @brief Nonzero while a live heap holds this record. */
+        std::atomic<uint64_t> m_InUse;
+
+        std::atomic<int64_t> m_LiveBytes;
+        std::atomic<int64_t> m_LiveCount;
+        std::atomic<uint64_t> m_TotalAllocs;
+        std::atomic<uint64_t> m_TotalFrees;
+        std::atomic<int64_t> m_CachedBytes;
+        std::atomic<int64_t> m_MappedBytes;
+
+        /** @brief Allocations / frees per second over the last interval. */
+        std::atomic<uint64_t> m_AllocRate;
+        std::atomic<uint64_t> m_FreeRate;
+
+        /** @brief steady_clock time of the sample, in nanoseconds. */
+        std::atomic<uint64_t> m_SampleNs;
+
+        /** @brief Rewritten only when the record changes hands, under the sequence lock. */
+        char m_Name[TELEMETRY_NAME_BYTES];
+    };
+
+    /**
+     * @struct PoolRecord
+     * @brief Occupancy of one watched pool (RingPool, MPMCPool or PoolChain).
+     */
+    struct alignas(64) PoolRecord {
+        /** @brief Sequence lock, odd while the record is written. */
+        std::atomic<uint64_t> m_Seq;
+
+        /** @brief Nonzero while a watched pool holds this record. */
+        std::atomic<uint64_t> m_InUse;
+
+        /** @brief Buffers the pool can hold. */
+        std::atomic<uint64_t> m_Capacity;
+
+        /** @brief Buffers sitting in the pool, ready to be popped. */
+        std::atomic<uint64_t> m_Available;
+
+        /** @brief Rings the pool is made of (1 unless it is a PoolChain). */
+        std::atomic<uint64_t> m_Pools;
+
+        /** @brief steady_clock time of the sample, in nanoseconds. */
+        std::atomic<uint64_t> m_SampleNs;
+
+        char m_Name[TELEMETRY_NAME_BYTES];
+    };
+
+    /**
+     * @struct HeapSample
+     * @brief A consistent copy of a HeapRecord.
+     */
+    struct HeapSample {
+        int64_t m_LiveBytes;
+        int64_t m_LiveCount;
+        uint64_t m_TotalAllocs;
+        uint64_t m_TotalFrees;
+        int64_t m_CachedBytes;
+        int64_t m_MappedBytes;
+        uint64_t m_AllocRate;
+        uint64_t m_FreeRate;
+        uint64_t m_SampleNs;
+        char m_Name[TELEMETRY_NAME_BYTES];
+    };
+
+    /**
+     * @struct PoolSample
+     * @brief A consistent copy of a PoolRecord.
+     */
+    struct PoolSample {
+        uint64_t m_Capacity;
+        uint64_t m_Available;
+        uint64_t m_Pools;
+        uint64_t m_SampleNs;
+        char m_Name[TELEMETRY_NAME_BYTES];
+    };
+
+    /** @brief Bytes of a region with the given tables, a multiple of 64. */
+    inline size_t RegionBytes(uint32_t heapSlots, uint32_t poolSlots) noexcept {
+        return sizeof(TelemetryHeader) + heapSlots * sizeof(HeapRecord) + poolSlots * sizeof(PoolRecord);
+    }
+
+    inline HeapRecord* HeapRecords(TelemetryHeader* header) noexcept {
+        return reinterpret_cast<HeapRecord*>(header + 1);
+    }
+
+    inline const HeapRecord* HeapRecords(const TelemetryHeader* header) noexcept {
+        return reinterpret_cast<const HeapRecord*>(header + 1);
+    }
+
+    inline PoolRecord* PoolRecords(TelemetryHeader* header) noexcept {
+        return reinterpret_cast<PoolRecord*>(HeapRecords(header) + header->m_HeapSlots);
+    }
+
+    inline const PoolRecord* PoolRecords(const TelemetryHeader* header) noexcept {
+        return reinterpret_cast<const PoolRecord*>(HeapRecords(header) + header->m_HeapSlots);
+    }
+
+    /** @brief true if `header` starts a region this version can read. */
+    inline bool IsValid(const TelemetryHeader* header) noexcept {
+        return header->m_Magic == TELEMETRY_MAGIC && header->m_Version == TELEMETRY_VERSION;
+    }
+
+    /**
+     * @brief Writer side: makes the record odd before its fields are stored.
+     */
+    inline void BeginWrite(std::atomic<uint64_t>& seq) noexcept {
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        // keeps the field stores below from moving above the odd sequence.
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /**
+     * @brief Writer side: publishes the fields stored since BeginWrite().
+     */
+    inline void EndWrite(std::atomic<uint64_t>& seq) noexcept {
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Reader side: runs `copy` until it saw a record nobody was writing.
+     * @return false if the record was being rewritten for every try.
+     */
+    template<typename Copy>
+    bool ReadConsistent(const std::atomic<uint64_t>& seq, Copy&& copy) noexcept {
+        for(int i = 0; i < TELEMETRY_READ_TRIES; ++i){
+            uint64_t before = seq.load(std::memory_order_acquire);
+
+            if(before & 1)
+                continue;
+
+            copy();
+
+            // keeps the field loads above from moving below the second sequence load.
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if(seq.load(std::memory_order_relaxed) == before)
+                return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Copies a heap record.
+     * @return false if the record is free or could not be read consistently.
+     */
+    inline bool ReadHeap(const HeapRecord& record, HeapSample& sample) noexcept {
+        bool inUse = false;
+
+        bool consistent = ReadConsistent(record.m_Seq, [&]() noexcept {
+            inUse = record.m_InUse.load(std::memory_order_relaxed) != 0;
+            sample.m_LiveBytes = record.m_LiveBytes.load(std::memory_order_relaxed);
+            sample.m_LiveCount = record.m_LiveCount.load(std::memory_order_relaxed);
+            sample.m_TotalAllocs = record.m_TotalAllocs.load(std::memory_order_relaxed);
+            sample.m_TotalFrees = record.m_TotalFrees.load(std::memory_order_relaxed);
+            sample.m_CachedBytes = record.m_CachedBytes.load(std::memory_order_relaxed);
+            sample.m_MappedBytes = record.m_MappedBytes.load(std::memory_order_relaxed);
+            sample.m_AllocRate = record.m_AllocRate.load(std::memory_order_relaxed);
+            sample.m_FreeRate = record.m_FreeRate.load(std::memory_order_relaxed);
+            sample.m_SampleNs = record.m_SampleNs.load(std::memory_order_relaxed);
+
+            // a torn copy is thrown away by the sequence check.
+            std::memcpy(sample.m_Name, record.m_Name, TELEMETRY_NAME_BYTES);
+        });
+
+        sample.m_Name[TELEMETRY_NAME_BYTES - 1] = '\0';
+        return consistent && inUse;
+    }
+
+    /**
+     * @brief Copies a pool record.
+     * @return false if the record is free or could not be read consistently.
+     */
+    inline bool ReadPool(const PoolRecord& record, PoolSample& sample) noexcept {
+        bool inUse = false;
+
+        bool consistent = ReadConsistent(record.m_Seq, [&]() noexcept {
+            inUse = record.m_InUse.load(std::memory_order_relaxed) != 0;
+            sample.m_Capacity = record.m_Capacity.load(std::memory_order_relaxed);
+            sample.m_Available = record.m_Available.load(std::memory_order_relaxed);
+            sample.m_Pools = record.m_Pools.load(std::memory_order_relaxed);
+            sample.m_SampleNs = record.m_SampleNs.load(std::memory_order_relaxed);
+            std::memcpy(sample.m_Name, record.m_Name, TELEMETRY_NAME_BYTES);
+        });
+
+        sample.m_Name[TELEMETRY_NAME_BYTES - 1] = '\0';
+        return consistent && inUse;
+    }
+}
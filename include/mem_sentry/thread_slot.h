@@ -0,0 +1,22 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+#include "mem_sentry/constants.h"
+
+namespace MEM_SENTRY::thread_slot {
+    /**
+     * @brief Returns the slot index assigned to the calling thread.
+     *
+     * Slots are handed out round-robin the first time a thread asks for one,
+     * so the first `THREAD_SLOTS` threads each get a private slot and later
+     * threads start sharing them. The value never changes for a given thread.
+     *
+     * @return size_t Slot index in the range [0, THREAD_SLOTS).
+     */
+    inline size_t Current() noexcept {
+        static std::atomic<size_t> s_NextSlot{0};
+        thread_local size_t slot = s_NextSlot.fetch_add(1, std::memory_order_relaxed) % constants::THREAD_SLOTS;
+        return slot;
+    }
+}
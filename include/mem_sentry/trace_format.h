@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+namespace MEM_SENTRY::trace {
+    /**
+     * On-disk format written by BinaryTraceReporter and read by the `memsentry_trace` tool.
+     *
+     * File layout:
+     * - TraceFileHeader at offset 0, padded up to `m_DataOffset` (a page boundary).
+     * - `m_RecordCount` fixed-size TraceRecord entries from `m_DataOffset` on.
+     *
+     * All fields are little-endian host order; the format is meant to be read back
+     * on the same kind of machine that produced it.
+     *
+     * @note This header has no dependency on the rest of MEM_SENTRY, so offline
+     * tools can include it without linking the tracking allocator.
+     */
+
+    /// @brief "MSTRACE1", identifies a trace file.
+    constexpr char TRACE_MAGIC[8] = {'M', 'S', 'T', 'R', 'A', 'C', 'E', '1'};
+
+    /// @brief bumped whenever TraceRecord or TraceFileHeader change.
+    constexpr uint32_t TRACE_VERSION = 1;
+
+    /// @brief bytes of one mapped window; a multiple of every common page size.
+    constexpr uint64_t TRACE_WINDOW_BYTES = 1024 * 1024;
+
+    /**
+     * @enum TraceRecordType
+     * @brief Kind of a TraceRecord. 0 is never written, so zero-filled tails of a
+     * trace that was not closed properly are skipped.
+     */
+    enum class TraceRecordType : uint8_t {
+        None     = 0,
+        Alloc    = 1,
+        Free     = 2,
+
+        /// @brief a block reported by Heap::ReportMemory().
+        Report   = 3,
+
+        /// @brief names heap `m_Heap`: the first 16 bytes of its name are stored
+        /// over m_Address, m_AllocId and m_Size (see EncodeHeapName()).
+        HeapName = 4
+    };
+
+    /**
+     * @struct TraceFileHeader
+     * @brief First bytes of a trace file.
+     */
+    struct TraceFileHeader {
+        /** @brief TRACE_MAGIC. */
+        char m_Magic[8];
+
+        /** @brief TRACE_VERSION. */
+        uint32_t m_Version;
+
+        /** @brief sizeof(TraceRecord), checked by readers. */
+        uint32_t m_RecordSize;
+
+        /** @brief File offset of the first record. */
+        uint64_t m_DataOffset;
+
+        /** @brief Wall-clock time the trace started, in ns since the Unix epoch. */
+        uint64_t m_StartRealtimeNs;
+
+        /** @brief Records in the file; 0 if the writer did not close the file. */
+        uint64_t m_RecordCount;
+    };
+
+    /**
+     * @struct TraceRecord
+     * @brief One fixed-size event.
+     *
+     * @note Memory Layout:
+     * - m_Timestamp(8), m_Address(8), m_AllocId(4), m_Size(4), m_Thread(4),
+     *   m_Heap(2), m_AlignShift(1), m_Type(1)
+     * - Total Size: 32 Bytes.
+     */
+    struct TraceRecord {
+        /** @brief ns since the trace started (steady clock). */
+        uint64_t m_Timestamp;
+
+        /** @brief User address of the block. */
+        uint64_t m_Address;
+
+        /** @brief Allocation ID, unique per heap. */
+        uint32_t m_AllocId;
+
+        /** @brief Size of the user data. */
+        uint32_t m_Size;
+
+        /** @brief OS thread id of the thread that produced the event. */
+        uint32_t m_Thread;
+
+        /** @brief Registry index of the heap (see HeapFactory::GetHeapByIndex()). */
+        uint16_t m_Heap;
+
+        /** @brief log2 of the alignment, 0 when unaligned. */
+        uint8_t m_AlignShift;
+
+        /** @brief Kind of this record. */
+        TraceRecordType m_Type;
+    };
+
+    static_assert(sizeof(TraceRecord) == 32, "TraceRecord is part of the file format");
+
+    /// @brief bytes of heap name a HeapName record can hold.
+    constexpr size_t TRACE_NAME_BYTES = 16;
+
+    /**
+     * @brief Stores up to TRACE_NAME_BYTES of `name` in a HeapName record.
+     */
+    inline void EncodeHeapName(TraceRecord& record, const char* name) noexcept {
+        char buffer[TRACE_NAME_BYTES] = {};
+        std::strncpy(buffer, name, TRACE_NAME_BYTES);
+        std::memcpy(&record.m_Address, buffer, TRACE_NAME_BYTES);
+    }
+
+    /**
+     * @brief Reads the name of a HeapName record into `out` (TRACE_NAME_BYTES + 1 chars).
+     */
+    inline void DecodeHeapName(const TraceRecord& record, char* out) noexcept {
+        std::memcpy(out, &record.m_Address, TRACE_NAME_BYTES);
+        out[TRACE_NAME_BYTES] = '\0';
+    }
+}
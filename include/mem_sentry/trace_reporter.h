@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "mem_sentry/alloc_header.h"
+#include "mem_sentry/constants.h"
+#include "mem_sentry/reporter.h"
+#include "mem_sentry/trace_format.h"
+
+namespace MEM_SENTRY::reporter {
+
+    /**
+     * @class BinaryTraceReporter
+     * @brief Streams every event as a fixed 32-byte record into a memory-mapped file.
+     *
+     * The file is append-only. Records are written through two mapped windows of
+     * `TRACE_WINDOW_BYTES` each (double buffering): while threads fill one window the
+     * next one is already mapped, and the thread that completes a window unmaps it and
+     * maps the window after the next in its place. A record costs one atomic
+     * fetch_add and a 32-byte copy, without locks, allocation or I/O calls; only the
+     * thread that crosses a window boundary pays for the remap.
+     *
+     * The trace is read back offline with the `memsentry_trace` tool (see tools/).
+     *
+     * @note Heaps are identified by their registry index; the first event of each
+     * heap, including a later heap that reuses the index, is preceded by a HeapName record.
+     * @note Attach it to heaps directly: behind an AsyncReporter it would only see
+     * header copies and record their addresses.
+     * @note Detach the reporter from every heap before destroying it; the destructor
+     * trims the file and writes the final record count.
+     */
+    class BinaryTraceReporter : public IReporter {
+    private:
+        /** @brief One mapped slice of the file. */
+        struct alignas(constants::CACHE_LINE_SIZE) Window {
+            /** @brief Index of the first record this window holds, published last. */
+            std::atomic<uint64_t> m_Base{0};
+
+            /** @brief Records written into this window so far. */
+            std::atomic<uint64_t> m_Written{0};
+
+            /** @brief Mapped memory, nullptr if mapping failed. */
+            trace::TraceRecord* p_Data{nullptr};
+        };
+
+        /** @brief Records per window. */
+        static constexpr uint64_t RECORDS_PER_WINDOW = trace::TRACE_WINDOW_BYTES / sizeof(trace::TraceRecord);
+
+        /** @brief File descriptor of the trace, -1 if it couldn't be opened. */
+        int m_Fd{-1};
+
+        /** @brief File offset of record 0. */
+        uint64_t m_DataOffset{0};
+
+        /** @brief Next record index to hand out. */
+        alignas(constants::CACHE_LINE_SIZE) std::atomic<uint64_t> m_Next{0};
+
+        /** @brief The two windows; window `w` lives in `m_Windows[w & 1]`. */
+        Window m_Windows[2];
+
+        /**
+         * @brief Per heap index, the Heap::GetGeneration() of the heap whose HeapName
+         * record was written last (0: none), so a heap reusing an index is named again.
+         */
+        std::atomic<uint32_t> m_Named[constants::MAX_HEAPS];
+
+        /** @brief Timestamps are relative to this point. */
+        std::chrono::steady_clock::time_point m_Start;
+
+        /**
+         * @brief Maps window `window` of the file (growing the file first).
+         * @return trace::TraceRecord* The mapping, or nullptr on failure.
+         */
+        trace::TraceRecord* mapWindow(uint64_t window) noexcept;
+
+        /**
+         * @brief Reserves the next record slot and copies `record` into it.
+         */
+        void append(const trace::TraceRecord& record) noexcept;
+
+        /**
+         * @brief Turns an event into a record (and a HeapName record the first time).
+         */
+        void write(trace::TraceRecordType type, alloc_header::AllocHeader* alloc) noexcept;
+
+    public:
+        /**
+         * @brief Create (truncate) the trace file and map its first two windows.
+         * @param path File to write. Check IsOpen() afterwards.
+         */
+        explicit BinaryTraceReporter(const char* path);
+
+        /**
+         * @brief Trim the file to the records written and store their count.
+         */
+        ~BinaryTraceReporter();
+
+        BinaryTraceReporter(const BinaryTraceReporter&) = delete;
+        BinaryTraceReporter& operator=(const BinaryTraceReporter&) = delete;
+
+        /**
+         * @brief Returns true if the file was created and mapped.
+         */
+        bool IsOpen() const noexcept { return m_Fd >= 0; }
+
+        /**
+         * @brief Number of records written (or being written) so far.
+         */
+        uint64_t GetRecordCount() const noexcept {
+            return m_Next.load(std::memory_order_relaxed);
+        }
+
+        virtual void onAlloc(alloc_header::AllocHeader* alloc) override;
+        virtual void onDealloc(alloc_header::AllocHeader* alloc) override;
+        virtual void report(alloc_header::AllocHeader* alloc) override;
+    };
+}
@@ -0,0 +1,167 @@
+#include <new>
+
+#include "mem_sentry/arena_heap.h"
+#include "mem_sentry/alloc_header.h"
+#include "mem_sentry/mem_sentry.h"
+
+MEM_SENTRY::heap::ArenaHeap::ArenaHeap(const char* name, size_t chunkSize, TrackingMode mode)
+    : Heap(name, mode), m_ChunkSize(chunkSize ? chunkSize : constants::ARENA_CHUNK_SIZE) {
+    m_IsArena = true;
+}
+
+MEM_SENTRY::heap::ArenaHeap::~ArenaHeap(){
+    Release();
+}
+
+void* MEM_SENTRY::heap::ArenaHeap::bump(ArenaChunk* chunk, size_t size, size_t alignment) noexcept {
+    if(size > chunk->m_Capacity)
+        return nullptr;
+
+    uintptr_t data = (uintptr_t)chunk->Data();
+    size_t mask = alignment - 1;
+
+    size_t used = chunk->m_Used.load(std::memory_order_relaxed);
+    size_t start;
+
+    do {
+        // the byte right before every object holds its kind, for the free path.
+        start = ((data + used + 1 + mask) & ~mask) - data;
+
+        if(start + size > chunk->m_Capacity)
+            return nullptr;
+    } while(!chunk->m_Used.compare_exchange_weak(used, start + size,
+        std::memory_order_relaxed, std::memory_order_relaxed));
+
+    char* pMem = (char*)data + start;
+    *(reinterpret_cast<alloc_header::BlockKind*>(pMem) - 1) = alloc_header::BlockKind::Arena;
+
+    return pMem;
+}
+
+MEM_SENTRY::heap::ArenaChunk* MEM_SENTRY::heap::ArenaHeap::newChunk(size_t bytes){
+    // a tracked block of this heap: the counters and the reporter see it like any other.
+    void* mem = sentry_allocate(sizeof(ArenaChunk) + bytes, this);
+
+    if(!mem)
+        return nullptr;
+
+    ArenaChunk* chunk = static_cast<ArenaChunk*>(mem);
+    chunk->p_Next = p_Chunks;
+    chunk->m_Capacity = bytes;
+    new (&chunk->m_Used) std::atomic<size_t>(0);
+
+    p_Chunks = chunk;
+    ++m_ChunkCount;
+
+    return chunk;
+}
+
+void MEM_SENTRY::heap::ArenaHeap::freeChunks(ArenaChunk* keep){
+    ArenaChunk* chunk = p_Chunks;
+
+    while(chunk){
+        ArenaChunk* next = chunk->p_Next;
+
+        if(chunk != keep){
+            sentry_deallocate(chunk);
+        }
+
+        chunk = next;
+    }
+
+    p_Chunks = keep;
+    m_ChunkCount = keep ? 1 : 0;
+
+    if(keep){
+        keep->p_Next = nullptr;
+    }
+}
+
+void* MEM_SENTRY::heap::ArenaHeap::Allocate(size_t size, size_t alignment){
+    if(size == 0)
+        size = 1;
+
+    if(alignment < constants::ARENA_MIN_ALIGNMENT)
+        alignment = constants::ARENA_MIN_ALIGNMENT;
+
+    // room for the kind byte and the worst-case padding.
+    size_t worst = size + alignment;
+
+    // big objects get a chunk of their own instead of wasting the rest of the current one.
+    if(worst > m_ChunkSize / 4){
+        std::lock_guard<std::mutex> lock(m_GrowMutex);
+
+        ArenaChunk* chunk = newChunk(worst);
+        return chunk ? bump(chunk, size, alignment) : nullptr;
+    }
+
+    while(true){
+        ArenaChunk* chunk = p_Current.load(std::memory_order_acquire);
+
+        if(chunk){
+            if(void* pMem = bump(chunk, size, alignment))
+                return pMem;
+        }
+
+        std::lock_guard<std::mutex> lock(m_GrowMutex);
+
+        // another thread added a chunk while this one waited: bump from that.
+        if(p_Current.load(std::memory_order_relaxed) != chunk)
+            continue;
+
+        ArenaChunk* fresh = newChunk(m_ChunkSize);
+
+        if(!fresh)
+            return nullptr;
+
+        p_Current.store(fresh, std::memory_order_release);
+    }
+}
+
+void MEM_SENTRY::heap::ArenaHeap::Reset(){
+    std::lock_guard<std::mutex> lock(m_GrowMutex);
+
+    ArenaChunk* keep = p_Current.load(std::memory_order_relaxed);
+
+    freeChunks(keep);
+
+    if(keep){
+        keep->m_Used.store(0, std::memory_order_relaxed);
+    }
+}
+
+void MEM_SENTRY::heap::ArenaHeap::Release(){
+    std::lock_guard<std::mutex> lock(m_GrowMutex);
+
+    p_Current.store(nullptr, std::memory_order_relaxed);
+    freeChunks(nullptr);
+}
+
+size_t MEM_SENTRY::heap::ArenaHeap::GetUsed(){
+    std::lock_guard<std::mutex> lock(m_GrowMutex);
+
+    size_t used = 0;
+
+    for(ArenaChunk* chunk = p_Chunks; chunk; chunk = chunk->p_Next){
+        used += chunk->m_Used.load(std::memory_order_relaxed);
+    }
+
+    return used;
+}
+
+size_t MEM_SENTRY::heap::ArenaHeap::GetCapacity(){
+    std::lock_guard<std::mutex> lock(m_GrowMutex);
+
+    size_t capacity = 0;
+
+    for(ArenaChunk* chunk = p_Chunks; chunk; chunk = chunk->p_Next){
+        capacity += chunk->m_Capacity;
+    }
+
+    return capacity;
+}
+
+size_t MEM_SENTRY::heap::ArenaHeap::GetChunkCount(){
+    std::lock_guard<std::mutex> lock(m_GrowMutex);
+    return m_ChunkCount;
+}
@@ -0,0 +1,162 @@
+#include "mem_sentry/async_reporter.h"
+#include "mem_sentry/thread_slot.h"
+
+namespace {
+    /** @brief set on the drain thread, whose own allocations are not reported. */
+    thread_local bool t_InDrain = false;
+
+    /** @brief events replayed from one slot before moving to the next one. */
+    constexpr size_t DRAIN_BATCH = 64;
+}
+
+MEM_SENTRY::reporter::AsyncReporter::AsyncReporter(IReporter* target, size_t ringCapacity,
+    std::chrono::microseconds interval) : p_Target(target), m_Interval(interval) {
+
+    // the waste-one-slot ring needs at least two entries.
+    if(ringCapacity < 2){
+        ringCapacity = 2;
+    }
+
+    // every slot is allocated up front: the producer side must never allocate.
+    m_Slots.reserve(constants::THREAD_SLOTS);
+    for(size_t i = 0; i < constants::THREAD_SLOTS; ++i){
+        m_Slots.push_back(std::make_unique<Slot>(ringCapacity));
+    }
+
+    m_Worker = std::thread(&AsyncReporter::run, this);
+}
+
+MEM_SENTRY::reporter::AsyncReporter::~AsyncReporter(){
+    m_Stop.store(true, std::memory_order_release);
+
+    if(m_Worker.joinable()){
+        m_Worker.join();
+    }
+
+    // the drain thread is gone, this thread is now the only consumer.
+    t_InDrain = true;
+    drain();
+    t_InDrain = false;
+}
+
+void MEM_SENTRY::reporter::AsyncReporter::enqueue(EventType type, alloc_header::AllocHeader* alloc) noexcept {
+    if(!alloc || t_InDrain)
+        return;
+
+    Slot& slot = *m_Slots[thread_slot::Current()];
+
+    // only collides when more threads than THREAD_SLOTS report at once.
+    if(slot.m_Busy.exchange(true, std::memory_order_acquire)){
+        m_Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto* buffer = slot.m_Free.pop();
+
+    if(!buffer){
+        slot.m_Busy.store(false, std::memory_order_release);
+        m_Dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ReportEvent& event = buffer->m_Buffer;
+    alloc_header::CopyHeader(alloc, event.m_Copy);
+    event.m_Type = type;
+
+    // can't fail: both rings have the same capacity.
+    slot.m_Filled.push(buffer);
+
+    slot.m_Busy.store(false, std::memory_order_release);
+}
+
+size_t MEM_SENTRY::reporter::AsyncReporter::drain(){
+    size_t total = 0;
+
+    std::lock_guard<std::mutex> lock(m_TargetMutex);
+
+    bool pending = true;
+    while(pending){
+        pending = false;
+
+        for(auto& slot : m_Slots){
+            size_t batch = 0;
+
+            while(batch < DRAIN_BATCH){
+                auto* buffer = slot->m_Filled.pop();
+
+                if(!buffer)
+                    break;
+
+                ReportEvent& event = buffer->m_Buffer;
+
+                if(p_Target){
+                    if(event.m_Type == EventType::Alloc){
+                        p_Target->onAlloc(&event.m_Copy.m_Header);
+                    } else {
+                        p_Target->onDealloc(&event.m_Copy.m_Header);
+                    }
+                }
+
+                slot->m_Free.push(buffer);
+                ++batch;
+            }
+
+            // a full batch means the slot may still have events, come back to it.
+            pending = pending || batch == DRAIN_BATCH;
+            total += batch;
+        }
+    }
+
+    m_Delivered.fetch_add(total, std::memory_order_relaxed);
+
+    return total;
+}
+
+void MEM_SENTRY::reporter::AsyncReporter::run(){
+    t_InDrain = true;
+
+    while(!m_Stop.load(std::memory_order_acquire)){
+        // read the request first: events queued before it are visible to this pass.
+        uint64_t request = m_FlushRequest.load(std::memory_order_acquire);
+
+        size_t drained = drain();
+
+        m_FlushDone.store(request, std::memory_order_release);
+
+        if(drained == 0 && m_FlushRequest.load(std::memory_order_acquire) == request){
+            std::this_thread::sleep_for(m_Interval);
+        }
+    }
+}
+
+void MEM_SENTRY::reporter::AsyncReporter::onAlloc(alloc_header::AllocHeader* alloc) {
+    enqueue(EventType::Alloc, alloc);
+}
+
+void MEM_SENTRY::reporter::AsyncReporter::onDealloc(alloc_header::AllocHeader* alloc) {
+    enqueue(EventType::Dealloc, alloc);
+}
+
+void MEM_SENTRY::reporter::AsyncReporter::report(alloc_header::AllocHeader* alloc) {
+    std::lock_guard<std::mutex> lock(m_TargetMutex);
+
+    if(p_Target){
+        p_Target->report(alloc);
+    }
+}
+
+void MEM_SENTRY::reporter::AsyncReporter::onCorruption(alloc_header::AllocHeader* alloc, canary::Corruption corruption) {
+    std::lock_guard<std::mutex> lock(m_TargetMutex);
+
+    if(p_Target){
+        p_Target->onCorruption(alloc, corruption);
+    }
+}
+
+void MEM_SENTRY::reporter::AsyncReporter::Flush(){
+    uint64_t ticket = m_FlushRequest.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+    while(m_FlushDone.load(std::memory_order_acquire) < ticket && !m_Stop.load(std::memory_order_acquire)){
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,308 @@
+#include <atomic>
+#include <cstdlib>
+#include <execinfo.h>
+#include <new>
+#include <pthread.h>
+
+#include "mem_sentry/callsite.h"
+
+namespace {
+    /**
+     * @brief One call stack of the table.
+     * A slot is claimed by CAS on `m_Hash`; the frames are published by the
+     * release store of a nonzero `m_Depth`.
+     */
+    struct Slot {
+        /** @brief Hash of the frames, 0 while the slot is free. */
+        std::atomic<uint64_t> m_Hash;
+
+        /** @brief Number of frames, 0 until they are written. */
+        std::atomic<uint32_t> m_Depth;
+
+        /** @brief Return addresses, innermost first. */
+        void* p_Frames[MEM_SENTRY::constants::CALLSITE_MAX_DEPTH];
+
+        std::atomic<int64_t> m_LiveBytes;
+        std::atomic<int64_t> m_LiveCount;
+        std::atomic<uint64_t> m_TotalAllocs;
+        std::atomic<uint64_t> m_TotalBytes;
+    };
+
+    static_assert((MEM_SENTRY::constants::CALLSITE_TABLE_SIZE & (MEM_SENTRY::constants::CALLSITE_TABLE_SIZE - 1)) == 0,
+        "the callsite table size must be a power of 2");
+
+    /** @brief The table, nullptr until the first capture. */
+    std::atomic<Slot*> g_Table{nullptr};
+
+    std::atomic<uint64_t> g_Dropped{0};
+    std::atomic<size_t> g_SiteCount{0};
+
+    /**
+     * @brief Returns the table, allocating it on first use.
+     * @note malloc instead of new: captures run inside the allocation path.
+     */
+    Slot* table() noexcept {
+        static Slot* slots = []() noexcept {
+            Slot* mem = static_cast<Slot*>(std::calloc(MEM_SENTRY::constants::CALLSITE_TABLE_SIZE, sizeof(Slot)));
+
+            if(mem){
+                for(size_t i = 0; i < MEM_SENTRY::constants::CALLSITE_TABLE_SIZE; ++i){
+                    new (&mem[i]) Slot();
+                }
+            }
+
+            g_Table.store(mem, std::memory_order_release);
+            return mem;
+        }();
+
+        return slots;
+    }
+
+    /** @brief Stack range of the calling thread, read once per thread. */
+    struct StackBounds {
+        uintptr_t m_Low{0};
+        uintptr_t m_High{0};
+        bool m_Known{false};
+    };
+
+    const StackBounds& stackBounds() noexcept {
+        thread_local StackBounds bounds;
+
+        if(!bounds.m_Known){
+            bounds.m_Known = true;
+
+            pthread_attr_t attr;
+
+            if(pthread_getattr_np(pthread_self(), &attr) == 0){
+                void* addr;
+                size_t size;
+
+                if(pthread_attr_getstack(&attr, &addr, &size) == 0){
+                    bounds.m_Low = (uintptr_t)addr;
+                    bounds.m_High = (uintptr_t)addr + size;
+                }
+
+                pthread_attr_destroy(&attr);
+            }
+        }
+
+        return bounds;
+    }
+
+    /**
+     * @brief Follows the frame-pointer chain starting at the frame record `fp`.
+     * Stops at the first frame outside the stack, misaligned, or not above the last one.
+     */
+    size_t unwind(void** fp, void** frames, size_t depth, size_t skip) noexcept {
+        const StackBounds& bounds = stackBounds();
+        size_t count = 0;
+
+        while(count < depth){
+            uintptr_t frame = (uintptr_t)fp;
+
+            if(frame < bounds.m_Low || frame + 2 * sizeof(void*) > bounds.m_High || (frame & (sizeof(void*) - 1)))
+                break;
+
+            void** next = static_cast<void**>(fp[0]);
+            void* ret = fp[1];
+
+            if(!ret)
+                break;
+
+            if(skip){
+                --skip;
+            } else {
+                frames[count++] = ret;
+            }
+
+            // the stack grows down: every caller's frame sits above its callee's.
+            if((uintptr_t)next <= frame)
+                break;
+
+            fp = next;
+        }
+
+        return count;
+    }
+
+    uint64_t hashFrames(void* const* frames, size_t depth) noexcept {
+        uint64_t h = depth;
+
+        for(size_t i = 0; i < depth; ++i){
+            h ^= (uint64_t)(uintptr_t)frames[i];
+            h *= 0x9E3779B97F4A7C15ull;
+            h ^= h >> 29;
+        }
+
+        // 0 marks a free slot.
+        return h ? h : 1;
+    }
+
+    bool sameFrames(const Slot& slot, uint32_t depth, void* const* frames, size_t count) noexcept {
+        if(depth != count)
+            return false;
+
+        for(size_t i = 0; i < count; ++i){
+            if(slot.p_Frames[i] != frames[i])
+                return false;
+        }
+
+        return true;
+    }
+
+    void copySite(const Slot& slot, uint32_t id, uint32_t depth, MEM_SENTRY::callsite::CallSite& site) noexcept {
+        site.m_Id = id;
+        site.m_Depth = depth;
+
+        for(uint32_t i = 0; i < depth; ++i){
+            site.p_Frames[i] = slot.p_Frames[i];
+        }
+
+        site.m_LiveBytes = slot.m_LiveBytes.load(std::memory_order_relaxed);
+        site.m_LiveCount = slot.m_LiveCount.load(std::memory_order_relaxed);
+        site.m_TotalAllocs = slot.m_TotalAllocs.load(std::memory_order_relaxed);
+        site.m_TotalBytes = slot.m_TotalBytes.load(std::memory_order_relaxed);
+    }
+
+    /** @brief Slot of a stack id, nullptr if there is none. */
+    Slot* find(uint32_t id) noexcept {
+        if(id == MEM_SENTRY::constants::CALLSITE_NO_STACK || id > MEM_SENTRY::constants::CALLSITE_TABLE_SIZE)
+            return nullptr;
+
+        Slot* slots = g_Table.load(std::memory_order_acquire);
+        return slots ? &slots[id - 1] : nullptr;
+    }
+}
+
+uint32_t MEM_SENTRY::callsite::Capture(size_t depth, size_t skip) noexcept {
+    if(depth > constants::CALLSITE_MAX_DEPTH)
+        depth = constants::CALLSITE_MAX_DEPTH;
+
+    void* frames[constants::CALLSITE_MAX_DEPTH];
+
+    // taking the frame address gives Capture() a frame record even when frame pointers are omitted.
+    size_t count = unwind(static_cast<void**>(__builtin_frame_address(0)), frames, depth, skip);
+
+    if(count == 0)
+        return constants::CALLSITE_NO_STACK;
+
+    Slot* slots = table();
+
+    if(!slots)
+        return constants::CALLSITE_NO_STACK;
+
+    const uint64_t hash = hashFrames(frames, count);
+    const size_t mask = constants::CALLSITE_TABLE_SIZE - 1;
+    size_t index = hash & mask;
+
+    for(size_t probe = 0; probe < constants::CALLSITE_MAX_PROBES; ++probe, index = (index + 1) & mask){
+        Slot& slot = slots[index];
+        uint64_t current = slot.m_Hash.load(std::memory_order_acquire);
+
+        if(current == 0){
+            if(slot.m_Hash.compare_exchange_strong(current, hash, std::memory_order_acq_rel)){
+                for(size_t i = 0; i < count; ++i){
+                    slot.p_Frames[i] = frames[i];
+                }
+
+                slot.m_Depth.store((uint32_t)count, std::memory_order_release);
+                g_SiteCount.fetch_add(1, std::memory_order_relaxed);
+
+                return (uint32_t)index + 1;
+            }
+
+            // another thread claimed it first: `current` now holds its hash.
+        }
+
+        if(current == hash){
+            uint32_t slotDepth = slot.m_Depth.load(std::memory_order_acquire);
+
+            // a slot still being written has the same hash, which is as good as a match.
+            if(slotDepth == 0 || sameFrames(slot, slotDepth, frames, count))
+                return (uint32_t)index + 1;
+        }
+    }
+
+    g_Dropped.fetch_add(1, std::memory_order_relaxed);
+    return constants::CALLSITE_NO_STACK;
+}
+
+void MEM_SENTRY::callsite::Account(uint32_t id, int64_t bytes, int64_t count) noexcept {
+    Slot* slot = find(id);
+
+    if(!slot)
+        return;
+
+    slot->m_LiveBytes.fetch_add(bytes, std::memory_order_relaxed);
+    slot->m_LiveCount.fetch_add(count, std::memory_order_relaxed);
+
+    if(count > 0){
+        slot->m_TotalAllocs.fetch_add((uint64_t)count, std::memory_order_relaxed);
+        slot->m_TotalBytes.fetch_add((uint64_t)bytes, std::memory_order_relaxed);
+    }
+}
+
+bool MEM_SENTRY::callsite::GetSite(uint32_t id, CallSite& site) noexcept {
+    Slot* slot = find(id);
+
+    if(!slot)
+        return false;
+
+    uint32_t depth = slot->m_Depth.load(std::memory_order_acquire);
+
+    if(depth == 0)
+        return false;
+
+    copySite(*slot, id, depth, site);
+    return true;
+}
+
+size_t MEM_SENTRY::callsite::TopSites(CallSite* sites, size_t max) noexcept {
+    Slot* slots = g_Table.load(std::memory_order_acquire);
+
+    if(!slots || max == 0)
+        return 0;
+
+    size_t count = 0;
+
+    for(size_t i = 0; i < constants::CALLSITE_TABLE_SIZE; ++i){
+        const Slot& slot = slots[i];
+        uint32_t depth = slot.m_Depth.load(std::memory_order_acquire);
+
+        if(depth == 0)
+            continue;
+
+        int64_t live = slot.m_LiveBytes.load(std::memory_order_relaxed);
+
+        if(count == max && live <= sites[max - 1].m_LiveBytes)
+            continue;
+
+        // insertion into the sorted output, the smallest falls off the end when full.
+        size_t pos = count < max ? count++ : max - 1;
+
+        while(pos > 0 && sites[pos - 1].m_LiveBytes < live){
+            sites[pos] = sites[pos - 1];
+            --pos;
+        }
+
+        copySite(slot, (uint32_t)i + 1, depth, sites[pos]);
+    }
+
+    return count;
+}
+
+size_t MEM_SENTRY::callsite::GetSiteCount() noexcept {
+    return g_SiteCount.load(std::memory_order_relaxed);
+}
+
+uint64_t MEM_SENTRY::callsite::GetDropped() noexcept {
+    return g_Dropped.load(std::memory_order_relaxed);
+}
+
+void MEM_SENTRY::callsite::Print(uint32_t id, int fd) noexcept {
+    CallSite site;
+
+    if(GetSite(id, site)){
+        backtrace_symbols_fd(site.p_Frames, (int)site.m_Depth, fd);
+    }
+}
@@ -1,11 +1,14 @@
 #include "mem_sentry/reporter.h"
 #include "mem_sentry/heap.h"
+#include "mem_sentry/callsite.h"
+#include <cstdio>
 #include <iostream>
 #include <iomanip>
 
 
 void MEM_SENTRY::reporter::ConsoleReporter::onAlloc(alloc_header::AllocHeader* alloc) {
-    if (!alloc || !alloc->p_Heap) return;
+    heap::Heap* pHeap = alloc ? alloc_header::GetHeap(alloc) : nullptr;
+    if (!pHeap) return;
 
     const char* CLR_BORDER = "\033[36m";   // Cyan
     const char* CLR_LABEL  = "\033[1;37m"; // Bold White
@@ -13,7 +16,7 @@ void MEM_SENTRY::reporter::ConsoleReporter::onAlloc(alloc_header::AllocHeader* a
     const char* CLR_RESET  = "\033[0m";
     const char* CLR_EVENT  = "\033[1;32m"; // Bold Green (ALLOC)
 
-    int size = alloc->m_Size + alloc->m_Alignment;
+    int size = alloc->m_Size + (int)alloc_header::GetAlignment(alloc);
 
     std::cout << CLR_BORDER
               << "╔══════════════════════ ALLOCATION ══════════════════════╗"
@@ -24,16 +27,16 @@ void MEM_SENTRY::reporter::ConsoleReporter::onAlloc(alloc_header::AllocHeader* a
 
     std::printf("%s║%s Heap:           %s%-38s %s║%s\n",
         CLR_BORDER, CLR_LABEL, CLR_VAL,
-        alloc->p_Heap->GetName(), CLR_BORDER, CLR_RESET);
+        pHeap->GetName(), CLR_BORDER, CLR_RESET);
 
     std::printf("%s║%s Size:           %s%-6d bytes (Align: %-2d)        %s║%s\n",
         CLR_BORDER, CLR_LABEL, CLR_VAL,
-        alloc->m_Size, alloc->m_Alignment,
+        alloc->m_Size, (int)alloc_header::GetAlignment(alloc),
         CLR_BORDER, CLR_RESET);
 
-    std::printf("%s║%s Heap Total:     %s%-38d %s║%s\n",
+    std::printf("%s║%s Heap Total:     %s%-38lld %s║%s\n",
         CLR_BORDER, CLR_LABEL, CLR_VAL,
-        alloc->p_Heap->GetTotal(), CLR_BORDER, CLR_RESET);
+        (long long)pHeap->GetTotal(), CLR_BORDER, CLR_RESET);
 
     std::cout << CLR_BORDER
               << "╚═════════════════════════════════════════════════════════╝"
@@ -41,7 +44,8 @@ void MEM_SENTRY::reporter::ConsoleReporter::onAlloc(alloc_header::AllocHeader* a
 }
 
 void MEM_SENTRY::reporter::ConsoleReporter::onDealloc(alloc_header::AllocHeader* alloc) {
-    if (!alloc || !alloc->p_Heap) return;
+    heap::Heap* pHeap = alloc ? alloc_header::GetHeap(alloc) : nullptr;
+    if (!pHeap) return;
 
     const char* CLR_BORDER = "\033[36m";   // Cyan
     const char* CLR_LABEL  = "\033[1;37m"; // Bold White
@@ -49,7 +53,7 @@ void MEM_SENTRY::reporter::ConsoleReporter::onDealloc(alloc_header::AllocHeader*
     const char* CLR_RESET  = "\033[0m";
     const char* CLR_EVENT  = "\033[1;31m"; // Bold Red (DEALLOC)
 
-    int size = alloc->m_Size + alloc->m_Alignment;
+    int size = alloc->m_Size + (int)alloc_header::GetAlignment(alloc);
 
     std::cout << CLR_BORDER
               << "╔════════════════════ DEALLOCATION ═════════════════════╗"
@@ -60,16 +64,16 @@ void MEM_SENTRY::reporter::ConsoleReporter::onDealloc(alloc_header::AllocHeader*
 
     std::printf("%s║%s Heap:           %s%-38s %s║%s\n",
         CLR_BORDER, CLR_LABEL, CLR_VAL,
-        alloc->p_Heap->GetName(), CLR_BORDER, CLR_RESET);
+        pHeap->GetName(), CLR_BORDER, CLR_RESET);
 
     std::printf("%s║%s Freed:          %s%-6d bytes (Align: %-2d)        %s║%s\n",
         CLR_BORDER, CLR_LABEL, CLR_VAL,
-        alloc->m_Size, alloc->m_Alignment,
+        alloc->m_Size, (int)alloc_header::GetAlignment(alloc),
         CLR_BORDER, CLR_RESET);
 
-    std::printf("%s║%s Heap Total:     %s%-38d %s║%s\n",
+    std::printf("%s║%s Heap Total:     %s%-38lld %s║%s\n",
         CLR_BORDER, CLR_LABEL, CLR_VAL,
-        alloc->p_Heap->GetTotal(), CLR_BORDER, CLR_RESET);
+        (long long)pHeap->GetTotal(), CLR_BORDER, CLR_RESET);
 
     std::cout << CLR_BORDER
               << "╚═════════════════════════════════════════════════════════╝"
@@ -92,11 +96,18 @@ void MEM_SENTRY::reporter::ConsoleReporter::report(alloc_header::AllocHeader* p_
     std::printf("%s║%s %-15s %s%-38d %s║%s\n", 
         CLR_BORDER, CLR_LABEL, "Allocation ID:", CLR_VAL, p_Alloc->m_AllocId, CLR_BORDER, CLR_RESET);
     
+#if MEM_SENTRY_COMPACT_HEADER
+    // the compact layout uses the block kind as its signature.
+    std::printf("%s║%s %-15s %s0x%-36X %s║%s\n", 
+        CLR_BORDER, CLR_LABEL, "Signature:", CLR_VAL, (unsigned)p_Alloc->m_Kind, CLR_BORDER, CLR_RESET);
+#else
     std::printf("%s║%s %-15s %s0x%-36X %s║%s\n", 
         CLR_BORDER, CLR_LABEL, "Signature:", CLR_VAL, p_Alloc->m_Signature, CLR_BORDER, CLR_RESET);
+#endif
 
     // Heap Info
-    const char* heapName = p_Alloc->p_Heap ? p_Alloc->p_Heap->GetName() : "ORPHANED/UNKNOWN";
+    heap::Heap* pHeap = alloc_header::GetHeap(p_Alloc);
+    const char* heapName = pHeap ? pHeap->GetName() : "ORPHANED/UNKNOWN";
     std::printf("%s║%s %-15s %s%-38s %s║%s\n", 
         CLR_BORDER, CLR_LABEL, "Heap Name:", CLR_VAL, heapName, CLR_BORDER, CLR_RESET);
 
@@ -110,21 +121,72 @@ void MEM_SENTRY::reporter::ConsoleReporter::report(alloc_header::AllocHeader* p_
         CLR_VAL,                // 4 (%s)
         p_Alloc->m_Size,        // 5 (%-6d)
         CLR_LABEL,              // 6 (%s) - NEW: Added this to fix the count
-        p_Alloc->m_Alignment,   // 7 (%-2d)
+        (int)alloc_header::GetAlignment(p_Alloc), // 7 (%-2d)
         CLR_BORDER,             // 8 (%s)
         CLR_RESET               // 9 (%s)
     );
 
     // Address Info
     std::printf("%s║%s %-15s %s%p                           %s║%s\n", 
-        CLR_BORDER, CLR_LABEL, "Raw Address:", CLR_VAL, p_Alloc->p_OriginalAddress, CLR_BORDER, CLR_RESET);
+        CLR_BORDER, CLR_LABEL, "Raw Address:", CLR_VAL, alloc_header::GetOriginalAddress(p_Alloc), CLR_BORDER, CLR_RESET);
+
+    // Call Site Info (see Heap::SetCallSiteDepth())
+    const uint32_t stackId = alloc_header::GetStackId(p_Alloc);
+    if (stackId != constants::CALLSITE_NO_STACK) {
+        std::printf("%s║%s %-15s %s#%-37u %s║%s\n", 
+            CLR_BORDER, CLR_LABEL, "Call Site:", CLR_VAL, stackId, CLR_BORDER, CLR_RESET);
+    }
 
     // Footer with Heap Total
-    if (p_Alloc->p_Heap) {
+    if (pHeap) {
         std::cout << CLR_BORDER << "╠----------------------------------------------------------╣" << CLR_RESET << "\n";
-        std::printf("%s║%s %-15s %s%-31d bytes %s║%s\n", 
-            CLR_BORDER, CLR_LABEL, "Heap Total Now:", CLR_VAL, p_Alloc->p_Heap->GetTotal(), CLR_BORDER, CLR_RESET);
+        std::printf("%s║%s %-15s %s%-31lld bytes %s║%s\n", 
+            CLR_BORDER, CLR_LABEL, "Heap Total Now:", CLR_VAL, (long long)pHeap->GetTotal(), CLR_BORDER, CLR_RESET);
+    }
+
+    std::cout << CLR_BORDER << "╚══════════════════════════════════════════════════════════╝" << CLR_RESET << "\n";
+
+    // the frames go straight to the descriptor, after everything buffered so far.
+    if (stackId != constants::CALLSITE_NO_STACK) {
+        std::cout.flush();
+        std::fflush(stdout);
+        callsite::Print(stackId, fileno(stdout));
     }
 
-    std::cout << CLR_BORDER << "╚══════════════════════════════════════════════════════════╝" << CLR_RESET << "\n" << std::endl;
+    std::cout << std::endl;
+}
+
+void MEM_SENTRY::reporter::ConsoleReporter::onCorruption(alloc_header::AllocHeader* alloc, canary::Corruption corruption) {
+    heap::Heap* pHeap = alloc ? alloc_header::GetHeap(alloc) : nullptr;
+    if (!pHeap) return;
+
+    const char* CLR_BORDER = "\033[36m";   // Cyan
+    const char* CLR_LABEL  = "\033[1;37m"; // Bold White
+    const char* CLR_VAL    = "\033[33m";   // Yellow
+    const char* CLR_RESET  = "\033[0m";
+    const char* CLR_EVENT  = "\033[1;31m"; // Bold Red (CORRUPTION)
+
+    std::cout << CLR_BORDER
+              << "╔═════════════════════ CORRUPTION ══════════════════════╗"
+              << CLR_RESET << "\n";
+
+    std::printf("%s║%s Event:          %s%-38s%s %s║%s\n",
+        CLR_BORDER, CLR_EVENT, CLR_EVENT, canary::CorruptionName(corruption), CLR_RESET, CLR_BORDER, CLR_RESET);
+
+    std::printf("%s║%s Heap:           %s%-38s %s║%s\n",
+        CLR_BORDER, CLR_LABEL, CLR_VAL,
+        pHeap->GetName(), CLR_BORDER, CLR_RESET);
+
+    std::printf("%s║%s Allocation ID:  %s%-38u %s║%s\n",
+        CLR_BORDER, CLR_LABEL, CLR_VAL,
+        alloc->m_AllocId, CLR_BORDER, CLR_RESET);
+
+    std::printf("%s║%s Size:           %s%-6d bytes (Align: %-2d)        %s║%s\n",
+        CLR_BORDER, CLR_LABEL, CLR_VAL,
+        alloc->m_Size, (int)alloc_header::GetAlignment(alloc),
+        CLR_BORDER, CLR_RESET);
+
+    std::cout << CLR_BORDER
+              << "╚═════════════════════════════════════════════════════════╝"
+              << CLR_RESET << "\n";
 }
@@ -1,18 +1,23 @@
+#include <cassert>
 #include <iostream>
-#include <unordered_set>
 #include <mutex>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#include <cmath>
 
 #include "mem_sentry/heap.h"
 #include "mem_sentry/alloc_header.h"
 
-bool MEM_SENTRY::heap::Heap::addAllocLL(alloc_header::AllocHeader* alloc){
+#if !MEM_SENTRY_COMPACT_HEADER
+bool MEM_SENTRY::heap::Heap::addAllocLL(HeapShard& shard, alloc_header::AllocHeader* alloc){
     if(!alloc) 
         return false;
     
     // if allocations list is empty.
-    if(!p_HeadList){
-        p_HeadList = alloc;
-        p_TailList = alloc;
+    if(!shard.p_Head){
+        shard.p_Head = alloc;
+        shard.p_Tail = alloc;
 
         // initialize links for single node
         alloc->p_Next = nullptr;
@@ -22,46 +27,46 @@ bool MEM_SENTRY::heap::Heap::addAllocLL(alloc_header::AllocHeader* alloc){
     }
     
     // add to the end and update tail.
-    p_TailList->p_Next = alloc;
-    alloc->p_Prev = p_TailList;
+    shard.p_Tail->p_Next = alloc;
+    alloc->p_Prev = shard.p_Tail;
     alloc->p_Next = nullptr;
-    p_TailList = alloc;
+    shard.p_Tail = alloc;
 
     return true;    
 }
 
-bool MEM_SENTRY::heap::Heap::removeAllocLL(alloc_header::AllocHeader* alloc){
+bool MEM_SENTRY::heap::Heap::removeAllocLL(HeapShard& shard, alloc_header::AllocHeader* alloc){
     if(!alloc)
         return false;
     
     // NOTE: this function won't `delete alloc` because this is handled in the overriden delete.
 
     // if allocations list is empty.
-    if(!p_HeadList){
+    if(!shard.p_Head){
         return false;
     }
     
     // only one node
-    if(p_HeadList == p_TailList){
-        p_HeadList = nullptr;
-        p_TailList = nullptr;
+    if(shard.p_Head == shard.p_Tail){
+        shard.p_Head = nullptr;
+        shard.p_Tail = nullptr;
         return true;
     }
 
     // if the alloc is the head.
-    if(alloc == p_HeadList){
-        p_HeadList = alloc->p_Next;
+    if(alloc == shard.p_Head){
+        shard.p_Head = alloc->p_Next;
         
         // always will be valid.
-        p_HeadList->p_Prev = nullptr;
+        shard.p_Head->p_Prev = nullptr;
         
         return true;
     }
 
     // if the alloc is the tail
-    if(alloc == p_TailList){
-        p_TailList = alloc->p_Prev;
-        if(p_TailList) p_TailList->p_Next = nullptr;
+    if(alloc == shard.p_Tail){
+        shard.p_Tail = alloc->p_Prev;
+        if(shard.p_Tail) shard.p_Tail->p_Next = nullptr;
         return true;
     }
     
@@ -75,120 +80,947 @@ bool MEM_SENTRY::heap::Heap::removeAllocLL(alloc_header::AllocHeader* alloc){
     return true;
 }
 
-int MEM_SENTRY::heap::Heap::CountAllocations() noexcept {
-    std::lock_guard<std::mutex> lock(m_llMutex);
+void MEM_SENTRY::heap::Heap::indexAdd(HeapShard& shard, alloc_header::AllocHeader* alloc){
+    if(!shard.m_Indexed)
+        return;
 
-    int count = 0;
-    alloc_header::AllocHeader* tmp = p_HeadList;
-    
-    while(tmp){
-        ++count; 
-        tmp = tmp->p_Next; 
+    uint32_t bucket = alloc->m_AllocId >> constants::ID_BUCKET_SHIFT;
+
+    // blocks are appended in ID order, so only the last entry can match.
+    if(shard.m_BucketCount && shard.p_Buckets[shard.m_BucketCount - 1].m_Bucket == bucket){
+        IdBucket& last = shard.p_Buckets[shard.m_BucketCount - 1];
+
+        if(last.m_Live++ == 0){
+            last.p_First = alloc;
+            --shard.m_DeadBuckets;
+        }
+
+        return;
+    }
+
+    if(shard.m_BucketCount == shard.m_BucketCapacity){
+        // drop dead entries first, growing only when at least half are live.
+        if(shard.m_DeadBuckets * 2 >= shard.m_BucketCount && shard.m_DeadBuckets){
+            uint32_t live = 0;
+
+            for(uint32_t i = 0; i < shard.m_BucketCount; ++i){
+                if(shard.p_Buckets[i].m_Live){
+                    shard.p_Buckets[live++] = shard.p_Buckets[i];
+                }
+            }
+
+            shard.m_BucketCount = live;
+            shard.m_DeadBuckets = 0;
+        } else {
+            uint32_t capacity = shard.m_BucketCapacity ? shard.m_BucketCapacity * 2 : 16;
+
+            // realloc instead of new: we are inside the allocation path.
+            void* buckets = std::realloc(shard.p_Buckets, capacity * sizeof(IdBucket));
+
+            if(!buckets){
+                // keep the list valid, range queries fall back to a walk.
+                shard.m_Indexed = false;
+                return;
+            }
+
+            shard.p_Buckets = static_cast<IdBucket*>(buckets);
+            shard.m_BucketCapacity = capacity;
+        }
+    }
+
+    shard.p_Buckets[shard.m_BucketCount++] = IdBucket{bucket, 1, alloc};
+}
+
+void MEM_SENTRY::heap::Heap::indexRemove(HeapShard& shard, alloc_header::AllocHeader* alloc){
+    if(!shard.m_Indexed)
+        return;
+
+    uint32_t bucket = alloc->m_AllocId >> constants::ID_BUCKET_SHIFT;
+
+    IdBucket* end = shard.p_Buckets + shard.m_BucketCount;
+    IdBucket* entry = std::lower_bound(shard.p_Buckets, end, bucket, [](const IdBucket& b, uint32_t value){
+        return b.m_Bucket < value;
+    });
+
+    if(entry == end || entry->m_Bucket != bucket || entry->m_Live == 0)
+        return;
+
+    if(--entry->m_Live == 0){
+        entry->p_First = nullptr;
+        ++shard.m_DeadBuckets;
+        return;
+    }
+
+    // the bucket still has live blocks after this one, so the next node belongs to it.
+    if(entry->p_First == alloc){
+        entry->p_First = alloc->p_Next;
+    }
+}
+
+MEM_SENTRY::alloc_header::AllocHeader* MEM_SENTRY::heap::Heap::indexFind(HeapShard& shard, uint32_t id){
+    alloc_header::AllocHeader* tmp = shard.p_Head;
+
+    if(shard.m_Indexed){
+        IdBucket* end = shard.p_Buckets + shard.m_BucketCount;
+        IdBucket* entry = std::lower_bound(shard.p_Buckets, end, id >> constants::ID_BUCKET_SHIFT,
+            [](const IdBucket& b, uint32_t value){
+                return b.m_Bucket < value;
+            });
+
+        while(entry != end && entry->m_Live == 0){
+            ++entry;
+        }
+
+        tmp = entry != end ? entry->p_First : nullptr;
+    }
+
+    // at most one bucket worth of blocks below `id`.
+    while(tmp && tmp->m_AllocId < id){
+        tmp = tmp->p_Next;
+    }
+
+    return tmp;
+}
+#else
+bool MEM_SENTRY::heap::Heap::addAllocLL(HeapShard& shard, alloc_header::AllocHeader* alloc){
+    // the last slot marks header copies (see alloc_header::HEADER_COPY_MARK).
+    if(!alloc || shard.m_Count >= alloc_header::HEADER_COPY_MARK)
+        return false;
+
+    // grow the block table, realloc instead of new: we are inside the allocation path.
+    if(shard.m_Count == shard.m_Capacity){
+        uint32_t capacity = shard.m_Capacity ? shard.m_Capacity * 2 : 64;
+
+        if(capacity > (1u << 26))
+            return false;
+
+        void* blocks = std::realloc(shard.p_Blocks, capacity * sizeof(alloc_header::AllocHeader*));
+
+        if(!blocks)
+            return false;
+
+        shard.p_Blocks = static_cast<alloc_header::AllocHeader**>(blocks);
+        shard.m_Capacity = capacity;
+    }
+
+    alloc->m_Slot = shard.m_Count;
+    shard.p_Blocks[shard.m_Count++] = alloc;
+
+    return true;
+}
+
+bool MEM_SENTRY::heap::Heap::removeAllocLL(HeapShard& shard, alloc_header::AllocHeader* alloc){
+    if(!alloc)
+        return false;
+
+    uint32_t slot = alloc->m_Slot;
+
+    if(slot >= shard.m_Count || shard.p_Blocks[slot] != alloc)
+        return false;
+
+    // move the last block into the hole so the table stays dense.
+    alloc_header::AllocHeader* last = shard.p_Blocks[--shard.m_Count];
+    shard.p_Blocks[slot] = last;
+    last->m_Slot = slot;
+
+    return true;
+}
+#endif
+
+namespace {
+    /** @brief Registry mapping heap indices to live heaps. */
+    MEM_SENTRY::heap::Heap* g_Heaps[MEM_SENTRY::constants::MAX_HEAPS];
+
+    /** @brief Generation of the last registered heap, guarded like g_Heaps. */
+    uint32_t g_HeapGeneration = 0;
+
+    /** @brief Guards g_Heaps. */
+    std::mutex& heapRegistryMutex(){
+        // function-local so heaps constructed during static init can register.
+        static std::mutex mutex;
+        return mutex;
+    }
+}
+
+void MEM_SENTRY::heap::Heap::registerHeap(){
+    std::lock_guard<std::mutex> lock(heapRegistryMutex());
+
+    m_Index = static_cast<uint16_t>(constants::MAX_HEAPS);
+    m_Generation = ++g_HeapGeneration;
+
+    for(size_t i = 0; i < constants::MAX_HEAPS; ++i){
+        if(!g_Heaps[i]){
+            g_Heaps[i] = this;
+            m_Index = static_cast<uint16_t>(i);
+            return;
+        }
+    }
+
+#if MEM_SENTRY_COMPACT_HEADER
+    std::printf("Error: more than %zu live heaps, compact headers can't refer to heap \"%s\"\n",
+        constants::MAX_HEAPS, m_name);
+    std::abort();
+#endif
+}
+
+MEM_SENTRY::heap::Heap* MEM_SENTRY::heap::HeapFactory::GetHeapByIndex(uint16_t index) noexcept {
+    if(index >= constants::MAX_HEAPS)
+        return nullptr;
+
+    // heaps register once and unregister in their destructor; a plain read is
+    // enough for any block that is still live.
+    return g_Heaps[index];
+}
+
+void MEM_SENTRY::heap::HeapFactory::ForEachHeap(void (*visit)(Heap* heap, void* context), void* context){
+    std::lock_guard<std::mutex> lock(heapRegistryMutex());
+
+    for(Heap* heap : g_Heaps){
+        if(heap){
+            visit(heap, context);
+        }
+    }
+}
+
+MEM_SENTRY::heap::Heap* MEM_SENTRY::heap::HeapFactory::GetNodeHeap(int node){
+    static std::atomic<Heap*> s_NodeHeaps[constants::MAX_NUMA_NODES];
+    static std::mutex s_NodeHeapsMutex;
+
+    if(node < 0 || node >= numa::NodeCount())
+        return nullptr;
+
+    Heap* heap = s_NodeHeaps[node].load(std::memory_order_acquire);
+
+    if(heap)
+        return heap;
+
+    std::lock_guard<std::mutex> lock(s_NodeHeapsMutex);
+
+    heap = s_NodeHeaps[node].load(std::memory_order_relaxed);
+
+    if(heap)
+        return heap;
+
+    // aligned_alloc instead of new: the heap itself must not be tracked by the default heap.
+    size_t bytes = (sizeof(Heap) + alignof(Heap) - 1) & ~(alignof(Heap) - 1);
+    void* mem = std::aligned_alloc(alignof(Heap), bytes);
+
+    if(!mem)
+        return nullptr;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "NodeHeap%d", node);
+
+    heap = new (mem) Heap(name, TrackingMode::ThreadLocal);
+    heap->SetSlabBackend(true);
+    heap->SetNumaNode(node);
+
+    ConnectHeaps(GetDefaultHeap(), heap);
+
+    s_NodeHeaps[node].store(heap, std::memory_order_release);
+
+    return heap;
+}
+
+MEM_SENTRY::heap::Heap::~Heap(){
+    {
+        // no other heap may keep a pointer to this one past its lifetime.
+        std::lock_guard<std::mutex> lock(Heap::m_graphMutex);
+
+        unlinkHeap(this);
+
+        std::free(p_AdjHeaps);
+        std::free(p_Reach);
+        p_AdjHeaps = nullptr;
+        p_Reach = nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(heapRegistryMutex());
+
+        if(m_Index < constants::MAX_HEAPS && g_Heaps[m_Index] == this){
+            g_Heaps[m_Index] = nullptr;
+        }
+    }
+
+    for(size_t i = 0; i < constants::THREAD_SLOTS; ++i){
+        slab::SlabCache* cache = m_Shards[i].p_Slab;
+
+        if(cache && cache->release()){
+            cache->~SlabCache();
+            std::free(cache);
+            m_Shards[i].p_Slab = nullptr;
+        }
+
+#if !MEM_SENTRY_COMPACT_HEADER
+        if(!m_Shards[i].p_Head){
+            std::free(m_Shards[i].p_Buckets);
+            m_Shards[i].p_Buckets = nullptr;
+        }
+#else
+        if(m_Shards[i].m_Count == 0){
+            std::free(m_Shards[i].p_Blocks);
+            m_Shards[i].p_Blocks = nullptr;
+        }
+#endif
+    }
+}
+
+void* MEM_SENTRY::heap::Heap::SlabAllocate(size_t bytes, uint8_t& shard){
+    if(slab::SlabCache::ClassOf(bytes) == constants::SLAB_CLASSES)
+        return nullptr;
+
+    size_t index = currentShard();
+    HeapShard& slabShard = m_Shards[index];
+    shard = static_cast<uint8_t>(index);
+
+    stats::ShardLock lock(slabShard.m_Mutex);
+
+    if(!slabShard.p_Slab){
+        // malloc instead of new: we are inside the allocation path.
+        void* mem = std::malloc(sizeof(slab::SlabCache));
+
+        if(!mem)
+            return nullptr;
+
+        slabShard.p_Slab = new (mem) slab::SlabCache(static_cast<uint32_t>(index));
+    }
+
+    slabShard.p_Slab->setNode(m_NumaNode.load(std::memory_order_relaxed));
+
+    return slabShard.p_Slab->allocate(bytes);
+}
+
+void MEM_SENTRY::heap::Heap::SlabFree(void* chunk){
+    slab::SlabPage* page = slab::SlabCache::PageOf(chunk);
+    HeapShard& shard = m_Shards[page->m_Shard];
+
+    stats::ShardLock lock(shard.m_Mutex);
+
+    page->p_Owner->free(chunk);
+}
+
+void MEM_SENTRY::heap::Heap::SlabFree(void* chunk, uint8_t shard, size_t bytes){
+    HeapShard& slabShard = m_Shards[shard];
+
+    assert(slab::SlabCache::PageOf(chunk)->p_Owner == slabShard.p_Slab && "slab chunk freed to the wrong shard");
+
+    stats::ShardLock lock(slabShard.m_Mutex);
+
+    slabShard.p_Slab->free(chunk, slab::SlabCache::ClassOf(bytes));
+}
+
+size_t MEM_SENTRY::heap::Heap::GetSlabReserved() noexcept {
+    size_t shards = m_ShardCount.load(std::memory_order_relaxed);
+
+    size_t pages = 0;
+    for(size_t i = 0; i < shards; ++i){
+        std::lock_guard<std::mutex> lock(m_Shards[i].m_Mutex);
+
+        if(m_Shards[i].p_Slab){
+            pages += m_Shards[i].p_Slab->pageCount();
+        }
+    }
+
+    return pages * constants::SLAB_PAGE_SIZE;
+}
+
+size_t MEM_SENTRY::heap::Heap::currentShard() noexcept {
+    if(m_Mode.load(std::memory_order_relaxed) == TrackingMode::Shared){
+        return 0;
+    }
+
+    size_t index = thread_slot::Current();
+
+    // grow the merge range so queries see this shard.
+    size_t count = m_ShardCount.load(std::memory_order_relaxed);
+    while(count <= index && !m_ShardCount.compare_exchange_weak(count, index + 1, std::memory_order_relaxed)){}
+
+    return index;
+}
+
+bool MEM_SENTRY::heap::Heap::sampleTick(size_t bytes, size_t interval) noexcept {
+    // one countdown per thread slot, whatever the tracking mode.
+    HeapShard& shard = m_Shards[thread_slot::Current()];
+
+    int64_t left = shard.m_SampleCountdown.fetch_sub((int64_t)bytes, std::memory_order_relaxed) - (int64_t)bytes;
+
+    if(left > 0){
+        return false;
+    }
+
+    // xorshift64*, seeded per thread: no locks, no allocation.
+    thread_local uint64_t state = 0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(&state);
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    uint64_t random = state * 0x2545F4914F6CDD1Dull;
+
+    // exponential gap with the requested mean: -ln(U) * interval, U in (0, 1].
+    double uniform = ((random >> 11) + 1) * (1.0 / 9007199254740992.0);
+    shard.m_SampleCountdown.store((int64_t)(-std::log(uniform) * (double)interval) + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+int64_t MEM_SENTRY::heap::Heap::GetTotal() const noexcept {
+    size_t shards = m_ShardCount.load(std::memory_order_relaxed);
+
+    int64_t total = 0;
+    for(size_t i = 0; i < shards; ++i){
+        total += m_Shards[i].m_LiveBytes.load(std::memory_order_relaxed);
+    }
+
+    return total;
+}
+
+int64_t MEM_SENTRY::heap::Heap::CountAllocations() const noexcept {
+    size_t shards = m_ShardCount.load(std::memory_order_relaxed);
+
+    int64_t count = 0;
+    for(size_t i = 0; i < shards; ++i){
+        count += m_Shards[i].m_LiveCount.load(std::memory_order_relaxed);
     }
     
     return count;
 }
 
+MEM_SENTRY::heap::HeapStats MEM_SENTRY::heap::Heap::GetStats() const noexcept {
+    size_t shards = m_ShardCount.load(std::memory_order_relaxed);
+
+    HeapStats stats{0, 0, 0, 0, 0, 0, 0, 0};
+    for(size_t i = 0; i < shards; ++i){
+        stats.m_LiveBytes += m_Shards[i].m_LiveBytes.load(std::memory_order_relaxed);
+        stats.m_LiveCount += m_Shards[i].m_LiveCount.load(std::memory_order_relaxed);
+        stats.m_TotalAllocs += m_Shards[i].m_TotalAllocs.load(std::memory_order_relaxed);
+        stats.m_TotalFrees += m_Shards[i].m_TotalFrees.load(std::memory_order_relaxed);
+    }
+
+    // cached and mapped counters are kept per thread slot, whatever the tracking mode.
+    for(size_t i = 0; i < constants::THREAD_SLOTS; ++i){
+        stats.m_CachedBytes += m_Shards[i].m_CachedBytes.load(std::memory_order_relaxed);
+        stats.m_CachedCount += m_Shards[i].m_CachedCount.load(std::memory_order_relaxed);
+        stats.m_MappedBytes += m_Shards[i].m_MappedBytes.load(std::memory_order_relaxed);
+        stats.m_MappedCount += m_Shards[i].m_MappedCount.load(std::memory_order_relaxed);
+    }
+
+    return stats;
+}
+
+MEM_SENTRY::heap::HeapStats MEM_SENTRY::heap::Heap::GetSampledEstimate() noexcept {
+    HeapStats stats = GetStats();
+    size_t interval = m_SampleInterval.load(std::memory_order_relaxed);
+
+    if(interval == 0){
+        return stats;
+    }
+
+    double bytes = 0;
+    double count = 0;
+
+    const auto weigh = [&](const alloc_header::AllocHeader* alloc){
+        // sampled on the requested size, counted like GetTotal() (with the alignment).
+        double weight = 1.0 / (1.0 - std::exp(-(double)alloc->m_Size / (double)interval));
+
+        count += weight;
+        bytes += weight * (double)(alloc->m_Size + alloc_header::GetAlignment(alloc));
+    };
+
+    size_t shards = m_ShardCount.load(std::memory_order_relaxed);
+    for(size_t i = 0; i < shards; ++i){
+        std::lock_guard<std::mutex> lock(m_Shards[i].m_Mutex);
+
+#if MEM_SENTRY_COMPACT_HEADER
+        for(uint32_t j = 0; j < m_Shards[i].m_Count; ++j){
+            weigh(m_Shards[i].p_Blocks[j]);
+        }
+#else
+        for(alloc_header::AllocHeader* tmp = m_Shards[i].p_Head; tmp; tmp = tmp->p_Next){
+            weigh(tmp);
+        }
+#endif
+    }
+
+    stats.m_LiveBytes = (int64_t)std::llround(bytes);
+    stats.m_LiveCount = (int64_t)std::llround(count);
+
+    return stats;
+}
+
 void MEM_SENTRY::heap::Heap::AddAllocation(alloc_header::AllocHeader* alloc) {
-    std::lock_guard<std::mutex> lock(m_llMutex);
-    
-    m_total += alloc->m_Size + alloc->m_Alignment;
+    size_t index = currentShard();
+    HeapShard& shard = m_Shards[index];
 
-    if (p_Reporter) {
-        p_Reporter->onAlloc(alloc);
+    {
+        stats::ShardLock lock(shard.m_Mutex);
+        
+        // IDs are handed out under the shard lock, so every shard list stays sorted by ID.
+        alloc->m_AllocId = GetNextId();
+        alloc->m_Shard = static_cast<uint8_t>(index);
+        shard.m_LiveBytes.fetch_add(alloc->m_Size + alloc_header::GetAlignment(alloc), std::memory_order_relaxed);
+        shard.m_LiveCount.fetch_add(1, std::memory_order_relaxed);
+        shard.m_TotalAllocs.fetch_add(1, std::memory_order_relaxed);
+
+        if(!addAllocLL(shard, alloc)){
+            std::printf("Error: error while manipulating Heap Allocations Linked List\n");
+        } else {
+#if !MEM_SENTRY_COMPACT_HEADER
+            indexAdd(shard, alloc);
+#endif
+        }
     }
 
-    if(!addAllocLL(alloc)){
-        std::printf("Error: error while manipulating Heap Allocations Linked List\n");
+    // outside the shard lock: a slow reporter must not stall other threads of this shard.
+    if (p_Reporter) {
+        p_Reporter->onAlloc(alloc);
     }
 }
 
 void MEM_SENTRY::heap::Heap::RemoveAlloc(alloc_header::AllocHeader* alloc) {
-    std::lock_guard<std::mutex> lock(m_llMutex);
+    HeapShard& shard = m_Shards[alloc->m_Shard];
+
+    {
+        stats::ShardLock lock(shard.m_Mutex);
 
-    m_total -= alloc->m_Size + alloc->m_Alignment;
+        shard.m_LiveBytes.fetch_sub(alloc->m_Size + alloc_header::GetAlignment(alloc), std::memory_order_relaxed);
+        shard.m_LiveCount.fetch_sub(1, std::memory_order_relaxed);
+        shard.m_TotalFrees.fetch_add(1, std::memory_order_relaxed);
 
+#if !MEM_SENTRY_COMPACT_HEADER
+        indexRemove(shard, alloc);
+#endif
+
+        if(!removeAllocLL(shard, alloc)){
+            std::printf("Error: error while manipulating Heap Allocations Linked List\n");
+        }
+    }
+
+    // the block is unlinked but not freed yet, so the header is still valid here.
     if (p_Reporter) {
         p_Reporter->onDealloc(alloc);
     }
+}
+
+void MEM_SENTRY::heap::Heap::ResizeAllocation(alloc_header::AllocHeader* alloc, size_t size) {
+    HeapShard& shard = m_Shards[alloc->m_Shard];
+
+    // under the shard lock, so a scrub never reads the new size next to the old end marker.
+    stats::ShardLock lock(shard.m_Mutex);
+
+    shard.m_LiveBytes.fetch_add((int64_t)size - (int64_t)alloc->m_Size, std::memory_order_relaxed);
+    alloc->m_Size = size;
 
-    if(!removeAllocLL(alloc)){
-        std::printf("Error: error while manipulating Heap Allocations Linked List\n");
+    canary::Arm(reinterpret_cast<char*>(alloc + 1), size);
+}
+
+bool MEM_SENTRY::heap::Heap::ReportCorruption(alloc_header::AllocHeader* alloc, canary::Corruption corruption){
+    if(p_Reporter){
+        p_Reporter->onCorruption(alloc, corruption);
+        return true;
     }
+
+    std::printf("Error: %s overwritten behind block %u (%u bytes) of heap %s\n",
+        canary::CorruptionName(corruption), (unsigned)alloc->m_AllocId, (unsigned)alloc->m_Size, m_name);
+
+    return false;
+}
+
+size_t MEM_SENTRY::heap::Heap::Scrub(ScrubCursor& cursor, size_t budget){
+    size_t shards = m_ShardCount.load(std::memory_order_relaxed);
+
+    if(cursor.m_Shard >= shards){
+        cursor.m_Shard = 0;
+        cursor.m_Next = 0;
+    }
+
+    HeapShard& shard = m_Shards[cursor.m_Shard];
+
+    // copies: the blocks may be freed as soon as the shard is unlocked.
+    alloc_header::HeaderCopy found[constants::SCRUB_REPORT_BATCH];
+    canary::Corruption kinds[constants::SCRUB_REPORT_BATCH];
+    size_t corrupted = 0;
+    bool finished;
+
+    {
+        std::lock_guard<std::mutex> lock(shard.m_Mutex);
+
+#if !MEM_SENTRY_COMPACT_HEADER
+        // the list is sorted by ID, so the next unchecked block is found through the index.
+        alloc_header::AllocHeader* tmp = indexFind(shard, cursor.m_Next);
+
+        for(size_t checked = 0; tmp && checked < budget && corrupted < constants::SCRUB_REPORT_BATCH; ++checked){
+            canary::Corruption corruption = canary::Inspect((char*)tmp + sizeof(alloc_header::AllocHeader), tmp->m_Size);
+
+            if(corruption != canary::Corruption::None){
+                alloc_header::CopyHeader(tmp, found[corrupted]);
+                kinds[corrupted++] = corruption;
+            }
+
+            cursor.m_Next = tmp->m_AllocId + 1;
+            tmp = tmp->p_Next;
+        }
+
+        finished = tmp == nullptr;
+#else
+        // blocks freed meanwhile swapped the last entries forward: a few may be checked twice or skipped.
+        uint32_t i = cursor.m_Next;
+
+        for(size_t checked = 0; i < shard.m_Count && checked < budget && corrupted < constants::SCRUB_REPORT_BATCH; ++checked, ++i){
+            alloc_header::AllocHeader* tmp = shard.p_Blocks[i];
+            canary::Corruption corruption = canary::Inspect((char*)tmp + sizeof(alloc_header::AllocHeader), tmp->m_Size);
+
+            if(corruption != canary::Corruption::None){
+                alloc_header::CopyHeader(tmp, found[corrupted]);
+                kinds[corrupted++] = corruption;
+            }
+        }
+
+        cursor.m_Next = i;
+        finished = i >= shard.m_Count;
+#endif
+    }
+
+    if(finished){
+        cursor.m_Next = 0;
+
+        if(++cursor.m_Shard >= shards){
+            cursor.m_Shard = 0;
+            ++cursor.m_Passes;
+        }
+    }
+
+    for(size_t i = 0; i < corrupted; ++i){
+        ReportCorruption(&found[i].m_Header, kinds[i]);
+    }
+
+    return corrupted;
+}
+
+MEM_SENTRY::heap::HeapSnapshot MEM_SENTRY::heap::Heap::Snapshot(size_t batch){
+    HeapSnapshot snapshot;
+    size_t shards = m_ShardCount.load(std::memory_order_relaxed);
+
+    if(batch == 0)
+        batch = 1;
+
+    for(size_t s = 0; s < shards; ++s){
+        HeapShard& shard = m_Shards[s];
+        uint32_t next = 0;
+        bool finished = false;
+
+        while(!finished){
+            // grown before the lock, so copying a slice never calls malloc under it.
+            if(!snapshot.Reserve(snapshot.Size() + batch)){
+                snapshot.Sort();
+                return snapshot;
+            }
+
+            stats::ShardLock lock(shard.m_Mutex);
+
+#if !MEM_SENTRY_COMPACT_HEADER
+            // the list is sorted by ID, so each slice resumes through the index.
+            alloc_header::AllocHeader* tmp = indexFind(shard, next);
+
+            for(size_t copied = 0; tmp && copied < batch; ++copied, tmp = tmp->p_Next){
+                snapshot.Push(tmp->m_AllocId, tmp->m_Size, (uint32_t)alloc_header::GetAlignment(tmp),
+                    (char*)tmp + sizeof(alloc_header::AllocHeader));
+                next = tmp->m_AllocId + 1;
+            }
+
+            finished = tmp == nullptr;
+#else
+            // frees between two slices swap entries forward: blocks seen twice are dropped by Sort().
+            uint32_t i = next;
+
+            for(size_t copied = 0; i < shard.m_Count && copied < batch; ++copied, ++i){
+                alloc_header::AllocHeader* tmp = shard.p_Blocks[i];
+                snapshot.Push(tmp->m_AllocId, tmp->m_Size, (uint32_t)alloc_header::GetAlignment(tmp),
+                    (char*)tmp + sizeof(alloc_header::AllocHeader));
+            }
+
+            next = i;
+            finished = i >= shard.m_Count;
+#endif
+        }
+    }
+
+    snapshot.Sort();
+    return snapshot;
 }
 
 void MEM_SENTRY::heap::Heap::ReportMemory(int bookMark1, int bookMark2){
-    std::lock_guard<std::mutex> lock(m_llMutex);
+    size_t shards = m_ShardCount.load(std::memory_order_relaxed);
 
-    alloc_header::AllocHeader* tmp = p_HeadList;
+    // lock every used shard in index order, so concurrent reports can't deadlock.
+    for(size_t i = 0; i < shards; ++i){
+        m_Shards[i].m_Mutex.lock();
+    }
 
-    while(tmp && tmp->m_AllocId < bookMark1){
-        tmp = tmp->p_Next;
+#if MEM_SENTRY_COMPACT_HEADER
+    // block tables are unordered: copy the blocks inside the range, then sort by ID
+    // and report them after the shards are unlocked.
+    // malloc instead of new: the reporter heap may be this heap.
+    size_t matches = 0;
+    for(size_t i = 0; i < shards; ++i){
+        matches += m_Shards[i].m_Count;
     }
-    
-    int total = 0;
 
-    while(tmp && tmp->m_AllocId <= bookMark2){
-        total += tmp->m_Size;
+    alloc_header::HeaderCopy* blocks = static_cast<alloc_header::HeaderCopy*>(
+        std::malloc((matches ? matches : 1) * sizeof(alloc_header::HeaderCopy)));
+
+    if(!blocks){
+        std::printf("Error: out of memory while taking the ReportMemory snapshot\n");
+    }
+
+    matches = 0;
+    for(size_t i = 0; blocks && i < shards; ++i){
+        for(uint32_t j = 0; j < m_Shards[i].m_Count; ++j){
+            alloc_header::AllocHeader* tmp = m_Shards[i].p_Blocks[j];
+
+            if(tmp->m_AllocId >= (uint32_t)bookMark1 && tmp->m_AllocId <= (uint32_t)bookMark2){
+                alloc_header::CopyHeader(tmp, blocks[matches++]);
+            }
+        }
+    }
+
+    for(size_t i = shards; i > 0; --i){
+        m_Shards[i - 1].m_Mutex.unlock();
+    }
+
+    std::sort(blocks, blocks + matches, [](const alloc_header::HeaderCopy& a, const alloc_header::HeaderCopy& b){
+        return a.m_Header.m_AllocId < b.m_Header.m_AllocId;
+    });
+
+    for(size_t i = 0; i < matches; ++i){
         if (p_Reporter) {
-            p_Reporter->report(tmp);
+            p_Reporter->report(&blocks[i].m_Header);
             printf("\n");
         }
-        tmp = tmp->p_Next;
+    }
+
+    std::free(blocks);
+#else
+    // one cursor per shard, each starting at its first block inside the range.
+    alloc_header::AllocHeader* cursors[constants::THREAD_SLOTS];
+
+    for(size_t i = 0; i < shards; ++i){
+        cursors[i] = indexFind(m_Shards[i], (uint32_t)bookMark1);
+    }
+
+    // copy the matching headers, so the reporter runs after the shards are unlocked.
+    // malloc instead of new: the reporter heap may be this heap.
+    size_t matches = 0;
+    size_t capacity = 0;
+    alloc_header::HeaderCopy* blocks = nullptr;
+
+    // k-way merge: always take the smallest ID among the shard cursors.
+    while(true){
+        size_t next = shards;
+
+        for(size_t i = 0; i < shards; ++i){
+            if(cursors[i] && cursors[i]->m_AllocId <= (uint32_t)bookMark2 &&
+               (next == shards || cursors[i]->m_AllocId < cursors[next]->m_AllocId)){
+                next = i;
+            }
+        }
+
+        if(next == shards){
+            break;
+        }
+
+        if(matches == capacity){
+            capacity = capacity ? capacity * 2 : 64;
+            void* grown = std::realloc(blocks, capacity * sizeof(alloc_header::HeaderCopy));
+
+            if(!grown){
+                std::printf("Error: out of memory while taking the ReportMemory snapshot\n");
+                break;
+            }
+
+            blocks = static_cast<alloc_header::HeaderCopy*>(grown);
+        }
+
+        // the links point into the live list, which the copy must not be used to walk.
+        alloc_header::CopyHeader(cursors[next], blocks[matches]);
+        ++matches;
+
+        cursors[next] = cursors[next]->p_Next;
+    }
+
+    for(size_t i = shards; i > 0; --i){
+        m_Shards[i - 1].m_Mutex.unlock();
+    }
+
+    for(size_t i = 0; i < matches; ++i){
+        if (p_Reporter) {
+            p_Reporter->report(&blocks[i].m_Header);
+            printf("\n");
+        }
+    }
+
+    std::free(blocks);
+#endif
+}
+
+namespace {
+    /**
+     * @brief Grows a heap pointer array with realloc so it holds at least `needed` entries.
+     * @note malloc instead of new: the graph must not allocate on the heaps it describes.
+     * @return true on success, false if out of memory (the array is left unchanged).
+     */
+    bool growHeapArray(MEM_SENTRY::heap::Heap**& array, uint32_t& capacity, uint32_t needed){
+        if(needed <= capacity)
+            return true;
+
+        uint32_t grown = capacity ? capacity * 2 : 8;
+        if(grown < needed)
+            grown = needed;
+
+        void* mem = std::realloc(array, grown * sizeof(MEM_SENTRY::heap::Heap*));
+
+        if(!mem)
+            return false;
+
+        array = static_cast<MEM_SENTRY::heap::Heap**>(mem);
+        capacity = grown;
+
+        return true;
+    }
+
+    /** @brief true if `heap` is one of the `count` entries of `array`. */
+    bool containsHeap(MEM_SENTRY::heap::Heap* const* array, uint32_t count, const MEM_SENTRY::heap::Heap* heap){
+        return std::find(array, array + count, heap) != array + count;
     }
 }
 
 std::mutex MEM_SENTRY::heap::Heap::m_graphMutex;
 
-void MEM_SENTRY::heap::Heap::AddHeap(Heap* heap) {
+uint64_t MEM_SENTRY::heap::Heap::m_VisitGeneration = 0;
+
+bool MEM_SENTRY::heap::Heap::allocateAdjList(size_t size) {
     std::lock_guard<std::mutex> lock(Heap::m_graphMutex);
 
-    if (heap) {
-        m_AdjHeaps.push_back(heap);
+    return size <= UINT32_MAX && growHeapArray(p_AdjHeaps, m_AdjCapacity, static_cast<uint32_t>(size));
+}
+
+bool MEM_SENTRY::heap::Heap::AddHeap(Heap* heap) {
+    // unlinkHeap() only walks the registry: an unregistered heap could be left dangling.
+    if(!heap || m_Index >= constants::MAX_HEAPS || heap->m_Index >= constants::MAX_HEAPS)
+        return false;
+
+    std::lock_guard<std::mutex> lock(Heap::m_graphMutex);
+
+    if(containsHeap(p_AdjHeaps, m_AdjCount, heap))
+        return true;
+
+    if(!growHeapArray(p_AdjHeaps, m_AdjCapacity, m_AdjCount + 1))
+        return false;
+
+    p_AdjHeaps[m_AdjCount++] = heap;
+
+    invalidateReach(this, heap);
+
+    return true;
+}
+
+void MEM_SENTRY::heap::Heap::invalidateReach(Heap* from, Heap* to){
+    // a heap that already reaches `to` reaches everything `to` does: its cache stays valid.
+    const auto stale = [from, to](Heap* heap){
+        return heap->m_ReachValid &&
+            containsHeap(heap->p_Reach, heap->m_ReachCount, from) &&
+            !containsHeap(heap->p_Reach, heap->m_ReachCount, to);
+    };
+
+    // AddHeap() links registered heaps only, so the registry holds every heap of the graph.
+    std::lock_guard<std::mutex> lock(heapRegistryMutex());
+
+    for(Heap* heap : g_Heaps){
+        if(heap && stale(heap)){
+            heap->m_ReachValid = false;
+        }
     }
 }
 
-void MEM_SENTRY::heap::Heap::dfs(Heap* currentHeap, std::unordered_set<Heap*>& visited, size_t& val,
-    const std::function<void(Heap*, size_t&)>& func) {
+void MEM_SENTRY::heap::Heap::unlinkHeap(Heap* dying){
+    std::lock_guard<std::mutex> lock(heapRegistryMutex());
 
-    if(visited.count(currentHeap)){
-        return;
+    for(Heap* heap : g_Heaps){
+        if(!heap || heap == dying)
+            continue;
+
+        Heap** end = std::remove(heap->p_AdjHeaps, heap->p_AdjHeaps + heap->m_AdjCount, dying);
+        heap->m_AdjCount = static_cast<uint32_t>(end - heap->p_AdjHeaps);
+
+        if(heap->m_ReachValid && containsHeap(heap->p_Reach, heap->m_ReachCount, dying)){
+            heap->m_ReachValid = false;
+        }
     }
+}
 
-    visited.insert(currentHeap);
-    func(currentHeap, val);
+uint32_t MEM_SENTRY::heap::Heap::reach(){
+    if(m_ReachValid)
+        return m_ReachCount;
 
-    for(auto heap : currentHeap->m_AdjHeaps){
-        dfs(heap, visited, val, func);
+    const uint64_t generation = ++m_VisitGeneration;
+
+    m_ReachCount = 0;
+
+    if(!growHeapArray(p_Reach, m_ReachCapacity, 1)){
+        std::printf("Error: heap \"%s\" can't allocate its hierarchy cache\n", m_name);
+        return 0;
     }
+
+    m_VisitMark = generation;
+    p_Reach[m_ReachCount++] = this;
+
+    // p_Reach is the BFS queue: entries before `i` are done, the rest are waiting.
+    for(uint32_t i = 0; i < m_ReachCount; ++i){
+        Heap* heap = p_Reach[i];
+
+        for(uint32_t n = 0; n < heap->m_AdjCount; ++n){
+            Heap* next = heap->p_AdjHeaps[n];
+
+            if(next->m_VisitMark == generation)
+                continue;
+
+            if(!growHeapArray(p_Reach, m_ReachCapacity, m_ReachCount + 1)){
+                // leave the cache invalid so the next query tries again.
+                std::printf("Error: heap \"%s\" can't grow its hierarchy cache, totals are partial\n", m_name);
+                return m_ReachCount;
+            }
+
+            next->m_VisitMark = generation;
+            p_Reach[m_ReachCount++] = next;
+        }
+    }
+
+    m_ReachValid = true;
+
+    return m_ReachCount;
 }
 
 size_t MEM_SENTRY::heap::Heap::GetTotalHH(){
     std::lock_guard<std::mutex> lock(Heap::m_graphMutex);
-    std::unordered_set<Heap*> visited;
 
     size_t total = 0;
+    uint32_t count = reach();
 
-    const auto lamda = [](Heap* heap, size_t& val){
-        val += heap->GetTotal();
-    };
-
-    dfs(this, visited, total, lamda);
+    for(uint32_t i = 0; i < count; ++i){
+        total += p_Reach[i]->GetTotal();
+    }
 
     return total;
 }
 
 size_t MEM_SENTRY::heap::Heap::CountAllocationsHH(){
     std::lock_guard<std::mutex> lock(Heap::m_graphMutex);
-    std::unordered_set<Heap*> visited;
 
     size_t total = 0;
+    uint32_t count = reach();
 
-    const auto lamda = [](Heap* heap, size_t& val){
-        val += heap->CountAllocations();
-    };
-
-    dfs(this, visited, total, lamda);
+    for(uint32_t i = 0; i < count; ++i){
+        total += p_Reach[i]->CountAllocations();
+    }
 
     return total;
 }
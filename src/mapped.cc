@@ -0,0 +1,126 @@
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "mem_sentry/mapped.h"
+
+namespace {
+    size_t roundUp(size_t bytes, size_t page) noexcept {
+        return (bytes + page - 1) & ~(page - 1);
+    }
+
+    /** @brief Anonymous private mapping, nullptr on failure. */
+    void* mapAnonymous(size_t length, int extraFlags) noexcept {
+        void* base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extraFlags, -1, 0);
+        return base == MAP_FAILED ? nullptr : base;
+    }
+}
+
+size_t MEM_SENTRY::mapped::PageSize() noexcept {
+    static const size_t s_Page = []() noexcept {
+        long page = ::sysconf(_SC_PAGESIZE);
+        return page > 0 ? static_cast<size_t>(page) : size_t{4096};
+    }();
+
+    return s_Page;
+}
+
+void* MEM_SENTRY::mapped::Map(size_t headerBytes, size_t dataBytes, size_t alignment, HugePages pages) noexcept {
+    const size_t page = PageSize();
+
+    // the metadata pages: the Region and the header end right at the first data page.
+    const size_t meta = roundUp(sizeof(Region) + headerBytes, page);
+
+    // mappings are page aligned, so only alignments above a page need slack to slide the data forward.
+    const size_t slack = alignment > page ? alignment - page : 0;
+
+    size_t granule = page;
+    size_t length = 0;
+    char* base = nullptr;
+
+#ifdef MAP_HUGETLB
+    if(pages == HugePages::Explicit){
+        granule = constants::MAPPED_HUGE_PAGE_SIZE;
+        length = roundUp(meta + slack + dataBytes, granule);
+        base = static_cast<char*>(mapAnonymous(length, MAP_HUGETLB));
+    }
+#endif
+
+    // no huge pages reserved (or none wanted): normal pages.
+    if(!base){
+        granule = page;
+        length = roundUp(meta + slack + dataBytes, granule);
+        base = static_cast<char*>(mapAnonymous(length, 0));
+
+        if(!base)
+            return nullptr;
+    }
+
+    char* pMem = base + meta;
+
+    if(alignment > page){
+        pMem = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(pMem) + alignment - 1) & ~(uintptr_t)(alignment - 1));
+
+        // normal pages can be trimmed to the block, huge pages only in whole huge pages.
+        if(granule == page){
+            char* start = pMem - meta;
+            char* end = pMem + roundUp(dataBytes, page);
+
+            if(start > base)
+                ::munmap(base, start - base);
+
+            if(base + length > end)
+                ::munmap(end, base + length - end);
+
+            length = end - start;
+            base = start;
+        }
+    }
+
+#ifdef MADV_HUGEPAGE
+    // only a hint: without THP the block keeps its normal pages.
+    if(pages == HugePages::Transparent){
+        ::madvise(pMem, base + length - pMem, MADV_HUGEPAGE);
+    }
+#endif
+
+    char* raw = pMem - headerBytes;
+
+    Region* region = RegionOf(raw);
+    region->p_Base = base;
+    region->m_Length = length;
+    region->m_PageSize = granule;
+
+    return raw;
+}
+
+size_t MEM_SENTRY::mapped::Unmap(void* raw) noexcept {
+    Region* region = RegionOf(raw);
+    size_t length = region->m_Length;
+
+    // read before the pages holding it go away.
+    ::munmap(region->p_Base, length);
+
+    return length;
+}
+
+bool MEM_SENTRY::mapped::Resize(void* raw, void* pMem, size_t dataBytes, int64_t& delta) noexcept {
+    Region* region = RegionOf(raw);
+    char* base = static_cast<char*>(region->p_Base);
+
+    const size_t length = region->m_Length;
+    const size_t needed = roundUp((static_cast<char*>(pMem) - base) + dataBytes, region->m_PageSize);
+
+    delta = 0;
+
+    if(needed == length)
+        return true;
+
+    // no MREMAP_MAYMOVE: the header is linked into the heap list and must stay where it is.
+    if(::mremap(base, length, needed, 0) == MAP_FAILED)
+        return needed < length;
+
+    region->m_Length = needed;
+    delta = (int64_t)needed - (int64_t)length;
+
+    return true;
+}
@@ -1,10 +1,16 @@
 #include <assert.h>
 #include <cstdint>
+#include <cstring>
+#include <malloc.h>
 #include <new>
 
+#include "mem_sentry/arena_heap.h"
 #include "mem_sentry/heap.h"
 #include "mem_sentry/alloc_header.h"
+#include "mem_sentry/callsite.h"
+#include "mem_sentry/canary.h"
 #include "mem_sentry/constants.h"
+#include "mem_sentry/mapped.h"
 
 // ============================================================================
 // INTERNAL HELPER FUNCTIONS
@@ -18,18 +24,34 @@
  * @param size Bytes of user data requested.
  * @param alignment Alignment used.
  * @param originalAddr The raw pointer returned by malloc (crucial for free()).
+ * It is only stored for aligned blocks, unaligned ones start at the header.
  * @param pHeader Pointer to the location where the header resides.
  * @param pHeap The heap instance tracking this allocation.
+ * @param kind The backend that produced `originalAddr`.
+ * @param slabShard Slab shard that carved `originalAddr` (not stored by the compact layout).
  */
 void set_alloc_header(size_t size, size_t alignment, char* originalAddr,
-    MEM_SENTRY::alloc_header::AllocHeader* pHeader, MEM_SENTRY::heap::Heap *pHeap){
+    MEM_SENTRY::alloc_header::AllocHeader* pHeader, MEM_SENTRY::heap::Heap *pHeap,
+    MEM_SENTRY::alloc_header::BlockKind kind, uint8_t slabShard){
 
+#if MEM_SENTRY_COMPACT_HEADER
+    pHeader->m_HeapIndex = pHeap->GetIndex();
+    (void)slabShard;
+#else
     pHeader->p_Heap = pHeap;
-    pHeader->m_Size = size;
-    pHeader->m_Alignment = alignment; 
+    pHeader->m_SlabShard = slabShard;
     pHeader->m_Signature = MEM_SENTRY::constants::MEMSYSTEM_SIGNATURE;
-    pHeader->m_AllocId = pHeap->GetNextId();
-    pHeader->p_OriginalAddress = originalAddr;
+    pHeader->m_StackId = MEM_SENTRY::constants::CALLSITE_NO_STACK;
+    pHeader->m_Reserved = 0;
+#endif
+    pHeader->m_Kind = kind;
+    pHeader->m_Size = size;
+    pHeader->m_AlignShift = alignment ? __builtin_ctzll(alignment) : 0;
+
+    // only aligned blocks keep their original pointer, right before the header.
+    if(alignment){
+        *(void**)((char*)pHeader - sizeof(void*)) = originalAddr;
+    }
 }
 
 /**
@@ -55,59 +77,309 @@ size_t calculate_aligned_memory_size(std::align_val_t alignment){
     return size;
 }
 
+/**
+ * @brief Raw bytes requested for a tracked block of `size` user bytes.
+ * The sized free path recomputes it to find the slab size class.
+ */
+size_t block_bytes(size_t size, size_t alignment){
+    return MEM_SENTRY::alloc_header::BlockBytes(size, alignment);
+}
+
+/**
+ * @brief Raw bytes requested for an unsampled block of `size` user bytes (see sentry_allocate_light()).
+ */
+size_t light_block_bytes(size_t size, size_t alignment){
+    // aligned blocks also keep the original pointer in front of the header.
+    size_t header_size = sizeof(MEM_SENTRY::alloc_header::LightHeader) + (alignment ? sizeof(void*) : 0);
+    return size + alignment + header_size + sizeof(int) + MEM_SENTRY::constants::REDZONE_BYTES;
+}
+
+/**
+ * @brief Called after an allocation failed: runs the new_handler, if there is one.
+ * @return true if the allocation should be retried, false if it failed for good.
+ */
+bool sentry_retry_new_handler(){
+    std::new_handler nh = std::get_new_handler();
+
+    if(!nh){
+        MEM_SENTRY::stats::Count(MEM_SENTRY::stats::Counter::AllocFailures);
+        return false;
+    }
+
+    MEM_SENTRY::stats::Count(MEM_SENTRY::stats::Counter::NewHandlerRetries);
+    nh();
+    return true;
+}
+
+/**
+ * @brief Runs `allocate` until it succeeds, calling the new_handler between attempts
+ * as operator new does. Only the operator new paths use it: the C-style calls
+ * (ms_malloc() & co.) are noexcept and fail with nullptr like malloc, without
+ * running a handler that may throw.
+ *
+ * @return void* The allocation, or nullptr when there is no new_handler left.
+ */
+template<typename Allocate>
+void* sentry_with_new_handler(Allocate allocate){
+    void* ptr;
+    while((ptr = allocate()) == nullptr && sentry_retry_new_handler());
+    return ptr;
+}
+
+/**
+ * @brief Obtains the raw memory for one tracked block.
+ * Blocks of at least the heap's mapped threshold get a mapping of their own,
+ * small blocks come from the heap's slab cache when the heap enables it,
+ * everything else from malloc. A node-bound
+ * heap also maps blocks of at least `NUMA_BIND_MIN_BYTES`, so that only memory
+ * MemSentry mapped itself is ever bound to the NUMA node.
+ * 
+ * @param bytes Total bytes needed (header + data + footer + padding).
+ * @param headerBytes Bytes of `bytes` the layout puts before the user data.
+ * @param alignment Alignment of the user data, 0 for the default alignment.
+ * @param pHeap The heap the block will belong to.
+ * @param kind Receives the backend that served the request.
+ * @param slabShard Receives the slab shard of slab chunks, SLAB_NO_SHARD otherwise.
+ * 
+ * @return void* Raw memory, or nullptr when out of memory. A mapped block is
+ * placed so that `raw + headerBytes` is already aligned.
+ */
+void* sentry_raw_allocate(size_t bytes, size_t headerBytes, size_t alignment, MEM_SENTRY::heap::Heap *pHeap,
+    MEM_SENTRY::alloc_header::BlockKind& kind, uint8_t& slabShard){
+    slabShard = MEM_SENTRY::constants::SLAB_NO_SHARD;
+
+    size_t threshold = pHeap->GetMappedThreshold();
+    int node = pHeap->GetNumaNode();
+
+    if(node != MEM_SENTRY::numa::NO_NODE && (!threshold || threshold > MEM_SENTRY::constants::NUMA_BIND_MIN_BYTES)){
+        threshold = MEM_SENTRY::constants::NUMA_BIND_MIN_BYTES;
+    }
+
+    if(threshold && bytes >= threshold){
+        // the mapping starts the data on a page boundary, the alignment padding of `bytes` isn't needed.
+        void* raw = MEM_SENTRY::mapped::Map(headerBytes, bytes - headerBytes - alignment, alignment, pHeap->GetMappedHugePages());
+
+        // out of address space (or over a mapping limit): malloc may still have room.
+        if(raw){
+            MEM_SENTRY::mapped::Region* region = MEM_SENTRY::mapped::RegionOf(raw);
+
+            if(node != MEM_SENTRY::numa::NO_NODE){
+                MEM_SENTRY::numa::BindMemory(region->p_Base, region->m_Length, node);
+            }
+
+            pHeap->AddMapped((int64_t)region->m_Length, 1);
+
+            kind = MEM_SENTRY::alloc_header::BlockKind::Mapped;
+            return raw;
+        }
+    }
+
+    if(pHeap->UsesSlabBackend()){
+        void* chunk = pHeap->SlabAllocate(bytes, slabShard);
+
+        if(chunk){
+            kind = MEM_SENTRY::alloc_header::BlockKind::Slab;
+            return chunk;
+        }
+    }
+
+    kind = MEM_SENTRY::alloc_header::BlockKind::Malloc;
+
+    // no new_handler here: operator new retries the whole block (sentry_with_new_handler()).
+    return malloc(bytes);
+}
+
+/**
+ * @brief Returns raw memory to the backend that produced it.
+ * 
+ * @param originalAddr The pointer returned by sentry_raw_allocate().
+ * @param kind The backend recorded in the block header.
+ * @param pHeap The heap the block belonged to.
+ */
+void sentry_raw_free(void* originalAddr, MEM_SENTRY::alloc_header::BlockKind kind, MEM_SENTRY::heap::Heap *pHeap){
+    if(MEM_SENTRY::alloc_header::IsSlab(kind)){
+        pHeap->SlabFree(originalAddr);
+        return;
+    }
+
+    if(MEM_SENTRY::alloc_header::IsMapped(kind)){
+        pHeap->AddMapped(-(int64_t)MEM_SENTRY::mapped::Unmap(originalAddr), -1);
+        return;
+    }
+
+    free(originalAddr);
+}
+
+/**
+ * @brief sentry_raw_free() for the sized free path.
+ * Slab chunks whose header recorded their shard go straight back to that cache, with the
+ * size class taken from `bytes`, so the page header is never read.
+ * 
+ * @param slabShard The shard recorded in the header, SLAB_NO_SHARD when unknown.
+ * @param bytes The raw bytes the block was requested with.
+ */
+void sentry_raw_free_sized(void* originalAddr, MEM_SENTRY::alloc_header::BlockKind kind, MEM_SENTRY::heap::Heap *pHeap,
+    uint8_t slabShard, size_t bytes){
+    if(MEM_SENTRY::alloc_header::IsSlab(kind) && slabShard != MEM_SENTRY::constants::SLAB_NO_SHARD){
+        pHeap->SlabFree(originalAddr, slabShard, bytes);
+        return;
+    }
+
+    sentry_raw_free(originalAddr, kind, pHeap);
+}
+
+/**
+ * @brief Allocates a block skipped by heap sampling.
+ * Layout: [Original Pointer?] [LightHeader] [User Data (Aligned?)] [Footer] [?Padding]
+ * The block is not linked, counted or reported; the header only holds what
+ * sentry_deallocate() needs to free it.
+ * 
+ * @param size Bytes requested by the user.
+ * @param alignment Alignment requirement (power of 2), or 0 for the default alignment.
+ * @param pHeap The heap the block is allocated from.
+ * 
+ * @return void* Pointer to the start of the user data.
+ */
+void* sentry_allocate_light(size_t size, size_t alignment, MEM_SENTRY::heap::Heap *pHeap){
+    // aligned blocks also keep the original pointer in front of the header.
+    size_t header_size = sizeof(MEM_SENTRY::alloc_header::LightHeader) + (alignment ? sizeof(void*) : 0);
+    size_t total_requested_memory = light_block_bytes(size, alignment);
+
+    MEM_SENTRY::alloc_header::BlockKind kind;
+    uint8_t slabShard;
+    void* ptr = sentry_raw_allocate(total_requested_memory, header_size, alignment, pHeap, kind, slabShard);
+
+    if(!ptr) 
+        return nullptr;
+
+    char* pMem = (char*) ptr + header_size;
+
+    if(alignment){
+        size_t mask = alignment - 1;
+        pMem = (char*)(((uintptr_t)pMem + mask) & ~mask);
+    }
+
+    MEM_SENTRY::alloc_header::LightHeader* pHeader = (MEM_SENTRY::alloc_header::LightHeader*) pMem - 1;
+
+    pHeader->p_Heap = pHeap;
+    pHeader->m_Size = size;
+    pHeader->m_AlignShift = alignment ? __builtin_ctzll(alignment) : 0;
+    pHeader->m_SlabShard = slabShard;
+    pHeader->m_Reserved = 0;
+    pHeader->m_Kind = MEM_SENTRY::alloc_header::ToLight(kind);
+
+    if(alignment){
+        *(void**)((char*)pHeader - sizeof(void*)) = ptr;
+    }
+
+    MEM_SENTRY::canary::Arm(pMem, size);
+
+    return pMem;
+}
+
+/**
+ * @brief Frees a block allocated by sentry_allocate_light().
+ * 
+ * @param pMem Pointer to the user data to free.
+ */
+void sentry_deallocate_light(void* pMem){
+    MEM_SENTRY::alloc_header::LightHeader* pHeader = (MEM_SENTRY::alloc_header::LightHeader*) pMem - 1;
+
+    // untracked, so there is nothing to report: make sure the canaries are intact in debug builds.
+    assert(MEM_SENTRY::canary::Inspect(pMem, pHeader->m_Size) == MEM_SENTRY::canary::Corruption::None);
+
+    void* pOriginal = pHeader->m_AlignShift ? *(void**)((char*)pHeader - sizeof(void*)) : (void*)pHeader;
+    MEM_SENTRY::alloc_header::BlockKind kind = pHeader->m_Kind;
+
+    // mark as freed memory, a second free then fails the kind check in sentry_deallocate().
+    pHeader->m_Kind = MEM_SENTRY::alloc_header::BlockKind::Freed;
+
+    sentry_raw_free(pOriginal, kind, pHeader->p_Heap);
+}
+
 // ============================================================================
 // CORE ALLOCATION LOGIC
 // ============================================================================
 
 /**
- * @brief Allocates standard (unaligned/default aligned) memory.
- * Layout: [Header] [User Data] [Footer]
+ * @brief Allocates one tracked block whose raw size is already known.
+ * Layout: [Original Pointer?] [Header] [User Data (Aligned?)] [Footer] [?Padding]
+ * Shared by sentry_allocate(), sentry_allocate_aligned() and the ISentry fast path
+ * (sentry_allocate_fixed()), which computes `rawBytes` at compile time.
  * 
- * @param size Bytes requested by the user.
+ * @param size Bytes requested by the user (never 0).
+ * @param alignment Alignment requirement (power of 2), or 0 for the default alignment.
+ * @param rawBytes block_bytes(size, alignment).
  * @param pHeap The heap to track this allocation.
  * 
- * @return void* Pointer to the start of the user data.
+ * @return void* Pointer to the start of the user data, nullptr when out of memory or
+ * when `size` is past alloc_header::MAX_BLOCK_SIZE.
  */
-void* sentry_allocate(size_t size, MEM_SENTRY::heap::Heap *pHeap){
-    if(size == 0) 
-        size = 1;
-    
-    size_t total_requested_memory = size + sizeof(MEM_SENTRY::alloc_header::AllocHeader) + sizeof(int);
-    
-    void* ptr;
-    while ((ptr = malloc(total_requested_memory)) == nullptr){
-        std::new_handler nh = std::get_new_handler();
+void* sentry_allocate_block(size_t size, size_t alignment, size_t rawBytes, MEM_SENTRY::heap::Heap *pHeap){
+    // the headers record the size in 32 bits, a bigger block would be tracked truncated:
+    // fails like malloc would, so operator new still goes through the new_handler.
+    if(size > MEM_SENTRY::alloc_header::MAX_BLOCK_SIZE) [[unlikely]]
+        return nullptr;
 
-        if(nh){
-            nh();
-        } else {
-            break;
-        }
-    }
+    if(!pHeap->ShouldSample(size))
+        return sentry_allocate_light(size, alignment, pHeap);
+
+    MEM_SENTRY::alloc_header::BlockKind kind;
+    uint8_t slabShard;
+    // aligned blocks also keep the original pointer in front of the header.
+    size_t headerBytes = MEM_SENTRY::alloc_header::HeaderFootprint(alignment);
+    void* ptr = sentry_raw_allocate(rawBytes, headerBytes, alignment, pHeap, kind, slabShard);
 
     if(!ptr) 
         return nullptr;
 
-    char* pMem = (char *)ptr;
+    char* pMem = (char*)ptr + headerBytes;
+
+    // the alignment must be power of 2, which is gauranteed via `calculate_aligned_memory_size()`
+    if(alignment){
+        size_t mask = alignment - 1;
+        pMem = (char*)(((uintptr_t)pMem + mask) & ~mask);
+    }
+
+    // the header always sits right before the user data.
+    MEM_SENTRY::alloc_header::AllocHeader *pHeader = (MEM_SENTRY::alloc_header::AllocHeader *) pMem - 1;
+
+    set_alloc_header(size, alignment, (char*)ptr, pHeader, pHeap, kind, slabShard);
+
+    // add end signature and redzone; armed before the block is linked, so a scrubber never sees it half written.
+    MEM_SENTRY::canary::Arm(pMem, size);
+
+    // captured here rather than in a helper, so the skipped frame is always this one.
+    if(!MEM_SENTRY_COMPACT_HEADER && pHeap->GetCallSiteDepth()){
+        uint32_t stackId = MEM_SENTRY::callsite::Capture(pHeap->GetCallSiteDepth(), 1);
+        MEM_SENTRY::alloc_header::SetStackId(pHeader, stackId);
+        MEM_SENTRY::callsite::Account(stackId, size, 1);
+    }
 
-    MEM_SENTRY::alloc_header::AllocHeader *pHeader = (MEM_SENTRY::alloc_header::AllocHeader *) pMem;
-    
-    set_alloc_header(size, 0, (char*)pHeader, pHeader, pHeap);
-    
     pHeap->AddAllocation(pHeader);
-    
-    void *pStartBlock = pMem + sizeof(MEM_SENTRY::alloc_header::AllocHeader);
-    
-    int *pEndMarker = (int*) ((char*) pStartBlock + size);
 
-    *pEndMarker = MEM_SENTRY::constants::MEMSYSTEM_ENDMARKER;
+    return pMem;
+}
 
-    return pStartBlock;
+/**
+ * @brief Allocates standard (unaligned/default aligned) memory.
+ * Layout: [Header] [User Data] [Footer]
+ * 
+ * @param size Bytes requested by the user.
+ * @param pHeap The heap to track this allocation.
+ * 
+ * @return void* Pointer to the start of the user data.
+ */
+void* sentry_allocate(size_t size, MEM_SENTRY::heap::Heap *pHeap){
+    if(size == 0) 
+        size = 1;
+
+    return sentry_allocate_block(size, 0, block_bytes(size, 0), pHeap);
 }
 
 /**
  * @brief Allocates aligned memory.
- * Layout: [Padding?] [Header] [User Data (Aligned)] [Footer] [?Padding]
+ * Layout: [Padding?] [Original Pointer] [Header] [User Data (Aligned)] [Footer] [?Padding]
  * Uses pointer arithmetic to guarantee the user data starts on the requested boundary.
  * 
  * @param size Bytes requested by the user.
@@ -120,83 +392,371 @@ void* sentry_allocate_aligned(size_t size, size_t alignment, MEM_SENTRY::heap::H
     if(size == 0) 
         size = 1;
 
-    uint16_t header_size = sizeof(MEM_SENTRY::alloc_header::AllocHeader);
-    size_t total_requested_memory = size + alignment + header_size + sizeof(int); // int for the signature at the end of data.
-    
-    void* ptr;
-    while ((ptr = malloc(total_requested_memory)) == nullptr){
-        std::new_handler nh = std::get_new_handler();
+    return sentry_allocate_block(size, alignment, block_bytes(size, alignment), pHeap);
+}
 
-        if(nh){
-            nh();
-        } else {
-            break;
-        }
-    }
+/**
+ * @brief Free-path canary check of a tracked block, when its heap asks for one.
+ * An overwrite goes to the heap's reporter; without one it is printed and, as the
+ * plain end marker assert used to, stops debug builds.
+ * 
+ * @param pMem Pointer to the user data.
+ * @param size Bytes of user data.
+ */
+void sentry_check_canaries(void* pMem, size_t size, MEM_SENTRY::alloc_header::AllocHeader* pHeader,
+    MEM_SENTRY::heap::Heap* pHeap){
+    if(!pHeap->ChecksCanariesOnFree())
+        return;
 
-    if(!ptr) 
-        return nullptr;
+    MEM_SENTRY::canary::Corruption corruption = MEM_SENTRY::canary::Inspect(pMem, size);
 
-    char *pOriginalMem = (char *) ptr;
+    if(corruption != MEM_SENTRY::canary::Corruption::None){
+        bool reported = pHeap->ReportCorruption(pHeader, corruption);
+        assert(reported && "heap block overflowed its end marker");
+        (void)reported;
+    }
+}
 
-    uintptr_t rawAddr = (uintptr_t) pOriginalMem;
+/**
+ * @brief Unified deallocation function.
+ * Works for both standard and aligned allocations because it retrieves
+ * the original address from the header, and for both backends (malloc, slab)
+ * because the header records which one produced the block. Both header
+ * layouts (full and MEM_SENTRY_COMPACT_HEADER) are read through the
+ * alloc_header accessors; unsampled blocks (LightHeader) and arena objects
+ * (left to ArenaHeap::Reset()) are told apart by the kind byte right before
+ * the user data.
+ * 
+ * @param pMem Pointer to the user data to free.
+ */
+void sentry_deallocate(void *pMem){
+    if (!pMem) return;
 
-    size_t data_size = size + sizeof(int); // data + signature.
+    MEM_SENTRY::alloc_header::BlockKind blockKind = MEM_SENTRY::alloc_header::KindOf(pMem);
 
-    uintptr_t potential_data_start = rawAddr + header_size; 
+    // arena objects are freed all at once by ArenaHeap::Reset().
+    if(blockKind == MEM_SENTRY::alloc_header::BlockKind::Arena)
+        return;
 
-    // the alignment must be power of 2, which is gauranteed via `calculate_aligned_memory_size()`
-    size_t mask = alignment - 1;
-    uintptr_t aligned_data_addr = (potential_data_start + mask) & ~mask;
+    // every layout ends with its kind byte, so unsampled blocks are recognized first.
+    if(MEM_SENTRY::alloc_header::IsLight(blockKind)){
+        sentry_deallocate_light(pMem);
+        return;
+    }
     
-    char* pMem = (char*) aligned_data_addr;
+    // Backtrack to find the header
+    MEM_SENTRY::alloc_header::AllocHeader *pHeader = (MEM_SENTRY::alloc_header::AllocHeader *) (
+        (char *)pMem - sizeof(MEM_SENTRY::alloc_header::AllocHeader)
+    );
 
-    // add end signature at the end.
-    int* signature_addr = (int*)(pMem + size);
-    *signature_addr = MEM_SENTRY::constants::MEMSYSTEM_ENDMARKER;
+    // to make sure we don't free data that is not allocated by our memory manager.
+    assert(MEM_SENTRY::alloc_header::IsLive(pHeader));
 
-    // backward header_size bytes to get the header address.
-    char* header_addr = (char*)(pMem - header_size); 
-    MEM_SENTRY::alloc_header::AllocHeader *pHeader = (MEM_SENTRY::alloc_header::AllocHeader *) header_addr;
+    MEM_SENTRY::heap::Heap* pHeap = MEM_SENTRY::alloc_header::GetHeap(pHeader);
+    void* pOriginal = MEM_SENTRY::alloc_header::GetOriginalAddress(pHeader);
+    MEM_SENTRY::alloc_header::BlockKind kind = pHeader->m_Kind;
 
-    set_alloc_header(size, alignment, pOriginalMem, pHeader, pHeap);
+    sentry_check_canaries(pMem, pHeader->m_Size, pHeader, pHeap);
 
-    pHeap->AddAllocation(pHeader);
+    MEM_SENTRY::callsite::Account(MEM_SENTRY::alloc_header::GetStackId(pHeader), -(int64_t)pHeader->m_Size, -1);
 
-    return pMem;
+    pHeap->RemoveAlloc(pHeader);
+
+    // mark as freed memory (compact headers overwrite the kind, read above).
+    MEM_SENTRY::alloc_header::MarkFreed(pHeader);
+
+    sentry_raw_free(pOriginal, kind, pHeap);
 }
 
 /**
- * @brief Unified deallocation function.
- * Works for both standard and aligned allocations because it retrieves
- * the 'p_OriginalAddress' from the header.
+ * @brief Frees a block whose size, alignment and raw size the caller knows.
+ * Same as sentry_deallocate(), but the end marker is found from `size` instead of the
+ * header, and slab chunks return to their size class without a read of the page header.
+ * Debug builds check that the size matches the one recorded at allocation.
  * 
  * @param pMem Pointer to the user data to free.
+ * @param size Bytes of user data the block was allocated with (never 0).
+ * @param alignment Alignment it was allocated with, 0 for the default alignment.
+ * @param rawBytes block_bytes(size, alignment).
  */
-void sentry_deallocate(void *pMem){
+void sentry_deallocate_block(void *pMem, size_t size, size_t alignment, size_t rawBytes){
     if (!pMem) return;
-    
-    // Backtrack to find the header
+
+    MEM_SENTRY::alloc_header::BlockKind kind = MEM_SENTRY::alloc_header::KindOf(pMem);
+
+    if(kind == MEM_SENTRY::alloc_header::BlockKind::Arena)
+        return;
+
+    if(MEM_SENTRY::alloc_header::IsLight(kind)){
+        MEM_SENTRY::alloc_header::LightHeader* pHeader = (MEM_SENTRY::alloc_header::LightHeader*) pMem - 1;
+
+        assert(pHeader->m_Size == (uint32_t)size && "sized delete does not match the allocation");
+        assert(MEM_SENTRY::canary::Inspect(pMem, size) == MEM_SENTRY::canary::Corruption::None);
+
+        void* pOriginal = pHeader->m_AlignShift ? *(void**)((char*)pHeader - sizeof(void*)) : (void*)pHeader;
+        MEM_SENTRY::heap::Heap* pHeap = pHeader->p_Heap;
+        uint8_t slabShard = pHeader->m_SlabShard;
+
+        pHeader->m_Kind = MEM_SENTRY::alloc_header::BlockKind::Freed;
+
+        sentry_raw_free_sized(pOriginal, kind, pHeap, slabShard, light_block_bytes(size, alignment));
+        return;
+    }
+
     MEM_SENTRY::alloc_header::AllocHeader *pHeader = (MEM_SENTRY::alloc_header::AllocHeader *) (
         (char *)pMem - sizeof(MEM_SENTRY::alloc_header::AllocHeader)
     );
 
-    // to make sure we don't free data that is not allocated by our memory manager.
-    assert(pHeader->m_Signature == MEM_SENTRY::constants::MEMSYSTEM_SIGNATURE);
+    assert(MEM_SENTRY::alloc_header::IsLive(pHeader));
+    assert(pHeader->m_Size == (uint32_t)size && "sized delete does not match the allocation");
+
+    MEM_SENTRY::heap::Heap* pHeap = MEM_SENTRY::alloc_header::GetHeap(pHeader);
+    void* pOriginal = MEM_SENTRY::alloc_header::GetOriginalAddress(pHeader);
+    uint8_t slabShard = MEM_SENTRY::alloc_header::GetSlabShard(pHeader);
+    kind = pHeader->m_Kind;
+
+    sentry_check_canaries(pMem, size, pHeader, pHeap);
+
+    MEM_SENTRY::callsite::Account(MEM_SENTRY::alloc_header::GetStackId(pHeader), -(int64_t)size, -1);
+
+    pHeap->RemoveAlloc(pHeader);
+
+    MEM_SENTRY::alloc_header::MarkFreed(pHeader);
+
+    sentry_raw_free_sized(pOriginal, kind, pHeap, slabShard, rawBytes);
+}
+
+/**
+ * @brief Deallocation with the size (and alignment) the compiler passes to sized delete.
+ * See sentry_deallocate_block().
+ * 
+ * @param pMem Pointer to the user data to free.
+ * @param size Bytes requested when the block was allocated.
+ * @param alignment Alignment it was allocated with, 0 for the default alignment.
+ */
+void sentry_deallocate_sized(void *pMem, size_t size, size_t alignment){
+    // the allocation path serves 0 bytes as 1.
+    if(size == 0)
+        size = 1;
+
+    sentry_deallocate_block(pMem, size, alignment, block_bytes(size, alignment));
+}
+
+// ============================================================================
+// FIXED-SIZE BLOCKS (ISentry fast path)
+// ============================================================================
+
+void* sentry_allocate_fixed(size_t size, size_t alignment, size_t rawBytes, MEM_SENTRY::heap::Heap* pHeap){
+#if MEM_SENTRY_ENABLE
+    // the ISentry operator new: retried through the new_handler.
+    return sentry_with_new_handler([&]{
+        return pHeap->IsArena()
+            ? static_cast<MEM_SENTRY::heap::ArenaHeap*>(pHeap)->Allocate(size, alignment)
+            : sentry_allocate_block(size, alignment, rawBytes, pHeap);
+    });
+#else
+    (void)rawBytes;
+    (void)pHeap;
+    return alignment ? std::aligned_alloc(alignment, size) : malloc(size);
+#endif
+}
+
+void sentry_deallocate_fixed(void* pMem, size_t size, size_t alignment, size_t rawBytes) noexcept {
+#if MEM_SENTRY_ENABLE
+    sentry_deallocate_block(pMem, size, alignment, rawBytes);
+#else
+    (void)size;
+    (void)alignment;
+    (void)rawBytes;
+    free(pMem);
+#endif
+}
+
+// ============================================================================
+// RECYCLED BLOCKS
+// ============================================================================
+
+void sentry_detach_block(void* pMem) noexcept {
+    MEM_SENTRY::alloc_header::AllocHeader* pHeader = (MEM_SENTRY::alloc_header::AllocHeader*) pMem - 1;
+
+    MEM_SENTRY::callsite::Account(MEM_SENTRY::alloc_header::GetStackId(pHeader), -(int64_t)pHeader->m_Size, -1);
+
+    MEM_SENTRY::alloc_header::GetHeap(pHeader)->RemoveAlloc(pHeader);
+}
+
+void sentry_attach_block(void* pMem) noexcept {
+    MEM_SENTRY::alloc_header::AllocHeader* pHeader = (MEM_SENTRY::alloc_header::AllocHeader*) pMem - 1;
+    MEM_SENTRY::heap::Heap* pHeap = MEM_SENTRY::alloc_header::GetHeap(pHeader);
+
+    // the call site of this allocation, not of the block's previous life.
+    uint32_t stackId = MEM_SENTRY::constants::CALLSITE_NO_STACK;
+
+    if(!MEM_SENTRY_COMPACT_HEADER && pHeap->GetCallSiteDepth()){
+        stackId = MEM_SENTRY::callsite::Capture(pHeap->GetCallSiteDepth(), 1);
+        MEM_SENTRY::callsite::Account(stackId, pHeader->m_Size, 1);
+    }
+
+    MEM_SENTRY::alloc_header::SetStackId(pHeader, stackId);
+
+    // a fresh allocation ID, linked at the end of its shard list like a new block.
+    pHeap->AddAllocation(pHeader);
+}
+
+void sentry_free_detached(void* pMem) noexcept {
+    MEM_SENTRY::alloc_header::AllocHeader* pHeader = (MEM_SENTRY::alloc_header::AllocHeader*) pMem - 1;
+
+    MEM_SENTRY::heap::Heap* pHeap = MEM_SENTRY::alloc_header::GetHeap(pHeader);
+    void* pOriginal = MEM_SENTRY::alloc_header::GetOriginalAddress(pHeader);
+    MEM_SENTRY::alloc_header::BlockKind kind = pHeader->m_Kind;
+
+    MEM_SENTRY::alloc_header::MarkFreed(pHeader);
+
+    sentry_raw_free(pOriginal, kind, pHeap);
+}
+
+// ============================================================================
+// REALLOCATION
+// ============================================================================
+
+/**
+ * @brief Returns true if a block can hold `size` user bytes without moving.
+ * Malloc blocks may use the slack malloc_usable_size() reports. Slab chunks must
+ * stay in their size class, because the sized free path recomputes the class
+ * from the size. Mapped blocks are resized here with mapped::Resize(), so their
+ * pages grow or go back to the OS with the block.
+ * 
+ * @param pMem Pointer to the user data.
+ * @param pOriginal The raw pointer the block was obtained at.
+ * @param kind The backend recorded in the header.
+ * @param rawBytes Raw bytes the block was requested with (block_bytes() / light_block_bytes()).
+ * @param newRawBytes The same for the new size.
+ * @param pHeap The heap of the block.
+ */
+bool sentry_fits_in_place(void* pMem, size_t size, void* pOriginal, MEM_SENTRY::alloc_header::BlockKind kind,
+    size_t rawBytes, size_t newRawBytes, MEM_SENTRY::heap::Heap* pHeap){
+    if(MEM_SENTRY::alloc_header::IsSlab(kind)){
+        return MEM_SENTRY::slab::SlabCache::ClassOf(rawBytes) == MEM_SENTRY::slab::SlabCache::ClassOf(newRawBytes);
+    }
+
+    if(MEM_SENTRY::alloc_header::IsMapped(kind)){
+        int64_t delta;
+
+        if(!MEM_SENTRY::mapped::Resize(pOriginal, pMem, size + sizeof(int) + MEM_SENTRY::constants::REDZONE_BYTES, delta))
+            return false;
+
+        pHeap->AddMapped(delta, 0);
+        return true;
+    }
+
+    size_t offset = (char*)pMem - (char*)pOriginal;
+    return offset + size + sizeof(int) + MEM_SENTRY::constants::REDZONE_BYTES <= malloc_usable_size(pOriginal);
+}
+
+/**
+ * @brief Moves a block that can't be resized in place: allocates `size` bytes from the
+ * same heap with the same alignment, copies the data and frees the old block.
+ * 
+ * @return void* The new block, or nullptr (old block untouched) when out of memory.
+ */
+void* sentry_move(void* pMem, size_t oldSize, size_t size, size_t alignment, MEM_SENTRY::heap::Heap* pHeap){
+    void* pNew = alignment ? sentry_allocate_aligned(size, alignment, pHeap) : sentry_allocate(size, pHeap);
+
+    if(!pNew)
+        return nullptr;
 
-    // mark as freed memory.
-    pHeader->m_Signature = MEM_SENTRY::constants::MEMSYSTEM_FREED_SIGNATURE;
+    std::memcpy(pNew, pMem, oldSize < size ? oldSize : size);
+    sentry_deallocate(pMem);
+
+    return pNew;
+}
+
+/**
+ * @brief Tracked realloc().
+ * Resizes the block in place when its raw memory has room (malloc slack, or the
+ * same slab size class): only `m_Size`, the canaries and the heap totals change,
+ * the block stays linked and keeps its ID. Otherwise the block moves within its
+ * heap, keeping its alignment.
+ * 
+ * @param pMem Block to resize, nullptr to allocate from the default heap.
+ * @param size New size in bytes (0 is served as 1, like the allocation path).
+ * 
+ * @return void* The resized block, or nullptr (old block untouched) when out of memory
+ * or when `size` is past alloc_header::MAX_BLOCK_SIZE.
+ * @note Arena objects don't record their size and can't be reallocated.
+ */
+void* sentry_reallocate(void* pMem, size_t size){
+    if(!pMem)
+        return sentry_allocate(size, MEM_SENTRY::heap::HeapFactory::GetDefaultHeap());
+
+    if(size == 0)
+        size = 1;
+
+    // in place or moved, the new size must fit the 32-bit size of the header.
+    if(size > MEM_SENTRY::alloc_header::MAX_BLOCK_SIZE) [[unlikely]]
+        return nullptr;
+
+    MEM_SENTRY::alloc_header::BlockKind kind = MEM_SENTRY::alloc_header::KindOf(pMem);
+
+    if(kind == MEM_SENTRY::alloc_header::BlockKind::Arena){
+        assert(false && "arena objects can't be reallocated");
+        return nullptr;
+    }
 
-    int* pEndMarker = (int*) ((char *)pMem + pHeader->m_Size);
+    if(MEM_SENTRY::alloc_header::IsLight(kind)){
+        MEM_SENTRY::alloc_header::LightHeader* pHeader = (MEM_SENTRY::alloc_header::LightHeader*) pMem - 1;
 
-    /*
-        make sure the end marker is with our signature to avoid free beyond the array.
-    */ 
-    assert(*pEndMarker == MEM_SENTRY::constants::MEMSYSTEM_ENDMARKER); 
+        assert(MEM_SENTRY::canary::Inspect(pMem, pHeader->m_Size) == MEM_SENTRY::canary::Corruption::None);
 
-    pHeader->p_Heap->RemoveAlloc(pHeader);
+        size_t alignment = pHeader->m_AlignShift ? (size_t)1 << pHeader->m_AlignShift : 0;
+        void* pOriginal = alignment ? *(void**)((char*)pHeader - sizeof(void*)) : (void*)pHeader;
 
-    free(pHeader->p_OriginalAddress);
+        if(sentry_fits_in_place(pMem, size, pOriginal, kind,
+            light_block_bytes(pHeader->m_Size, alignment), light_block_bytes(size, alignment), pHeader->p_Heap)){
+            pHeader->m_Size = (uint32_t)size;
+            MEM_SENTRY::canary::Arm(pMem, size);
+            return pMem;
+        }
+
+        return sentry_move(pMem, pHeader->m_Size, size, alignment, pHeader->p_Heap);
+    }
+
+    MEM_SENTRY::alloc_header::AllocHeader *pHeader = (MEM_SENTRY::alloc_header::AllocHeader *) (
+        (char *)pMem - sizeof(MEM_SENTRY::alloc_header::AllocHeader)
+    );
+
+    assert(MEM_SENTRY::alloc_header::IsLive(pHeader));
+
+    MEM_SENTRY::heap::Heap* pHeap = MEM_SENTRY::alloc_header::GetHeap(pHeader);
+    size_t alignment = MEM_SENTRY::alloc_header::GetAlignment(pHeader);
+
+    // moving the end marker would hide an overwrite of the old one.
+    sentry_check_canaries(pMem, pHeader->m_Size, pHeader, pHeap);
+
+    // a shrinking mapped block moves its end marker under the shard lock before the tail
+    // is unmapped: a scrub holding the lock must never read the old end in the freed pages.
+    if(MEM_SENTRY::alloc_header::IsMapped(kind) && size < pHeader->m_Size){
+        MEM_SENTRY::callsite::Account(MEM_SENTRY::alloc_header::GetStackId(pHeader),
+            (int64_t)size - (int64_t)pHeader->m_Size, 0);
+        pHeap->ResizeAllocation(pHeader, size);
+
+        int64_t delta;
+        // shrinking never fails: at worst the pages stay mapped.
+        MEM_SENTRY::mapped::Resize(MEM_SENTRY::alloc_header::GetOriginalAddress(pHeader), pMem,
+            size + sizeof(int) + MEM_SENTRY::constants::REDZONE_BYTES, delta);
+        pHeap->AddMapped(delta, 0);
+
+        return pMem;
+    }
+
+    if(sentry_fits_in_place(pMem, size, MEM_SENTRY::alloc_header::GetOriginalAddress(pHeader), kind,
+        block_bytes(pHeader->m_Size, alignment), block_bytes(size, alignment), pHeap)){
+        MEM_SENTRY::callsite::Account(MEM_SENTRY::alloc_header::GetStackId(pHeader),
+            (int64_t)size - (int64_t)pHeader->m_Size, 0);
+        pHeap->ResizeAllocation(pHeader, size);
+        return pMem;
+    }
+
+    return sentry_move(pMem, pHeader->m_Size, size, alignment, pHeap);
 }
 
 // ============================================================================
@@ -206,7 +766,11 @@ void sentry_deallocate(void *pMem){
 // --- Standard Scalar ---
 void* operator new(size_t size, MEM_SENTRY::heap::Heap *pHeap) {
 #if MEM_SENTRY_ENABLE
-    void* ptr = sentry_allocate(size, pHeap);
+    void* ptr = sentry_with_new_handler([&]{
+        return pHeap->IsArena()
+            ? static_cast<MEM_SENTRY::heap::ArenaHeap*>(pHeap)->Allocate(size)
+            : sentry_allocate(size, pHeap);
+    });
     
     if(!ptr){
         throw std::bad_alloc();
@@ -247,7 +811,11 @@ void operator delete[](void* pMem) noexcept {
 void* operator new(size_t size, std::align_val_t alignment, MEM_SENTRY::heap::Heap *pHeap) {
     size_t alignment_size = calculate_aligned_memory_size(alignment);
 #if MEM_SENTRY_ENABLE
-    void* ptr = sentry_allocate_aligned(size, alignment_size, pHeap);
+    void* ptr = sentry_with_new_handler([&]{
+        return pHeap->IsArena()
+            ? static_cast<MEM_SENTRY::heap::ArenaHeap*>(pHeap)->Allocate(size, alignment_size)
+            : sentry_allocate_aligned(size, alignment_size, pHeap);
+    });
 
     if(!ptr){
         throw std::bad_alloc();
@@ -289,11 +857,13 @@ void operator delete[](void* pMem, std::align_val_t alignment) noexcept {
 // NOTHROW NEW OPERATORS (Return nullptr on failure)
 // ============================================================================
 
+// like the standard ones: the throwing operator new, new_handler included, with the exception caught.
 void* operator new(std::size_t size, const std::nothrow_t& tag) noexcept {
     if(size == 0)  
         size = 1;
 #if MEM_SENTRY_ENABLE
-    return sentry_allocate(size, MEM_SENTRY::heap::HeapFactory::GetDefaultHeap());
+    try { return ::operator new(size); }
+    catch(...) { return nullptr; }
 #else
     return malloc(size);
 #endif
@@ -306,7 +876,9 @@ void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
 void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t& tag) noexcept {
     size_t alignment_size = calculate_aligned_memory_size(al);
 #if MEM_SENTRY_ENABLE
-    return sentry_allocate_aligned(size, alignment_size, MEM_SENTRY::heap::HeapFactory::GetDefaultHeap());
+    (void)alignment_size;
+    try { return ::operator new(size, al); }
+    catch(...) { return nullptr; }
 #else
     return std::aligned_alloc(size, alignment_size);
 #endif
@@ -341,17 +913,88 @@ void operator delete[](void* ptr, std::align_val_t al, const std::nothrow_t& tag
 // ============================================================================
 
 void operator delete(void* ptr, std::size_t sz) noexcept {
-    ::operator delete(ptr);
+#if MEM_SENTRY_ENABLE
+    sentry_deallocate_sized(ptr, sz, 0);
+#else
+    free(ptr);
+#endif
 }
 
 void operator delete[](void* ptr, std::size_t sz) noexcept {
-    ::operator delete(ptr);
+    ::operator delete(ptr, sz);
 }
 
 void operator delete(void* ptr, std::size_t sz, std::align_val_t al) noexcept {
-    ::operator delete(ptr, al);
+#if MEM_SENTRY_ENABLE
+    sentry_deallocate_sized(ptr, sz, calculate_aligned_memory_size(al));
+#else
+    free(ptr);
+#endif
 }
 
 void operator delete[](void* ptr, std::size_t sz, std::align_val_t al) noexcept {
-    ::operator delete[](ptr, al);
-}
\ No newline at end of file
+    ::operator delete(ptr, sz, al);
+}
+
+// ============================================================================
+// C-STYLE ALLOCATION
+// ============================================================================
+
+// the C-style calls never run the new_handler (it may throw out of these noexcept calls):
+// they fail once with nullptr, like malloc.
+void* ms_malloc(size_t size, MEM_SENTRY::heap::Heap* pHeap) noexcept {
+#if MEM_SENTRY_ENABLE
+    if(!pHeap)
+        pHeap = MEM_SENTRY::heap::HeapFactory::GetDefaultHeap();
+
+    void* ptr = pHeap->IsArena()
+        ? static_cast<MEM_SENTRY::heap::ArenaHeap*>(pHeap)->Allocate(size)
+        : sentry_allocate(size, pHeap);
+
+    if(!ptr){
+        MEM_SENTRY::stats::Count(MEM_SENTRY::stats::Counter::AllocFailures);
+    }
+
+    return ptr;
+#else
+    (void)pHeap;
+    return malloc(size);
+#endif
+}
+
+void* ms_calloc(size_t count, size_t size, MEM_SENTRY::heap::Heap* pHeap) noexcept {
+    size_t bytes;
+
+    if(__builtin_mul_overflow(count, size, &bytes))
+        return nullptr;
+
+    void* ptr = ms_malloc(bytes, pHeap);
+
+    if(ptr){
+        std::memset(ptr, 0, bytes);
+    }
+
+    return ptr;
+}
+
+void* ms_realloc(void* pMem, size_t size) noexcept {
+#if MEM_SENTRY_ENABLE
+    void* ptr = sentry_reallocate(pMem, size);
+
+    if(!ptr){
+        MEM_SENTRY::stats::Count(MEM_SENTRY::stats::Counter::AllocFailures);
+    }
+
+    return ptr;
+#else
+    return realloc(pMem, size);
+#endif
+}
+
+void ms_free(void* pMem) noexcept {
+#if MEM_SENTRY_ENABLE
+    sentry_deallocate(pMem);
+#else
+    free(pMem);
+#endif
+}
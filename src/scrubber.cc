@@ -0,0 +1,71 @@
+#include "mem_sentry/scrubber.h"
+
+MEM_SENTRY::heap::Scrubber::Scrubber(std::chrono::microseconds interval, size_t batch)
+    : m_Interval(interval), m_Batch(batch ? batch : 1) {
+    m_Worker = std::thread(&Scrubber::run, this);
+}
+
+MEM_SENTRY::heap::Scrubber::~Scrubber(){
+    m_Stop.store(true, std::memory_order_release);
+
+    if(m_Worker.joinable()){
+        m_Worker.join();
+    }
+}
+
+void MEM_SENTRY::heap::Scrubber::Watch(Heap* heap){
+    if(!heap)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    for(const Watched& watched : m_Heaps){
+        if(watched.p_Heap == heap)
+            return;
+    }
+
+    m_Heaps.push_back(Watched{heap, ScrubCursor{}});
+}
+
+void MEM_SENTRY::heap::Scrubber::Unwatch(Heap* heap){
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    for(size_t i = 0; i < m_Heaps.size(); ++i){
+        if(m_Heaps[i].p_Heap == heap){
+            m_Heaps[i] = m_Heaps.back();
+            m_Heaps.pop_back();
+            return;
+        }
+    }
+}
+
+size_t MEM_SENTRY::heap::Scrubber::Step(){
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    size_t found = 0;
+    for(Watched& watched : m_Heaps){
+        found += watched.p_Heap->Scrub(watched.m_Cursor, m_Batch);
+    }
+
+    m_Found.fetch_add(found, std::memory_order_relaxed);
+
+    return found;
+}
+
+uint64_t MEM_SENTRY::heap::Scrubber::GetPasses(Heap* heap){
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    for(const Watched& watched : m_Heaps){
+        if(watched.p_Heap == heap)
+            return watched.m_Cursor.m_Passes;
+    }
+
+    return 0;
+}
+
+void MEM_SENTRY::heap::Scrubber::run(){
+    while(!m_Stop.load(std::memory_order_acquire)){
+        Step();
+        std::this_thread::sleep_for(m_Interval);
+    }
+}
@@ -0,0 +1,105 @@
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+#include "mem_sentry/slab.h"
+
+MEM_SENTRY::slab::SlabPage* MEM_SENTRY::slab::SlabCache::newPage(size_t classIndex){
+    // std::aligned_alloc is not routed through our operators, so this never re-enters the heap.
+    void* mem = std::aligned_alloc(constants::SLAB_PAGE_SIZE, constants::SLAB_PAGE_SIZE);
+
+    if(!mem)
+        return nullptr;
+
+    // bind before the header write faults the page in (the move covers recycled memory).
+    if(m_Node != numa::NO_NODE)
+        numa::BindMemory(mem, constants::SLAB_PAGE_SIZE, m_Node);
+
+    SlabPage* page = new (mem) SlabPage;
+    page->p_Owner = this;
+    page->m_Shard = m_Shard;
+    page->m_Class = static_cast<uint32_t>(classIndex);
+    page->m_ChunkSize = static_cast<uint32_t>((classIndex + 1) * constants::SLAB_CLASS_GRANULARITY);
+    page->m_Carved = sizeof(SlabPage);
+
+    page->p_Next = p_Pages;
+    p_Pages = page;
+    ++m_PageCount;
+
+    p_Current[classIndex] = page;
+
+    return page;
+}
+
+void* MEM_SENTRY::slab::SlabCache::allocate(size_t bytes){
+    size_t classIndex = ClassOf(bytes);
+
+    if(classIndex == constants::SLAB_CLASSES)
+        return nullptr;
+
+    // 1. recycle a freed chunk of the same class.
+    if(FreeChunk* chunk = p_FreeLists[classIndex]){
+        p_FreeLists[classIndex] = chunk->p_Next;
+        ++m_LiveChunks;
+        return chunk;
+    }
+
+    // 2. carve the current page, mapping a new one when it is full.
+    SlabPage* page = p_Current[classIndex];
+
+    if(!page || page->m_Carved + page->m_ChunkSize > constants::SLAB_PAGE_SIZE){
+        page = newPage(classIndex);
+
+        if(!page)
+            return nullptr;
+    }
+
+    char* chunk = reinterpret_cast<char*>(page) + page->m_Carved;
+    page->m_Carved += page->m_ChunkSize;
+    ++m_LiveChunks;
+
+    return chunk;
+}
+
+void MEM_SENTRY::slab::SlabCache::free(void* chunk){
+    if(!chunk)
+        return;
+
+    free(chunk, PageOf(chunk)->m_Class);
+}
+
+void MEM_SENTRY::slab::SlabCache::free(void* chunk, size_t classIndex){
+    if(!chunk)
+        return;
+
+    assert(PageOf(chunk)->m_Class == classIndex && "chunk freed with the wrong size class");
+
+    FreeChunk* node = static_cast<FreeChunk*>(chunk);
+    node->p_Next = p_FreeLists[classIndex];
+    p_FreeLists[classIndex] = node;
+
+    --m_LiveChunks;
+}
+
+bool MEM_SENTRY::slab::SlabCache::release(){
+    if(m_LiveChunks != 0)
+        return false;
+
+    SlabPage* page = p_Pages;
+
+    while(page){
+        SlabPage* next = page->p_Next;
+        std::free(page);
+        page = next;
+    }
+
+    p_Pages = nullptr;
+    m_PageCount = 0;
+
+    for(size_t i = 0; i < constants::SLAB_CLASSES; ++i){
+        p_FreeLists[i] = nullptr;
+        p_Current[i] = nullptr;
+    }
+
+    return true;
+}
@@ -0,0 +1,245 @@
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "mem_sentry/snapshot.h"
+
+namespace {
+    /** @brief One block, used to sort the parallel arrays together. */
+    struct Entry {
+        uint32_t m_Id;
+        uint32_t m_Size;
+        uint32_t m_Alignment;
+        const void* p_Address;
+    };
+
+    /** @brief Grows one array with realloc, leaving it untouched on failure. */
+    template<typename T>
+    bool grow(T*& array, size_t capacity) noexcept {
+        T* grown = static_cast<T*>(std::realloc(array, capacity * sizeof(T)));
+
+        if(!grown)
+            return false;
+
+        array = grown;
+        return true;
+    }
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    /**
+     * @brief Bit `k` is set when `a[k]` equals one of `b[0..3]`: `a` is compared
+     * against the 4 rotations of `b`, which covers all 16 pairs.
+     */
+    inline unsigned matchMask(const uint32_t* a, const uint32_t* b) noexcept {
+#if defined(__SSE2__)
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+
+        return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+#else
+        uint32x4_t va = vld1q_u32(a);
+        uint32x4_t vb = vld1q_u32(b);
+
+        uint32x4_t eq = vceqq_u32(va, vb);
+        eq = vorrq_u32(eq, vceqq_u32(va, vextq_u32(vb, vb, 1)));
+        eq = vorrq_u32(eq, vceqq_u32(va, vextq_u32(vb, vb, 2)));
+        eq = vorrq_u32(eq, vceqq_u32(va, vextq_u32(vb, vb, 3)));
+
+        const uint32_t bits[4] = {1, 2, 4, 8};
+        return vaddvq_u32(vandq_u32(eq, vld1q_u32(bits)));
+#endif
+    }
+#endif
+}
+
+MEM_SENTRY::heap::HeapSnapshot::~HeapSnapshot(){
+    std::free(p_Ids);
+    std::free(p_Sizes);
+    std::free(p_Alignments);
+    std::free(p_Addresses);
+}
+
+MEM_SENTRY::heap::HeapSnapshot::HeapSnapshot(HeapSnapshot&& other) noexcept
+    : p_Ids(std::exchange(other.p_Ids, nullptr)),
+      p_Sizes(std::exchange(other.p_Sizes, nullptr)),
+      p_Alignments(std::exchange(other.p_Alignments, nullptr)),
+      p_Addresses(std::exchange(other.p_Addresses, nullptr)),
+      m_Count(std::exchange(other.m_Count, 0)),
+      m_Capacity(std::exchange(other.m_Capacity, 0)) {}
+
+MEM_SENTRY::heap::HeapSnapshot& MEM_SENTRY::heap::HeapSnapshot::operator=(HeapSnapshot&& other) noexcept {
+    if(this != &other){
+        std::swap(p_Ids, other.p_Ids);
+        std::swap(p_Sizes, other.p_Sizes);
+        std::swap(p_Alignments, other.p_Alignments);
+        std::swap(p_Addresses, other.p_Addresses);
+        std::swap(m_Count, other.m_Count);
+        std::swap(m_Capacity, other.m_Capacity);
+    }
+
+    return *this;
+}
+
+bool MEM_SENTRY::heap::HeapSnapshot::Reserve(size_t capacity) noexcept {
+    if(capacity <= m_Capacity)
+        return true;
+
+    // each array keeps its old contents if a later one fails, so the snapshot stays usable.
+    if(!grow(p_Ids, capacity) || !grow(p_Sizes, capacity) ||
+       !grow(p_Alignments, capacity) || !grow(p_Addresses, capacity))
+        return false;
+
+    m_Capacity = capacity;
+    return true;
+}
+
+void MEM_SENTRY::heap::HeapSnapshot::Sort(){
+    bool sorted = true;
+
+    for(size_t i = 1; i < m_Count && sorted; ++i){
+        sorted = p_Ids[i - 1] < p_Ids[i];
+    }
+
+    // a single shard list is already sorted and unique.
+    if(sorted)
+        return;
+
+    Entry* entries = static_cast<Entry*>(std::malloc(m_Count * sizeof(Entry)));
+
+    if(!entries)
+        return;
+
+    for(size_t i = 0; i < m_Count; ++i){
+        entries[i] = Entry{p_Ids[i], p_Sizes[i], p_Alignments[i], p_Addresses[i]};
+    }
+
+    std::sort(entries, entries + m_Count, [](const Entry& a, const Entry& b){
+        return a.m_Id < b.m_Id;
+    });
+
+    size_t count = 0;
+
+    for(size_t i = 0; i < m_Count; ++i){
+        if(count && p_Ids[count - 1] == entries[i].m_Id)
+            continue;
+
+        p_Ids[count] = entries[i].m_Id;
+        p_Sizes[count] = entries[i].m_Size;
+        p_Alignments[count] = entries[i].m_Alignment;
+        p_Addresses[count] = entries[i].p_Address;
+        ++count;
+    }
+
+    m_Count = count;
+    std::free(entries);
+}
+
+uint64_t MEM_SENTRY::heap::HeapSnapshot::GetTotalBytes() const noexcept {
+    uint64_t total = 0;
+
+    for(size_t i = 0; i < m_Count; ++i){
+        total += p_Sizes[i];
+    }
+
+    return total;
+}
+
+MEM_SENTRY::heap::SnapshotDiff MEM_SENTRY::heap::Diff(const HeapSnapshot& before, const HeapSnapshot& after){
+    SnapshotDiff diff;
+
+    const uint32_t* a = before.p_Ids;
+    const uint32_t* b = after.p_Ids;
+    const size_t na = before.m_Count;
+    const size_t nb = after.m_Count;
+
+    // at most every block changes, so nothing grows during the merge.
+    if(!diff.m_Freed.Reserve(na) || !diff.m_Added.Reserve(nb))
+        return diff;
+
+    size_t i = 0;
+    size_t j = 0;
+
+    // bit k: a[i + k] (b[j + k]) already matched a block of the other side.
+    unsigned matchedA = 0;
+    unsigned matchedB = 0;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+    while(i + 4 <= na && j + 4 <= nb){
+        matchedA |= matchMask(a + i, b + j);
+        matchedB |= matchMask(b + j, a + i);
+
+        const uint32_t lastA = a[i + 3];
+        const uint32_t lastB = b[j + 3];
+
+        // a block is done once the other side has moved past its last ID.
+        if(lastA <= lastB){
+            for(unsigned k = 0; k < 4; ++k){
+                if(!(matchedA & (1u << k))){
+                    diff.m_Freed.pushFrom(before, i + k);
+                }
+            }
+
+            i += 4;
+            matchedA = 0;
+        }
+
+        if(lastB <= lastA){
+            for(unsigned k = 0; k < 4; ++k){
+                if(!(matchedB & (1u << k))){
+                    diff.m_Added.pushFrom(after, j + k);
+                }
+            }
+
+            j += 4;
+            matchedB = 0;
+        }
+    }
+#endif
+
+    // scalar merge of the rest, skipping the blocks the vector loop already matched.
+    while(i < na && j < nb){
+        if(matchedA & 1){
+            ++i;
+            matchedA >>= 1;
+        } else if(matchedB & 1){
+            ++j;
+            matchedB >>= 1;
+        } else if(a[i] < b[j]){
+            diff.m_Freed.pushFrom(before, i++);
+            matchedA >>= 1;
+        } else if(a[i] > b[j]){
+            diff.m_Added.pushFrom(after, j++);
+            matchedB >>= 1;
+        } else {
+            ++i;
+            ++j;
+            matchedA >>= 1;
+            matchedB >>= 1;
+        }
+    }
+
+    for(; i < na; ++i, matchedA >>= 1){
+        if(!(matchedA & 1)){
+            diff.m_Freed.pushFrom(before, i);
+        }
+    }
+
+    for(; j < nb; ++j, matchedB >>= 1){
+        if(!(matchedB & 1)){
+            diff.m_Added.pushFrom(after, j);
+        }
+    }
+
+    return diff;
+}
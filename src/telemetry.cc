@@ -0,0 +1,260 @@
+#include <cstdio>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "mem_sentry/telemetry.h"
+
+namespace {
+    uint64_t steadyNs() noexcept {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** @brief Copies a name into a record field, always terminated. */
+    void copyName(char* dst, const char* src) noexcept {
+        std::strncpy(dst, src ? src : "", MEM_SENTRY::telemetry::TELEMETRY_NAME_BYTES - 1);
+        dst[MEM_SENTRY::telemetry::TELEMETRY_NAME_BYTES - 1] = '\0';
+    }
+
+    /** @brief Events per second between two samples. */
+    uint64_t perSecond(uint64_t events, uint64_t ns) noexcept {
+        return ns ? (uint64_t)((double)events * 1e9 / (double)ns) : 0;
+    }
+}
+
+MEM_SENTRY::telemetry::TelemetryExporter::TelemetryExporter(const char* name, std::chrono::microseconds interval,
+    uint32_t heapSlots, uint32_t poolSlots)
+    : m_Interval(interval) {
+    if(name){
+        copyName(m_Name, name);
+    } else {
+        std::snprintf(m_Name, sizeof(m_Name), "/memsentry.%d", (int)::getpid());
+    }
+
+    const size_t bytes = RegionBytes(heapSlots, poolSlots);
+
+    // a stale region of a crashed process may have other table sizes: start over.
+    ::shm_unlink(m_Name);
+
+    int fd = ::shm_open(m_Name, O_CREAT | O_EXCL | O_RDWR, 0600);
+
+    if(fd < 0){
+        std::printf("Error: can't create telemetry region \"%s\"\n", m_Name);
+        return;
+    }
+
+    void* mem = MAP_FAILED;
+
+    if(::ftruncate(fd, (off_t)bytes) == 0){
+        mem = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+
+    ::close(fd);
+
+    if(mem == MAP_FAILED){
+        std::printf("Error: can't map telemetry region \"%s\"\n", m_Name);
+        ::shm_unlink(m_Name);
+        return;
+    }
+
+    // the object is zero-filled: every record starts free, with an even sequence.
+    p_Region = new (mem) TelemetryHeader();
+    m_Bytes = bytes;
+
+    p_Region->m_HeapSlots = heapSlots;
+    p_Region->m_PoolSlots = poolSlots;
+    p_Region->m_Pid = (int32_t)::getpid();
+    p_Region->m_IntervalNs = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+    p_Region->m_Version = TELEMETRY_VERSION;
+
+    m_Heaps.assign(heapSlots, HeapTrack{0, 0, 0, 0, 0});
+    m_Pools.assign(poolSlots, WatchedPool{nullptr, nullptr});
+
+    // readers check the magic last.
+    std::atomic_thread_fence(std::memory_order_release);
+    p_Region->m_Magic = TELEMETRY_MAGIC;
+
+    Publish();
+
+    m_Worker = std::thread(&TelemetryExporter::run, this);
+}
+
+MEM_SENTRY::telemetry::TelemetryExporter::~TelemetryExporter(){
+    {
+        std::lock_guard<std::mutex> lock(m_WakeMutex);
+        m_Stop = true;
+    }
+
+    m_Wake.notify_one();
+
+    if(m_Worker.joinable()){
+        m_Worker.join();
+    }
+
+    if(p_Region){
+        ::munmap(p_Region, m_Bytes);
+        ::shm_unlink(m_Name);
+        p_Region = nullptr;
+    }
+}
+
+bool MEM_SENTRY::telemetry::TelemetryExporter::watchPool(const char* name, void* pool, PoolSampler sample){
+    if(!p_Region || !pool)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    for(const WatchedPool& watched : m_Pools){
+        if(watched.p_Pool == pool)
+            return true;
+    }
+
+    PoolRecord* records = PoolRecords(p_Region);
+
+    for(size_t i = 0; i < m_Pools.size(); ++i){
+        if(m_Pools[i].p_Pool)
+            continue;
+
+        m_Pools[i] = WatchedPool{pool, sample};
+
+        PoolRecord& record = records[i];
+        BeginWrite(record.m_Seq);
+        copyName(record.m_Name, name);
+        sample(pool, record);
+        record.m_SampleNs.store(steadyNs(), std::memory_order_relaxed);
+        record.m_InUse.store(1, std::memory_order_relaxed);
+        EndWrite(record.m_Seq);
+
+        return true;
+    }
+
+    return false;
+}
+
+void MEM_SENTRY::telemetry::TelemetryExporter::unwatchPool(const void* pool){
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    for(size_t i = 0; i < m_Pools.size(); ++i){
+        if(m_Pools[i].p_Pool != pool)
+            continue;
+
+        m_Pools[i] = WatchedPool{nullptr, nullptr};
+
+        PoolRecord& record = PoolRecords(p_Region)[i];
+        BeginWrite(record.m_Seq);
+        record.m_InUse.store(0, std::memory_order_relaxed);
+        EndWrite(record.m_Seq);
+
+        return;
+    }
+}
+
+bool MEM_SENTRY::telemetry::TelemetryExporter::publishHeap(heap::Heap* heap, uint64_t now){
+    const uint16_t index = heap->GetIndex();
+
+    if(index >= m_Heaps.size())
+        return false;
+
+    const heap::HeapStats stats = heap->GetStats();
+
+    HeapTrack& track = m_Heaps[index];
+    HeapRecord& record = HeapRecords(p_Region)[index];
+
+    // a new heap in the record, or its counters went back: no rate this time.
+    // the generation, not the address, tells heaps apart: a heap built where a destroyed
+    // one lived can take over both its address and its index between two publishes.
+    const bool renamed = track.m_Generation != heap->GetGeneration();
+    const bool fresh = renamed || stats.m_TotalAllocs < track.m_TotalAllocs ||
+        stats.m_TotalFrees < track.m_TotalFrees;
+
+    BeginWrite(record.m_Seq);
+
+    if(renamed){
+        copyName(record.m_Name, heap->GetName());
+    }
+
+    record.m_LiveBytes.store(stats.m_LiveBytes, std::memory_order_relaxed);
+    record.m_LiveCount.store(stats.m_LiveCount, std::memory_order_relaxed);
+    record.m_TotalAllocs.store(stats.m_TotalAllocs, std::memory_order_relaxed);
+    record.m_TotalFrees.store(stats.m_TotalFrees, std::memory_order_relaxed);
+    record.m_CachedBytes.store(stats.m_CachedBytes, std::memory_order_relaxed);
+    record.m_MappedBytes.store(stats.m_MappedBytes, std::memory_order_relaxed);
+    record.m_AllocRate.store(fresh ? 0 : perSecond(stats.m_TotalAllocs - track.m_TotalAllocs, now - track.m_SampleNs),
+        std::memory_order_relaxed);
+    record.m_FreeRate.store(fresh ? 0 : perSecond(stats.m_TotalFrees - track.m_TotalFrees, now - track.m_SampleNs),
+        std::memory_order_relaxed);
+    record.m_SampleNs.store(now, std::memory_order_relaxed);
+    record.m_InUse.store(1, std::memory_order_relaxed);
+
+    EndWrite(record.m_Seq);
+
+    track = HeapTrack{heap->GetGeneration(), stats.m_TotalAllocs, stats.m_TotalFrees, now, m_Pass};
+
+    return true;
+}
+
+void MEM_SENTRY::telemetry::TelemetryExporter::Publish(){
+    if(!p_Region)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    const uint64_t now = steadyNs();
+    ++m_Pass;
+
+    struct Pass {
+        TelemetryExporter* p_Exporter;
+        uint64_t m_Now;
+        uint64_t m_Dropped;
+    } pass{this, now, 0};
+
+    heap::HeapFactory::ForEachHeap([](heap::Heap* heap, void* context){
+        Pass* pass = static_cast<Pass*>(context);
+
+        if(!pass->p_Exporter->publishHeap(heap, pass->m_Now)){
+            ++pass->m_Dropped;
+        }
+    }, &pass);
+
+    p_Region->m_DroppedHeaps.store(pass.m_Dropped, std::memory_order_relaxed);
+
+    // heaps destroyed since the last publish.
+    HeapRecord* heaps = HeapRecords(p_Region);
+
+    for(size_t i = 0; i < m_Heaps.size(); ++i){
+        if(m_Heaps[i].m_Generation && m_Heaps[i].m_Pass != m_Pass){
+            m_Heaps[i].m_Generation = 0;
+
+            BeginWrite(heaps[i].m_Seq);
+            heaps[i].m_InUse.store(0, std::memory_order_relaxed);
+            EndWrite(heaps[i].m_Seq);
+        }
+    }
+
+    PoolRecord* pools = PoolRecords(p_Region);
+
+    for(size_t i = 0; i < m_Pools.size(); ++i){
+        if(!m_Pools[i].p_Pool)
+            continue;
+
+        BeginWrite(pools[i].m_Seq);
+        m_Pools[i].p_Sample(m_Pools[i].p_Pool, pools[i]);
+        pools[i].m_SampleNs.store(now, std::memory_order_relaxed);
+        EndWrite(pools[i].m_Seq);
+    }
+
+    p_Region->m_PublishNs.store(now, std::memory_order_relaxed);
+    p_Region->m_Publishes.fetch_add(1, std::memory_order_release);
+}
+
+void MEM_SENTRY::telemetry::TelemetryExporter::run(){
+    std::unique_lock<std::mutex> lock(m_WakeMutex);
+
+    while(!m_Wake.wait_for(lock, m_Interval, [this]() { return m_Stop; })){
+        lock.unlock();
+        Publish();
+        lock.lock();
+    }
+}
@@ -0,0 +1,175 @@
+#include <cstdio>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "mem_sentry/trace_reporter.h"
+#include "mem_sentry/heap.h"
+
+namespace {
+    /**
+     * @brief OS thread id of the calling thread, cached per thread.
+     */
+    uint32_t currentThreadId() noexcept {
+        thread_local uint32_t tid = static_cast<uint32_t>(::syscall(SYS_gettid));
+        return tid;
+    }
+
+    /**
+     * @brief log2 of a power-of-two alignment, 0 when unaligned.
+     */
+    uint8_t alignShift(size_t alignment) noexcept {
+        return alignment ? static_cast<uint8_t>(__builtin_ctzll(alignment)) : 0;
+    }
+}
+
+MEM_SENTRY::reporter::BinaryTraceReporter::BinaryTraceReporter(const char* path) {
+    m_Start = std::chrono::steady_clock::now();
+
+    for(auto& named : m_Named){
+        named.store(0, std::memory_order_relaxed);
+    }
+
+    m_Fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+    if(m_Fd < 0){
+        std::printf("Error: BinaryTraceReporter can't open \"%s\"\n", path);
+        return;
+    }
+
+    // records must start on a page boundary so every window can be mapped.
+    long page = ::sysconf(_SC_PAGESIZE);
+    m_DataOffset = page > 0 ? static_cast<uint64_t>(page) : 4096;
+
+    trace::TraceFileHeader header{};
+    std::memcpy(header.m_Magic, trace::TRACE_MAGIC, sizeof(header.m_Magic));
+    header.m_Version = trace::TRACE_VERSION;
+    header.m_RecordSize = sizeof(trace::TraceRecord);
+    header.m_DataOffset = m_DataOffset;
+    header.m_StartRealtimeNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    header.m_RecordCount = 0;
+
+    if(::pwrite(m_Fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header)){
+        std::printf("Error: BinaryTraceReporter can't write the header of \"%s\"\n", path);
+        ::close(m_Fd);
+        m_Fd = -1;
+        return;
+    }
+
+    for(uint64_t w = 0; w < 2; ++w){
+        m_Windows[w].p_Data = mapWindow(w);
+        m_Windows[w].m_Base.store(w * RECORDS_PER_WINDOW, std::memory_order_release);
+    }
+}
+
+MEM_SENTRY::reporter::BinaryTraceReporter::~BinaryTraceReporter() {
+    if(m_Fd < 0)
+        return;
+
+    for(auto& window : m_Windows){
+        if(window.p_Data){
+            ::munmap(window.p_Data, trace::TRACE_WINDOW_BYTES);
+            window.p_Data = nullptr;
+        }
+    }
+
+    uint64_t count = m_Next.load(std::memory_order_acquire);
+
+    // drop the unused tail of the last window and record how many entries are valid.
+    if(::ftruncate(m_Fd, m_DataOffset + count * sizeof(trace::TraceRecord)) != 0){
+        std::printf("Error: BinaryTraceReporter can't trim the trace file\n");
+    }
+
+    if(::pwrite(m_Fd, &count, sizeof(count), offsetof(trace::TraceFileHeader, m_RecordCount)) != (ssize_t)sizeof(count)){
+        std::printf("Error: BinaryTraceReporter can't write the record count\n");
+    }
+
+    ::close(m_Fd);
+}
+
+MEM_SENTRY::trace::TraceRecord* MEM_SENTRY::reporter::BinaryTraceReporter::mapWindow(uint64_t window) noexcept {
+    uint64_t offset = m_DataOffset + window * trace::TRACE_WINDOW_BYTES;
+
+    // grow the file so the whole window is backed. Unlike ftruncate, posix_fallocate
+    // never shrinks, so two threads remapping neighbour windows can't race.
+    if(::posix_fallocate(m_Fd, offset, trace::TRACE_WINDOW_BYTES) != 0){
+        return nullptr;
+    }
+
+    void* mem = ::mmap(nullptr, trace::TRACE_WINDOW_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, m_Fd, offset);
+
+    return mem == MAP_FAILED ? nullptr : static_cast<trace::TraceRecord*>(mem);
+}
+
+void MEM_SENTRY::reporter::BinaryTraceReporter::append(const trace::TraceRecord& record) noexcept {
+    uint64_t index = m_Next.fetch_add(1, std::memory_order_relaxed);
+    uint64_t window = index / RECORDS_PER_WINDOW;
+
+    Window& slot = m_Windows[window & 1];
+
+    // only waits when writers run two full windows ahead of the remap.
+    while(slot.m_Base.load(std::memory_order_acquire) != window * RECORDS_PER_WINDOW){
+        std::this_thread::yield();
+    }
+
+    if(slot.p_Data){
+        slot.p_Data[index - window * RECORDS_PER_WINDOW] = record;
+    }
+
+    // the thread completing a window recycles it for the window after the next.
+    if(slot.m_Written.fetch_add(1, std::memory_order_acq_rel) + 1 == RECORDS_PER_WINDOW){
+        if(slot.p_Data){
+            ::munmap(slot.p_Data, trace::TRACE_WINDOW_BYTES);
+        }
+
+        slot.p_Data = mapWindow(window + 2);
+        slot.m_Written.store(0, std::memory_order_relaxed);
+        slot.m_Base.store((window + 2) * RECORDS_PER_WINDOW, std::memory_order_release);
+    }
+}
+
+void MEM_SENTRY::reporter::BinaryTraceReporter::write(trace::TraceRecordType type, alloc_header::AllocHeader* alloc) noexcept {
+    if(m_Fd < 0 || !alloc)
+        return;
+
+    heap::Heap* pHeap = alloc_header::GetHeap(alloc);
+    uint16_t heapIndex = pHeap ? pHeap->GetIndex() : static_cast<uint16_t>(constants::MAX_HEAPS);
+
+    trace::TraceRecord record{};
+    record.m_Timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_Start).count());
+    record.m_Thread = currentThreadId();
+    record.m_Heap = heapIndex;
+
+    if(pHeap && heapIndex < constants::MAX_HEAPS &&
+        m_Named[heapIndex].load(std::memory_order_relaxed) != pHeap->GetGeneration() &&
+        m_Named[heapIndex].exchange(pHeap->GetGeneration(), std::memory_order_relaxed) != pHeap->GetGeneration()){
+        trace::TraceRecord name = record;
+        name.m_Type = trace::TraceRecordType::HeapName;
+        trace::EncodeHeapName(name, pHeap->GetName());
+        append(name);
+    }
+
+    record.m_Address = reinterpret_cast<uint64_t>(alloc_header::GetAddress(alloc));
+    record.m_AllocId = alloc->m_AllocId;
+    record.m_Size = alloc->m_Size;
+    record.m_AlignShift = alignShift(alloc_header::GetAlignment(alloc));
+    record.m_Type = type;
+
+    append(record);
+}
+
+void MEM_SENTRY::reporter::BinaryTraceReporter::onAlloc(alloc_header::AllocHeader* alloc) {
+    write(trace::TraceRecordType::Alloc, alloc);
+}
+
+void MEM_SENTRY::reporter::BinaryTraceReporter::onDealloc(alloc_header::AllocHeader* alloc) {
+    write(trace::TraceRecordType::Free, alloc);
+}
+
+void MEM_SENTRY::reporter::BinaryTraceReporter::report(alloc_header::AllocHeader* alloc) {
+    write(trace::TraceRecordType::Report, alloc);
+}
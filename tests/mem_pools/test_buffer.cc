@@ -146,6 +146,24 @@ void TestInlineBufferLargeObject() {
     ASSERT_TRUE((addr % 64) == 0);
 }
 
+void TestInPlaceStorage() {
+    LOG_TEST("TestInPlaceStorage");
+
+    LifetimeTracker::constructor_calls = 0;
+    LifetimeTracker::destructor_calls = 0;
+
+    alignas(64) unsigned char storage[sizeof(LifetimeTracker)];
+    {
+        Buffer<LifetimeTracker, 64, true> b(InPlaceStorage{storage}, 77);
+        ASSERT_TRUE(static_cast<void*>(b.p_Buffer) == static_cast<void*>(storage));
+        ASSERT_EQ(b.p_Buffer->data, 77);
+        ASSERT_EQ(LifetimeTracker::constructor_calls, 1);
+    }
+
+    // the destructor runs ~T but leaves the storage to its owner.
+    ASSERT_EQ(LifetimeTracker::destructor_calls, 1);
+}
+
 int main() {
     TestDynamicBufferAlignmentAndConstruction();
     TestInlineBufferConstruction();
@@ -156,6 +174,7 @@ int main() {
     TestVariadicConstruction();
     TestExtremeAlignment();
     TestInlineBufferLargeObject();
+    TestInPlaceStorage();
 
     std::cout << "\n\033[32mAll mem_pools::Buffer tests passed successfully.\033[0m" << std::endl;
     return 0;
@@ -7,6 +7,7 @@
 #include <atomic>
 #include <algorithm>
 #include <random>
+#include <functional>
 
 #include "mem_pools/chain.h"
 #include "mem_pools/buffer.h"
@@ -553,6 +554,320 @@ void TestMassiveGrowth() {
     ASSERT_EQ(count, TARGET_POOLS);
 }
 
+/**
+ * @brief Routing through the pool bitmaps once the chain spans several groups.
+ */
+void TestBitmapRouting() {
+    LOG_TEST("TestBitmapRouting (pools across index groups)");
+
+    // Usable capacity 1 per pool, 150 pools -> three 64-pool groups.
+    PoolChain<int, alignof(int), true> chain(2, 0);
+    constexpr int POOLS = 150;
+
+    std::vector<Buffer<int, alignof(int), true>*> held;
+    for (int i = 0; i < POOLS; ++i) {
+        auto* b = chain.pop();
+        ASSERT_TRUE(b != nullptr);
+        *b->p_Buffer = i;
+        held.push_back(b);
+    }
+
+    // 1. Pushes fill the first non-full pools, pops drain in chain order.
+    for (auto* b : held) ASSERT_TRUE(chain.push(b));
+
+    auto* extra = new Buffer<int, alignof(int), true>(-1);
+    ASSERT_TRUE(!chain.push(extra));
+    delete extra;
+
+    for (int i = 0; i < POOLS; ++i) {
+        auto* b = chain.pop();
+        ASSERT_EQ(*b->p_Buffer, i);
+        held[i] = b;
+    }
+
+    // 2. Steady state deep in the chain: a single buffer keeps cycling through
+    // the first pool with room instead of walking the 149 full-or-empty ones.
+    for (int i = 0; i < POOLS - 1; ++i) ASSERT_TRUE(chain.push(held[i]));
+    auto* last = held[POOLS - 1];
+    for (int round = 0; round < 1000; ++round) {
+        ASSERT_TRUE(chain.push(last));
+        last = chain.pop();
+        ASSERT_TRUE(last != nullptr);
+    }
+    ASSERT_TRUE(chain.push(last));
+
+    // 3. Everything is back: draining takes all 150 without growing.
+    for (int i = 0; i < POOLS; ++i) held[i] = chain.pop();
+    for (int i = 0; i < POOLS; ++i) ASSERT_TRUE(chain.push(held[i]));
+    auto* another = new Buffer<int, alignof(int), true>(-1);
+    ASSERT_TRUE(!chain.push(another));
+    delete another;
+}
+
+void TestTrimPolicy() {
+    LOG_TEST("TestTrimPolicy (explicit + automatic trim)");
+    LifeTracker::active_count.store(0);
+
+    using TrackerBuffer = Buffer<LifeTracker, 64, true>;
+
+    {
+        // Usable capacity 1 per pool.
+        PoolChain<LifeTracker, 64, true> chain(2, 1);
+
+        std::vector<TrackerBuffer*> held;
+        for (int i = 0; i < 10; ++i) held.push_back(chain.pop());
+        ASSERT_EQ(chain.poolCount(), 10);
+
+        // 1. Tail pools that are not refilled are kept.
+        for (int i = 0; i < 7; ++i) ASSERT_TRUE(chain.push(held[i]));
+        ASSERT_EQ(chain.trim(), 0);
+
+        // 2. Once refilled they are unlinked, down to the low watermark...
+        for (int i = 7; i < 10; ++i) ASSERT_TRUE(chain.push(held[i]));
+        chain.setTrimPolicy(TrimPolicy{3, 0, std::chrono::milliseconds(0)});
+        ASSERT_EQ(chain.trim(), 7);
+        ASSERT_EQ(chain.poolCount(), 3);
+        ASSERT_EQ(chain.retiredCount(), 7);
+
+        // ...and freed after the producer's next push acknowledged the retirement.
+        auto* b = chain.pop();
+        ASSERT_TRUE(chain.push(b));
+        ASSERT_EQ(chain.trim(), 0);
+        ASSERT_EQ(chain.retiredCount(), 0);
+        ASSERT_EQ(LifeTracker::active_count.load(), 3);
+
+        // 3. The chain grows again after a trim, reusing emptied index groups.
+        chain.setTrimPolicy(TrimPolicy{});
+        held.clear();
+        for (int i = 0; i < 150; ++i) held.push_back(chain.pop());
+        ASSERT_EQ(chain.poolCount(), 150);
+        for (auto* h : held) ASSERT_TRUE(chain.push(h));
+        ASSERT_EQ(chain.trim(), 149);
+        ASSERT_TRUE(chain.push(chain.pop()));
+        ASSERT_EQ(chain.trim(), 0);
+        ASSERT_EQ(LifeTracker::active_count.load(), 1);
+
+        held.clear();
+        for (int i = 0; i < 100; ++i) held.push_back(chain.pop());
+        ASSERT_EQ(chain.poolCount(), 100);
+        for (auto* h : held) ASSERT_TRUE(chain.push(h));
+
+        // 4. Automatic trim in pop() once above the high watermark.
+        chain.setTrimPolicy(TrimPolicy{2, 4, std::chrono::milliseconds(0)});
+        for (int i = 0; i < 1024; ++i) ASSERT_TRUE(chain.push(chain.pop()));
+        ASSERT_EQ(chain.poolCount(), 2);
+    }
+
+    ASSERT_EQ(LifeTracker::active_count.load(), 0);
+}
+
+void TestTrimConcurrent() {
+    LOG_TEST("TestTrimConcurrent (trim while the producer pushes)");
+    LifeTracker::active_count.store(0);
+
+    using TrackerBuffer = Buffer<LifeTracker, 64, true>;
+    constexpr int ROUNDS = 2000;
+
+    {
+        PoolChain<LifeTracker, 64, true> chain(4, 1);
+        chain.setTrimPolicy(TrimPolicy{1, 8, std::chrono::milliseconds(0)});
+
+        // consumer -> producer handoff of the borrowed buffers.
+        RingPool<LifeTracker, 64, true> handoff(true, 1024, 0);
+        std::atomic<bool> done{false};
+
+        std::thread producer([&]() {
+            while (!done.load(std::memory_order_acquire) || handoff.currentSize()) {
+                if (auto* b = handoff.pop()) {
+                    while (!chain.push(b)) std::this_thread::yield();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        // bursts of growing size force growth, quiet phases let the trim run.
+        std::vector<TrackerBuffer*> burst;
+        for (int round = 0; round < ROUNDS; ++round) {
+            size_t size = 1 + (round % 50) * 4;
+            for (size_t i = 0; i < size; ++i) burst.push_back(chain.pop());
+            for (auto* b : burst) {
+                while (!handoff.push(b)) std::this_thread::yield();
+            }
+            burst.clear();
+
+            if (round % 10 == 0) chain.trim();
+        }
+
+        done.store(true, std::memory_order_release);
+        producer.join();
+
+        chain.trim();
+        chain.push(chain.pop());
+        chain.trim();
+        ASSERT_EQ(chain.retiredCount(), 0);
+        ASSERT_TRUE(chain.poolCount() < 64);
+    }
+
+    ASSERT_EQ(LifeTracker::active_count.load(), 0);
+}
+
+// Records the thread that constructed it.
+struct ThreadStamp {
+    std::thread::id m_BuiltOn;
+    ThreadStamp() : m_BuiltOn(std::this_thread::get_id()) {}
+};
+
+void TestBackgroundGrowth() {
+    LOG_TEST("TestBackgroundGrowth (helper thread + executor)");
+
+    // 1. Helper thread: pools are built ahead of time, off the consumer thread.
+    {
+        // Usable capacity 7 per pool, pre-build once fewer than 4 buffers are left.
+        PoolChain<ThreadStamp, 64, true> chain(8);
+        chain.setGrowthPolicy(GrowthPolicy{4, {}});
+        ASSERT_TRUE(!chain.hasSpare());
+
+        std::vector<Buffer<ThreadStamp, 64, true>*> held;
+        for (int i = 0; i < 4; ++i) held.push_back(chain.pop());
+        ASSERT_EQ(chain.freeBuffers(), 3);
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!chain.hasSpare() && std::chrono::steady_clock::now() < deadline) std::this_thread::yield();
+        ASSERT_TRUE(chain.hasSpare());
+
+        // drain the first pool, the next pop links the spare instead of building.
+        for (int i = 0; i < 3; ++i) held.push_back(chain.pop());
+        auto* grown = chain.pop();
+        ASSERT_TRUE(grown != nullptr);
+        ASSERT_EQ(chain.poolCount(), 2);
+        ASSERT_TRUE(grown->p_Buffer->m_BuiltOn != std::this_thread::get_id());
+        held.push_back(grown);
+
+        for (auto* b : held) ASSERT_TRUE(chain.push(b));
+        ASSERT_EQ(chain.freeBuffers(), 14);
+    }
+
+    // 2. User executor: one task per spare, the chain frees an unused spare.
+    LifeTracker::active_count.store(0);
+    {
+        std::vector<std::function<void()>> tasks;
+        PoolChain<LifeTracker, 64, true> chain(4, 1);
+        chain.setGrowthPolicy(GrowthPolicy{2, [&](std::function<void()> task) { tasks.push_back(std::move(task)); }});
+
+        auto* a = chain.pop();
+        auto* b = chain.pop();
+        ASSERT_EQ(tasks.size(), 1);
+
+        // no second request while the first one is pending.
+        auto* c = chain.pop();
+        ASSERT_EQ(tasks.size(), 1);
+
+        tasks[0]();
+        ASSERT_TRUE(chain.hasSpare());
+        ASSERT_EQ(LifeTracker::active_count.load(), 6);
+
+        // growth takes the spare without building anything inline.
+        auto* d = chain.pop();
+        ASSERT_TRUE(!chain.hasSpare());
+        ASSERT_EQ(LifeTracker::active_count.load(), 6);
+        ASSERT_EQ(tasks.size(), 1);
+
+        // the next request comes once the new pool drops below the threshold too.
+        auto* e = chain.pop();
+        ASSERT_EQ(tasks.size(), 2);
+        tasks[1]();
+        ASSERT_EQ(LifeTracker::active_count.load(), 9);
+
+        chain.push(a); chain.push(b); chain.push(c); chain.push(d); chain.push(e);
+    }
+    ASSERT_EQ(LifeTracker::active_count.load(), 0);
+}
+
+void TestTrimWithBackgroundGrowth() {
+    LOG_TEST("TestTrimWithBackgroundGrowth (trim + pre-built spares while the producer pushes)");
+    LifeTracker::active_count.store(0);
+
+    using TrackerBuffer = Buffer<LifeTracker, 64, true>;
+    constexpr int ROUNDS = 2000;
+
+    {
+        PoolChain<LifeTracker, 64, true> chain(4, 1);
+        chain.setTrimPolicy(TrimPolicy{1, 8, std::chrono::milliseconds(0)});
+        chain.setGrowthPolicy(GrowthPolicy{6, {}});
+
+        RingPool<LifeTracker, 64, true> handoff(true, 1024, 0);
+        std::atomic<bool> done{false};
+
+        std::thread producer([&]() {
+            while (!done.load(std::memory_order_acquire) || handoff.currentSize()) {
+                if (auto* b = handoff.pop()) {
+                    while (!chain.push(b)) std::this_thread::yield();
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        // the helper thread builds spares while bursts grow the chain and quiet phases trim it.
+        std::vector<TrackerBuffer*> burst;
+        for (int round = 0; round < ROUNDS; ++round) {
+            size_t size = 1 + (round % 50) * 4;
+            for (size_t i = 0; i < size; ++i) burst.push_back(chain.pop());
+            for (auto* b : burst) {
+                while (!handoff.push(b)) std::this_thread::yield();
+            }
+            burst.clear();
+
+            if (round % 10 == 0) chain.trim();
+        }
+
+        done.store(true, std::memory_order_release);
+        producer.join();
+
+        chain.trim();
+        chain.push(chain.pop());
+        chain.trim();
+        ASSERT_EQ(chain.retiredCount(), 0);
+        ASSERT_TRUE(chain.poolCount() < 64);
+    }
+
+    // an unused spare is freed with the chain.
+    ASSERT_EQ(LifeTracker::active_count.load(), 0);
+}
+
+void TestBlockingWait() {
+    LOG_TEST("TestBlockingWait (pop_wait waits instead of growing)");
+
+    // Usable capacity 3, value 7 in every buffer.
+    PoolChain<int, alignof(int), true> chain(4, 7);
+
+    std::vector<Buffer<int, alignof(int), true>*> held;
+    for (int i = 0; i < 3; ++i) held.push_back(chain.pop_wait());
+    ASSERT_EQ(chain.poolCount(), 1);
+
+    // empty: pop() would grow, pop_wait() times out instead.
+    ASSERT_TRUE(chain.pop_wait(std::chrono::milliseconds(5)) == nullptr);
+    ASSERT_EQ(chain.poolCount(), 1);
+
+    Buffer<int, alignof(int), true>* got = nullptr;
+    std::thread consumer([&]() { got = chain.pop_wait(); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_TRUE(chain.push(held.back()));
+    consumer.join();
+
+    ASSERT_TRUE(got == held.back());
+    ASSERT_EQ(*got->p_Buffer, 7);
+    ASSERT_EQ(chain.poolCount(), 1);
+
+    // full: push_wait() gives up on a buffer no pool has room for.
+    for (auto* b : held) ASSERT_TRUE(chain.push_wait(b));
+    Buffer<int, alignof(int), true> stranger(0);
+    ASSERT_TRUE(!chain.push_wait(&stranger, std::chrono::milliseconds(5)));
+    ASSERT_EQ(chain.freeBuffers(), 3);
+}
+
 int main() {
     TestChainExpansionFullMode();
     TestMultiPoolWrapAround();
@@ -564,6 +879,12 @@ int main() {
     TestCrossPoolCleanup();
     TestHeavyConcurrency();
     TestMassiveGrowth();
+    TestBitmapRouting();
+    TestTrimPolicy();
+    TestTrimConcurrent();
+    TestBackgroundGrowth();
+    TestTrimWithBackgroundGrowth();
+    TestBlockingWait();
 
     std::cout << "\n\033[32m[PASSED]\033[0m All PoolChain tests completed successfully." << std::endl;
     return 0;
@@ -0,0 +1,213 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <algorithm>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "mem_pools/io_chain.h"
+#include "mem_pools/chain.h"
+
+using namespace MEM_SENTRY::mem_pool;
+
+// ----------------------------------------------------------------------------
+// HELPER MACROS
+// ----------------------------------------------------------------------------
+#define ASSERT_EQ(val, expected) \
+    do { \
+        if((val) != (expected)) { \
+            std::cerr << "[\033[31mFAIL\033[0m] " << __FUNCTION__ << " line " << __LINE__ \
+                      << ": Expected " << #val << " == " << expected \
+                      << ", but got " << (val) << "\n"; \
+            std::exit(1); \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if(!(cond)) { \
+            std::cerr << "[\033[31mFAIL\033[0m] " << __FUNCTION__ << " line " << __LINE__ \
+                      << ": Assertion " << #cond << " failed.\n"; \
+            std::exit(1); \
+        } \
+    } while(0)
+
+#define LOG_TEST(name) std::cout << "[\033[32mRUN\033[0m] " << name << "..." << std::endl
+
+// 16-byte blocks make every test cross block boundaries.
+using Pool = PoolChain<std::array<char, 16>, 16, false>;
+using Chain = IoChain<16, 16, false>;
+
+static std::string pattern(size_t bytes, char first = 'a') {
+    std::string s(bytes, '\0');
+    for (size_t i = 0; i < bytes; ++i) s[i] = (char)(first + i % 26);
+    return s;
+}
+
+void TestAppendConsume() {
+    LOG_TEST("TestAppendConsume");
+
+    // usable capacity 7 per pool.
+    Pool pool(8);
+    {
+        Chain chain(pool);
+        ASSERT_TRUE(chain.empty());
+        ASSERT_EQ(chain.segments(), 0);
+
+        std::string data = pattern(40);
+        ASSERT_EQ(chain.append(data.data(), data.size()), 40);
+        ASSERT_EQ(chain.size(), 40);
+        ASSERT_EQ(chain.segments(), 3);
+        ASSERT_EQ(chain.room(), 8);
+        ASSERT_EQ(pool.freeBuffers(), 4);
+
+        // the spans are the pooled blocks themselves, in order.
+        iovec iov[8];
+        size_t spans = chain.readSpans(iov, 8);
+        ASSERT_EQ(spans, 3);
+        ASSERT_EQ(iov[0].iov_len, 16);
+        ASSERT_EQ(iov[2].iov_len, 8);
+        ASSERT_TRUE(std::memcmp(iov[1].iov_base, data.data() + 16, 16) == 0);
+
+        // partial consume inside the first block keeps it.
+        ASSERT_EQ(chain.consume(10), 10);
+        ASSERT_EQ(chain.segments(), 3);
+        spans = chain.readSpans(iov, 8);
+        ASSERT_EQ(iov[0].iov_len, 6);
+        ASSERT_TRUE(std::memcmp(iov[0].iov_base, data.data() + 10, 6) == 0);
+
+        // crossing the boundary returns the drained block to the pool.
+        char out[20];
+        ASSERT_EQ(chain.read(out, 20), 20);
+        ASSERT_TRUE(std::memcmp(out, data.data() + 10, 20) == 0);
+        ASSERT_EQ(chain.segments(), 2);
+        ASSERT_EQ(pool.freeBuffers(), 5);
+
+        // a limited span count stops early.
+        ASSERT_EQ(chain.readSpans(iov, 1), 1);
+        ASSERT_EQ(iov[0].iov_len, 2);
+
+        // drained: the write block is rewound and kept.
+        ASSERT_EQ(chain.consume(100), 10);
+        ASSERT_TRUE(chain.empty());
+        ASSERT_EQ(chain.segments(), 1);
+        ASSERT_EQ(chain.room(), 16);
+        ASSERT_EQ(chain.readSpans(iov, 8), 0);
+
+        ASSERT_EQ(chain.append(data.data(), 16), 16);
+        ASSERT_EQ(chain.segments(), 1);
+        ASSERT_EQ(chain.consume(16), 16);
+        ASSERT_EQ(chain.segments(), 0);
+    }
+
+    // every block is back.
+    ASSERT_EQ(pool.freeBuffers(), 7);
+}
+
+void TestSegmentLimit() {
+    LOG_TEST("TestSegmentLimit");
+
+    Pool pool(8);
+    IoChain<16, 16, false, 4> chain(pool);
+
+    std::string data = pattern(100);
+    ASSERT_EQ(chain.append(data.data(), data.size()), 64);
+    ASSERT_EQ(chain.segments(), 4);
+    ASSERT_EQ(chain.room(), 0);
+
+    iovec iov[8];
+    ASSERT_EQ(chain.writeSpans(iov, 8, 16), 0);
+
+    // one block drained, one more can be taken.
+    ASSERT_EQ(chain.consume(16), 16);
+    ASSERT_EQ(chain.append(data.data() + 64, 36), 16);
+    ASSERT_EQ(chain.size(), 64);
+
+    char out[64];
+    ASSERT_EQ(chain.read(out, 64), 64);
+    ASSERT_TRUE(std::memcmp(out, data.data() + 16, 64) == 0);
+    ASSERT_EQ(chain.segments(), 0);
+}
+
+void TestScatterGatherIO() {
+    LOG_TEST("TestScatterGatherIO (writev / readv through a pipe)");
+
+    Pool pool(8);
+    Chain out(pool);
+    Chain in(pool);
+
+    int fds[2];
+    ASSERT_TRUE(::pipe(fds) == 0);
+
+    std::string data = pattern(150, 'A');
+    std::string received;
+
+    size_t appended = 0;
+    while (appended < data.size()) {
+        appended += out.append(data.data() + appended, std::min<size_t>(37, data.size() - appended));
+
+        // send what is there, with no copy out of the blocks.
+        iovec iov[16];
+        ssize_t sent = ::writev(fds[1], iov, (int)out.readSpans(iov, 16));
+        ASSERT_TRUE(sent > 0);
+        out.consume((size_t)sent);
+
+        // receive straight into pooled blocks, the first span continuing a partly filled one.
+        size_t spans = in.writeSpans(iov, 16, (size_t)sent);
+        ASSERT_TRUE(spans > 0);
+        ssize_t got = ::readv(fds[0], iov, (int)spans);
+        ASSERT_EQ(got, sent);
+        ASSERT_EQ(in.commit((size_t)got), (size_t)got);
+    }
+
+    ASSERT_TRUE(out.empty());
+    ASSERT_EQ(in.size(), data.size());
+
+    received.resize(in.size());
+    ASSERT_EQ(in.read(received.data(), received.size()), data.size());
+    ASSERT_TRUE(received == data);
+
+    // a commit never goes past the room reserved.
+    size_t room = in.room();
+    ASSERT_EQ(in.commit(room + 100), room);
+    in.clear();
+    ASSERT_EQ(in.segments(), 0);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+void TestDynamicBlocks() {
+    LOG_TEST("TestDynamicBlocks (heap allocated blocks)");
+
+    PoolChain<std::array<char, 64>, 64, true> pool(4);
+    {
+        IoChain<64, 64, true> chain(pool);
+
+        // the pool grows while the stream holds more blocks than one ring has.
+        std::string data = pattern(64 * 5 + 3);
+        ASSERT_EQ(chain.append(data.data(), data.size()), data.size());
+        ASSERT_EQ(chain.segments(), 6);
+        ASSERT_TRUE(pool.poolCount() > 1);
+
+        std::string back(data.size(), '\0');
+        ASSERT_EQ(chain.read(back.data(), back.size()), data.size());
+        ASSERT_TRUE(back == data);
+
+        chain.append(data.data(), 100);
+    }
+    ASSERT_EQ(pool.freeBuffers(), pool.poolCount() * 3);
+}
+
+int main() {
+    TestAppendConsume();
+    TestSegmentLimit();
+    TestScatterGatherIO();
+    TestDynamicBlocks();
+
+    std::cout << "\n\033[32m[PASSED]\033[0m All IoChain tests completed successfully." << std::endl;
+    return 0;
+}
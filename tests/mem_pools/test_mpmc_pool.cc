@@ -0,0 +1,184 @@
+#include <iostream>
+#include <vector>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+
+#include "mem_pools/mpmc_pool.h"
+#include "mem_pools/buffer.h"
+
+using namespace MEM_SENTRY::mem_pool;
+
+// ----------------------------------------------------------------------------
+// HELPER MACROS
+// ----------------------------------------------------------------------------
+#define ASSERT_EQ(val, expected) \
+    do { \
+        if((val) != (expected)) { \
+            std::cerr << "[\033[31mFAIL\033[0m] " << __FUNCTION__ << " line " << __LINE__ \
+                      << ": Expected " << #val << " == " << expected \
+                      << ", but got " << (val) << "\n"; \
+            std::exit(1); \
+        } \
+    } while(0)
+
+#define ASSERT_TRUE(cond) \
+    do { \
+        if(!(cond)) { \
+            std::cerr << "[\033[31mFAIL\033[0m] " << __FUNCTION__ << " line " << __LINE__ \
+                      << ": Assertion " << #cond << " failed.\n"; \
+            std::exit(1); \
+        } \
+    } while(0)
+
+#define LOG_TEST(name) std::cout << "[\033[32mRUN\033[0m] " << name << "..." << std::endl
+
+
+void TestFullModeMPMC() {
+    LOG_TEST("TestFullModeMPMC");
+
+    MPMCPool<int, alignof(int), true> pool(false, 6, 7);
+    ASSERT_TRUE(pool.isValid());
+    ASSERT_EQ(pool.queueSize(), 8);
+
+    // no waste slot: every slot holds a buffer.
+    ASSERT_EQ(pool.currentSize(), pool.queueSize());
+
+    std::vector<Buffer<int, alignof(int), true>*> taken;
+    while (auto* b = pool.pop()) {
+        ASSERT_EQ(*b->p_Buffer, 7);
+        taken.push_back(b);
+    }
+    ASSERT_EQ(taken.size(), pool.queueSize());
+
+    for (auto* b : taken) ASSERT_TRUE(pool.push(b));
+    // the pool deletes the buffers it holds on destruction.
+}
+
+void TestEmptyModeMPMC() {
+    LOG_TEST("TestEmptyModeMPMC");
+
+    MPMCPool<int, alignof(int), true> pool(true, 4);
+    ASSERT_TRUE(pool.isValid());
+    ASSERT_TRUE(pool.pop() == nullptr);
+    ASSERT_TRUE(!pool.push(nullptr));
+
+    std::vector<Buffer<int, alignof(int), true>*> owned;
+    for (int i = 0; i < 4; ++i) {
+        owned.push_back(new Buffer<int, alignof(int), true>(i));
+        ASSERT_TRUE(pool.push(owned.back()));
+    }
+
+    // full now
+    auto* extra = new Buffer<int, alignof(int), true>(99);
+    ASSERT_TRUE(!pool.push(extra));
+
+    // FIFO across several laps.
+    for (int lap = 0; lap < 3; ++lap) {
+        auto* b = pool.pop();
+        ASSERT_TRUE(b != nullptr);
+        ASSERT_TRUE(pool.push(b));
+    }
+    for (int i = 0; i < 4; ++i) {
+        auto* b = pool.pop();
+        ASSERT_EQ(*b->p_Buffer, (i + 3) % 4);
+    }
+    ASSERT_TRUE(pool.pop() == nullptr);
+
+    for (auto* b : owned) delete b;
+    delete extra;
+}
+
+void TestMultiProducerMultiConsumer() {
+    LOG_TEST("TestMultiProducerMultiConsumer (4 x 4 threads)");
+
+    constexpr int PRODUCERS = 4;
+    constexpr int CONSUMERS = 4;
+    constexpr size_t PER_PRODUCER = 100000;
+    constexpr size_t ITEMS = PRODUCERS * PER_PRODUCER;
+
+    MPMCPool<size_t, 64, true> pool(true, 256);
+
+    std::atomic<size_t> sum_consumed{0};
+    std::atomic<size_t> consumed{0};
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < PRODUCERS; ++p) {
+        threads.emplace_back([&, p]() {
+            for (size_t i = 0; i < PER_PRODUCER; ++i) {
+                auto* b = new Buffer<size_t, 64, true>(p * PER_PRODUCER + i + 1);
+                while (!pool.push(b)) std::this_thread::yield();
+            }
+        });
+    }
+
+    for (int c = 0; c < CONSUMERS; ++c) {
+        threads.emplace_back([&]() {
+            while (consumed.load(std::memory_order_relaxed) < ITEMS) {
+                auto* b = pool.pop();
+                if (!b) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                sum_consumed.fetch_add(*b->p_Buffer, std::memory_order_relaxed);
+                consumed.fetch_add(1, std::memory_order_relaxed);
+                delete b;
+            }
+        });
+    }
+
+    for (auto& t : threads) t.join();
+
+    ASSERT_EQ(consumed.load(), ITEMS);
+    ASSERT_EQ(sum_consumed.load(), ITEMS * (ITEMS + 1) / 2);
+    ASSERT_EQ(pool.currentSize(), 0);
+}
+
+void TestSharedFreeList() {
+    LOG_TEST("TestSharedFreeList (acquire on one worker, release on another)");
+
+    constexpr int WORKERS = 8;
+    constexpr int ROUNDS = 20000;
+
+    // full mode: the pool owns the buffers, workers borrow and return them.
+    MPMCPool<int, 64, true> pool(false, 16, 0);
+    MPMCPool<int, 64, true> handoff(true, 16);
+    ASSERT_TRUE(pool.isValid());
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < WORKERS; ++w) {
+        workers.emplace_back([&, w]() {
+            for (int i = 0; i < ROUNDS; ++i) {
+                if (w % 2 == 0) {
+                    // acquire and hand off to another worker.
+                    auto* b = pool.pop();
+                    if (!b) { std::this_thread::yield(); continue; }
+                    *b->p_Buffer += 1;
+                    while (!handoff.push(b)) std::this_thread::yield();
+                } else {
+                    // release what someone else acquired.
+                    if (auto* b = handoff.pop()) {
+                        while (!pool.push(b)) std::this_thread::yield();
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        });
+    }
+    for (auto& t : workers) t.join();
+
+    while (auto* b = handoff.pop()) ASSERT_TRUE(pool.push(b));
+
+    // every buffer came back exactly once.
+    ASSERT_EQ(pool.currentSize(), pool.queueSize());
+}
+
+int main() {
+    TestFullModeMPMC();
+    TestEmptyModeMPMC();
+    TestMultiProducerMultiConsumer();
+    TestSharedFreeList();
+    std::cout << "\n\033[32m[PASSED]\033[0m All MPMCPool tests completed successfully." << std::endl;
+    return 0;
+}
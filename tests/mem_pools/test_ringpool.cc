@@ -236,6 +236,60 @@ void TestLifecycleManagement() {
     ASSERT_EQ(g_lifeCount.load(), 0);
 }
 
+void TestArenaStorage() {
+    LOG_TEST("TestArenaStorage (contiguous buffers + payloads)");
+    g_lifeCount.store(0);
+
+    {
+        RingPool<Spy, 64, true> pool(ArenaStorage{}, 16);
+        ASSERT_TRUE(pool.isValid());
+        ASSERT_TRUE(pool.arena() != nullptr);
+        ASSERT_EQ(static_cast<size_t>(g_lifeCount.load()), pool.queueSize() - 1);
+
+        // buffers and payloads are laid out back to back, payloads on the requested alignment.
+        auto* arena = pool.arena();
+        for (size_t i = 0; i + 1 < arena->count(); ++i) {
+            uintptr_t a = reinterpret_cast<uintptr_t>(arena->at(i)->p_Buffer);
+            uintptr_t b = reinterpret_cast<uintptr_t>(arena->at(i + 1)->p_Buffer);
+            ASSERT_TRUE(a % 64 == 0);
+            ASSERT_EQ(b - a, 64);
+        }
+
+        // the pool hands out arena buffers like any other and takes them back.
+        auto* b = pool.pop();
+        ASSERT_TRUE(arena->owns(b));
+        ASSERT_TRUE(pool.push(b));
+        ASSERT_TRUE(!pool.arena()->owns(nullptr));
+    }
+
+    // one free destroyed every Spy.
+    ASSERT_EQ(g_lifeCount.load(), 0);
+
+    // arguments are forwarded to every T, inline buffers also work.
+    RingPool<int, alignof(int), true> values(ArenaStorage{}, 8, 42);
+    for (size_t i = 0; i < values.queueSize() - 1; ++i) ASSERT_EQ(*values.pop()->p_Buffer, 42);
+    ASSERT_TRUE(values.pop() == nullptr);
+
+    RingPool<int, 64, false> inlinePool(ArenaStorage{}, 4, 5);
+    auto* inlineBuffer = inlinePool.pop();
+    ASSERT_EQ(inlineBuffer->m_Buffer, 5);
+    ASSERT_TRUE(reinterpret_cast<uintptr_t>(inlineBuffer) % 64 == 0);
+    inlinePool.push(inlineBuffer);
+
+    // huge-page backing is a hint, the arena is valid either way.
+    RingPool<double, 64, true> huge(ArenaStorage{true}, 4096, 1.5);
+    ASSERT_TRUE(huge.isValid());
+    ASSERT_TRUE(huge.arena()->bytes() % (2 * 1024 * 1024) == 0);
+    ASSERT_TRUE(*huge.pop()->p_Buffer == 1.5);
+
+    // node binding is a hint too: the block is page aligned and usable on any kernel.
+    RingPool<double, 64, true> local(ArenaStorage{.m_Node = MEM_SENTRY::numa::CurrentNode()}, 1024, 2.5);
+    ASSERT_TRUE(local.isValid());
+    ASSERT_TRUE(local.arena()->bytes() % 4096 == 0);
+    ASSERT_TRUE(reinterpret_cast<uintptr_t>(local.arena()->at(0)) % 4096 == 0);
+    ASSERT_TRUE(*local.pop()->p_Buffer == 2.5);
+}
+
 void TestHighPressureContention() {
     LOG_TEST("TestHighPressureContention (No Sleep)");
 
@@ -315,14 +369,206 @@ void TestHighPressureContention() {
     ASSERT_EQ(sum_produced.load(), sum_consumed.load());
 }
 
+void TestBulkOperations() {
+    LOG_TEST("TestBulkOperations");
+
+    using IntBuffer = Buffer<int, alignof(int), true>;
+    RingPool<int, alignof(int), true> pool(true, 8);
+    const size_t capacity = pool.queueSize() - 1;
+
+    std::vector<IntBuffer*> owned;
+    for (size_t i = 0; i < capacity + 2; ++i) {
+        owned.push_back(new IntBuffer(static_cast<int>(i)));
+    }
+
+    // 1. A batch larger than the free space is cut to the capacity.
+    ASSERT_EQ(pool.push_bulk(owned.data(), owned.size()), capacity);
+    ASSERT_EQ(pool.currentSize(), capacity);
+    ASSERT_EQ(pool.push_bulk(owned.data() + capacity, 2), 0);
+
+    // 2. Partial pops come out in FIFO order.
+    IntBuffer* out[16] = {};
+    ASSERT_EQ(pool.pop_bulk(out, 3), 3);
+    for (int i = 0; i < 3; ++i) ASSERT_EQ(*out[i]->p_Buffer, i);
+
+    // 3. The next batch wraps around the end of the ring.
+    ASSERT_EQ(pool.push_bulk(owned.data() + capacity, 2), 2);
+    ASSERT_EQ(pool.pop_bulk(out + 3, 16), capacity - 1);
+    for (size_t i = 0; i < capacity + 2; ++i) ASSERT_EQ(*out[i]->p_Buffer, static_cast<int>(i));
+    ASSERT_EQ(pool.pop_bulk(out, 16), 0);
+
+    // 4. nullptr ends a batch, single and bulk calls mix freely.
+    IntBuffer* withNull[3] = {owned[0], nullptr, owned[1]};
+    ASSERT_EQ(pool.push_bulk(withNull, 3), 1);
+    ASSERT_TRUE(pool.push(owned[1]));
+    ASSERT_TRUE(pool.pop() == owned[0]);
+    ASSERT_EQ(pool.pop_bulk(out, 4), 1);
+    ASSERT_TRUE(out[0] == owned[1]);
+
+    for (auto* b : owned) delete b;
+}
+
+void TestBulkProducerConsumer() {
+    LOG_TEST("TestBulkProducerConsumer (multi-threaded bursts)");
+
+    constexpr size_t ITEMS = 200000;
+    constexpr size_t BURST = 64;
+    using SizeBuffer = Buffer<size_t, 64, true>;
+
+    RingPool<size_t, 64, true> pool(true, 256);
+    std::atomic<size_t> sum_consumed{0};
+
+    std::thread producer([&]() {
+        SizeBuffer* batch[BURST];
+        size_t next = 1;
+
+        while (next <= ITEMS) {
+            size_t n = 0;
+            for (; n < BURST && next + n <= ITEMS; ++n) batch[n] = new SizeBuffer(next + n);
+
+            size_t sent = 0;
+            while (sent < n) {
+                sent += pool.push_bulk(batch + sent, n - sent);
+                if (sent < n) std::this_thread::yield();
+            }
+            next += n;
+        }
+    });
+
+    std::thread consumer([&]() {
+        SizeBuffer* batch[BURST];
+        size_t consumed = 0;
+        size_t expected = 1;
+        bool ordered = true;
+
+        while (consumed < ITEMS) {
+            size_t n = pool.pop_bulk(batch, BURST);
+            if (n == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (size_t i = 0; i < n; ++i) {
+                ordered = ordered && *batch[i]->p_Buffer == expected++;
+                sum_consumed.fetch_add(*batch[i]->p_Buffer, std::memory_order_relaxed);
+                delete batch[i];
+            }
+            consumed += n;
+        }
+
+        ASSERT_TRUE(ordered);
+    });
+
+    producer.join();
+    consumer.join();
+
+    ASSERT_EQ(sum_consumed.load(), ITEMS * (ITEMS + 1) / 2);
+    ASSERT_EQ(pool.currentSize(), 0);
+}
+
+void TestBlockingWait() {
+    LOG_TEST("TestBlockingWait (pop_wait / push_wait)");
+
+    using IntBuffer = Buffer<int, alignof(int), true>;
+
+    // 1. A consumer parked in pop_wait() is woken by a late push.
+    {
+        RingPool<int, alignof(int), true> pool(true, 4);
+        std::atomic<bool> popped{false};
+        IntBuffer* got = nullptr;
+
+        std::thread consumer([&]() {
+            got = pool.pop_wait();
+            popped.store(true, std::memory_order_release);
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ASSERT_TRUE(!popped.load(std::memory_order_acquire));
+
+        auto* b = new IntBuffer(42);
+        ASSERT_TRUE(pool.push(b));
+        consumer.join();
+
+        ASSERT_TRUE(got == b);
+        ASSERT_EQ(*got->p_Buffer, 42);
+        delete got;
+    }
+
+    // 2. Timeouts: an empty ring gives nullptr, a full ring refuses the buffer.
+    {
+        RingPool<int, alignof(int), true> pool(true, 4);
+
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_TRUE(pool.pop_wait(std::chrono::milliseconds(5)) == nullptr);
+        ASSERT_TRUE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(5));
+
+        std::vector<IntBuffer*> held;
+        for (int i = 0; i < 3; ++i) {
+            held.push_back(new IntBuffer(i));
+            ASSERT_TRUE(pool.push(held.back()));
+        }
+
+        auto* extra = new IntBuffer(3);
+        ASSERT_TRUE(!pool.push_wait(extra, std::chrono::milliseconds(5)));
+        ASSERT_TRUE(!pool.push_wait(nullptr));
+
+        // 3. A producer parked in push_wait() is woken by a pop.
+        std::thread producer([&]() { ASSERT_TRUE(pool.push_wait(extra)); });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto* first = pool.pop();
+        ASSERT_TRUE(first == held[0]);
+        producer.join();
+
+        for (int i = 1; i < 3; ++i) ASSERT_TRUE(pool.pop() == held[i]);
+        ASSERT_TRUE(pool.pop() == extra);
+
+        for (auto* b : held) delete b;
+        delete extra;
+    }
+
+    // 4. A stream through a small ring, both sides blocking, stays in order.
+    {
+        constexpr int ITEMS = 100000;
+        RingPool<int, alignof(int), true> pool(true, 8);
+        bool ordered = true;
+
+        std::thread consumer([&]() {
+            for (int i = 0; i < ITEMS; ++i) {
+                auto* b = pool.pop_wait();
+                ordered = ordered && *b->p_Buffer == i;
+                delete b;
+            }
+        });
+
+        std::thread producer([&]() {
+            for (int i = 0; i < ITEMS; ++i) {
+                // pause now and then so the consumer gets to park.
+                if (i % 10000 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                pool.push_wait(new IntBuffer(i));
+            }
+        });
+
+        producer.join();
+        consumer.join();
+
+        ASSERT_TRUE(ordered);
+        ASSERT_EQ(pool.currentSize(), 0);
+    }
+}
+
 int main() {
     TestFullModePool();
     TestEmptyModeCallerOwned();
     TestWrapAroundBehavior();
     TestProducerConsumerSimulation();
+    TestBulkOperations();
+    TestBulkProducerConsumer();
+    TestBlockingWait();
 
     TestAlignmentGuarantees();
     TestLifecycleManagement();
+    TestArenaStorage();
     TestHighPressureContention();
     std::cout << "\n\033[32m[PASSED]\033[0m All MEM_SENTRY tests completed successfully." << std::endl;
     return 0;
@@ -0,0 +1,52 @@
+// Checks of mem_sentry/interpose.h, in a translation unit of their own: the header
+// renames malloc/calloc/realloc/free for the rest of the file.
+
+#include <iostream>
+#include <cstring>
+
+#include "mem_sentry/heap.h"
+
+// last: the malloc/calloc/realloc/free below go to the tracked ms_* functions.
+#include "mem_sentry/interpose.h"
+
+#define ASSERT_EQ(val, expected) \
+    do { \
+        if((val) != (expected)) { \
+            std::cerr << "[\033[31mFAIL\033[0m] " << __FUNCTION__ << " line " << __LINE__ \
+                      << ": Expected " << #val << " == " << expected \
+                      << ", but got " << (val) << "\n"; \
+            std::exit(1); \
+        } \
+    } while(0)
+
+#define LOG_TEST(name) std::cout << "[\033[32mRUN\033[0m] " << name << "..." << std::endl
+
+void TestInterposedCalls() {
+    LOG_TEST("TestInterposedCalls (interpose.h)");
+#if MEM_SENTRY_ENABLE
+    // the caller detached the default heap's reporter.
+    MEM_SENTRY::heap::Heap* def = MEM_SENTRY::heap::HeapFactory::GetDefaultHeap();
+
+    // 1. The plain C calls are tracked by the default heap, realloc keeps the block tracked.
+    size_t before = def->CountAllocations();
+    char* c = static_cast<char*>(malloc(32));
+    ASSERT_EQ(def->CountAllocations(), before + 1);
+    std::memset(c, 'x', 32);
+    c = static_cast<char*>(realloc(c, 4096));
+    ASSERT_EQ(def->CountAllocations(), before + 1);
+    ASSERT_EQ(c[31], 'x');
+    free(c);
+    ASSERT_EQ(def->CountAllocations(), before);
+
+    // 2. calloc zeroes, and the names still work as function pointers.
+    void* (*allocate)(size_t) = malloc;
+    void (*release)(void*) = free;
+    int* zeroed = static_cast<int*>(calloc(16, sizeof(int)));
+    ASSERT_EQ(zeroed[15], 0);
+    void* p = allocate(8);
+    ASSERT_EQ(def->CountAllocations(), before + 2);
+    release(p);
+    free(zeroed);
+    ASSERT_EQ(def->CountAllocations(), before);
+#endif
+}
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <string>
 #include <algorithm>
+#include <iterator>
 #include <thread>
 #include <random>
 #include <atomic>
@@ -10,6 +11,10 @@
 #include <new>      
 #include <mutex>
 #include <limits>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <stdexcept>
 
 // ----------------------------------------------------------------------------
 // CONFIGURATION
@@ -18,8 +23,22 @@
 #include "mem_sentry/heap.h"
 #include "mem_sentry/sentry.h"
 #include "mem_sentry/alloc_header.h"
+#include "mem_sentry/stats.h"
 
 #include "mem_sentry/reporter.h"
+#include "mem_sentry/async_reporter.h"
+#include "mem_sentry/trace_reporter.h"
+#include "mem_sentry/scrubber.h"
+#include "mem_sentry/arena_heap.h"
+#include "mem_sentry/callsite.h"
+#include "mem_sentry/recycler.h"
+#include "mem_sentry/telemetry.h"
+
+#include "mem_pools/pool.h"
+#include "mem_pools/chain.h"
+
+// memsentry_trace's replay, from tools/
+#include "trace_replay.h"
 
 using MEM_SENTRY::heap::Heap;
 using MEM_SENTRY::heap::HeapFactory;
@@ -27,6 +46,9 @@ using MEM_SENTRY::alloc_header::AllocHeader;
 
 static MEM_SENTRY::reporter::ConsoleReporter gConsoleReporter;
 
+// tests/test_interpose.cc, a file of its own because interpose.h renames the C allocation calls.
+void TestInterposedCalls();
+
 // ----------------------------------------------------------------------------
 // HELPER MACROS
 // ----------------------------------------------------------------------------
@@ -66,6 +88,129 @@ public:
     AudioObject() : sampleRate(44100) {}
 };
 
+class FrameObject : public MEM_SENTRY::sentry::ISentry<FrameObject> {
+public:
+    uint64_t frame;
+    char payload[40];
+    explicit FrameObject(uint64_t f) : frame(f) {}
+};
+
+// Counts the objects its policy allocated and freed, around the default tracked path.
+struct CountingPolicy {
+    static inline std::atomic<int> allocs{0};
+    static inline std::atomic<int> frees{0};
+
+    template<size_t Size, size_t Alignment>
+    static void* Allocate(Heap* heap) {
+        allocs++;
+        return MEM_SENTRY::sentry::TrackedPolicy::Allocate<Size, Alignment>(heap);
+    }
+
+    template<size_t Size, size_t Alignment>
+    static void Deallocate(void* pMem) noexcept {
+        frees++;
+        MEM_SENTRY::sentry::TrackedPolicy::Deallocate<Size, Alignment>(pMem);
+    }
+};
+
+class PolicyObject : public MEM_SENTRY::sentry::ISentry<PolicyObject, CountingPolicy> {
+public:
+    int value;
+    explicit PolicyObject(int v) : value(v) {}
+};
+
+// Bigger than PolicyObject, so it takes the generic path of the inherited operators.
+class DerivedPolicyObject : public PolicyObject {
+public:
+    char extra[100];
+    DerivedPolicyObject() : PolicyObject(7) {}
+};
+
+class alignas(64) AlignedPolicyObject : public MEM_SENTRY::sentry::ISentry<AlignedPolicyObject, CountingPolicy> {
+public:
+    char data[24];
+};
+
+// Constructors that throw on request, to exercise the placement deletes.
+class ThrowingPolicyObject : public MEM_SENTRY::sentry::ISentry<ThrowingPolicyObject, CountingPolicy> {
+public:
+    int value;
+    explicit ThrowingPolicyObject(bool fail) : value(1) { if (fail) throw std::runtime_error("constructor"); }
+};
+
+class ThrowingDerivedObject : public ThrowingPolicyObject {
+public:
+    char extra[100];
+    explicit ThrowingDerivedObject(bool fail) : ThrowingPolicyObject(false) { if (fail) throw std::runtime_error("constructor"); }
+};
+
+class alignas(64) ThrowingAlignedObject : public MEM_SENTRY::sentry::ISentry<ThrowingAlignedObject, CountingPolicy> {
+public:
+    char data[24];
+    explicit ThrowingAlignedObject(bool fail) { if (fail) throw std::runtime_error("constructor"); }
+};
+
+// Small cache, so a few dozen objects exercise the overflow stack.
+class RecycledObject : public MEM_SENTRY::sentry::ISentry<RecycledObject, MEM_SENTRY::sentry::RecyclingPolicy<8>> {
+public:
+    uint64_t id;
+    char payload[24];
+    explicit RecycledObject(uint64_t i) : id(i) {}
+};
+
+// Records the IDs passed to report(), to check range queries without console output.
+class RangeReporter : public MEM_SENTRY::reporter::IReporter {
+public:
+    std::vector<uint32_t> ids;
+    void onAlloc(AllocHeader*) override {}
+    void onDealloc(AllocHeader*) override {}
+    void report(AllocHeader* alloc) override { ids.push_back(alloc->m_AllocId); }
+};
+
+// Allocates and frees on the reported heap from report(), which needs the shard locks to be free.
+class ReentrantReporter : public MEM_SENTRY::reporter::IReporter {
+public:
+    Heap* p_Heap{nullptr};
+    std::vector<uint32_t> ids;
+    void onAlloc(AllocHeader*) override {}
+    void onDealloc(AllocHeader*) override {}
+    void report(AllocHeader* alloc) override {
+        ids.push_back(alloc->m_AllocId);
+        delete new (p_Heap) int(0);
+    }
+};
+
+// Counts replayed events and remembers if any ran on a given thread; never allocates.
+class CountingReporter : public MEM_SENTRY::reporter::IReporter {
+public:
+    std::atomic<int> allocs{0};
+    std::atomic<int> deallocs{0};
+    std::atomic<int> reports{0};
+    std::atomic<bool> sawForbiddenThread{false};
+    std::thread::id forbidden;
+    void onAlloc(AllocHeader*) override { allocs++; check(); }
+    void onDealloc(AllocHeader*) override { deallocs++; check(); }
+    void report(AllocHeader*) override { reports++; }
+private:
+    void check() { if (std::this_thread::get_id() == forbidden) sawForbiddenThread = true; }
+};
+
+// Records the corruptions it is told about; never allocates.
+class CorruptionReporter : public MEM_SENTRY::reporter::IReporter {
+public:
+    std::atomic<int> count{0};
+    std::atomic<uint32_t> lastId{0};
+    std::atomic<MEM_SENTRY::canary::Corruption> lastKind{MEM_SENTRY::canary::Corruption::None};
+    void onAlloc(AllocHeader*) override {}
+    void onDealloc(AllocHeader*) override {}
+    void report(AllocHeader*) override {}
+    void onCorruption(AllocHeader* alloc, MEM_SENTRY::canary::Corruption kind) override {
+        lastId = alloc->m_AllocId;
+        lastKind = kind;
+        count++;
+    }
+};
+
 // Aligned structure: 128-byte alignment
 struct alignas(128) AlignedDeepData {
     float data[32]; 
@@ -80,6 +225,7 @@ public:
         std::cout << "=============================================\n";
         std::cout << "    Memory Sentry Full Robust Test Suite\n";
         std::cout << "    Mode: " << (MEM_SENTRY_ENABLE ? "\033[36mENABLED\033[0m" : "\033[33mDISABLED (Std Malloc)\033[0m") << "\n";
+        std::cout << "    Header: " << sizeof(AllocHeader) << " bytes" << (MEM_SENTRY_COMPACT_HEADER ? " (compact)" : "") << "\n";
         std::cout << "=============================================\n\n";
 
         // --- Original Tests ---
@@ -114,8 +260,31 @@ public:
         TestInteractiveLeakReport();
 
         TestMultiThreadedAllocations();
+        TestThreadLocalTracking();
+        TestSlabBackend();
+        TestHeaderLayout();
+        TestBookmarkRangeQuery();
+        TestHeapCounters();
+        TestAsyncReporter();
+        TestBinaryTraceReporter();
+        TestHeapSampling();
+        TestNumaNodeHeaps();
+        TestHotPathStats();
+        TestSizedDelete();
+        TestCanaries();
+        TestArenaHeap();
+        TestReallocate();
+        TestInterposed();
+        TestHeapSnapshot();
+        TestCallSites();
+        TestSentryFastPath();
+        TestSentryConstructorThrows();
+        TestRecyclingPolicy();
+        TestMappedBlocks();
+        TestTelemetryExporter();
 
         TestHeapHierarchy();
+        TestHeapHierarchyCache();
         TestHeapHierarchyThreadSafety();
 
         std::cout << "\n=============================================\n";
@@ -675,6 +844,1663 @@ private:
         #endif
     }
 
+    static void TestThreadLocalTracking() {
+        LOG_TEST("TestThreadLocalTracking (Sharded Lists + Cross-Thread Free)");
+        Heap shardedHeap("ShardedHeap", MEM_SENTRY::heap::TrackingMode::ThreadLocal);
+
+        const int NUM_THREADS = 8;
+        const int ALLOCS_PER_THREAD = 500;
+
+        std::vector<std::vector<int*>> perThread(NUM_THREADS);
+
+        // Phase 1: every thread allocates into its own shard.
+        {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < NUM_THREADS; ++t) {
+                threads.emplace_back([&, t]() {
+                    perThread[t].reserve(ALLOCS_PER_THREAD);
+                    for (int i = 0; i < ALLOCS_PER_THREAD; ++i) {
+                        perThread[t].push_back(new (&shardedHeap) int(i));
+                    }
+                });
+            }
+            for (auto& th : threads) th.join();
+        }
+
+        #if MEM_SENTRY_ENABLE
+        // Merged queries must see every shard.
+        ASSERT_EQ(GetCount(&shardedHeap), (size_t)(NUM_THREADS * ALLOCS_PER_THREAD));
+        ASSERT_EQ(GetTotal(&shardedHeap), (long long)(NUM_THREADS * ALLOCS_PER_THREAD * sizeof(int)));
+        #endif
+
+        // Phase 2: free from a different thread than the one that allocated.
+        {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < NUM_THREADS; ++t) {
+                threads.emplace_back([&, t]() {
+                    for (int* p : perThread[(t + 1) % NUM_THREADS]) {
+                        delete p;
+                    }
+                });
+            }
+            for (auto& th : threads) th.join();
+        }
+
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(GetCount(&shardedHeap), 0);
+        ASSERT_EQ(GetTotal(&shardedHeap), 0);
+
+        // Switching back to shared mode keeps blocks in the shard they were linked into.
+        int* early = new (&shardedHeap) int(1);
+        shardedHeap.SetTrackingMode(MEM_SENTRY::heap::TrackingMode::Shared);
+        int* late = new (&shardedHeap) int(2);
+        ASSERT_EQ(GetCount(&shardedHeap), 2);
+        delete early;
+        delete late;
+        ASSERT_EQ(GetCount(&shardedHeap), 0);
+        #endif
+    }
+
+    static void TestSlabBackend() {
+        LOG_TEST("TestSlabBackend (Size Classes + ISentry Opt-In)");
+        Heap slabHeap("SlabHeap", MEM_SENTRY::heap::TrackingMode::ThreadLocal);
+        slabHeap.SetSlabBackend(true);
+        ASSERT_TRUE(slabHeap.UsesSlabBackend());
+
+        // 1. Small blocks of every size in the 16-128 range.
+        std::vector<char*> blocks;
+        for (int size = 1; size <= 128; ++size) {
+            char* p = new (&slabHeap) char[size];
+            ASSERT_TRUE(reinterpret_cast<uintptr_t>(p) % 16 == 0);
+            std::memset(p, 0xAB, size);
+            blocks.push_back(p);
+        }
+
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(GetCount(&slabHeap), 128);
+        ASSERT_TRUE(slabHeap.GetSlabReserved() > 0);
+        #endif
+
+        // 2. Freed chunks are recycled by the next request of the same class.
+        char* first = blocks[63];
+        delete[] first;
+        char* again = new (&slabHeap) char[64];
+        #if MEM_SENTRY_ENABLE
+        ASSERT_TRUE(again == first);
+        #endif
+        blocks[63] = again;
+
+        // 3. Aligned and large requests on the same heap.
+        AlignedDeepData* aligned = new (std::align_val_t(128), &slabHeap) AlignedDeepData();
+        ASSERT_TRUE(reinterpret_cast<uintptr_t>(aligned) % 128 == 0);
+        char* large = new (&slabHeap) char[4096];
+
+        // 4. ISentry types opt in through their heap, without touching call sites.
+        PhysicsObject::setHeap(&slabHeap);
+        PhysicsObject* obj = new PhysicsObject();
+        obj->x = 1.0;
+
+        // 5. Free one block from another thread.
+        std::thread remote([&]() { delete obj; });
+        remote.join();
+
+        for (char* p : blocks) delete[] p;
+        delete aligned;
+        delete[] large;
+
+        ASSERT_EQ(GetCount(&slabHeap), 0);
+        ASSERT_EQ(GetTotal(&slabHeap), 0);
+
+        // 6. Blocks allocated before the backend was disabled are still freed correctly.
+        int* slabBlock = new (&slabHeap) int(5);
+        slabHeap.SetSlabBackend(false);
+        int* mallocBlock = new (&slabHeap) int(6);
+        delete slabBlock;
+        delete mallocBlock;
+        ASSERT_EQ(GetCount(&slabHeap), 0);
+
+        PhysicsObject::setHeap(HeapFactory::GetDefaultHeap());
+    }
+
+    static void TestHeaderLayout() {
+        LOG_TEST("TestHeaderLayout (" << sizeof(AllocHeader) << "-byte header)");
+        ASSERT_EQ(sizeof(AllocHeader), (MEM_SENTRY_COMPACT_HEADER ? 16u : 48u));
+
+        Heap layoutHeap("LayoutHeap", MEM_SENTRY::heap::TrackingMode::ThreadLocal);
+        ASSERT_TRUE(HeapFactory::GetHeapByIndex(layoutHeap.GetIndex()) == &layoutHeap);
+
+        // 1. Mixed plain and aligned blocks, freed out of order.
+        std::vector<char*> plain;
+        std::vector<AlignedDeepData*> aligned;
+        for (int i = 0; i < 64; ++i) {
+            plain.push_back(new (&layoutHeap) char[i + 1]);
+            aligned.push_back(new (std::align_val_t(128), &layoutHeap) AlignedDeepData());
+            ASSERT_TRUE(reinterpret_cast<uintptr_t>(aligned.back()) % 128 == 0);
+        }
+
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(GetCount(&layoutHeap), 128);
+
+        // 2. Both layouts resolve the heap, alignment and original address.
+        const AllocHeader* plainHeader = reinterpret_cast<const AllocHeader*>(plain[3]) - 1;
+        const AllocHeader* alignedHeader = reinterpret_cast<const AllocHeader*>(aligned[3]) - 1;
+        ASSERT_TRUE(MEM_SENTRY::alloc_header::GetHeap(plainHeader) == &layoutHeap);
+        ASSERT_TRUE(MEM_SENTRY::alloc_header::GetHeap(alignedHeader) == &layoutHeap);
+        ASSERT_EQ(MEM_SENTRY::alloc_header::GetAlignment(plainHeader), 0u);
+        ASSERT_EQ(MEM_SENTRY::alloc_header::GetAlignment(alignedHeader), 128u);
+        ASSERT_TRUE(MEM_SENTRY::alloc_header::GetOriginalAddress(plainHeader) == plainHeader);
+        ASSERT_TRUE(MEM_SENTRY::alloc_header::GetOriginalAddress(alignedHeader) <= (const void*)alignedHeader);
+        ASSERT_TRUE(MEM_SENTRY::alloc_header::IsLive(alignedHeader));
+        #endif
+
+        for (int i = 0; i < 64; i += 2) {
+            delete[] plain[i];
+            delete aligned[63 - i];
+        }
+        for (int i = 1; i < 64; i += 2) {
+            delete[] plain[i];
+            delete aligned[63 - i];
+        }
+
+        ASSERT_EQ(GetCount(&layoutHeap), 0);
+        ASSERT_EQ(GetTotal(&layoutHeap), 0);
+
+        // 3. Heap indices are unique while heaps are alive and reused afterwards.
+        uint16_t index;
+        {
+            Heap scoped("ScopedHeap");
+            index = scoped.GetIndex();
+            ASSERT_TRUE(index != layoutHeap.GetIndex());
+            ASSERT_TRUE(HeapFactory::GetHeapByIndex(index) == &scoped);
+        }
+        ASSERT_TRUE(HeapFactory::GetHeapByIndex(index) == nullptr);
+    }
+
+    static void TestBookmarkRangeQuery() {
+        LOG_TEST("TestBookmarkRangeQuery (ID Index + Snapshot)");
+        Heap rangeHeap("RangeHeap", MEM_SENTRY::heap::TrackingMode::ThreadLocal);
+        RangeReporter reporter;
+        reporter.ids.reserve(8192);
+
+        // 1. Blocks from several threads, spanning many index buckets.
+        constexpr int NUM_THREADS = 4;
+        constexpr int PER_THREAD = 3000;
+        std::vector<int*> blocks(NUM_THREADS * PER_THREAD);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    blocks[t * PER_THREAD + i] = new (&rangeHeap) int(i);
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+
+        // 2. Free every block whose ID is not a multiple of 3, emptying some buckets entirely.
+        std::vector<uint32_t> expected;
+        std::vector<int*> kept;
+        for (int* p : blocks) {
+        #if MEM_SENTRY_ENABLE
+            uint32_t id = (reinterpret_cast<AllocHeader*>(p) - 1)->m_AllocId;
+        #else
+            uint32_t id = 0;
+        #endif
+            if (id % 3 == 0 && !(id > 2000 && id < 6000)) {
+                expected.push_back(id);
+                kept.push_back(p);
+            } else {
+                delete p;
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+
+        #if MEM_SENTRY_ENABLE
+        rangeHeap.SetReporter(&reporter);
+
+        // 3. A range in the middle returns exactly the live blocks in it, in ID order.
+        const uint32_t lo = 1500, hi = 9000;
+        rangeHeap.ReportMemory(lo, hi);
+        std::vector<uint32_t> inRange;
+        for (uint32_t id : expected) {
+            if (id >= lo && id <= hi) inRange.push_back(id);
+        }
+        ASSERT_EQ(reporter.ids.size(), inRange.size());
+        ASSERT_TRUE(reporter.ids == inRange);
+
+        // 4. A range falling in emptied buckets returns nothing; a full range returns everything.
+        reporter.ids.clear();
+        rangeHeap.ReportMemory(2001, 5999);
+        ASSERT_EQ(reporter.ids.size(), 0u);
+
+        reporter.ids.clear();
+        rangeHeap.ReportMemory(0, 1 << 30);
+        ASSERT_TRUE(reporter.ids == expected);
+
+        // 5. The reporter runs after the shards are unlocked, so it may use the heap it reports.
+        ReentrantReporter reentrant;
+        reentrant.p_Heap = &rangeHeap;
+        reentrant.ids.reserve(8192);
+        rangeHeap.SetReporter(&reentrant);
+        rangeHeap.ReportMemory(lo, hi);
+        ASSERT_TRUE(reentrant.ids == inRange);
+        ASSERT_EQ(GetCount(&rangeHeap), kept.size());
+
+        rangeHeap.SetReporter(nullptr);
+        #endif
+
+        // 6. New blocks after the frees are still indexed.
+        int* late = new (&rangeHeap) int(1);
+        ASSERT_EQ(GetCount(&rangeHeap), kept.size() + 1);
+        delete late;
+
+        for (int* p : kept) delete p;
+        ASSERT_EQ(GetCount(&rangeHeap), 0);
+    }
+
+    static void TestHeapCounters() {
+        LOG_TEST("TestHeapCounters (Lock-Free Stats)");
+        Heap statsHeap("StatsHeap", MEM_SENTRY::heap::TrackingMode::ThreadLocal);
+
+        // 1. A reader polls the counters while writers allocate and free.
+        constexpr int NUM_THREADS = 4;
+        constexpr int ITERATIONS = 2000;
+        std::atomic<bool> done{false};
+        std::atomic<bool> sawNegative{false};
+
+        std::thread scraper([&]() {
+            while (!done.load(std::memory_order_acquire)) {
+                MEM_SENTRY::heap::HeapStats stats = statsHeap.GetStats();
+                if (stats.m_LiveBytes < 0 || stats.m_LiveCount < 0) sawNegative = true;
+            }
+        });
+
+        std::vector<std::thread> writers;
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            writers.emplace_back([&]() {
+                for (int i = 0; i < ITERATIONS; ++i) {
+                    char* p = new (&statsHeap) char[16];
+                    if (i % 2 == 0) {
+                        char* extra = new (&statsHeap) char[8];
+                        delete[] extra;
+                    }
+                    delete[] p;
+                }
+            });
+        }
+        for (auto& th : writers) th.join();
+        done = true;
+        scraper.join();
+
+        ASSERT_TRUE(!sawNegative.load());
+
+        // 2. Totals after a known sequence.
+        std::vector<int*> live;
+        for (int i = 0; i < 10; ++i) live.push_back(new (&statsHeap) int(i));
+        delete live.back();
+        live.pop_back();
+
+        #if MEM_SENTRY_ENABLE
+        MEM_SENTRY::heap::HeapStats stats = statsHeap.GetStats();
+        const uint64_t allocs = NUM_THREADS * (ITERATIONS + ITERATIONS / 2) + 10;
+        ASSERT_EQ(stats.m_LiveCount, 9);
+        ASSERT_EQ(stats.m_LiveBytes, (int64_t)(9 * sizeof(int)));
+        ASSERT_EQ(stats.m_TotalAllocs, allocs);
+        ASSERT_EQ(stats.m_TotalFrees, allocs - 9);
+        ASSERT_EQ(statsHeap.CountAllocations(), stats.m_LiveCount);
+        ASSERT_EQ(statsHeap.GetTotal(), stats.m_LiveBytes);
+        #endif
+
+        for (int* p : live) delete p;
+        ASSERT_EQ(GetCount(&statsHeap), 0);
+        ASSERT_EQ(GetTotal(&statsHeap), 0);
+    }
+
+    static void TestAsyncReporter() {
+        LOG_TEST("TestAsyncReporter (Per-Thread Rings + Drain Thread)");
+        CountingReporter counter;
+        counter.forbidden = std::this_thread::get_id();
+
+        #if MEM_SENTRY_ENABLE
+        Heap asyncHeap("AsyncHeap", MEM_SENTRY::heap::TrackingMode::ThreadLocal);
+        {
+            MEM_SENTRY::reporter::AsyncReporter async(&counter, 4096);
+            asyncHeap.SetReporter(&async);
+
+            // 1. Events from the main thread are replayed on the drain thread.
+            int* single = new (&asyncHeap) int(1);
+            delete single;
+            async.Flush();
+            ASSERT_EQ(counter.allocs.load(), 1);
+            ASSERT_EQ(counter.deallocs.load(), 1);
+            ASSERT_TRUE(!counter.sawForbiddenThread.load());
+
+            // 2. Several producers; nothing is lost while the rings have room.
+            constexpr int NUM_THREADS = 4;
+            constexpr int ITERATIONS = 1000;
+            std::vector<std::thread> threads;
+            for (int t = 0; t < NUM_THREADS; ++t) {
+                threads.emplace_back([&]() {
+                    for (int i = 0; i < ITERATIONS; ++i) {
+                        delete new (&asyncHeap) int(i);
+                    }
+                });
+            }
+            for (auto& th : threads) th.join();
+            async.Flush();
+
+            const uint64_t expected = 2 + 2 * NUM_THREADS * ITERATIONS;
+            ASSERT_EQ(async.GetDelivered() + async.GetDropped(), expected);
+            ASSERT_EQ((uint64_t)(counter.allocs + counter.deallocs), async.GetDelivered());
+
+            // 3. report() is forwarded synchronously.
+            int* leak = new (&asyncHeap) int(7);
+            asyncHeap.ReportMemory(0, 1 << 30);
+            ASSERT_EQ(counter.reports.load(), 1);
+            delete leak;
+
+            async.Flush();
+            asyncHeap.SetReporter(nullptr);
+        }
+        ASSERT_EQ(counter.allocs.load(), counter.deallocs.load());
+
+        // 4. A tiny ring drops instead of blocking the producer.
+        {
+            CountingReporter slow;
+            MEM_SENTRY::reporter::AsyncReporter async(&slow, 2, std::chrono::milliseconds(50));
+            asyncHeap.SetReporter(&async);
+            for (int i = 0; i < 100; ++i) delete new (&asyncHeap) int(i);
+            asyncHeap.SetReporter(nullptr);
+            ASSERT_TRUE(async.GetDropped() > 0);
+        }
+        #endif
+    }
+
+    static void TestBinaryTraceReporter() {
+        LOG_TEST("TestBinaryTraceReporter (mmap Trace File)");
+        #if MEM_SENTRY_ENABLE
+        const char* path = "mem_sentry_test_trace.bin";
+        Heap traceHeap("TraceHeap", MEM_SENTRY::heap::TrackingMode::ThreadLocal);
+
+        // 1. Enough events from several threads to roll over both mapped windows.
+        constexpr int NUM_THREADS = 4;
+        constexpr int ITERATIONS = 20000;
+        int* leak = nullptr;
+        uint64_t written = 0;
+        {
+            MEM_SENTRY::reporter::BinaryTraceReporter trace(path);
+            ASSERT_TRUE(trace.IsOpen());
+            traceHeap.SetReporter(&trace);
+
+            std::vector<std::thread> threads;
+            for (int t = 0; t < NUM_THREADS; ++t) {
+                threads.emplace_back([&]() {
+                    for (int i = 0; i < ITERATIONS; ++i) {
+                        delete new (&traceHeap) int(i);
+                    }
+                });
+            }
+            for (auto& th : threads) th.join();
+
+            int leakId = traceHeap.GetNextId();
+            leak = new (&traceHeap) int(42);
+
+            // report records carry the address of the block, not of the copy handed to the reporter.
+            traceHeap.ReportMemory(leakId, leakId + 1);
+            traceHeap.SetReporter(nullptr);
+            written = trace.GetRecordCount();
+        }
+
+        // 2. Read it back with the format header only.
+        FILE* file = std::fopen(path, "rb");
+        ASSERT_TRUE(file != nullptr);
+        MEM_SENTRY::trace::TraceFileHeader header;
+        ASSERT_EQ(std::fread(&header, sizeof(header), 1, file), 1u);
+        ASSERT_TRUE(std::memcmp(header.m_Magic, MEM_SENTRY::trace::TRACE_MAGIC, 8) == 0);
+        ASSERT_EQ(header.m_RecordSize, sizeof(MEM_SENTRY::trace::TraceRecord));
+        ASSERT_EQ(header.m_RecordCount, written);
+
+        // 1 name + 2 per iteration + the leaked block and its report.
+        const uint64_t expected = 1 + 2ull * NUM_THREADS * ITERATIONS + 2;
+        ASSERT_EQ(header.m_RecordCount, expected);
+
+        std::fseek(file, (long)header.m_DataOffset, SEEK_SET);
+        uint64_t allocs = 0, frees = 0, names = 0;
+        bool sawLeak = false, sawReport = false;
+        MEM_SENTRY::trace::TraceRecord record;
+        while (std::fread(&record, sizeof(record), 1, file) == 1) {
+            ASSERT_EQ(record.m_Heap, traceHeap.GetIndex());
+            if (record.m_Type == MEM_SENTRY::trace::TraceRecordType::Alloc) ++allocs;
+            if (record.m_Type == MEM_SENTRY::trace::TraceRecordType::Free) ++frees;
+            if (record.m_Type == MEM_SENTRY::trace::TraceRecordType::HeapName) {
+                char name[MEM_SENTRY::trace::TRACE_NAME_BYTES + 1];
+                MEM_SENTRY::trace::DecodeHeapName(record, name);
+                ASSERT_TRUE(std::strcmp(name, "TraceHeap") == 0);
+                ++names;
+            }
+            if (record.m_Address == reinterpret_cast<uint64_t>(leak) &&
+                record.m_Type == MEM_SENTRY::trace::TraceRecordType::Alloc) {
+                sawLeak = true;
+            }
+            if (record.m_Type == MEM_SENTRY::trace::TraceRecordType::Report) {
+                ASSERT_EQ(record.m_Address, reinterpret_cast<uint64_t>(leak));
+                sawReport = true;
+            }
+        }
+        std::fclose(file);
+        std::remove(path);
+
+        ASSERT_EQ(names, 1u);
+        ASSERT_EQ(allocs, frees + 1);
+        ASSERT_TRUE(sawLeak);
+        ASSERT_TRUE(sawReport);
+
+        delete leak;
+
+        // 3. A heap that reuses the index of a destroyed one gets a HeapName record of its own.
+        {
+            MEM_SENTRY::reporter::BinaryTraceReporter trace(path);
+            ASSERT_TRUE(trace.IsOpen());
+            uint16_t firstIndex;
+            uint32_t firstGeneration;
+            {
+                Heap first("TraceFirst");
+                firstIndex = first.GetIndex();
+                firstGeneration = first.GetGeneration();
+                first.SetReporter(&trace);
+                delete new (&first) int(1);
+                first.SetReporter(nullptr);
+            }
+
+            Heap second("TraceSecond");
+            ASSERT_EQ(second.GetIndex(), firstIndex);
+            ASSERT_TRUE(second.GetGeneration() != firstGeneration);
+            second.SetReporter(&trace);
+            delete new (&second) int(2);
+            delete new (&second) int(3);
+            second.SetReporter(nullptr);
+
+            // 2 names + 2 records per block.
+            ASSERT_EQ(trace.GetRecordCount(), 2u + 2u * 3u);
+        }
+
+        // 4. memsentry_trace's replay keeps the two heaps apart instead of merging them under the index.
+        std::vector<MEM_SENTRY::trace::TraceRecord> records;
+        ASSERT_TRUE(MEM_SENTRY::trace::LoadTrace(path, header, records));
+        std::remove(path);
+        ASSERT_EQ(records.size(), size_t{8});
+
+        MEM_SENTRY::trace::TraceReplay replay;
+        MEM_SENTRY::trace::ReplayTrace(records, nullptr, replay);
+        ASSERT_EQ(replay.m_Heaps.size(), size_t{2});
+        ASSERT_EQ(replay.m_Heaps[0].m_Index, replay.m_Heaps[1].m_Index);
+        ASSERT_TRUE(replay.m_Heaps[0].m_Name == "TraceFirst");
+        ASSERT_EQ(replay.m_Heaps[0].m_Allocs, 1u);
+        ASSERT_EQ(replay.m_Heaps[0].m_Frees, 1u);
+        ASSERT_TRUE(replay.m_Heaps[1].m_Name == "TraceSecond");
+        ASSERT_EQ(replay.m_Heaps[1].m_Allocs, 2u);
+        ASSERT_EQ(replay.m_Heaps[1].m_Frees, 2u);
+        ASSERT_TRUE(replay.m_Heaps[1].m_Live.empty());
+
+        // --heap selects one of them by name.
+        MEM_SENTRY::trace::TraceReplay filtered;
+        MEM_SENTRY::trace::ReplayTrace(records, "TraceFirst", filtered);
+        ASSERT_EQ(filtered.m_Heaps.size(), size_t{2});
+        ASSERT_EQ(filtered.m_Heaps[0].m_Allocs, 1u);
+        ASSERT_EQ(filtered.m_Heaps[1].m_Allocs, 0u);
+        #endif
+    }
+
+    static void TestHeapSampling() {
+        LOG_TEST("TestHeapSampling (Light Headers + Scaled Estimate)");
+        Heap sampledHeap("SampledHeap", MEM_SENTRY::heap::TrackingMode::ThreadLocal);
+
+        // 1. Interval 0 (the default) tracks every allocation.
+        ASSERT_EQ(sampledHeap.GetSamplingInterval(), (size_t)0);
+        int* tracked = new (&sampledHeap) int(1);
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(GetCount(&sampledHeap), 1);
+        #endif
+        delete tracked;
+
+        // 2. With a 64 KiB interval most blocks skip tracking, but all of them work.
+        constexpr size_t INTERVAL = 64 * 1024;
+        constexpr int BLOCKS = 20000;
+        constexpr size_t BLOCK_SIZE = 256;
+        sampledHeap.SetSamplingInterval(INTERVAL);
+        sampledHeap.SetSlabBackend(true);
+
+        std::vector<char*> blocks;
+        std::vector<AlignedDeepData*> aligned;
+        for (int i = 0; i < BLOCKS; ++i) {
+            // alternate slab-sized and malloc-sized blocks.
+            char* p = new (&sampledHeap) char[i % 2 ? 64 : BLOCK_SIZE * 2 - 64];
+            std::memset(p, 0xCD, i % 2 ? 64 : BLOCK_SIZE * 2 - 64);
+            blocks.push_back(p);
+
+            if (i % 100 == 0) {
+                AlignedDeepData* a = new (std::align_val_t(128), &sampledHeap) AlignedDeepData();
+                ASSERT_TRUE(reinterpret_cast<uintptr_t>(a) % 128 == 0);
+                aligned.push_back(a);
+            }
+        }
+
+        #if MEM_SENTRY_ENABLE
+        const int64_t realBytes = (int64_t)BLOCKS * BLOCK_SIZE;
+        const int64_t sampled = sampledHeap.CountAllocations();
+        ASSERT_TRUE(sampled > 0);
+        ASSERT_TRUE(sampled < BLOCKS / 10);
+
+        // 3. The estimate scales the sample back up (loose bound, the sample is random).
+        MEM_SENTRY::heap::HeapStats estimate = sampledHeap.GetSampledEstimate();
+        const int64_t realTotal = realBytes + (int64_t)aligned.size() * (int64_t)(sizeof(AlignedDeepData) + 128);
+        ASSERT_TRUE(estimate.m_LiveBytes > realTotal / 2);
+        ASSERT_TRUE(estimate.m_LiveBytes < realTotal * 2);
+        ASSERT_TRUE(estimate.m_LiveCount > 0);
+        #endif
+
+        // 4. Sampled and light blocks free through the same delete, from any thread.
+        std::thread remote([&]() {
+            for (size_t i = 0; i < blocks.size(); i += 2) delete[] blocks[i];
+        });
+        remote.join();
+        for (size_t i = 1; i < blocks.size(); i += 2) delete[] blocks[i];
+        for (AlignedDeepData* a : aligned) delete a;
+
+        ASSERT_EQ(GetCount(&sampledHeap), 0);
+        ASSERT_EQ(GetTotal(&sampledHeap), 0);
+
+        // 5. Turning sampling off tracks everything again.
+        sampledHeap.SetSamplingInterval(0);
+        int* again = new (&sampledHeap) int(2);
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(GetCount(&sampledHeap), 1);
+        #endif
+        delete again;
+    }
+
+    static void TestNumaNodeHeaps() {
+        LOG_TEST("TestNumaNodeHeaps (Node Binding + Node-Local Heaps)");
+        namespace numa = MEM_SENTRY::numa;
+
+        // 1. Topology: at least one node, and the running CPU maps to one of them.
+        const int nodes = numa::NodeCount();
+        ASSERT_TRUE(nodes >= 1);
+        ASSERT_TRUE(numa::CurrentNode() >= 0 && numa::CurrentNode() < nodes);
+
+        // 2. Binding a heap is range-checked and can be undone.
+        Heap bound("BoundHeap");
+        ASSERT_EQ(bound.GetNumaNode(), numa::NO_NODE);
+        ASSERT_TRUE(!bound.SetNumaNode(nodes));
+        ASSERT_TRUE(bound.SetNumaNode(0));
+        ASSERT_EQ(bound.GetNumaNode(), 0);
+
+        // slab and large blocks of a bound heap still work when the kernel refuses mbind.
+        bound.SetSlabBackend(true);
+        char* small = new (&bound) char[32];
+        char* large = new (&bound) char[MEM_SENTRY::constants::NUMA_BIND_MIN_BYTES * 2];
+        std::memset(small, 0xAB, 32);
+        std::memset(large, 0xCD, MEM_SENTRY::constants::NUMA_BIND_MIN_BYTES * 2);
+        #if MEM_SENTRY_ENABLE
+        // large blocks get a mapping of their own, only that is bound.
+        ASSERT_EQ(bound.GetStats().m_MappedCount, 1);
+        #endif
+        delete[] small;
+        delete[] large;
+        ASSERT_EQ(GetCount(&bound), 0);
+        ASSERT_TRUE(bound.SetNumaNode(numa::NO_NODE));
+
+        // a range without a full page has nothing to bind.
+        char page[64];
+        ASSERT_TRUE(numa::BindMemory(page, sizeof(page), 0));
+        ASSERT_TRUE(!numa::BindMemory(page, sizeof(page), nodes));
+
+        // 3. Node heaps are created once, bound, and out of range nodes have none.
+        ASSERT_TRUE(HeapFactory::GetNodeHeap(-1) == nullptr);
+        ASSERT_TRUE(HeapFactory::GetNodeHeap(nodes) == nullptr);
+
+        Heap* node0 = HeapFactory::GetNodeHeap(0);
+        ASSERT_TRUE(node0 != nullptr);
+        ASSERT_TRUE(HeapFactory::GetNodeHeap(0) == node0);
+        ASSERT_EQ(node0->GetNumaNode(), 0);
+        ASSERT_TRUE(node0->UsesSlabBackend());
+        ASSERT_TRUE(std::strcmp(node0->GetName(), "NodeHeap0") == 0);
+
+        Heap* local = HeapFactory::GetLocalHeap();
+        ASSERT_TRUE(local != nullptr);
+        ASSERT_TRUE(local->GetNumaNode() >= 0 && local->GetNumaNode() < nodes);
+
+        // 4. Node heaps keep their own stats and add up through the default heap graph.
+        Heap* root = HeapFactory::GetDefaultHeap();
+        const size_t LARGE = MEM_SENTRY::constants::NUMA_BIND_MIN_BYTES;
+        const size_t before = root->GetTotalHH();
+        const size_t count0 = GetCount(node0);
+
+        int* value = new (node0) int(7);
+        char* buffer = new (node0) char[LARGE];
+        std::memset(buffer, 0x11, LARGE);
+
+        // freed from a thread that may run on another node.
+        std::thread remote([&]() { delete value; });
+        remote.join();
+
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(GetCount(node0), count0 + 1);
+        ASSERT_TRUE(node0->GetStats().m_LiveBytes >= (int64_t)LARGE);
+        ASSERT_TRUE(root->GetTotalHH() >= before + LARGE);
+        #endif
+
+        delete[] buffer;
+        ASSERT_EQ(GetCount(node0), count0);
+        (void)before;
+    }
+
+    static void TestHotPathStats() {
+        LOG_TEST("TestHotPathStats (Hot-Path Counters)");
+        namespace stats = MEM_SENTRY::stats;
+        using stats::Counter;
+
+        stats::Reset();
+
+        // 1. A shard lock held by another thread counts as contended and records the wait.
+        std::mutex mutex;
+        std::atomic<bool> held{false};
+
+        std::thread holder([&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            held.store(true);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        });
+
+        while (!held.load()) std::this_thread::yield();
+        { stats::ShardLock lock(mutex); }
+        holder.join();
+
+        // tracked allocations go through the shard locks too.
+        Heap heap("StatsHeap");
+        delete new (&heap) int(1);
+
+        // 2. new_handler retries and the final failure of an allocation malloc can't serve.
+        static int s_HandlerCalls;
+        s_HandlerCalls = 0;
+        std::new_handler previous = std::set_new_handler([]() {
+            ++s_HandlerCalls;
+            std::set_new_handler(nullptr);
+        });
+
+        void* huge = ::operator new(size_t{1} << 60, std::nothrow);
+        std::set_new_handler(previous);
+        ASSERT_TRUE(huge == nullptr);
+        ASSERT_EQ(s_HandlerCalls, 1);
+
+        // 3. A full ring refuses a push, an empty one a pop; bulk calls count when cut short.
+        using Pool = MEM_SENTRY::mem_pool::RingPool<int, 64, false>;
+        using PoolBuffer = MEM_SENTRY::mem_pool::Buffer<int, 64, false>;
+
+        Pool full(false, 4, 0);
+        PoolBuffer extra(0);
+        ASSERT_TRUE(!full.push(&extra));
+        PoolBuffer* batch[8];
+        ASSERT_EQ(full.pop_bulk(batch, 8), size_t{3});
+        ASSERT_TRUE(full.pop() == nullptr);
+        ASSERT_EQ(full.push_bulk(batch, 3), size_t{3});
+
+        // 4. A chain whose pools are all empty grows.
+        MEM_SENTRY::mem_pool::PoolChain<int, 64, false> chain(4, 0);
+        PoolBuffer* popped[4];
+        for (auto& buffer : popped) buffer = chain.pop();
+        ASSERT_EQ(chain.poolCount(), size_t{2});
+        for (auto* buffer : popped) chain.push(buffer);
+
+        stats::StatsSnapshot snapshot = stats::Snapshot();
+
+        if constexpr (stats::ENABLED) {
+            ASSERT_TRUE(snapshot.get(Counter::ShardLockContended) >= 1);
+            ASSERT_TRUE(snapshot.get(Counter::ShardLockAcquired) >= 3);
+            ASSERT_TRUE(snapshot.samples(stats::Histogram::ShardLockWait) >= 1);
+            ASSERT_EQ(snapshot.get(Counter::NewHandlerRetries), uint64_t{1});
+            ASSERT_EQ(snapshot.get(Counter::AllocFailures), uint64_t{1});
+            ASSERT_TRUE(snapshot.get(Counter::RingPushFull) >= 1);
+            ASSERT_TRUE(snapshot.get(Counter::RingPopEmpty) >= 2);
+            ASSERT_EQ(snapshot.get(Counter::ChainGrowths), uint64_t{1});
+            ASSERT_EQ(snapshot.samples(stats::Histogram::ChainGrowth), uint64_t{1});
+
+            stats::Reset();
+            ASSERT_EQ(stats::Snapshot().get(Counter::ShardLockAcquired), uint64_t{0});
+        } else {
+            // compiled out: nothing is ever counted.
+            for (size_t c = 0; c < stats::COUNTERS; ++c) {
+                ASSERT_EQ(snapshot.m_Counters[c], uint64_t{0});
+            }
+        }
+
+        ASSERT_TRUE(std::strcmp(stats::CounterName(Counter::RingPushFull), "RingPushFull") == 0);
+        ASSERT_TRUE(std::strcmp(stats::HistogramName(stats::Histogram::ChainGrowth), "ChainGrowth") == 0);
+    }
+
+    static void TestSizedDelete() {
+        LOG_TEST("TestSizedDelete (Compiler-Provided Sizes)");
+        Heap sizedHeap("SizedHeap", MEM_SENTRY::heap::TrackingMode::ThreadLocal);
+        sizedHeap.SetSlabBackend(true);
+
+        // 1. Every slab size class: the chunk goes back to the class it came from.
+        for (size_t size = 1; size <= 400; size += 7) {
+            void* p = ::operator new(size, &sizedHeap);
+            std::memset(p, 0x5A, size);
+            ::operator delete(p, size);
+
+            void* again = ::operator new(size, &sizedHeap);
+            #if MEM_SENTRY_ENABLE
+            ASSERT_TRUE(again == p);
+            #endif
+            ::operator delete(again, size);
+        }
+
+        ASSERT_EQ(GetCount(&sizedHeap), 0);
+        ASSERT_EQ(GetTotal(&sizedHeap), 0);
+
+        // 2. Aligned, array and malloc-sized blocks, freed from another thread too.
+        void* aligned = ::operator new(96, std::align_val_t{64}, &sizedHeap);
+        ASSERT_TRUE(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+        ::operator delete(aligned, 96, std::align_val_t{64});
+
+        void* array = ::operator new[](48, &sizedHeap);
+        void* large = ::operator new(8192, &sizedHeap);
+        std::thread remote([&]() {
+            ::operator delete[](array, 48);
+            ::operator delete(large, 8192);
+        });
+        remote.join();
+
+        // 3. A plain `delete` of an ISentry type goes through sized delete on its own.
+        PhysicsObject::setHeap(&sizedHeap);
+        PhysicsObject* obj = new PhysicsObject();
+        delete obj;
+        PhysicsObject::setHeap(HeapFactory::GetDefaultHeap());
+
+        // 4. Zero-byte requests are served as one byte, unsampled blocks take the light path.
+        void* empty = ::operator new(0, &sizedHeap);
+        ::operator delete(empty, size_t{0});
+
+        sizedHeap.SetSamplingInterval(1 << 30);
+        void* light = ::operator new(32, &sizedHeap);
+        void* lightAligned = ::operator new(32, std::align_val_t{128}, &sizedHeap);
+        ::operator delete(light, 32);
+        ::operator delete(lightAligned, 32, std::align_val_t{128});
+
+        ASSERT_EQ(GetCount(&sizedHeap), 0);
+        ASSERT_EQ(GetTotal(&sizedHeap), 0);
+    }
+
+    static void TestCanaries() {
+        LOG_TEST("TestCanaries (End Marker + " << MEM_SENTRY::constants::REDZONE_BYTES << "-byte Redzone + Scrubber)");
+        namespace canary = MEM_SENTRY::canary;
+        using canary::Corruption;
+
+        // 1. The SIMD fill and check agree on every length around the vector width.
+        unsigned char zone[80];
+        for (size_t n = 0; n <= 64; ++n) {
+            std::memset(zone, 0, sizeof(zone));
+            canary::FillRedzone(zone + 1, n);
+            ASSERT_TRUE(canary::RedzoneIntact(zone + 1, n));
+            ASSERT_EQ(zone[n + 1], 0);
+            if (n) {
+                zone[n] ^= 1;
+                ASSERT_TRUE(!canary::RedzoneIntact(zone + 1, n));
+            }
+        }
+
+#if MEM_SENTRY_ENABLE
+        Heap guarded("GuardedHeap", MEM_SENTRY::heap::TrackingMode::ThreadLocal);
+        CorruptionReporter reporter;
+        guarded.SetReporter(&reporter);
+        ASSERT_TRUE(guarded.ChecksCanariesOnFree());
+
+        // 2. An intact block frees quietly, an overflow is reported by the free path.
+        char* clean = new (&guarded) char[20];
+        std::memset(clean, 0x11, 20);
+        delete[] clean;
+        ASSERT_EQ(reporter.count.load(), 0);
+
+        char* overflow = new (&guarded) char[20];
+        uint32_t overflowId = reinterpret_cast<AllocHeader*>(overflow)[-1].m_AllocId;
+        overflow[20] = 0;   // one byte past the end
+        delete[] overflow;
+        ASSERT_EQ(reporter.count.load(), 1);
+        ASSERT_EQ(reporter.lastId.load(), overflowId);
+        ASSERT_TRUE(reporter.lastKind.load() == Corruption::EndMarker);
+
+        if constexpr (MEM_SENTRY::constants::REDZONE_BYTES > 0) {
+            // past the end marker: only the redzone sees it.
+            char* far = new (&guarded) char[20];
+            far[20 + sizeof(int) + MEM_SENTRY::constants::REDZONE_BYTES - 1] = 0;
+            ::operator delete[](far, 20);
+            ASSERT_EQ(reporter.count.load(), 2);
+            ASSERT_TRUE(reporter.lastKind.load() == Corruption::Redzone);
+        }
+
+        // 3. With the free-path check off, Scrub() finds live overflows slice by slice.
+        reporter.count = 0;
+        guarded.SetCanaryCheckOnFree(false);
+
+        std::vector<char*> blocks;
+        for (int i = 0; i < 100; ++i) {
+            blocks.push_back(new (&guarded) char[8 + i]);
+        }
+        blocks[7][8 + 7] = 0;
+        blocks[63][8 + 63] = 0;
+
+        MEM_SENTRY::heap::ScrubCursor cursor;
+        size_t found = 0;
+        int slices = 0;
+        while (cursor.m_Passes == 0) {
+            found += guarded.Scrub(cursor, 16);
+            ++slices;
+        }
+        ASSERT_EQ(found, size_t{2});
+        ASSERT_EQ(reporter.count.load(), 2);
+        ASSERT_TRUE(slices >= 100 / 16);
+
+        // 4. The background thread does the same, and frees stay quiet meanwhile.
+        MEM_SENTRY::heap::Scrubber scrubber(std::chrono::microseconds(200), 32);
+        scrubber.Watch(&guarded);
+        scrubber.Watch(&guarded);
+
+        std::thread churn([&]() {
+            for (int i = 0; i < 2000; ++i) delete new (&guarded) int(i);
+        });
+
+        for (int i = 0; i < 5000 && scrubber.GetPasses(&guarded) < 2; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        churn.join();
+        scrubber.Unwatch(&guarded);
+
+        ASSERT_TRUE(scrubber.GetFound() >= 2);
+        ASSERT_EQ(scrubber.GetPasses(&guarded), uint64_t{0});
+
+        for (char* p : blocks) delete[] p;
+        ASSERT_EQ(GetCount(&guarded), 0);
+        guarded.SetReporter(nullptr);
+#endif
+    }
+
+    static void TestArenaHeap() {
+        LOG_TEST("TestArenaHeap (Bump Allocation + Bulk Reset)");
+#if MEM_SENTRY_ENABLE
+        using MEM_SENTRY::heap::ArenaHeap;
+
+        ArenaHeap arena("FrameArena", 4096);
+        CountingReporter reporter;
+        arena.SetReporter(&reporter);
+        ASSERT_TRUE(arena.IsArena());
+        ASSERT_EQ(arena.GetChunkCount(), size_t{0});
+
+        // 1. ISentry objects routed to the arena: one tracked chunk, not one block each.
+        FrameObject::setHeap(&arena);
+        std::vector<FrameObject*> objects;
+        for (uint64_t i = 0; i < 40; ++i) {
+            FrameObject* obj = new FrameObject(i);
+            ASSERT_EQ((uintptr_t)obj % MEM_SENTRY::constants::ARENA_MIN_ALIGNMENT, uintptr_t{0});
+            ASSERT_TRUE(MEM_SENTRY::alloc_header::KindOf(obj) == MEM_SENTRY::alloc_header::BlockKind::Arena);
+            objects.push_back(obj);
+        }
+        ASSERT_EQ(arena.GetChunkCount(), size_t{1});
+        ASSERT_EQ(GetCount(&arena), 1);
+        ASSERT_EQ(reporter.allocs.load(), 1);
+        ASSERT_TRUE(arena.GetUsed() >= 40 * sizeof(FrameObject));
+        for (uint64_t i = 0; i < 40; ++i) ASSERT_EQ(objects[i]->frame, i);
+
+        // delete runs the destructor only.
+        for (FrameObject* obj : objects) delete obj;
+        ASSERT_EQ(reporter.deallocs.load(), 0);
+
+        // 2. Full chunks grow the arena, big objects and over-aligned ones still fit.
+        for (int i = 0; i < 200; ++i) new (&arena) FrameObject(i);
+        ASSERT_TRUE(arena.GetChunkCount() > 1);
+
+        AlignedDeepData* aligned = new (&arena) AlignedDeepData();
+        ASSERT_EQ((uintptr_t)aligned % alignof(AlignedDeepData), uintptr_t{0});
+
+        size_t chunks = arena.GetChunkCount();
+        char* big = new (&arena) char[16 * 1024];
+        std::memset(big, 0x5A, 16 * 1024);
+        ASSERT_EQ(arena.GetChunkCount(), chunks + 1);
+        ASSERT_TRUE(arena.GetCapacity() >= 16 * 1024 + chunks * 4096);
+        delete[] big;
+
+        // 3. The chunk totals are visible through the hierarchy.
+        Heap parent("ArenaParent");
+        parent.AddHeap(&arena);
+        ASSERT_EQ((int64_t)parent.GetTotalHH(), arena.GetTotal());
+        ASSERT_TRUE(arena.GetTotal() >= (int64_t)arena.GetCapacity());
+
+        // 4. Reset frees everything but the current chunk, which is rewound.
+        arena.Reset();
+        ASSERT_EQ(arena.GetChunkCount(), size_t{1});
+        ASSERT_EQ(arena.GetUsed(), size_t{0});
+        ASSERT_EQ(GetCount(&arena), 1);
+        ASSERT_EQ(reporter.deallocs.load(), reporter.allocs.load() - 1);
+
+        // 5. Concurrent bumps never hand out overlapping memory.
+        std::vector<std::thread> threads;
+        std::vector<std::vector<uint64_t*>> perThread(4);
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&arena, &perThread, t]() {
+                for (uint64_t i = 0; i < 2000; ++i) {
+                    uint64_t* v = new (&arena) uint64_t((uint64_t)t << 32 | i);
+                    perThread[t].push_back(v);
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        for (int t = 0; t < 4; ++t) {
+            for (uint64_t i = 0; i < 2000; ++i) ASSERT_EQ(*perThread[t][i], ((uint64_t)t << 32 | i));
+        }
+
+        // 6. Release drops every chunk.
+        arena.Release();
+        ASSERT_EQ(arena.GetChunkCount(), size_t{0});
+        ASSERT_EQ(GetCount(&arena), 0);
+        ASSERT_EQ(reporter.deallocs.load(), reporter.allocs.load());
+
+        FrameObject::setHeap(nullptr);
+        arena.SetReporter(nullptr);
+#endif
+    }
+
+    static void TestReallocate() {
+        LOG_TEST("TestReallocate (In-Place Resize)");
+#if MEM_SENTRY_ENABLE
+        Heap heap("ReallocHeap");
+        CorruptionReporter reporter;
+        heap.SetReporter(&reporter);
+
+        // 1. Shrinking and growing back within the malloc block stay in place.
+        char* p = static_cast<char*>(ms_malloc(100, &heap));
+        for (int i = 0; i < 100; ++i) p[i] = (char)i;
+        uint32_t id = reinterpret_cast<AllocHeader*>(p)[-1].m_AllocId;
+        ASSERT_EQ(GetTotal(&heap), 100);
+
+        ASSERT_TRUE(ms_realloc(p, 50) == p);
+        ASSERT_EQ(GetTotal(&heap), 50);
+        ASSERT_TRUE(ms_realloc(p, 100) == p);
+        ASSERT_EQ(GetTotal(&heap), 100);
+        ASSERT_EQ(GetCount(&heap), 1);
+        ASSERT_EQ(reinterpret_cast<AllocHeader*>(p)[-1].m_AllocId, id);
+
+        // the end marker moved with the size: writing the new tail is no overflow.
+        std::memset(p + 50, 0x77, 50);
+
+        // 2. Growing past the block moves it, the data comes along.
+        char* moved = static_cast<char*>(ms_realloc(p, 100000));
+        ASSERT_TRUE(moved != nullptr);
+        for (int i = 0; i < 50; ++i) ASSERT_EQ(moved[i], (char)i);
+        ASSERT_EQ(GetTotal(&heap), 100000);
+        ASSERT_EQ(GetCount(&heap), 1);
+        ms_free(moved);
+        ASSERT_EQ(GetCount(&heap), 0);
+        ASSERT_EQ(reporter.count.load(), 0);
+
+        // 3. Slab chunks resize in place within their size class only.
+        Heap slabHeap("ReallocSlabHeap");
+        slabHeap.SetSlabBackend(true);
+        char* small = static_cast<char*>(ms_malloc(40, &slabHeap));
+        std::memset(small, 0x42, 40);
+        ASSERT_TRUE(ms_realloc(small, 44) == small);
+        char* grown = static_cast<char*>(ms_realloc(small, 400));
+        ASSERT_TRUE(grown != small);
+        for (int i = 0; i < 40; ++i) ASSERT_EQ(grown[i], (char)0x42);
+        ::operator delete(grown, 400);
+        ASSERT_EQ(GetCount(&slabHeap), 0);
+
+        // 4. Moved aligned blocks keep their alignment.
+        void* aligned = ::operator new(64, std::align_val_t{64}, &heap);
+        void* alignedMoved = ms_realloc(aligned, 8192);
+        ASSERT_EQ((uintptr_t)alignedMoved % 64, uintptr_t{0});
+        ASSERT_EQ(GetTotal(&heap), 8192 + 64);
+        ms_free(alignedMoved);
+
+        // 5. calloc zeroes and refuses overflowing counts.
+        int* zeroed = static_cast<int*>(ms_calloc(16, sizeof(int), &heap));
+        for (int i = 0; i < 16; ++i) ASSERT_EQ(zeroed[i], 0);
+        ms_free(zeroed);
+        ASSERT_TRUE(ms_calloc(SIZE_MAX / 2, 4, &heap) == nullptr);
+
+        // 6. Sizes past the 32-bit size of the headers are refused, the block stays as it was.
+        const size_t tooBig = MEM_SENTRY::alloc_header::MAX_BLOCK_SIZE + 1;
+        ASSERT_TRUE(ms_malloc(tooBig, &heap) == nullptr);
+        char* tracked = static_cast<char*>(ms_malloc(64, &heap));
+        ASSERT_TRUE(ms_realloc(tracked, tooBig) == nullptr);
+        ASSERT_EQ(reinterpret_cast<AllocHeader*>(tracked)[-1].m_Size, 64u);
+        ms_free(tracked);
+
+        Heap lightHeap("ReallocLightHeap");
+        lightHeap.SetSamplingInterval(size_t{1} << 40);
+        // the first block draws the countdown of the thread, the next one is skipped.
+        void* sampled = ms_malloc(64, &lightHeap);
+        char* light = static_cast<char*>(ms_malloc(64, &lightHeap));
+        ASSERT_TRUE(MEM_SENTRY::alloc_header::IsLight(MEM_SENTRY::alloc_header::KindOf(light)));
+        ASSERT_TRUE(ms_realloc(light, tooBig) == nullptr);
+        ASSERT_EQ(reinterpret_cast<MEM_SENTRY::alloc_header::LightHeader*>(light)[-1].m_Size, 64u);
+        ms_free(light);
+        ms_free(sampled);
+
+        // 7. The C-style calls fail with nullptr and never run the new_handler, which may throw.
+        static int s_CHandlerCalls;
+        s_CHandlerCalls = 0;
+        std::new_handler previousHandler = std::set_new_handler([]() {
+            ++s_CHandlerCalls;
+            throw std::bad_alloc();
+        });
+        ASSERT_TRUE(ms_malloc(tooBig, &heap) == nullptr);
+        ASSERT_TRUE(ms_calloc(tooBig, 1, &heap) == nullptr);
+        char* kept = static_cast<char*>(ms_malloc(64, &heap));
+        ASSERT_TRUE(ms_realloc(kept, tooBig) == nullptr);
+        ms_free(kept);
+
+        // operator new still goes through the handler.
+        bool threw = false;
+        try { ::operator delete(::operator new(tooBig, &heap)); } catch (const std::bad_alloc&) { threw = true; }
+        std::set_new_handler(previousHandler);
+        ASSERT_TRUE(threw);
+        ASSERT_EQ(s_CHandlerCalls, 1);
+
+        ASSERT_EQ(GetCount(&heap), 0);
+        heap.SetReporter(nullptr);
+#endif
+    }
+
+    static void TestInterposed() {
+        Heap* def = HeapFactory::GetDefaultHeap();
+        def->SetReporter(nullptr);
+        TestInterposedCalls();
+        def->SetReporter(&gConsoleReporter);
+    }
+
+    static void TestHeapSnapshot() {
+        LOG_TEST("TestHeapSnapshot (Sliced Snapshot + Vectorized Diff)");
+        using MEM_SENTRY::heap::HeapSnapshot;
+
+        // 1. Diff matches std::set_difference on random sets of every size around the vector width.
+        std::mt19937 rng(23);
+        for (int round = 0; round < 200; ++round) {
+            std::vector<uint32_t> before, after;
+            size_t na = rng() % 40, nb = rng() % 40;
+            for (uint32_t id = 1; before.size() < na || after.size() < nb; ++id) {
+                unsigned pick = rng() % 4;
+                if (pick & 1 && before.size() < na) before.push_back(id);
+                if (pick & 2 && after.size() < nb) after.push_back(id);
+            }
+
+            HeapSnapshot a, b;
+            for (uint32_t id : before) a.Push(id, id * 2, 0, nullptr);
+            for (uint32_t id : after) b.Push(id, id * 2, 0, nullptr);
+
+            std::vector<uint32_t> freed, added;
+            std::set_difference(before.begin(), before.end(), after.begin(), after.end(), std::back_inserter(freed));
+            std::set_difference(after.begin(), after.end(), before.begin(), before.end(), std::back_inserter(added));
+
+            MEM_SENTRY::heap::SnapshotDiff diff = MEM_SENTRY::heap::Diff(a, b);
+            ASSERT_EQ(diff.m_Freed.Size(), freed.size());
+            ASSERT_EQ(diff.m_Added.Size(), added.size());
+            for (size_t i = 0; i < freed.size(); ++i) ASSERT_EQ(diff.m_Freed.GetId(i), freed[i]);
+            for (size_t i = 0; i < added.size(); ++i) {
+                ASSERT_EQ(diff.m_Added.GetId(i), added[i]);
+                ASSERT_EQ(diff.m_Added.GetSize(i), added[i] * 2);
+            }
+        }
+
+#if MEM_SENTRY_ENABLE
+        // 2. Snapshots of a sharded heap, taken in small slices, come out sorted and complete.
+        Heap heap("SnapshotHeap", MEM_SENTRY::heap::TrackingMode::ThreadLocal);
+        std::vector<int*> blocks(300);
+        std::thread other([&]() {
+            for (int i = 0; i < 150; ++i) blocks[i] = new (&heap) int(i);
+        });
+        other.join();
+        for (int i = 150; i < 300; ++i) blocks[i] = new (&heap) int(i);
+
+        HeapSnapshot first = heap.Snapshot(7);
+        ASSERT_EQ(first.Size(), size_t{300});
+        ASSERT_EQ(first.GetTotalBytes(), uint64_t{300 * sizeof(int)});
+        for (size_t i = 1; i < first.Size(); ++i) ASSERT_TRUE(first.GetId(i - 1) < first.GetId(i));
+        ASSERT_TRUE(first.GetAddress(0) == blocks[0]);
+
+        // 3. The diff names exactly the blocks freed and allocated in between.
+        std::vector<uint32_t> freedIds;
+        for (int i = 0; i < 300; i += 3) {
+            freedIds.push_back(reinterpret_cast<AllocHeader*>(blocks[i])[-1].m_AllocId);
+            delete blocks[i];
+            blocks[i] = nullptr;
+        }
+        std::vector<int*> leaks;
+        for (int i = 0; i < 50; ++i) leaks.push_back(new (&heap) int(i));
+
+        HeapSnapshot second = heap.Snapshot();
+        MEM_SENTRY::heap::SnapshotDiff diff = MEM_SENTRY::heap::Diff(first, second);
+        std::sort(freedIds.begin(), freedIds.end());
+        ASSERT_EQ(diff.m_Freed.Size(), freedIds.size());
+        for (size_t i = 0; i < freedIds.size(); ++i) ASSERT_EQ(diff.m_Freed.GetId(i), freedIds[i]);
+        ASSERT_EQ(diff.m_Added.Size(), leaks.size());
+        for (size_t i = 0; i < leaks.size(); ++i) ASSERT_TRUE(diff.m_Added.GetAddress(i) == leaks[i]);
+
+        for (int* p : blocks) delete p;
+        for (int* p : leaks) delete p;
+        ASSERT_TRUE(heap.Snapshot().Empty());
+#endif
+    }
+
+    // two distinct call sites for TestCallSites().
+    __attribute__((noinline)) static int* AllocFromSiteA(Heap* heap) { return new (heap) int(1); }
+    __attribute__((noinline)) static int* AllocFromSiteB(Heap* heap) { return new (heap) int(2); }
+
+    static void TestCallSites() {
+        LOG_TEST("TestCallSites (Frame-Pointer Capture + Per-Site Totals)");
+        using MEM_SENTRY::callsite::CallSite;
+        using MEM_SENTRY::constants::CALLSITE_NO_STACK;
+
+        Heap heap("CallSiteHeap");
+        const auto stackOf = [](int* p) {
+            return MEM_SENTRY::alloc_header::GetStackId(reinterpret_cast<AllocHeader*>(p) - 1);
+        };
+
+        // 1. Off by default, and the depth is clamped.
+        ASSERT_EQ(heap.GetCallSiteDepth(), size_t{0});
+        heap.SetCallSiteDepth(1000);
+        ASSERT_EQ(heap.GetCallSiteDepth(), MEM_SENTRY::constants::CALLSITE_MAX_DEPTH);
+        heap.SetCallSiteDepth(0);
+
+#if MEM_SENTRY_ENABLE
+        int* untracked = new (&heap) int(0);
+        ASSERT_EQ(stackOf(untracked), CALLSITE_NO_STACK);
+        delete untracked;
+
+        heap.SetCallSiteDepth(8);
+        std::vector<int*> a, b;
+        for (int i = 0; i < 10; ++i) a.push_back(AllocFromSiteA(&heap));
+        for (int i = 0; i < 5; ++i) b.push_back(AllocFromSiteB(&heap));
+
+#if !MEM_SENTRY_COMPACT_HEADER
+        // 2. Every block of a site shares its stack id, the two sites don't.
+        const uint32_t idA = stackOf(a[0]);
+        const uint32_t idB = stackOf(b[0]);
+        ASSERT_TRUE(idA != CALLSITE_NO_STACK);
+        ASSERT_TRUE(idB != CALLSITE_NO_STACK);
+        ASSERT_TRUE(idA != idB);
+        for (int* p : a) ASSERT_EQ(stackOf(p), idA);
+        for (int* p : b) ASSERT_EQ(stackOf(p), idB);
+
+        // 3. Per-site totals follow the live blocks.
+        CallSite site;
+        ASSERT_TRUE(MEM_SENTRY::callsite::GetSite(idA, site));
+        ASSERT_TRUE(site.m_Depth > 0);
+        ASSERT_EQ(site.m_LiveCount, int64_t{10});
+        ASSERT_EQ(site.m_LiveBytes, int64_t{10 * sizeof(int)});
+
+        CallSite top[2];
+        ASSERT_EQ(MEM_SENTRY::callsite::TopSites(top, 2), size_t{2});
+        ASSERT_EQ(top[0].m_Id, idA);
+        ASSERT_EQ(top[1].m_Id, idB);
+
+        for (size_t i = 0; i < a.size(); i += 2) {
+            delete a[i];
+            a[i] = nullptr;
+        }
+        ASSERT_TRUE(MEM_SENTRY::callsite::GetSite(idA, site));
+        ASSERT_EQ(site.m_LiveCount, int64_t{5});
+#else
+        // 2. The compact layout has no room for a stack id.
+        ASSERT_EQ(stackOf(a[0]), CALLSITE_NO_STACK);
+#endif
+
+        for (int* p : a) delete p;
+        for (int* p : b) delete p;
+
+#if !MEM_SENTRY_COMPACT_HEADER
+        // 4. Everything freed: the sites keep their lifetime totals only.
+        ASSERT_TRUE(MEM_SENTRY::callsite::GetSite(idA, site));
+        ASSERT_EQ(site.m_LiveCount, int64_t{0});
+        ASSERT_EQ(site.m_LiveBytes, int64_t{0});
+        ASSERT_EQ(site.m_TotalAllocs, uint64_t{10});
+        ASSERT_EQ(MEM_SENTRY::callsite::GetDropped(), uint64_t{0});
+#endif
+#endif
+    }
+
+    static void TestSentryFastPath() {
+        LOG_TEST("TestSentryFastPath (Compile-Time Block Layout + Policy)");
+        using MEM_SENTRY::sentry::FixedBlock;
+
+        // 1. The block layout is fixed at compile time and matches the runtime one.
+        static_assert(FixedBlock<sizeof(PolicyObject), alignof(PolicyObject)>::ALIGNMENT == 0);
+        static_assert(FixedBlock<sizeof(AlignedPolicyObject), alignof(AlignedPolicyObject)>::ALIGNMENT == 64);
+        static_assert(FixedBlock<24, 8>::RAW_BYTES == MEM_SENTRY::alloc_header::BlockBytes(24, 0));
+
+        Heap heap("FastPathHeap");
+        PolicyObject::setHeap(&heap);
+        AlignedPolicyObject::setHeap(&heap);
+        CountingPolicy::allocs = 0;
+        CountingPolicy::frees = 0;
+
+        // 2. Single objects go through the policy, on the class heap.
+        std::vector<PolicyObject*> objects;
+        for (int i = 0; i < 32; ++i) objects.push_back(new PolicyObject(i));
+        AlignedPolicyObject* aligned = new AlignedPolicyObject();
+        ASSERT_TRUE(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+        ASSERT_EQ(CountingPolicy::allocs.load(), 33);
+
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(GetCount(&heap), size_t{33});
+        // the totals count the alignment padding reserved by aligned blocks.
+        ASSERT_EQ(heap.GetTotal(), (int64_t)(32 * sizeof(PolicyObject) + sizeof(AlignedPolicyObject) + 64));
+        const AllocHeader* alignedHeader = reinterpret_cast<const AllocHeader*>(aligned) - 1;
+        ASSERT_EQ(MEM_SENTRY::alloc_header::GetAlignment(alignedHeader), size_t{64});
+        #endif
+
+        // 3. Bigger derived objects and arrays take the generic path.
+        DerivedPolicyObject* derived = new DerivedPolicyObject();
+        PolicyObject* array = new PolicyObject[3]{PolicyObject(1), PolicyObject(2), PolicyObject(3)};
+        ASSERT_EQ(CountingPolicy::allocs.load(), 33);
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(GetCount(&heap), size_t{35});
+        #endif
+        delete[] array;
+        delete derived;
+        ASSERT_EQ(CountingPolicy::frees.load(), 0);
+
+        // 4. delete returns single objects through the policy too.
+        for (PolicyObject* p : objects) delete p;
+        delete aligned;
+        ASSERT_EQ(CountingPolicy::frees.load(), 33);
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(GetCount(&heap), size_t{0});
+        ASSERT_EQ(heap.GetTotal(), 0);
+        #endif
+
+        // 5. An explicit heap still wins over the class heap, and nothrow new shares the fast path.
+        Heap other("FastPathOther");
+        PolicyObject* placed = new (&other) PolicyObject(1);
+        PolicyObject* nothrow = new (std::nothrow) PolicyObject(2);
+        ASSERT_TRUE(nothrow != nullptr);
+        ASSERT_EQ(CountingPolicy::allocs.load(), 35);
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(GetCount(&other), size_t{1});
+        ASSERT_EQ(GetCount(&heap), size_t{1});
+        #endif
+        delete placed;
+        delete nothrow;
+        ASSERT_EQ(CountingPolicy::frees.load(), 35);
+
+        PolicyObject::setHeap(nullptr);
+        AlignedPolicyObject::setHeap(nullptr);
+    }
+
+    static void TestSentryConstructorThrows() {
+        LOG_TEST("TestSentryConstructorThrows (Placement Delete Partners)");
+
+        Heap heap("ThrowHeap");
+        Heap other("ThrowOther");
+        ThrowingPolicyObject::setHeap(&heap);
+        ThrowingAlignedObject::setHeap(&heap);
+        CountingPolicy::allocs = 0;
+        CountingPolicy::frees = 0;
+
+        const auto throws = [](auto&& make) {
+            try { make(); } catch (const std::runtime_error&) { return true; }
+            return false;
+        };
+
+        // 1. Single objects go back through the policy when their constructor throws.
+        ASSERT_TRUE(throws([] { return new (std::nothrow) ThrowingPolicyObject(true); }));
+        ASSERT_TRUE(throws([&] { return new (&other) ThrowingPolicyObject(true); }));
+        ASSERT_TRUE(throws([] { return new (std::nothrow) ThrowingAlignedObject(true); }));
+        ASSERT_TRUE(throws([&] { return new (&other) ThrowingAlignedObject(true); }));
+        ASSERT_EQ(CountingPolicy::allocs.load(), 4);
+        ASSERT_EQ(CountingPolicy::frees.load(), 4);
+
+        // 2. Bigger derived objects took the generic path and are freed by it.
+        ASSERT_TRUE(throws([] { return new (std::nothrow) ThrowingDerivedObject(true); }));
+        ASSERT_TRUE(throws([&] { return new (&other) ThrowingDerivedObject(true); }));
+        ASSERT_EQ(CountingPolicy::allocs.load(), 4);
+        ASSERT_EQ(CountingPolicy::frees.load(), 4);
+
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(GetCount(&heap), size_t{0});
+        ASSERT_EQ(GetCount(&other), size_t{0});
+        ASSERT_EQ(heap.GetTotal(), 0);
+        ASSERT_EQ(other.GetTotal(), 0);
+        #endif
+
+        // 3. Objects that construct fine are unaffected.
+        ThrowingPolicyObject* fine = new (&other) ThrowingPolicyObject(false);
+        ASSERT_EQ(fine->value, 1);
+        delete fine;
+        ASSERT_EQ(CountingPolicy::frees.load(), 5);
+
+        ThrowingPolicyObject::setHeap(nullptr);
+        ThrowingAlignedObject::setHeap(nullptr);
+    }
+
+    static void TestRecyclingPolicy() {
+        LOG_TEST("TestRecyclingPolicy (Per-Thread Freelists)");
+        #if MEM_SENTRY_ENABLE
+        using Bin = MEM_SENTRY::sentry::RecycleBin<sizeof(RecycledObject), alignof(RecycledObject), 8>;
+        const int64_t objectBytes = (int64_t)sizeof(RecycledObject);
+
+        Heap heap("RecycleHeap");
+        RecycledObject::setHeap(&heap);
+
+        // 1. A deleted object leaves its heap while parked and is handed back by the next new.
+        RecycledObject* first = new RecycledObject(1);
+        const uint32_t firstId = (reinterpret_cast<AllocHeader*>(first) - 1)->m_AllocId;
+        delete first;
+        ASSERT_EQ(GetCount(&heap), size_t{0});
+        ASSERT_EQ(heap.GetTotal(), 0);
+        ASSERT_EQ(heap.GetStats().m_TotalFrees, uint64_t{1});
+        ASSERT_EQ(heap.GetStats().m_CachedCount, 1);
+        ASSERT_EQ(heap.GetStats().m_CachedBytes, objectBytes);
+
+        // the reused block is a new allocation: fresh ID, inside a bookmark taken after its first life.
+        const int mark = heap.GetNextId();
+        RecycledObject* again = new RecycledObject(2);
+        ASSERT_TRUE(again == first);
+        ASSERT_EQ(again->id, uint64_t{2});
+        ASSERT_TRUE((reinterpret_cast<AllocHeader*>(again) - 1)->m_AllocId > firstId);
+        ASSERT_EQ(GetCount(&heap), size_t{1});
+        ASSERT_EQ(heap.GetStats().m_TotalAllocs, uint64_t{2});
+        ASSERT_EQ(heap.GetStats().m_CachedCount, 0);
+
+        RangeReporter range;
+        heap.SetReporter(&range);
+        heap.ReportMemory(mark, mark + 10);
+        heap.SetReporter(nullptr);
+        ASSERT_EQ(range.ids.size(), size_t{1});
+        delete again;
+
+        // 2. Past the capacity, half of the thread's cache moves to the overflow stack.
+        std::vector<RecycledObject*> objects;
+        for (int i = 0; i < 20; ++i) objects.push_back(new RecycledObject(i));
+        for (RecycledObject* p : objects) delete p;
+        ASSERT_EQ(Bin::LocalCount(), size_t{8});
+        ASSERT_EQ(Bin::OverflowCount(), size_t{12});
+        ASSERT_EQ(GetCount(&heap), size_t{0});
+        ASSERT_EQ(heap.GetStats().m_CachedCount, 20);
+        ASSERT_EQ(heap.GetStats().m_CachedBytes, 20 * objectBytes);
+
+        // 3. A block of another heap is freed normally while the cache holds this one's.
+        Heap other("RecycleOther");
+        RecycledObject* foreign = new (&other) RecycledObject(3);
+        ASSERT_EQ(GetCount(&other), size_t{1});
+        delete foreign;
+        ASSERT_EQ(GetCount(&other), size_t{0});
+        ASSERT_EQ(Bin::LocalCount(), size_t{8});
+
+        // 4. Another thread reuses the overflow stack, and returns its cache there when it exits.
+        bool reused = true;
+        std::thread worker([&]() {
+            std::vector<RecycledObject*> local;
+            for (int i = 0; i < 6; ++i) local.push_back(new RecycledObject(i));
+            for (RecycledObject* p : local) {
+                reused = reused && std::find(objects.begin(), objects.end(), p) != objects.end();
+            }
+            for (RecycledObject* p : local) delete p;
+        });
+        worker.join();
+        ASSERT_TRUE(reused);
+        ASSERT_EQ(Bin::OverflowCount(), size_t{12});
+        ASSERT_EQ(GetCount(&heap), size_t{0});
+        ASSERT_EQ(heap.GetStats().m_CachedCount, 20);
+
+        // 5. releaseCache() frees the calling thread's cache and the overflow stack for good.
+        RecycledObject::releaseCache();
+        ASSERT_EQ(Bin::LocalCount(), size_t{0});
+        ASSERT_EQ(Bin::OverflowCount(), size_t{0});
+        ASSERT_EQ(GetCount(&heap), size_t{0});
+        ASSERT_EQ(heap.GetTotal(), 0);
+        ASSERT_EQ(heap.GetStats().m_CachedCount, 0);
+        ASSERT_EQ(heap.GetStats().m_CachedBytes, 0);
+
+        RecycledObject::setHeap(nullptr);
+        #endif
+    }
+
+    static void TestMappedBlocks() {
+        LOG_TEST("TestMappedBlocks (mmap Large-Block Path)");
+#if MEM_SENTRY_ENABLE
+        using MEM_SENTRY::alloc_header::BlockKind;
+        using MEM_SENTRY::alloc_header::KindOf;
+        using MEM_SENTRY::mapped::HugePages;
+        const size_t page = MEM_SENTRY::mapped::PageSize();
+
+        Heap heap("MappedHeap");
+        heap.SetMappedThreshold(64 * 1024);
+
+        // 1. Small blocks keep malloc, big ones get their own page-aligned mapping.
+        char* small = static_cast<char*>(ms_malloc(100, &heap));
+        char* big = static_cast<char*>(ms_malloc(1 << 20, &heap));
+        ASSERT_TRUE(KindOf(small) == BlockKind::Malloc);
+        ASSERT_TRUE(KindOf(big) == BlockKind::Mapped);
+        ASSERT_TRUE(reinterpret_cast<uintptr_t>(big) % page == 0);
+        std::memset(big, 0x5A, 1 << 20);
+
+        MEM_SENTRY::heap::HeapStats stats = heap.GetStats();
+        ASSERT_EQ(stats.m_MappedCount, 1);
+        ASSERT_TRUE(stats.m_MappedBytes >= (int64_t)(1 << 20) + (int64_t)page);
+        ASSERT_EQ(stats.m_MappedBytes % (int64_t)page, 0);
+        ASSERT_EQ(GetTotal(&heap), (1 << 20) + 100);
+        ASSERT_EQ(GetCount(&heap), 2);
+
+        // 2. Shrinking stays in place and unmaps the tail; growing keeps the data.
+        ASSERT_TRUE(ms_realloc(big, 256 * 1024) == big);
+        ASSERT_TRUE(heap.GetStats().m_MappedBytes < stats.m_MappedBytes);
+        ASSERT_EQ(GetTotal(&heap), 256 * 1024 + 100);
+
+        // a scrub running next to the shrinks only ever reads mapped end markers.
+        {
+            std::atomic<bool> stop{false};
+            std::thread scrubber([&]() {
+                MEM_SENTRY::heap::ScrubCursor cursor;
+                while (!stop.load(std::memory_order_relaxed)) heap.Scrub(cursor);
+            });
+            for (int i = 0; i < 200; ++i) {
+                char* shrinking = static_cast<char*>(ms_malloc(512 * 1024, &heap));
+                ASSERT_TRUE(ms_realloc(shrinking, 72 * 1024) == shrinking);
+                ms_free(shrinking);
+            }
+            stop.store(true, std::memory_order_relaxed);
+            scrubber.join();
+        }
+
+        char* grown = static_cast<char*>(ms_realloc(big, 4 << 20));
+        ASSERT_TRUE(grown != nullptr);
+        ASSERT_TRUE(KindOf(grown) == BlockKind::Mapped);
+        ASSERT_TRUE(grown[0] == 0x5A && grown[256 * 1024 - 1] == 0x5A);
+        ASSERT_EQ(heap.GetStats().m_MappedCount, 1);
+
+        // 3. free returns the pages: nothing stays mapped.
+        ms_free(grown);
+        ms_free(small);
+        ASSERT_EQ(heap.GetStats().m_MappedCount, 0);
+        ASSERT_EQ(heap.GetStats().m_MappedBytes, 0);
+        ASSERT_EQ(GetCount(&heap), 0);
+
+        // 4. Alignments up to a page cost no padding, bigger ones are honoured too.
+        void* aligned = ::operator new(128 * 1024, std::align_val_t{64}, &heap);
+        void* wide = ::operator new(128 * 1024, std::align_val_t{64 * 1024}, &heap);
+        ASSERT_TRUE(KindOf(aligned) == BlockKind::Mapped && KindOf(wide) == BlockKind::Mapped);
+        ASSERT_TRUE(reinterpret_cast<uintptr_t>(aligned) % page == 0);
+        ASSERT_TRUE(reinterpret_cast<uintptr_t>(wide) % (64 * 1024) == 0);
+        std::memset(wide, 0x11, 128 * 1024);
+        ::operator delete(aligned, std::align_val_t{64});
+        ::operator delete(wide, std::align_val_t{64 * 1024});
+        ASSERT_EQ(heap.GetStats().m_MappedBytes, 0);
+
+        // 5. Huge page requests fall back to normal pages when none are reserved.
+        heap.SetMappedThreshold(64 * 1024, HugePages::Explicit);
+        char* huge = static_cast<char*>(ms_malloc(3 << 20, &heap));
+        ASSERT_TRUE(KindOf(huge) == BlockKind::Mapped);
+        std::memset(huge, 0x22, 3 << 20);
+        ms_free(huge);
+
+        heap.SetMappedThreshold(64 * 1024, HugePages::Transparent);
+        char* thp = static_cast<char*>(ms_malloc(3 << 20, &heap));
+        ASSERT_TRUE(KindOf(thp) == BlockKind::Mapped);
+        std::memset(thp, 0x33, 3 << 20);
+        ms_free(thp);
+        ASSERT_EQ(heap.GetStats().m_MappedCount, 0);
+
+        // 6. Unsampled blocks map too, and count as mapped without being tracked.
+        heap.SetSamplingInterval(size_t{1} << 50);
+        ms_free(ms_malloc(8, &heap));   // the first allocation always takes a sample and arms the countdown.
+        char* light = static_cast<char*>(ms_malloc(1 << 20, &heap));
+        ASSERT_TRUE(KindOf(light) == BlockKind::MappedLight);
+        ASSERT_EQ(heap.GetStats().m_MappedCount, 1);
+        ASSERT_EQ(GetCount(&heap), 0);
+        ms_free(light);
+        ASSERT_EQ(heap.GetStats().m_MappedBytes, 0);
+
+        // 7. Threshold 0 turns the path off.
+        heap.SetSamplingInterval(0);
+        heap.SetMappedThreshold(0);
+        char* plain = static_cast<char*>(ms_malloc(1 << 20, &heap));
+        ASSERT_TRUE(KindOf(plain) == BlockKind::Malloc);
+        ms_free(plain);
+#endif
+    }
+
+    static void TestTelemetryExporter() {
+        LOG_TEST("TestTelemetryExporter (Shared Memory Seqlock Table)");
+#if MEM_SENTRY_ENABLE
+        using namespace MEM_SENTRY::telemetry;
+
+        // an interval that never elapses: every publish below is explicit.
+        TelemetryExporter exporter("/memsentry_test_telemetry", std::chrono::hours(1));
+        ASSERT_TRUE(exporter.IsOpen());
+        ASSERT_EQ(exporter.GetPublishes(), 1);
+
+        const TelemetryHeader* region = exporter.GetRegion();
+        ASSERT_TRUE(IsValid(region));
+        ASSERT_EQ(region->m_HeapSlots, MEM_SENTRY::constants::TELEMETRY_HEAP_SLOTS);
+
+        // 1. Heap counters show up in the record of the heap's index.
+        Heap* heap = new Heap("TelemetryHeap");
+        const uint16_t index = heap->GetIndex();
+        ASSERT_TRUE(index < region->m_HeapSlots);
+
+        void* blocks[3];
+        for (void*& block : blocks) block = ms_malloc(100, heap);
+
+        exporter.Publish();
+
+        HeapSample sample;
+        ASSERT_TRUE(ReadHeap(HeapRecords(region)[index], sample));
+        ASSERT_TRUE(std::strcmp(sample.m_Name, "TelemetryHeap") == 0);
+        ASSERT_EQ(sample.m_LiveCount, 3);
+        ASSERT_EQ(sample.m_LiveBytes, heap->GetTotal());
+        ASSERT_EQ(sample.m_TotalAllocs, 3);
+
+        for (void* block : blocks) ms_free(block);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        exporter.Publish();
+
+        ASSERT_TRUE(ReadHeap(HeapRecords(region)[index], sample));
+        ASSERT_EQ(sample.m_LiveCount, 0);
+        ASSERT_EQ(sample.m_TotalFrees, 3);
+        ASSERT_TRUE(sample.m_FreeRate > 0);
+        ASSERT_EQ(sample.m_AllocRate, 0);
+
+        // 2. A destroyed heap frees its record.
+        delete heap;
+        exporter.Publish();
+        ASSERT_TRUE(!ReadHeap(HeapRecords(region)[index], sample));
+
+        // 3. A heap replacing a destroyed one between two publishes gets its own name and no rate,
+        // even when it takes over the index and the address.
+        Heap* first = new Heap("TelemetryFirst");
+        ms_free(ms_malloc(100, first));
+        exporter.Publish();
+        const uint16_t reusedIndex = first->GetIndex();
+        const uint32_t firstGeneration = first->GetGeneration();
+        delete first;
+
+        Heap* second = new Heap("TelemetrySecond");
+        ASSERT_EQ(second->GetIndex(), reusedIndex);
+        ASSERT_TRUE(second->GetGeneration() != firstGeneration);
+        for (int i = 0; i < 5; ++i) ms_free(ms_malloc(100, second));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        exporter.Publish();
+
+        ASSERT_TRUE(ReadHeap(HeapRecords(region)[reusedIndex], sample));
+        ASSERT_TRUE(std::strcmp(sample.m_Name, "TelemetrySecond") == 0);
+        ASSERT_EQ(sample.m_TotalAllocs, 5);
+        ASSERT_EQ(sample.m_AllocRate, 0);
+        delete second;
+        exporter.Publish();
+
+        // 4. Pool occupancy, for a ring and a chain.
+        MEM_SENTRY::mem_pool::RingPool<int, alignof(int), true> ring(false, 8, 0);
+        MEM_SENTRY::mem_pool::PoolChain<int, alignof(int), true> chain(4, 0);
+        ASSERT_TRUE(exporter.WatchPool("ring", ring));
+        ASSERT_TRUE(exporter.WatchPool("chain", chain));
+        ASSERT_TRUE(exporter.WatchPool("ring", ring));
+
+        auto* a = ring.pop();
+        auto* b = ring.pop();
+        std::vector<MEM_SENTRY::mem_pool::Buffer<int, alignof(int), true>*> held;
+        for (int i = 0; i < 4; ++i) held.push_back(chain.pop());
+
+        exporter.Publish();
+
+        PoolSample pool;
+        ASSERT_TRUE(ReadPool(PoolRecords(region)[0], pool));
+        ASSERT_TRUE(std::strcmp(pool.m_Name, "ring") == 0);
+        ASSERT_EQ(pool.m_Capacity, 7);
+        ASSERT_EQ(pool.m_Available, 5);
+        ASSERT_EQ(pool.m_Pools, 1);
+
+        ASSERT_TRUE(ReadPool(PoolRecords(region)[1], pool));
+        ASSERT_TRUE(std::strcmp(pool.m_Name, "chain") == 0);
+        ASSERT_EQ(pool.m_Capacity, 6);
+        ASSERT_EQ(pool.m_Available, 2);
+        ASSERT_EQ(pool.m_Pools, 2);
+
+        exporter.UnwatchPool(ring);
+        ASSERT_TRUE(!ReadPool(PoolRecords(region)[0], pool));
+
+        ring.push(a);
+        ring.push(b);
+        for (auto* buffer : held) chain.push(buffer);
+        exporter.UnwatchPool(chain);
+
+        // 5. A reader racing the publisher only ever sees whole records.
+        Heap busy("TelemetryBusy");
+        std::atomic<bool> stop{false};
+        std::thread publisher([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                ms_free(ms_malloc(64, &busy));
+                exporter.Publish();
+            }
+        });
+
+        const HeapRecord& record = HeapRecords(region)[busy.GetIndex()];
+        const uint64_t until = exporter.GetPublishes() + 500;
+        size_t reads = 0;
+
+        while (exporter.GetPublishes() < until) {
+            if (ReadHeap(record, sample)) {
+                ASSERT_EQ(sample.m_TotalFrees, sample.m_TotalAllocs);
+                ASSERT_TRUE(std::strcmp(sample.m_Name, "TelemetryBusy") == 0);
+                ++reads;
+            }
+            std::this_thread::yield();
+        }
+
+        stop.store(true);
+        publisher.join();
+        ASSERT_TRUE(reads > 0);
+#endif
+    }
+
     static void TestHeapHierarchy() {
         LOG_TEST("TestHeapHierarchy (Graph Logic)");
         
@@ -729,6 +2555,111 @@ private:
         delete pIso;
     }
 
+    static void TestHeapHierarchyCache() {
+        LOG_TEST("TestHeapHierarchyCache (Cached Reach + Invalidation)");
+
+        Heap root("CacheRoot");
+        Heap a("CacheA");
+        Heap b("CacheB");
+        Heap c("CacheC");
+
+        int* pRoot = new (&root) int(1);
+        int* pA = new (&a) int(2);
+        int* pB = new (&b) int(3);
+        int* pC = new (&c) int(4);
+
+        // Graph: Root -> A, B -> C
+        root.allocateAdjList(4);
+        root.AddHeap(&a);
+        root.AddHeap(&a); // duplicate edges are ignored
+        b.AddHeap(&c);
+
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(root.CountAllocationsHH(), 2);
+        ASSERT_EQ(b.CountAllocationsHH(), 2);
+
+        // 1. Repeated queries reuse the cached reach: no allocation on any heap.
+        Heap* def = HeapFactory::GetDefaultHeap();
+        const uint64_t allocsBefore = def->GetStats().m_TotalAllocs;
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_EQ(root.GetTotalHH(), 2 * sizeof(int));
+        }
+        ASSERT_EQ(def->GetStats().m_TotalAllocs, allocsBefore);
+
+        // 2. Counters are read live, only the topology is cached.
+        int* pA2 = new (&a) int(5);
+        ASSERT_EQ(root.CountAllocationsHH(), 3);
+        delete pA2;
+
+        // 3. A new edge extends every heap that reaches its source: Root -> A -> B -> C.
+        a.AddHeap(&b);
+        ASSERT_EQ(root.CountAllocationsHH(), 4);
+        ASSERT_EQ(a.CountAllocationsHH(), 3);
+        ASSERT_EQ(b.CountAllocationsHH(), 2);
+
+        // 4. A cycle doesn't visit any heap twice.
+        c.AddHeap(&root);
+        ASSERT_EQ(b.CountAllocationsHH(), 4);
+        ASSERT_EQ(root.GetTotalHH(), 4 * sizeof(int));
+        #endif
+
+        // 5. A destroyed heap leaves the graph of its neighbors.
+        {
+            Heap temp("CacheTemp");
+            int* pTemp = new (&temp) int(6);
+            HeapFactory::ConnectHeaps(&c, &temp);
+            #if MEM_SENTRY_ENABLE
+            ASSERT_EQ(root.CountAllocationsHH(), 5);
+            #endif
+            delete pTemp;
+        }
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(root.CountAllocationsHH(), 4);
+        ASSERT_EQ(c.CountAllocationsHH(), 4);
+        #endif
+
+        // 6. A heap that found the registry full can't be linked: nothing could unlink it.
+        #if !MEM_SENTRY_COMPACT_HEADER
+        {
+            // the fillers live on a heap of their own, the default heap's reporter stays quiet.
+            const size_t MAX_HEAPS = MEM_SENTRY::constants::MAX_HEAPS;
+            Heap holder("CacheHolder");
+            Heap** filler = new (&holder) Heap*[MAX_HEAPS];
+            size_t count = 0;
+            Heap* unregistered = nullptr;
+
+            while(!unregistered && count < MAX_HEAPS){
+                filler[count] = new (&holder) Heap("CacheFiller");
+
+                if(filler[count]->GetIndex() == MAX_HEAPS){
+                    unregistered = filler[count];
+                }
+                ++count;
+            }
+
+            ASSERT_TRUE(unregistered != nullptr);
+            ASSERT_TRUE(!root.AddHeap(unregistered));
+            ASSERT_TRUE(!unregistered->AddHeap(&root));
+            ASSERT_TRUE(!HeapFactory::ConnectHeaps(&c, unregistered));
+            ASSERT_TRUE(root.AddHeap(&a));
+
+            for(size_t i = 0; i < count; ++i){
+                delete filler[i];
+            }
+            delete[] filler;
+        }
+        #endif
+
+        #if MEM_SENTRY_ENABLE
+        ASSERT_EQ(root.CountAllocationsHH(), 4);
+        #endif
+
+        delete pRoot;
+        delete pA;
+        delete pB;
+        delete pC;
+    }
+
     static void TestHeapHierarchyThreadSafety() {
         LOG_TEST("TestHeapHierarchyThreadSafety (Deadlock Check)");
         
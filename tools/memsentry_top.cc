@@ -0,0 +1,257 @@
+// memsentry_top: live reader for the shared memory region of a TelemetryExporter.
+//
+// Maps the region read-only and prints, every interval:
+// - one line per heap (live bytes and blocks, allocations and frees per second, cached and mapped bytes),
+// - one line per watched pool (available buffers out of the capacity, rings).
+//
+// With --prometheus it prints the same counters once in the Prometheus text
+// exposition format instead, for a textfile collector or a scrape sidecar.
+//
+// Usage:
+//   memsentry_top <pid | /shm-name> [--interval MS] [--count N] [--prometheus]
+//
+// The tool only depends on mem_sentry/telemetry_format.h and does not link MemSentry;
+// reading never blocks or slows the process being watched.
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mem_sentry/telemetry_format.h"
+
+using MEM_SENTRY::telemetry::HeapSample;
+using MEM_SENTRY::telemetry::PoolSample;
+using MEM_SENTRY::telemetry::TelemetryHeader;
+
+namespace {
+    /** @brief Command line options. */
+    struct Options {
+        char m_Name[256]{};
+        unsigned m_IntervalMs{1000};
+        unsigned long m_Count{0};
+        bool m_Prometheus{false};
+    };
+
+    void usage(const char* argv0){
+        std::fprintf(stderr, "usage: %s <pid | /shm-name> [--interval MS] [--count N] [--prometheus]\n", argv0);
+    }
+
+    bool isNumber(const char* s){
+        if(!*s)
+            return false;
+
+        for(; *s; ++s){
+            if(*s < '0' || *s > '9')
+                return false;
+        }
+
+        return true;
+    }
+
+    bool parseArgs(int argc, char** argv, Options& options){
+        bool named = false;
+
+        for(int i = 1; i < argc; ++i){
+            if(!std::strcmp(argv[i], "--interval") && i + 1 < argc){
+                options.m_IntervalMs = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            } else if(!std::strcmp(argv[i], "--count") && i + 1 < argc){
+                options.m_Count = std::strtoul(argv[++i], nullptr, 10);
+            } else if(!std::strcmp(argv[i], "--prometheus")){
+                options.m_Prometheus = true;
+            } else if(argv[i][0] != '-' && !named){
+                // a pid names the exporter's default region.
+                if(isNumber(argv[i])){
+                    std::snprintf(options.m_Name, sizeof(options.m_Name), "/memsentry.%s", argv[i]);
+                } else {
+                    std::snprintf(options.m_Name, sizeof(options.m_Name), "%s", argv[i]);
+                }
+
+                named = true;
+            } else {
+                return false;
+            }
+        }
+
+        return named;
+    }
+
+    /**
+     * @brief Maps the region read-only; nullptr (with a message) if it is missing or not a telemetry region.
+     */
+    const TelemetryHeader* mapRegion(const char* name, size_t& bytes){
+        int fd = ::shm_open(name, O_RDONLY, 0);
+
+        if(fd < 0){
+            std::fprintf(stderr, "error: no telemetry region \"%s\"\n", name);
+            return nullptr;
+        }
+
+        struct stat st;
+        void* mem = MAP_FAILED;
+
+        if(::fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(TelemetryHeader)){
+            bytes = (size_t)st.st_size;
+            mem = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+        }
+
+        ::close(fd);
+
+        if(mem == MAP_FAILED){
+            std::fprintf(stderr, "error: can't map \"%s\"\n", name);
+            return nullptr;
+        }
+
+        const TelemetryHeader* header = static_cast<const TelemetryHeader*>(mem);
+
+        if(!MEM_SENTRY::telemetry::IsValid(header) ||
+            MEM_SENTRY::telemetry::RegionBytes(header->m_HeapSlots, header->m_PoolSlots) > bytes){
+            std::fprintf(stderr, "error: \"%s\" is not a telemetry region of version %u\n",
+                name, MEM_SENTRY::telemetry::TELEMETRY_VERSION);
+            ::munmap(mem, bytes);
+            return nullptr;
+        }
+
+        return header;
+    }
+
+    void printTable(const TelemetryHeader* header){
+        std::printf("pid %d, %" PRIu64 " publishes", header->m_Pid, header->m_Publishes.load(std::memory_order_acquire));
+
+        if(uint64_t dropped = header->m_DroppedHeaps.load(std::memory_order_relaxed)){
+            std::printf(", %" PRIu64 " heaps not exported", dropped);
+        }
+
+        std::printf("\n%-32s %14s %10s %10s %10s %12s %12s\n",
+            "HEAP", "LIVE BYTES", "BLOCKS", "ALLOC/S", "FREE/S", "CACHED", "MAPPED");
+
+        const auto* heaps = MEM_SENTRY::telemetry::HeapRecords(header);
+
+        for(uint32_t i = 0; i < header->m_HeapSlots; ++i){
+            HeapSample s;
+
+            if(!MEM_SENTRY::telemetry::ReadHeap(heaps[i], s))
+                continue;
+
+            std::printf("%-32s %14" PRId64 " %10" PRId64 " %10" PRIu64 " %10" PRIu64 " %12" PRId64 " %12" PRId64 "\n",
+                s.m_Name, s.m_LiveBytes, s.m_LiveCount, s.m_AllocRate, s.m_FreeRate, s.m_CachedBytes, s.m_MappedBytes);
+        }
+
+        const auto* pools = MEM_SENTRY::telemetry::PoolRecords(header);
+        bool title = false;
+
+        for(uint32_t i = 0; i < header->m_PoolSlots; ++i){
+            PoolSample s;
+
+            if(!MEM_SENTRY::telemetry::ReadPool(pools[i], s))
+                continue;
+
+            if(!title){
+                std::printf("\n%-32s %12s %12s %6s\n", "POOL", "AVAILABLE", "CAPACITY", "RINGS");
+                title = true;
+            }
+
+            std::printf("%-32s %12" PRIu64 " %12" PRIu64 " %6" PRIu64 "\n", s.m_Name, s.m_Available, s.m_Capacity, s.m_Pools);
+        }
+
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+
+    /** @brief Prints a name as a Prometheus label value. */
+    void printLabel(const char* name){
+        for(; *name; ++name){
+            if(*name == '"' || *name == '\\'){
+                std::putchar('\\');
+            }
+
+            std::putchar(*name);
+        }
+    }
+
+    void printMetric(const char* metric, const char* label, const char* name, int64_t value){
+        std::printf("%s{%s=\"", metric, label);
+        printLabel(name);
+        std::printf("\"} %" PRId64 "\n", value);
+    }
+
+    void printPrometheus(const TelemetryHeader* header){
+        const auto* heaps = MEM_SENTRY::telemetry::HeapRecords(header);
+        const auto* pools = MEM_SENTRY::telemetry::PoolRecords(header);
+
+        std::printf("# TYPE memsentry_heap_live_bytes gauge\n");
+        std::printf("# TYPE memsentry_heap_live_blocks gauge\n");
+        std::printf("# TYPE memsentry_heap_allocs_total counter\n");
+        std::printf("# TYPE memsentry_heap_frees_total counter\n");
+        std::printf("# TYPE memsentry_heap_cached_bytes gauge\n");
+        std::printf("# TYPE memsentry_heap_mapped_bytes gauge\n");
+
+        for(uint32_t i = 0; i < header->m_HeapSlots; ++i){
+            HeapSample s;
+
+            if(!MEM_SENTRY::telemetry::ReadHeap(heaps[i], s))
+                continue;
+
+            printMetric("memsentry_heap_live_bytes", "heap", s.m_Name, s.m_LiveBytes);
+            printMetric("memsentry_heap_live_blocks", "heap", s.m_Name, s.m_LiveCount);
+            printMetric("memsentry_heap_allocs_total", "heap", s.m_Name, (int64_t)s.m_TotalAllocs);
+            printMetric("memsentry_heap_frees_total", "heap", s.m_Name, (int64_t)s.m_TotalFrees);
+            printMetric("memsentry_heap_cached_bytes", "heap", s.m_Name, s.m_CachedBytes);
+            printMetric("memsentry_heap_mapped_bytes", "heap", s.m_Name, s.m_MappedBytes);
+        }
+
+        std::printf("# TYPE memsentry_pool_available gauge\n");
+        std::printf("# TYPE memsentry_pool_capacity gauge\n");
+
+        for(uint32_t i = 0; i < header->m_PoolSlots; ++i){
+            PoolSample s;
+
+            if(!MEM_SENTRY::telemetry::ReadPool(pools[i], s))
+                continue;
+
+            printMetric("memsentry_pool_available", "pool", s.m_Name, (int64_t)s.m_Available);
+            printMetric("memsentry_pool_capacity", "pool", s.m_Name, (int64_t)s.m_Capacity);
+        }
+
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char** argv){
+    Options options;
+
+    if(!parseArgs(argc, argv, options)){
+        usage(argv[0]);
+        return 2;
+    }
+
+    size_t bytes = 0;
+    const TelemetryHeader* header = mapRegion(options.m_Name, bytes);
+
+    if(!header){
+        return 1;
+    }
+
+    if(options.m_Prometheus){
+        printPrometheus(header);
+    } else {
+        for(unsigned long i = 0; options.m_Count == 0 || i < options.m_Count; ++i){
+            if(i){
+                std::this_thread::sleep_for(std::chrono::milliseconds(options.m_IntervalMs));
+            }
+
+            printTable(header);
+        }
+    }
+
+    ::munmap(const_cast<TelemetryHeader*>(header), bytes);
+    return 0;
+}
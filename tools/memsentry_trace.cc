@@ -0,0 +1,149 @@
+// memsentry_trace: offline analyzer for traces written by BinaryTraceReporter.
+//
+// Replays the records of a trace to rebuild the state of every heap, then prints:
+// - a per-heap summary (allocations, frees, live blocks and bytes, peak bytes),
+// - the blocks still live at the end whose IDs fall between two bookmarks (--leaks),
+// - a power-of-two histogram of allocation sizes (--histogram).
+//
+// Usage:
+//   memsentry_trace <trace-file> [--heap NAME] [--leaks FROM TO] [--histogram]
+//
+// A registry index can be reused by a later heap; every HeapName record starts a new
+// heap, so such heaps are listed separately under the same index.
+//
+// The tool only depends on mem_sentry/trace_format.h and does not link MemSentry.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "trace_replay.h"
+
+using MEM_SENTRY::trace::HeapReplay;
+using MEM_SENTRY::trace::TraceFileHeader;
+using MEM_SENTRY::trace::TraceRecord;
+using MEM_SENTRY::trace::TraceReplay;
+
+namespace {
+    /** @brief Command line options. */
+    struct Options {
+        const char* p_Path{nullptr};
+        const char* p_Heap{nullptr};
+        bool m_Leaks{false};
+        uint32_t m_From{0};
+        uint32_t m_To{UINT32_MAX};
+        bool m_Histogram{false};
+    };
+
+    void usage(const char* argv0){
+        std::fprintf(stderr, "usage: %s <trace-file> [--heap NAME] [--leaks FROM TO] [--histogram]\n", argv0);
+    }
+
+    bool parseArgs(int argc, char** argv, Options& options){
+        for(int i = 1; i < argc; ++i){
+            if(!std::strcmp(argv[i], "--heap") && i + 1 < argc){
+                options.p_Heap = argv[++i];
+            } else if(!std::strcmp(argv[i], "--leaks") && i + 2 < argc){
+                options.m_Leaks = true;
+                options.m_From = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+                options.m_To = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            } else if(!std::strcmp(argv[i], "--histogram")){
+                options.m_Histogram = true;
+            } else if(argv[i][0] != '-' && !options.p_Path){
+                options.p_Path = argv[i];
+            } else {
+                return false;
+            }
+        }
+
+        return options.p_Path != nullptr;
+    }
+}
+
+int main(int argc, char** argv){
+    Options options;
+
+    if(!parseArgs(argc, argv, options)){
+        usage(argv[0]);
+        return 2;
+    }
+
+    TraceFileHeader header;
+    std::vector<TraceRecord> records;
+
+    if(!MEM_SENTRY::trace::LoadTrace(options.p_Path, header, records)){
+        return 1;
+    }
+
+    TraceReplay replay;
+    MEM_SENTRY::trace::ReplayTrace(records, options.p_Heap, replay);
+
+    std::printf("trace:   %s\n", options.p_Path);
+    std::printf("records: %zu (%llu skipped), duration %.3f ms\n\n", records.size(),
+        (unsigned long long)replay.m_Skipped, replay.m_LastTimestamp / 1e6);
+
+    std::printf("%-5s %-16s %12s %12s %10s %14s %14s\n", "heap", "name", "allocs", "frees", "live", "live bytes", "peak bytes");
+    for(const HeapReplay& heap : replay.m_Heaps){
+        if(!heap.m_Allocs && !heap.m_Frees)
+            continue;
+
+        std::printf("%-5u %-16s %12llu %12llu %10zu %14lld %14lld\n", heap.m_Index,
+            heap.m_Name.empty() ? "?" : heap.m_Name.c_str(),
+            (unsigned long long)heap.m_Allocs, (unsigned long long)heap.m_Frees, heap.m_Live.size(),
+            (long long)heap.m_LiveBytes, (long long)heap.m_PeakBytes);
+    }
+
+    if(options.m_Leaks){
+        std::printf("\nlive blocks with IDs in [%u, %u]:\n", options.m_From, options.m_To);
+        std::printf("%-16s %10s %10s %6s %10s %18s %14s\n", "heap", "id", "size", "align", "thread", "address", "time (ms)");
+
+        uint64_t leaks = 0;
+        uint64_t leakedBytes = 0;
+
+        for(const HeapReplay& heap : replay.m_Heaps){
+            std::vector<const TraceRecord*> live;
+
+            for(const auto& [id, record] : heap.m_Live){
+                if(id >= options.m_From && id <= options.m_To){
+                    live.push_back(&record);
+                }
+            }
+
+            std::sort(live.begin(), live.end(), [](const TraceRecord* a, const TraceRecord* b){
+                return a->m_AllocId < b->m_AllocId;
+            });
+
+            for(const TraceRecord* record : live){
+                std::printf("%-16s %10u %10u %6u %10u %#18llx %14.3f\n",
+                    heap.m_Name.empty() ? "?" : heap.m_Name.c_str(), record->m_AllocId, record->m_Size,
+                    record->m_AlignShift ? 1u << record->m_AlignShift : 0u, record->m_Thread,
+                    (unsigned long long)record->m_Address, record->m_Timestamp / 1e6);
+
+                ++leaks;
+                leakedBytes += record->m_Size;
+            }
+        }
+
+        std::printf("%llu blocks, %llu bytes\n", (unsigned long long)leaks, (unsigned long long)leakedBytes);
+    }
+
+    if(options.m_Histogram){
+        uint64_t most = *std::max_element(replay.m_Histogram, replay.m_Histogram + 32);
+
+        std::printf("\nallocation sizes:\n");
+        for(int i = 0; i < 32; ++i){
+            if(!replay.m_Histogram[i])
+                continue;
+
+            int bar = most ? static_cast<int>(replay.m_Histogram[i] * 50 / most) : 0;
+            std::printf("[%10llu, %10llu) %12llu %s\n", i ? 1ull << i : 0ull, 1ull << (i + 1),
+                (unsigned long long)replay.m_Histogram[i], std::string(bar ? bar : 1, '#').c_str());
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,170 @@
+#pragma once
+// Trace loading and replay shared by memsentry_trace and its tests.
+//
+// Like the tool, this only depends on mem_sentry/trace_format.h and does not link MemSentry.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mem_sentry/trace_format.h"
+
+namespace MEM_SENTRY::trace {
+    /**
+     * @struct HeapReplay
+     * @brief Replayed state of one heap.
+     *
+     * @note Registry indices are reused once a heap is destroyed, so one index can
+     * stand for several heaps in a trace; each HeapName record starts a new HeapReplay.
+     */
+    struct HeapReplay {
+        /** @brief Registry index the heap was traced under. */
+        uint16_t m_Index{0};
+
+        /** @brief Name from the HeapName record, empty if the trace lacks one. */
+        std::string m_Name;
+
+        uint64_t m_Allocs{0};
+        uint64_t m_Frees{0};
+        int64_t m_LiveBytes{0};
+        int64_t m_PeakBytes{0};
+
+        /** @brief live blocks by allocation ID. */
+        std::unordered_map<uint32_t, TraceRecord> m_Live;
+    };
+
+    /**
+     * @struct TraceReplay
+     * @brief Result of ReplayTrace().
+     */
+    struct TraceReplay {
+        /** @brief heaps ordered by index, then by order of appearance. */
+        std::vector<HeapReplay> m_Heaps;
+
+        /** @brief power-of-two histogram of allocation sizes (see SizeBucket()). */
+        uint64_t m_Histogram[32] = {};
+
+        /** @brief latest timestamp replayed. */
+        uint64_t m_LastTimestamp{0};
+
+        /** @brief records of an unknown type. */
+        uint64_t m_Skipped{0};
+    };
+
+    /** @brief Index of the power-of-two bucket holding `size` (bucket i covers [2^i, 2^(i+1))). */
+    inline int SizeBucket(uint32_t size){
+        return size ? 31 - __builtin_clz(size) : 0;
+    }
+
+    /**
+     * @brief Reads the whole trace. Traces that were not closed properly have a zero
+     * record count; their records are then taken from the file size.
+     */
+    inline bool LoadTrace(const char* path, TraceFileHeader& header, std::vector<TraceRecord>& records){
+        FILE* file = std::fopen(path, "rb");
+
+        if(!file){
+            std::fprintf(stderr, "error: can't open %s\n", path);
+            return false;
+        }
+
+        bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+            !std::memcmp(header.m_Magic, TRACE_MAGIC, sizeof(header.m_Magic)) &&
+            header.m_Version == TRACE_VERSION &&
+            header.m_RecordSize == sizeof(TraceRecord);
+
+        if(!ok){
+            std::fprintf(stderr, "error: %s is not a version %u MemSentry trace\n", path, TRACE_VERSION);
+            std::fclose(file);
+            return false;
+        }
+
+        std::fseek(file, 0, SEEK_END);
+        long size = std::ftell(file);
+        uint64_t available = size > (long)header.m_DataOffset ? (size - header.m_DataOffset) / sizeof(TraceRecord) : 0;
+        uint64_t count = header.m_RecordCount ? std::min(header.m_RecordCount, available) : available;
+
+        records.resize(count);
+        std::fseek(file, (long)header.m_DataOffset, SEEK_SET);
+
+        if(count && std::fread(records.data(), sizeof(TraceRecord), count, file) != count){
+            std::fprintf(stderr, "error: short read in %s\n", path);
+            std::fclose(file);
+            return false;
+        }
+
+        std::fclose(file);
+        return true;
+    }
+
+    /**
+     * @brief Replays `records` in one pass.
+     *
+     * The reporter writes a heap's HeapName record before its first event, so a name
+     * is known by the time its events are replayed. Events of an index with no name
+     * yet go to an unnamed heap.
+     *
+     * @param heap only replay the heaps with this name, nullptr for all of them.
+     */
+    inline void ReplayTrace(const std::vector<TraceRecord>& records, const char* heap, TraceReplay& replay){
+        // slot in m_Heaps of the heap currently traced under each index.
+        std::unordered_map<uint16_t, size_t> current;
+
+        for(const TraceRecord& record : records){
+            auto it = current.find(record.m_Heap);
+
+            if(record.m_Type == TraceRecordType::HeapName || it == current.end()){
+                HeapReplay& state = replay.m_Heaps.emplace_back();
+                state.m_Index = record.m_Heap;
+
+                if(record.m_Type == TraceRecordType::HeapName){
+                    char name[TRACE_NAME_BYTES + 1];
+                    DecodeHeapName(record, name);
+                    state.m_Name = name;
+                }
+
+                it = current.insert_or_assign(record.m_Heap, replay.m_Heaps.size() - 1).first;
+            }
+
+            HeapReplay& state = replay.m_Heaps[it->second];
+
+            if(heap && state.m_Name != heap)
+                continue;
+
+            replay.m_LastTimestamp = std::max(replay.m_LastTimestamp, record.m_Timestamp);
+
+            switch(record.m_Type){
+                case TraceRecordType::Alloc:
+                    ++state.m_Allocs;
+                    state.m_LiveBytes += record.m_Size;
+                    state.m_PeakBytes = std::max(state.m_PeakBytes, state.m_LiveBytes);
+                    state.m_Live[record.m_AllocId] = record;
+                    ++replay.m_Histogram[SizeBucket(record.m_Size)];
+                    break;
+
+                case TraceRecordType::Free:
+                    ++state.m_Frees;
+                    state.m_LiveBytes -= record.m_Size;
+                    state.m_Live.erase(record.m_AllocId);
+                    break;
+
+                case TraceRecordType::Report:
+                case TraceRecordType::HeapName:
+                    break;
+
+                default:
+                    ++replay.m_Skipped;
+                    break;
+            }
+        }
+
+        // stable, so heaps sharing an index stay in trace order.
+        std::stable_sort(replay.m_Heaps.begin(), replay.m_Heaps.end(), [](const HeapReplay& a, const HeapReplay& b){
+            return a.m_Index < b.m_Index;
+        });
+    }
+}